@@ -150,6 +150,7 @@ struct FunctionDecl
     std::vector<ASTNodePtr> defaultArgs;
     std::string returnType;              // NEW: fn name(...) -> int
     ASTNodePtr body;              // BlockStmt
+    std::vector<ASTNodePtr> decorators; // @expr lines above it, outermost first
 };
 
 struct ReturnStmt
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// ─── Aes ──────────────────────────────────────────────────────────────────────
+// AES-128/192/256 with CTR and GCM modes for the `encrypt` module and the
+// legacy aes128_ecb_* natives.  The key schedule is expanded once per Key.
+// With AES-NI + PCLMULQDQ the block cipher and GHASH run on those
+// instructions; otherwise a bitsliced implementation (four blocks per pass)
+// and a multiply-based GHASH are used.  Neither path indexes tables with
+// secret data, so both run in constant time.
+
+namespace aes
+{
+    class Key
+    {
+    public:
+        // len must be 16, 24 or 32; nullptr otherwise.
+        static std::shared_ptr<const Key> create(const uint8_t *key, size_t len);
+
+        int bits() const { return 32 * (rounds_ - 6); }
+        int rounds() const { return rounds_; }
+
+        void encryptBlocks(const uint8_t *in, uint8_t *out, size_t blocks) const;
+        void decryptBlocks(const uint8_t *in, uint8_t *out, size_t blocks) const;
+
+        // out = in ^ keystream for whole blocks, advancing counter.  inc32
+        // increments only the low 32 bits (GCM); otherwise the whole
+        // 128-bit big-endian counter.
+        void ctrBlocks(uint8_t counter[16], const uint8_t *in, uint8_t *out, size_t blocks, bool inc32) const;
+
+    private:
+        Key() = default;
+
+        int rounds_ = 0;
+        alignas(16) uint8_t enc_[15 * 16]; // FIPS-197 round keys
+        alignas(16) uint8_t dec_[15 * 16]; // AES-NI equivalent inverse cipher keys
+        uint64_t planes_[15][8];           // bitsliced round keys
+    };
+
+    // ─── Ctr ─────────────────────────────────────────────────────────────────
+    // Counter-mode stream: process() may be called with any lengths; unused
+    // keystream carries over to the next call.
+
+    class Ctr
+    {
+    public:
+        Ctr(std::shared_ptr<const Key> key, const uint8_t iv[16], bool inc32 = false);
+        void process(const uint8_t *in, uint8_t *out, size_t len);
+
+    private:
+        std::shared_ptr<const Key> key_;
+        uint8_t counter_[16];
+        uint8_t stream_[16];
+        size_t used_ = 16;
+        bool inc32_;
+    };
+
+    // ─── Gcm ─────────────────────────────────────────────────────────────────
+    // Streaming AES-GCM (NIST SP 800-38D).  All AAD must be supplied before
+    // the first update().  A decrypting stream releases plaintext before the
+    // tag is checked; callers must discard it if verify() fails.
+
+    class Gcm
+    {
+    public:
+        Gcm(std::shared_ptr<const Key> key, const uint8_t *nonce, size_t nonceLen, bool encrypt);
+
+        void aad(const uint8_t *data, size_t len);
+        void update(const uint8_t *in, uint8_t *out, size_t len);
+        void tag(uint8_t out[16]);
+        // Constant-time comparison against the first len (12..16) tag bytes.
+        bool verify(const uint8_t *expected, size_t len);
+
+    private:
+        void ghash(const uint8_t *data, size_t len);
+        void ghashFlush();
+
+        std::shared_ptr<const Key> key_;
+        std::unique_ptr<Ctr> ctr_;
+        bool encrypt_;
+        bool started_ = false;
+        alignas(16) uint8_t h_[4][16]; // H, H^2, H^3, H^4 (AES-NI form) or H
+        alignas(16) uint8_t y_[16];    // running GHASH
+        uint8_t j0_[16];
+        uint8_t buf_[16];              // partial GHASH block
+        size_t bufLen_ = 0;
+        uint64_t aadLen_ = 0;
+        uint64_t textLen_ = 0;
+    };
+
+    // "aes-ni" or "bitsliced".
+    const char *backend();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// ─── BufferedFile ─────────────────────────────────────────────────────────────
+// Read/write file handle over stdio with a large user-space buffer, so many
+// small writes turn into few syscalls.  Modes follow fopen ("r", "w", "a",
+// "r+", "w+", "a+", optional "b"); files are always opened in binary mode.
+// The stream is flushed and closed by close() or the destructor.
+
+class BufferedFile
+{
+public:
+    static constexpr size_t kBufferSize = 1 << 20;
+
+    // Returns nullptr if the mode is invalid or the path cannot be opened.
+    static std::shared_ptr<BufferedFile> open(const std::string &path, const std::string &mode);
+    static bool validMode(const std::string &mode);
+    ~BufferedFile();
+
+    BufferedFile(const BufferedFile &) = delete;
+    BufferedFile &operator=(const BufferedFile &) = delete;
+
+    bool isOpen() const { return stream_ != nullptr; }
+    bool canRead() const { return readable_; }
+    bool canWrite() const { return writable_; }
+
+    bool write(std::string_view data);
+    std::string read(size_t n);
+    std::string readAll();
+    // Reads one line without its "\n" / "\r\n"; false at end of file.
+    bool readLine(std::string &line);
+
+    // whence: 0 = start, 1 = current, 2 = end.
+    bool seek(int64_t offset, int whence);
+    int64_t tell();
+    int64_t size();
+    bool flush();
+    bool close();
+
+private:
+    BufferedFile() = default;
+
+    enum class LastOp
+    {
+        None,
+        Read,
+        Write
+    };
+    // stdio requires a flush or seek between switching read and write.
+    void switchTo(LastOp op);
+
+    std::FILE *stream_ = nullptr;
+    std::unique_ptr<char[]> buffer_;
+    bool readable_ = false;
+    bool writable_ = false;
+    LastOp last_ = LastOp::None;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// ─── Codec ────────────────────────────────────────────────────────────────────
+// Byte/text codecs behind base64_*, to_hex / from_hex, url_* and xor_bytes.
+// Each output is sized once up front and written in place.  Base64 and hex
+// use SSSE3 or AVX2 kernels when the CPU has them; URL encoding finds the
+// bytes that need escaping 16 at a time and copies everything else in runs.
+// Results are identical on every path.
+
+namespace codec
+{
+    // Standard alphabet with '=' padding.
+    std::string base64Encode(std::string_view in);
+    // Characters outside the alphabet (line breaks, spaces, ...) are
+    // skipped; decoding stops at the first '='.
+    std::string base64Decode(std::string_view in);
+
+    // Lower-case digits.
+    std::string hexEncode(std::string_view in);
+    // Two characters per byte; a trailing odd character is ignored.  A pair
+    // that is not valid hex decodes the way strtol would read it (e.g. "4z"
+    // gives 0x04, "zz" gives 0).
+    std::string hexDecode(std::string_view in);
+
+    // Percent-encodes everything except A-Z a-z 0-9 - _ . ~
+    std::string urlEncode(std::string_view in);
+    // %XX escapes and '+' as space.
+    std::string urlDecode(std::string_view in);
+
+    // data ^ key repeated; key must not be empty.
+    std::string xorRepeat(std::string_view data, std::string_view key);
+    // Same, over a buffer in place (bytes.xor()).  An empty key is a no-op.
+    void xorInPlace(uint8_t *data, size_t len, std::string_view key);
+
+    // "avx2", "ssse3" or "portable".
+    const char *backend();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// ─── Cpu ──────────────────────────────────────────────────────────────────────
+// Runtime CPU feature checks for the accelerated kernels (hashing, AES, text
+// codecs, string distance).  Each answer is computed once.  Setting
+// QUANTUM_NO_SIMD in the environment makes every check report false, which
+// forces the portable code paths for testing.
+
+namespace cpu
+{
+    bool hasShaNi();  // SHA extensions (with SSSE3 / SSE4.1)
+    bool hasAesNi();  // AES-NI and PCLMULQDQ (with SSSE3 / SSE4.1)
+    bool hasSse2();   // SSE2
+    bool hasSsse3();  // SSSE3 (PSHUFB)
+    bool hasAvx2();   // AVX2, with the OS saving YMM state
+}
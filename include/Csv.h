@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class MappedFile;
+
+// ─── Csv ──────────────────────────────────────────────────────────────────────
+// RFC 4180 records behind csv.reader / csv.columns / csv.writer.  The reader
+// works a record at a time over a buffer in memory, a memory-mapped file
+// (read in place) or a stream read in chunks, so memory stays flat however
+// large the file is.  Delimiters, quotes and line breaks are located 64
+// bytes at a time (SSE2 / AVX2) and handed out one by one from a bitmask.
+// Fields are views into the input; only quoted fields containing a doubled
+// quote are copied.  Quoted fields may span lines; a CRLF, a lone LF or a
+// lone CR ends a record.  Like most readers, it tolerates a stray quote
+// inside an unquoted field and text after a closing quote, keeping both
+// literally.
+
+namespace csv
+{
+    class Reader
+    {
+    public:
+        // quote '\0' turns quoting off (plain TSV and the like).
+        Reader(std::string_view text, char delimiter = ',', char quote = '"');
+        Reader(std::shared_ptr<MappedFile> file, char delimiter = ',', char quote = '"');
+
+        // The next record's fields, valid until the next call.  Blank lines
+        // are skipped.  False at the end of input, or on an error (an
+        // unterminated quoted field) with error() set.
+        bool next(std::vector<std::string_view> &fields);
+
+        // Records returned so far.
+        size_t recordNumber() const { return records_; }
+        // Bytes of input consumed so far.
+        uint64_t offset() const { return base_ + pos_; }
+        const std::string &error() const { return error_; }
+
+    private:
+        enum class Status : uint8_t
+        {
+            Done,
+            NeedMore, // stream mode: the record runs past the buffer
+            End,
+            Failed
+        };
+        struct Copy
+        {
+            size_t field;
+            size_t offset; // in scratch_
+        };
+
+        bool more();
+        size_t find(size_t pos);
+        size_t scan(size_t pos);    // find() past the current block
+        Status record(std::vector<std::string_view> &fields);
+
+        std::shared_ptr<MappedFile> file_;
+        std::string buf_;           // stream mode: unread input
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+        size_t pos_ = 0;
+        uint64_t base_ = 0;         // offset of data_[0] in the input
+        bool eof_ = true;
+
+        char delimiter_;
+        char quote_;
+        size_t maskBase_ = SIZE_MAX; // block the mask describes
+        uint64_t mask_ = 0;
+
+        std::vector<Copy> copies_;   // fields decoded into scratch_
+        std::string scratch_;
+        size_t records_ = 0;
+        std::string error_;
+    };
+
+    // ─── Writing ─────────────────────────────────────────────────────────────
+
+    // s as one field: quoted, with quotes doubled, when it contains the
+    // delimiter, a quote, CR or LF, and copied as is otherwise.
+    void appendField(std::string &out, std::string_view s, char delimiter = ',', char quote = '"');
+
+    // Kernel used to find structural bytes: "avx2", "sse2" or "portable".
+    const char *backend();
+}
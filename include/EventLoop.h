@@ -0,0 +1,126 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ─── EventLoop ────────────────────────────────────────────────────────────────
+// Single-threaded reactor owned by the VM thread, plus a small pool of I/O
+// threads for blocking work.
+//
+//  * submit()  — run blocking work on the pool; the continuation it returns is
+//                executed on the loop thread.  Work must not touch interpreter
+//                state, only the continuation may create values or call back
+//                into scripts.
+//  * watch()   — readiness callbacks for non-blocking sockets (epoll on Linux,
+//                poll / WSAPoll elsewhere).
+//  * addTimer()— one-shot timers.
+//
+// runOnce() waits for any of the three and dispatches them on the caller's
+// thread.
+
+class EventLoop
+{
+public:
+    using Task = std::function<void()>;
+    using Work = std::function<Task()>;
+    using Handle = intptr_t; // socket descriptor (int on POSIX, SOCKET on Windows)
+    using FdCallback = std::function<void(int events)>;
+
+    enum : int
+    {
+        Readable = 1,
+        Writable = 2,
+        Error = 4 // hang-up or socket error; always reported
+    };
+
+    // workers == 0 picks a small default based on the hardware.  Threads are
+    // started lazily on the first submit().
+    explicit EventLoop(size_t workers = 0);
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    // Queue `work` on the pool; its continuation runs on the loop thread.
+    void submit(Work work);
+
+    // Queue a continuation directly.  Safe to call from any thread.
+    void post(Task task);
+
+    // ── Reactor (loop thread only) ────────────────────────────────────────────
+    // `keepAlive` watchers keep hasPending() true (listening servers, open
+    // connections); others are serviced only while something else is pending.
+    void watch(Handle fd, int events, FdCallback cb, bool keepAlive = true);
+    void modify(Handle fd, int events);
+    void unwatch(Handle fd);
+    bool isWatched(Handle fd) const { return watchers_.count(fd) != 0; }
+
+    uint64_t addTimer(double delayMs, Task task);
+    void cancelTimer(uint64_t id);
+
+    // True while submitted work, posted tasks, timers or keep-alive watchers
+    // are outstanding.
+    bool hasPending() const;
+
+    // Dispatch everything that is ready.  If nothing is, wait up to timeoutMs
+    // (-1 = until something happens).  Returns the number of callbacks run.
+    size_t runOnce(int timeoutMs);
+
+    // ── fork() support (POSIX) ───────────────────────────────────────────────
+    // A loop can be carried into a child process only while it is idle: no
+    // pool threads, watchers or timers.  The child then calls afterFork() to
+    // get its own poller and wake-up descriptors.
+    bool canFork() const;
+    void afterFork();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Watcher
+    {
+        int events;
+        bool keepAlive;
+        FdCallback cb;
+    };
+
+    void initPoller();
+    void closePoller();
+    void startWorkers();
+    void workerMain();
+    void wake();
+    size_t runCompletions();
+    size_t runTimers();
+    size_t pollOnce(int timeoutMs);
+    int nextTimerTimeout(int timeoutMs) const;
+
+    size_t workerCount_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workReady_;
+    std::deque<Work> work_;
+    std::deque<Task> done_;
+    size_t pending_ = 0; // submitted + posted, not yet run on the loop thread
+
+    std::unordered_map<Handle, std::shared_ptr<Watcher>> watchers_;
+    size_t keepAlive_ = 0;
+
+    std::multimap<Clock::time_point, uint64_t> timerQueue_;
+    std::unordered_map<uint64_t, Task> timers_;
+    uint64_t nextTimerId_ = 1;
+
+    // Wakes the poller when a worker posts a completion.
+    int pollFd_ = -1;  // epoll instance (Linux)
+    Handle wakeRead_ = -1;
+    Handle wakeWrite_ = -1;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// ─── Fuzzy ────────────────────────────────────────────────────────────────────
+// String distances behind edit_distance, hamming_distance and fuzzy_search.
+// Levenshtein uses the Myers/Hyyrö bit-vector algorithm: one 64-bit word per
+// 64 pattern characters, so a comparison costs O(n·⌈m/64⌉) word operations
+// and allocates no matrix.  Hamming compares 16 or 32 bytes per step.
+// Distances are over bytes, not code points.
+
+namespace fuzzy
+{
+    // Bit-vector Levenshtein for one pattern against many texts; the pattern
+    // tables are built once in the constructor.
+    class Matcher
+    {
+    public:
+        explicit Matcher(std::string_view pattern);
+
+        // Edit distance from the pattern to text.  Once the distance is
+        // known to exceed maxDist the scan stops and maxDist + 1 is returned.
+        size_t distance(std::string_view text, size_t maxDist = SIZE_MAX) const;
+
+        size_t length() const { return m_; }
+
+    private:
+        size_t singleWord(std::string_view text, size_t maxDist) const;
+        size_t multiWord(std::string_view text, size_t maxDist) const;
+
+        size_t m_;
+        size_t words_;
+        std::array<uint64_t, 256> peq1_{};  // match masks when the pattern fits one word
+        std::vector<uint64_t> peq_;         // [byte * words_ + word] otherwise
+    };
+
+    // Levenshtein distance between a and b (the shorter one is the pattern).
+    size_t editDistance(std::string_view a, std::string_view b, size_t maxDist = SIZE_MAX);
+
+    // Positions that differ over the common prefix length, plus the
+    // difference in length.
+    size_t hamming(std::string_view a, std::string_view b);
+
+    // ─── Batch search ────────────────────────────────────────────────────────
+
+    enum class Metric
+    {
+        Levenshtein,
+        Hamming
+    };
+
+    struct Match
+    {
+        size_t index;
+        size_t distance;
+    };
+
+    // Every candidate within maxDist of query, ordered by distance then
+    // index.  Candidates whose length alone puts them out of range are
+    // skipped without a comparison.  threads: 1 runs on the calling thread,
+    // 0 uses one thread per core.
+    std::vector<Match> search(std::string_view query, const std::vector<std::string_view> &candidates,
+                              size_t maxDist, Metric metric, size_t threads = 1);
+
+    // "avx2", "sse2" or "portable" (the Hamming kernel in use).
+    const char *backend();
+}
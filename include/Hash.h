@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ─── Hash ─────────────────────────────────────────────────────────────────────
+// Incremental message digests shared by sha256()/sha1()/md5(), the hashlib
+// objects and hash_file().  Input is compressed straight from the caller's
+// buffer a block at a time; only a partial trailing block is ever copied.
+// SHA-256 and SHA-1 use the x86 SHA extensions when the CPU has them (checked
+// once at startup) and a portable implementation otherwise.
+
+namespace hash
+{
+    class Hasher
+    {
+    public:
+        virtual ~Hasher() = default;
+
+        virtual void update(const void *data, size_t len) = 0;
+        // Writes digestSize() bytes.  Does not disturb the running state, so
+        // more data may follow.
+        virtual void digest(uint8_t *out) const = 0;
+        virtual void reset() = 0;
+        virtual std::unique_ptr<Hasher> clone() const = 0;
+
+        virtual size_t digestSize() const = 0;
+        virtual size_t blockSize() const = 0;
+        virtual std::string name() const = 0;
+
+        void update(std::string_view s) { update(s.data(), s.size()); }
+        std::string digestBytes() const;
+        std::string hexdigest() const;
+    };
+
+    // "sha256", "sha1" or "md5" (case-insensitive, "sha-256" accepted);
+    // nullptr for anything else.
+    std::unique_ptr<Hasher> create(std::string_view algorithm);
+
+    // HMAC over any of the above; nullptr if the algorithm is unknown.
+    std::unique_ptr<Hasher> createHmac(std::string_view algorithm, std::string_view key);
+
+    std::string toHex(const uint8_t *data, size_t len);
+
+    // Hex digest of data in one call; empty for an unknown algorithm.
+    std::string hexOf(std::string_view algorithm, std::string_view data);
+
+    // Feed a whole file through h: regular files straight from a read-only
+    // mapping, anything else through a fixed buffer.  False if the path
+    // cannot be opened.
+    bool hashFile(Hasher &h, const std::string &path);
+
+    // ─── Batch file hashing ──────────────────────────────────────────────────
+    // Hashes many files on a private set of threads, each worker pulling the
+    // next file from a shared cursor so one large file does not hold up the
+    // rest.  Blocks until every job is done; onDone(index) is called on the
+    // worker thread as each file finishes.  Algorithms must be valid for
+    // create().
+
+    struct FileJob
+    {
+        std::string path;
+        std::string algorithm;
+    };
+
+    struct FileResult
+    {
+        std::string hex;
+        bool ok = false; // false if the file could not be opened
+    };
+
+    std::vector<FileResult> hashFiles(const std::vector<FileJob> &jobs, size_t threads,
+                                      const std::function<void(size_t index)> &onDone = nullptr);
+
+    // "sha-ni" when the hardware SHA-256/SHA-1 kernels are in use, else
+    // "portable".
+    const char *backend();
+}
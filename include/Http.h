@@ -0,0 +1,171 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ─── Http ─────────────────────────────────────────────────────────────────────
+// HTTP/1.1 message parsing and serialisation shared by http.serve(), fetch()
+// and parse_http_request().  Parsed request fields are string_views into the
+// parser's own buffer, so nothing is copied until a caller asks for a value.
+
+struct HttpHeader
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+struct HttpResponseHead
+{
+    int status = 0;
+    std::string reason;
+    std::string version;
+    std::vector<std::pair<std::string, std::string>> headers; // names as sent
+    long long contentLength = -1; // -1 when absent
+    bool chunked = false;
+    bool keepAlive = true;
+
+    // Case-insensitive header lookup; empty string if absent.
+    std::string header(std::string_view name) const;
+};
+
+struct HttpRequestHead
+{
+    std::string_view method;
+    std::string_view target; // path + query as sent
+    std::string_view version;
+    std::vector<HttpHeader> headers;
+    size_t contentLength = 0;
+    bool chunked = false;
+    bool keepAlive = true;
+
+    // Case-insensitive header lookup; empty view if absent.
+    std::string_view header(std::string_view name) const;
+};
+
+namespace http
+{
+    bool iequals(std::string_view a, std::string_view b);
+
+    // Parse a request line + header block from the front of `data`.
+    // Returns the head's length including the blank line, 0 if more bytes are
+    // needed, or -1 if the input is malformed.
+    long parseRequestHead(std::string_view data, HttpRequestHead &out);
+    // Same contract for a status line + header block.
+    long parseResponseHead(std::string_view data, HttpResponseHead &out);
+
+    const char *reasonPhrase(int status);
+
+    // Append "HTTP/1.1 <status> <reason>" plus headers and the blank line.
+    // With bodyLength < 0 the body is sent chunked.
+    void appendResponseHead(std::string &out, int status,
+                            const std::vector<std::pair<std::string, std::string>> &headers,
+                            long long bodyLength, bool keepAlive);
+    void appendChunk(std::string &out, std::string_view data);
+    inline void appendLastChunk(std::string &out) { out += "0\r\n\r\n"; }
+}
+
+// ─── HttpRequestParser ────────────────────────────────────────────────────────
+// Incremental request parser for one connection.  Bytes are appended with
+// feed(); parse() reports when a whole request (head and body) is buffered.
+// After the caller has used head()/body(), consume() drops that request and
+// keeps any pipelined bytes that followed it.  The buffer is reused for the
+// lifetime of the connection.
+
+class HttpRequestParser
+{
+public:
+    enum class Status
+    {
+        NeedMore,
+        Done,
+        Error
+    };
+
+    size_t maxHeaderBytes = 64 * 1024;
+    size_t maxBodyBytes = 16 * 1024 * 1024;
+
+    void feed(const char *data, size_t len) { buf_.append(data, len); }
+    Status parse();
+    void consume();
+
+    const HttpRequestHead &head() const { return head_; }
+    std::string_view body() const { return body_; }
+    size_t buffered() const { return buf_.size() - start_; }
+    // Status code to answer a parse error with (400, 413 or 431).
+    int errorStatus() const { return errorStatus_; }
+
+private:
+    Status fail(int status);
+
+    std::string buf_;
+    size_t start_ = 0;   // first byte of the current request
+    size_t headLen_ = 0; // 0 until the head of the current request is parsed
+    size_t bodyEnd_ = 0; // offset just past the current request
+    size_t chunkPos_ = 0; // chunked bodies: next unparsed chunk-size line
+    HttpRequestHead head_;
+    std::string_view body_;
+    std::string chunkedBody_; // reassembled chunked body, reused
+    int errorStatus_ = 400;
+};
+
+// ─── HttpResponseParser ───────────────────────────────────────────────────────
+// Incremental response parser for one client connection.  parse() is pulled
+// repeatedly: Head once the status line and headers are in, then Data for
+// each run of body bytes (a view valid until the next feed()), then Done.
+// The next pipelined response follows on the same parser.  Content-Length,
+// chunked and read-until-close bodies are supported; 1xx interim responses
+// are skipped.
+
+class HttpResponseParser
+{
+public:
+    enum class Status
+    {
+        NeedMore,
+        Head,
+        Data,
+        Done,
+        Error
+    };
+
+    size_t maxHeaderBytes = 64 * 1024;
+
+    void feed(const char *data, size_t len);
+    Status parse();
+    // After Head: the response carries no body (reply to a HEAD request).
+    void skipBody();
+    // The peer closed the connection; ends a read-until-close body.
+    void finish() { eof_ = true; }
+
+    const HttpResponseHead &head() const { return head_; }
+    std::string_view data() const { return data_; }
+    const std::string &error() const { return error_; }
+    // True between messages with nothing buffered.
+    bool idle() const { return state_ == State::Head && buf_.size() == pos_; }
+
+private:
+    enum class State
+    {
+        Head,
+        Body,
+        UntilClose,
+        ChunkSize,
+        ChunkData,
+        ChunkEnd,
+        Trailers,
+        Finished
+    };
+
+    Status fail(const std::string &msg);
+
+    std::string buf_;
+    size_t pos_ = 0;
+    State state_ = State::Head;
+    unsigned long long remaining_ = 0;
+    HttpResponseHead head_;
+    std::string_view data_;
+    std::string error_;
+    bool eof_ = false;
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include "EventLoop.h"
+#include "Http.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class TcpStream;
+namespace net
+{
+    struct Address;
+}
+
+// ─── HttpClient ───────────────────────────────────────────────────────────────
+// HTTP/1.1 client with a per-host connection pool, driven by the EventLoop.
+//
+//  * Idle keep-alive connections are reused; they do not keep the loop alive.
+//  * Up to maxConnectionsPerHost connections are opened per host:port.  Past
+//    that, idempotent requests are pipelined onto the least busy connection
+//    (at most maxPipelineDepth in flight each) and the rest wait their turn.
+//  * An idempotent request that got no response bytes because a reused
+//    connection was closed underneath it is retried on another connection.
+//
+// All callbacks run on the loop thread.
+
+class HttpClient : public std::enable_shared_from_this<HttpClient>
+{
+public:
+    using Resolver = std::function<void(const std::string &host, int port,
+                                        std::function<void(const net::Address *addr, const std::string &err)> done)>;
+
+    struct Request
+    {
+        std::string method = "GET";
+        std::string host;
+        int port = 80;
+        std::string target = "/";
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+        double timeoutMs = 0;  // whole exchange; 0 = none
+        bool pipeline = true;  // may queue behind other requests on a connection
+
+        std::function<void(const HttpResponseHead &)> onHead;
+        std::function<void(const char *data, size_t len)> onData;
+        std::function<void()> onDone;
+        std::function<void(const std::string &)> onError;
+
+        // Flow control while the body is arriving: stop / restart reading
+        // from the connection.
+        void pause();
+        void resume();
+
+    private:
+        friend class HttpClient;
+        std::weak_ptr<TcpStream> stream_;
+        bool responding_ = false; // response bytes have arrived
+        bool finished_ = false;
+        int attempts_ = 0;
+        uint64_t timer_ = 0;
+    };
+
+    HttpClient(EventLoop &loop, Resolver resolve) : loop_(loop), resolve_(std::move(resolve)) {}
+
+    size_t maxConnectionsPerHost = 8;
+    size_t maxPipelineDepth = 4;
+    double idleTimeoutMs = 30000;
+
+    void send(const std::shared_ptr<Request> &req);
+    // Close every idle pooled connection.
+    void closeIdle();
+
+    size_t connectionsOpened() const { return opened_; }
+    size_t openConnections() const;
+    size_t idleConnections() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Conn
+    {
+        std::string key;
+        std::shared_ptr<TcpStream> stream;
+        std::string pendingOut; // requests queued before the socket exists
+        HttpResponseParser parser;
+        std::deque<std::shared_ptr<Request>> inflight;
+        size_t completed = 0;
+        bool reusable = true;
+        bool dead = false;
+        std::string error;
+        Clock::time_point idleSince;
+    };
+
+    struct Host
+    {
+        std::vector<std::shared_ptr<Conn>> conns;
+        std::deque<std::shared_ptr<Request>> waiting;
+    };
+
+    static std::string keyOf(const Request &req);
+    static bool idempotent(const std::string &method);
+    static std::string serialize(const Request &req);
+
+    bool place(const std::shared_ptr<Request> &req);
+    void assign(const std::shared_ptr<Conn> &conn, const std::shared_ptr<Request> &req);
+    void open(const std::shared_ptr<Conn> &conn, const std::string &host, int port);
+    void onResponseBytes(const std::shared_ptr<Conn> &conn);
+    // Conns are taken by value: callers often pass an element of the pool
+    // vector these two erase from.
+    void discard(std::shared_ptr<Conn> conn);
+    void connDead(std::shared_ptr<Conn> conn, const std::string &msg, bool retryAll);
+    void pump(const std::string &key);
+    void finish(const std::shared_ptr<Request> &req, const std::string *error);
+    void timedOut(const std::shared_ptr<Request> &req);
+
+    EventLoop &loop_;
+    Resolver resolve_;
+    std::unordered_map<std::string, Host> hosts_;
+    size_t opened_ = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ─── IP addresses and prefixes ────────────────────────────────────────────────
+// Numeric IPv4 / IPv6 parsing and formatting, shared by IPSet, ip_in_cidr,
+// cidr_hosts / ip_hosts and net.probe.  Nothing here touches the OS resolver.
+
+namespace ipaddr
+{
+    // 128-bit value, most significant half first.  IPv4 addresses live in the
+    // low 32 bits of lo.
+    struct Address
+    {
+        uint64_t hi = 0;
+        uint64_t lo = 0;
+        bool v6 = false;
+
+        int bits() const { return v6 ? 128 : 32; }
+        // Bit i counted from the most significant end (0 = first bit).
+        int bit(int i) const
+        {
+            if (!v6)
+                return static_cast<int>((lo >> (31 - i)) & 1);
+            return static_cast<int>(i < 64 ? (hi >> (63 - i)) & 1 : (lo >> (127 - i)) & 1);
+        }
+        bool operator==(const Address &o) const { return hi == o.hi && lo == o.lo && v6 == o.v6; }
+        bool operator<(const Address &o) const { return hi != o.hi ? hi < o.hi : lo < o.lo; }
+    };
+
+    struct Prefix
+    {
+        Address addr; // host bits cleared
+        int length = 0;
+
+        bool contains(const Address &a) const;
+        Address last() const; // highest address in the prefix
+    };
+
+    bool parseV4(std::string_view text, uint32_t &out);
+    // Dotted IPv4 or IPv6 (with "::" and a trailing dotted quad; a %zone
+    // suffix is ignored).
+    bool parse(std::string_view text, Address &out);
+    // "addr/len", or a bare address as a single-host prefix.  Host bits are
+    // cleared.
+    bool parsePrefix(std::string_view text, Prefix &out);
+    // The length-bit prefix containing a.
+    Prefix prefixOf(const Address &a, int length);
+
+    std::string formatV4(uint32_t ip);
+    // IPv6 in RFC 5952 form: lower case, longest zero run compressed.
+    std::string format(const Address &a);
+    std::string format(const Prefix &p);
+
+    // ::ffff:a.b.c.d as the IPv4 address it wraps; anything else unchanged.
+    Address unmapped(const Address &a);
+
+    // a + 1, wrapping within the family.
+    Address next(const Address &a);
+}
+
+// ─── IPSet ────────────────────────────────────────────────────────────────────
+// A set of IPv4 and IPv6 prefixes in two binary tries (one per family), built
+// once and queried many times.  Membership walks at most prefix-length nodes
+// and stops at the first prefix on the path; longestMatch() keeps walking to
+// the most specific one.  Each prefix carries a caller-defined tag.
+
+class IpSet
+{
+public:
+    static constexpr uint32_t kNoTag = 0xFFFFFFFFu;
+
+    IpSet();
+
+    // Insert a prefix; adding it again replaces its tag.  Returns true if
+    // the prefix is new.
+    bool add(const ipaddr::Prefix &p, uint32_t tag = 0);
+    bool contains(const ipaddr::Address &a) const;
+    // Tag of the most specific prefix containing a, or kNoTag; the prefix
+    // itself goes to *matched when given.
+    uint32_t longestMatch(const ipaddr::Address &a, ipaddr::Prefix *matched = nullptr) const;
+
+    size_t size() const { return count_; }
+    // Every prefix with its tag, IPv4 first, each family in address order.
+    std::vector<std::pair<ipaddr::Prefix, uint32_t>> prefixes() const;
+
+private:
+    struct Node
+    {
+        uint32_t child[2] = {0, 0}; // 0 = none (the root is never a child)
+        uint32_t tag = kNoTag;
+    };
+
+    std::vector<Node> &trie(const ipaddr::Address &a) { return a.v6 ? v6_ : v4_; }
+    const std::vector<Node> &trie(const ipaddr::Address &a) const { return a.v6 ? v6_ : v4_; }
+
+    std::vector<Node> v4_;
+    std::vector<Node> v6_;
+    size_t count_ = 0;
+};
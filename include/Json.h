@@ -0,0 +1,167 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class MappedFile;
+
+// ─── Json ─────────────────────────────────────────────────────────────────────
+// Pull parser behind JSON.parse and json.events / json.lines / json.select.  The caller
+// asks for one token at a time; open containers live on an explicit stack,
+// so nesting depth costs a byte each rather than C++ stack frames.  Input
+// is a buffer in memory, a memory-mapped file (read in place), or a stream
+// read in fixed-size chunks, so memory stays flat however large the
+// document is.  Strings without escapes are returned as views into the
+// input; escaped ones are decoded into one reused buffer.  String bodies
+// are scanned 16 or 32 bytes at a time for the closing quote.
+//
+// The writing half formats strings and numbers straight into the caller's
+// buffer for JSON.stringify.
+
+namespace json
+{
+    enum class Token : uint8_t
+    {
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+        End,  // input exhausted after a complete value
+        Error // see Reader::error()
+    };
+
+    const char *tokenName(Token t);
+
+    class Reader
+    {
+    public:
+        explicit Reader(std::string_view text);
+        explicit Reader(std::shared_ptr<MappedFile> file);
+
+        // Several whitespace-separated top-level values (JSON Lines,
+        // concatenated JSON) instead of exactly one.
+        void allowMultiple(bool on) { multiple_ = on; }
+
+        Token next();
+
+        // Key or String: the decoded text.  Number: the literal as written.
+        // Valid until the next call to next().
+        std::string_view text() const { return text_; }
+        double number() const { return number_; }
+
+        // Containers open after the last token (a BeginX counts itself).
+        size_t depth() const { return stack_.size(); }
+        // Whether the innermost open container is an array.
+        bool inArray() const { return !stack_.empty() && stack_.back() == '['; }
+        // Bytes of input consumed so far.
+        uint64_t offset() const { return base_ + pos_; }
+        const std::string &error() const { return error_; }
+
+        // After BeginObject / BeginArray, consume through the matching end
+        // token; after any other token, do nothing.  False on an error.
+        bool skip();
+
+    private:
+        enum class Expect : uint8_t
+        {
+            Value,
+            ValueOrClose, // just after '['
+            KeyOrClose,   // just after '{'
+            Key,          // after ',' in an object
+            Colon,        // after a key
+            CommaOrClose,
+            Done
+        };
+
+        bool more();                // read another chunk; false at EOF
+        bool skipSpace();           // false at EOF
+        Token fail(const std::string &what);
+        Token value();
+        Token afterValue(Token t);
+        bool string();              // into text_
+        bool literal(std::string_view word);
+        bool numberToken();
+
+        std::shared_ptr<MappedFile> file_;
+        std::string buf_;           // stream mode: unread input
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+        size_t pos_ = 0;
+        uint64_t base_ = 0;         // offset of data_[0] in the input
+        bool eof_ = true;
+
+        std::vector<char> stack_;   // '{' or '['
+        Expect expect_ = Expect::Value;
+        bool multiple_ = false;
+        bool started_ = false;
+
+        std::string_view text_;
+        std::string scratch_;
+        double number_ = 0;
+        std::string error_;
+    };
+
+    // ─── Writing ─────────────────────────────────────────────────────────────
+
+    // s as a quoted JSON string.  Runs that need no escaping are copied
+    // whole; the next '"', '\\' or control byte is found 16 or 32 bytes at
+    // a time.  Control bytes become \n, \t, ... or \u00XX; everything
+    // else, UTF-8 included, passes through.
+    void appendString(std::string &out, std::string_view s);
+
+    // The shortest digits that read back as the same double, laid out the
+    // way JavaScript prints numbers (100, 0.1, 1e+21, 1e-7).  NaN and the
+    // infinities have no JSON form and become null.
+    void appendNumber(std::string &out, double v);
+
+    // Kernel used to scan strings: "avx2", "sse2" or "portable".
+    const char *backend();
+
+    // ─── Paths ───────────────────────────────────────────────────────────────
+    // A JSONPath subset for json.select: $ then any of .name, ['name'],
+    // [n], [*], .* and ..name / ..* (at any depth below).
+
+    class Path
+    {
+    public:
+        // nullptr with error set when the expression does not parse.
+        static std::unique_ptr<Path> compile(std::string_view expr, std::string &error);
+
+        // Matching runs alongside a Reader: a value's states are step()
+        // of its container's states and its key or index.  States are
+        // bitmasks over steps.
+        uint64_t start() const { return 1; }
+        uint64_t step(uint64_t states, std::string_view key) const;
+        uint64_t step(uint64_t states, size_t index) const;
+        bool matches(uint64_t states) const { return (states >> steps_.size()) & 1; }
+        // Whether anything below a value in these states can still match.
+        bool viable(uint64_t states) const { return (states & ((uint64_t(1) << steps_.size()) - 1)) != 0; }
+
+    private:
+        struct Step
+        {
+            enum Kind : uint8_t
+            {
+                Name,
+                Index,
+                Any
+            } kind;
+            bool deep; // '..': may skip any number of levels first
+            std::string name;
+            size_t index;
+        };
+        template <typename Eq>
+        uint64_t advance(uint64_t states, Eq eq) const;
+
+        std::vector<Step> steps_;
+    };
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class MappedFile;
+
+// ─── KvStore ──────────────────────────────────────────────────────────────────
+// Persistent string-to-bytes store kept in one append-only log file.  Every
+// set or delete appends a checksummed record; an in-memory hash index maps
+// each live key to the newest copy of its value.  Small values are cached in
+// the index, large ones are read straight from a mapping of the log.
+//
+// Opening replays the log and cuts it back to the last intact record, so a
+// write torn by a crash costs that write and nothing before it.  Overwritten
+// and deleted records are reclaimed by compaction, which rewrites the live
+// records to a new file and renames it over the log.
+
+namespace kv
+{
+    enum class Sync
+    {
+        Always,   // every write is flushed and fsynced before it returns
+        Interval, // every write reaches the OS; fsync at most once a second
+        None      // writes are buffered until flush() or close()
+    };
+
+    class Store
+    {
+    public:
+        // Returns nullptr if the path cannot be opened or created, or holds
+        // something other than a store.
+        static std::unique_ptr<Store> open(const std::string &path, Sync sync = Sync::Interval);
+        ~Store();
+
+        Store(const Store &) = delete;
+        Store &operator=(const Store &) = delete;
+
+        bool isOpen() const { return file_ != nullptr; }
+        const std::string &path() const { return path_; }
+
+        bool has(std::string_view key) const;
+        // False when the key is absent.
+        bool get(std::string_view key, std::string &value);
+        // set and erase return false when the record cannot be written.
+        bool set(std::string_view key, std::string_view value);
+        bool erase(std::string_view key);
+        std::vector<std::string> keys() const;
+        size_t size() const { return index_.size(); }
+
+        // Bytes in the log, and the part of them held by live records.
+        uint64_t fileBytes() const { return end_; }
+        uint64_t liveBytes() const { return end_ - kHeaderSize - dead_; }
+
+        // Rewrites the log with only live records.  Runs by itself once
+        // dead records outweigh live ones in a log over kCompactMin bytes.
+        bool compact();
+        // Pushes buffered writes to disk and fsyncs the log.
+        bool flush();
+        bool close();
+
+        static constexpr size_t kHeaderSize = 5;        // magic + version
+        static constexpr size_t kInlineMax = 256;       // larger values stay on disk
+        static constexpr uint64_t kCompactMin = 1 << 20;
+
+    private:
+        Store() = default;
+
+        struct Entry
+        {
+            uint64_t offset; // of the value within the log
+            uint32_t size;   // of the value
+            uint32_t record; // whole record, header included
+            std::string value; // the value itself when size <= kInlineMax
+        };
+
+        bool replay();
+        bool append(uint8_t type, std::string_view key, std::string_view value);
+        bool afterWrite();
+        bool sync();
+        // A mapping that covers [0, end) of the log.
+        const char *mapped(uint64_t end);
+
+        std::string path_;
+        Sync sync_ = Sync::Interval;
+        std::FILE *file_ = nullptr;
+        std::shared_ptr<MappedFile> map_;
+        std::unordered_map<std::string, Entry> index_;
+        uint64_t end_ = 0;  // log size, including buffered writes
+        uint64_t dead_ = 0; // bytes of overwritten and deleted records
+        bool dirty_ = false; // written since the last fsync
+        int64_t lastSync_ = 0;
+        std::string record_; // reused encoding buffer
+    };
+}
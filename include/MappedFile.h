@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// ─── MappedFile ───────────────────────────────────────────────────────────────
+// Read-only view of a file's contents.  Regular files are memory-mapped so the
+// bytes are never copied; pipes, character devices, files that report a size
+// of zero (empty, or procfs/sysfs) and anything mmap refuses are read through
+// a buffered stream instead (`isMapped()` tells them apart).
+
+class MappedFile
+{
+public:
+    // Returns nullptr if the path cannot be opened.
+    static std::shared_ptr<MappedFile> open(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isMapped() const { return mapped_; }
+
+    // Whole file when mapped; for streams, only what spool() has loaded.
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Stream mode: read up to n bytes from the current position (0 at EOF).
+    size_t readSome(char *dst, size_t n);
+
+    // Stream mode: load the unread rest of the stream into memory so that
+    // data()/size() can be used for random access.  No-op when mapped.
+    void spool();
+
+    // Hint that the mapping will be scanned front to back.
+    void adviseSequential() const;
+
+private:
+    MappedFile() = default;
+
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string spooled_;
+    std::FILE *stream_ = nullptr;
+#ifdef _WIN32
+    void *fileHandle_ = nullptr;
+    void *mapHandle_ = nullptr;
+#endif
+};
+
+// ─── LineReader ───────────────────────────────────────────────────────────────
+// Sequential line iteration over a MappedFile in constant memory.  Mapped files
+// are scanned in place, so the returned view points straight into the mapping;
+// streams go through one reusable buffer.  A view stays valid until the next
+// call.  Line terminators ("\n" or "\r\n") are stripped.
+
+class LineReader
+{
+public:
+    explicit LineReader(std::shared_ptr<MappedFile> file);
+
+    bool next(std::string_view &line);
+    size_t lineNumber() const { return lineNo_; }
+
+private:
+    std::shared_ptr<MappedFile> file_;
+    size_t pos_ = 0;
+    size_t lineNo_ = 0;
+    std::string buf_;
+    bool eof_ = false;
+};
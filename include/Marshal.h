@@ -0,0 +1,33 @@
+#pragma once
+#include "Value.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// ─── Marshal ──────────────────────────────────────────────────────────────────
+// Compact binary encoding of value graphs for marshal.dumps / loads: nil,
+// bools, numbers, strings, bytes, arrays, dicts and class instances (stored
+// by class name and rebuilt from the class of that name when loaded).
+// Whole numbers are zigzag varints and other numbers raw doubles.  Each
+// distinct string, dict keys included, is written once and referred to by
+// index after that.  An array, dict, instance or bytes value reached a
+// second time is written as a reference to the first, so shared and cyclic
+// structure comes back exactly as it was.  Objects with a single owner
+// cannot be reached twice and are not tracked at all.  Functions, classes
+// and pointers have no encoding.
+
+namespace marshal
+{
+    // Deeper values are refused: encoding and decoding recurse per level.
+    constexpr size_t kMaxDepth = 1000;
+
+    // Appends v's encoding, with the format header, to out.  Throws
+    // RuntimeError for a value with no encoding or nested too deeply.
+    void dump(std::vector<uint8_t> &out, const QuantumValue &v);
+
+    // Decodes a whole buffer written by dump().  Instances take their class
+    // from globals.  Throws RuntimeError on malformed or truncated input or
+    // an unknown class.
+    QuantumValue load(std::string_view data, const std::shared_ptr<Environment> &globals);
+}
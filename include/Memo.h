@@ -0,0 +1,107 @@
+#pragma once
+#include "Value.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// ─── Memo ─────────────────────────────────────────────────────────────────────
+// Least-recently-used cache keyed on argument lists, behind memoize() and
+// LRUCache.  Keys compare by structure, not by their string form: 1 and "1"
+// are different keys, [1, 2] equals any other [1, 2], and a dict equals one
+// with the same entries in any order.  Objects with identity (instances,
+// functions, classes) compare as themselves.  Arrays and dicts are copied
+// when they become keys, so mutating an argument later cannot corrupt the
+// cache.  Lookups, inserts and evictions are O(1).
+
+namespace memo
+{
+    // Containers nested deeper than this compare by identity, which also
+    // keeps cyclic values from recursing forever.
+    constexpr int kMaxDepth = 32;
+
+    size_t hash(const QuantumValue &v);
+    bool equal(const QuantumValue &a, const QuantumValue &b);
+
+    struct Key
+    {
+        std::vector<QuantumValue> values;
+        size_t hash = 0;
+
+        explicit Key(std::vector<QuantumValue> values);
+    };
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    class Cache
+    {
+    public:
+        // Zero for maxEntries, maxBytes or ttl means no bound of that kind.
+        // ttl is in seconds.
+        Cache(size_t maxEntries, size_t maxBytes, double ttl);
+
+        Cache(const Cache &) = delete;
+        Cache &operator=(const Cache &) = delete;
+
+        // The value cached under key, now the most recently used, or nullptr
+        // when absent or expired.  Counts a hit or a miss.
+        const QuantumValue *get(const Key &key);
+        // As get() but without touching recency or the counters.
+        const QuantumValue *peek(const Key &key);
+        // Caches value under key (freezing the key's containers), then
+        // evicts least recently used entries until back within bounds.
+        void put(Key key, QuantumValue value);
+        bool erase(const Key &key);
+        void clear();
+
+        size_t size() const { return index_.size(); }
+        size_t bytes() const { return bytes_; }
+        const Stats &stats() const { return stats_; }
+
+        // Keys, most recently used first.
+        template <typename F>
+        void forEach(F &&f)
+        {
+            expire();
+            for (const auto &e : order_)
+                f(e.key, e.value);
+        }
+
+    private:
+        struct Entry
+        {
+            Key key;
+            QuantumValue value;
+            size_t bytes;
+            double expires; // steady-clock seconds; 0 = never
+        };
+        using Order = std::list<Entry>;
+
+        struct KeyHash
+        {
+            size_t operator()(const Key *k) const { return k->hash; }
+        };
+        struct KeyEq
+        {
+            bool operator()(const Key *a, const Key *b) const;
+        };
+
+        Order::iterator find(const Key &key);
+        void remove(Order::iterator it);
+        void expire();
+
+        size_t maxEntries_;
+        size_t maxBytes_;
+        double ttl_;
+        Order order_; // front = most recently used
+        std::unordered_map<const Key *, Order::iterator, KeyHash, KeyEq> index_;
+        size_t bytes_ = 0;
+        Stats stats_;
+    };
+}
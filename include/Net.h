@@ -0,0 +1,179 @@
+#pragma once
+#include "EventLoop.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// ─── Net ──────────────────────────────────────────────────────────────────────
+// Non-blocking sockets driven by the EventLoop reactor.  Everything here runs
+// on the loop thread; callbacks are plain std::function so the same classes
+// back the script-level socket module, the HTTP server and fetch().
+
+namespace net
+{
+    using Handle = EventLoop::Handle;
+    constexpr Handle kInvalid = -1;
+
+    // Socket address stored opaquely so this header stays free of OS headers.
+    struct Address
+    {
+        alignas(8) unsigned char data[128] = {};
+        int len = 0;
+
+        std::string host() const;
+        int port() const;
+        void setPort(int port);
+    };
+
+    // Initialise the socket library (WSAStartup on Windows).  Idempotent.
+    void startup();
+
+    // Numeric IPv4/IPv6 literal only — never blocks.
+    bool parseAddress(const std::string &host, int port, Address &out);
+    // Numeric literal or DNS name (getaddrinfo; may block on a lookup).
+    bool resolve(const std::string &host, int port, bool udp, Address &out, std::string &err);
+
+    void closeSocket(Handle h);
+    std::string lastError();
+
+    // Start a non-blocking connect.  Returns kInvalid (and sets err) only when
+    // the attempt fails immediately; completion is signalled by writability.
+    Handle startConnect(const Address &addr, std::string &err, int *code = nullptr);
+    // 0 if the connect completed, otherwise the pending socket error code.
+    int connectResult(Handle h);
+    std::string errorString(int code);
+    // The peer actively refused (RST): the host is up, the port is closed.
+    bool isRefused(int code);
+}
+
+// ─── TcpStream ────────────────────────────────────────────────────────────────
+// One TCP connection.  Incoming bytes are read into a reusable per-connection
+// buffer and handed to onData as a view (valid only during the call).
+// Outgoing bytes are written straight to the socket when possible and queued
+// otherwise; write() returns false once the queue passes the high-water mark
+// so producers can wait for onDrain.
+
+class TcpStream : public std::enable_shared_from_this<TcpStream>
+{
+public:
+    static constexpr size_t kReadChunk = 64 * 1024;
+    static constexpr size_t kDefaultHighWater = 1 << 20;
+
+    // Begin connecting; onConnect or onError fires later.
+    static std::shared_ptr<TcpStream> connect(EventLoop &loop, const net::Address &addr, std::string &err);
+    // Wrap an already-connected (accepted) socket.
+    static std::shared_ptr<TcpStream> adopt(EventLoop &loop, net::Handle fd);
+
+    ~TcpStream();
+
+    std::function<void()> onConnect;
+    std::function<void(const char *data, size_t len)> onData;
+    std::function<void()> onEnd; // peer finished sending
+    std::function<void()> onDrain;
+    std::function<void(const std::string &)> onError;
+    std::function<void()> onClose;
+
+    // Start delivering onData (called once the callbacks are set).
+    void start();
+
+    bool write(std::string_view data);
+    // Close after the write queue has been flushed.
+    void end();
+    void close();
+    void pause();
+    void resume();
+
+    bool isOpen() const { return fd_ != net::kInvalid; }
+    bool isConnecting() const { return connecting_; }
+    size_t buffered() const { return out_.size() - outPos_; }
+    void setHighWater(size_t bytes) { highWater_ = bytes; }
+    // Whether this connection alone keeps the event loop (and script) alive;
+    // idle pooled client connections should not.
+    void setHoldsLoop(bool hold);
+    const std::string &remoteHost() const { return remoteHost_; }
+    int remotePort() const { return remotePort_; }
+    int localPort() const;
+
+private:
+    TcpStream(EventLoop &loop, net::Handle fd);
+    void onEvents(int events);
+    void handleReadable();
+    bool flushOut();
+    void updateInterest();
+    void fail(const std::string &msg);
+    void fillPeer();
+
+    EventLoop &loop_;
+    net::Handle fd_;
+    bool connecting_ = false;
+    bool paused_ = false;
+    bool started_ = false;
+    bool ending_ = false;
+    bool eof_ = false;
+    bool holdsLoop_ = true;
+    bool closed_ = false;
+    std::string readBuf_;
+    std::string out_;
+    size_t outPos_ = 0;
+    size_t highWater_ = kDefaultHighWater;
+    bool aboveHighWater_ = false;
+    std::string remoteHost_;
+    int remotePort_ = 0;
+};
+
+// ─── TcpListener ──────────────────────────────────────────────────────────────
+
+class TcpListener : public std::enable_shared_from_this<TcpListener>
+{
+public:
+    // port 0 picks an ephemeral port (see port()).  reusePort enables
+    // SO_REUSEPORT so several processes can share the port.
+    static std::shared_ptr<TcpListener> listen(EventLoop &loop, const std::string &host, int port,
+                                               int backlog, bool reusePort, std::string &err);
+    ~TcpListener();
+
+    // Receives each accepted, non-blocking socket.
+    std::function<void(net::Handle fd)> onAccept;
+
+    void start();
+    // Stop accepting without closing (e.g. before fork()).
+    void stop();
+    void close();
+    int port() const { return port_; }
+    net::Handle handle() const { return fd_; }
+
+private:
+    TcpListener(EventLoop &loop, net::Handle fd, int port) : loop_(loop), fd_(fd), port_(port) {}
+    void acceptAll();
+
+    EventLoop &loop_;
+    net::Handle fd_;
+    int port_;
+};
+
+// ─── UdpSocket ────────────────────────────────────────────────────────────────
+
+class UdpSocket : public std::enable_shared_from_this<UdpSocket>
+{
+public:
+    static std::shared_ptr<UdpSocket> bind(EventLoop &loop, const std::string &host, int port, std::string &err);
+    ~UdpSocket();
+
+    std::function<void(const char *data, size_t len, const net::Address &from)> onMessage;
+
+    void start();
+    bool sendTo(std::string_view data, const net::Address &to);
+    void close();
+    int port() const { return port_; }
+
+private:
+    UdpSocket(EventLoop &loop, net::Handle fd, int port) : loop_(loop), fd_(fd), port_(port) {}
+    void readAll();
+
+    EventLoop &loop_;
+    net::Handle fd_;
+    int port_;
+    std::string readBuf_;
+};
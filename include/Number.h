@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// ─── Number ───────────────────────────────────────────────────────────────────
+// Conversions between doubles and text shared by toString, print, str(),
+// JSON, toFixed and the string-to-number coercions.  Formatting writes the
+// shortest digits that read back as the same double (std::to_chars), and
+// parsing goes through std::from_chars, so neither touches iostreams,
+// locales or exceptions.
+
+namespace number
+{
+    // Shortest round-trip digits laid out as JavaScript prints numbers:
+    // plain for 1e-7 < |v| < 1e21, i.e. decimal exponents in [-6, 21)
+    // (100, 0.1, 0.000001), exponent form outside (1e+21, 1e-7).  -0
+    // prints as 0; NaN and the infinities as nan, inf and -inf.
+    void append(std::string &out, double v);
+    std::string format(double v);
+
+    // v with exactly `places` digits after the point (at most 100), as
+    // Number.prototype.toFixed and "{:.2f}" formats.
+    void appendFixed(std::string &out, double v, int places);
+
+    // Parses a number at the start of s the way std::stod does, without
+    // throwing: leading whitespace, an optional sign, then the longest
+    // decimal, 0x-hex, inf or nan prefix.  Out-of-range values become ±inf
+    // or 0.  Returns false, leaving v alone, when s has no number there;
+    // `used` receives the characters consumed.
+    bool parse(std::string_view s, double &v, size_t *used = nullptr);
+
+    // A script number as a count, length or position: negatives and NaN give
+    // 0, and values past SIZE_MAX saturate instead of overflowing the cast.
+    size_t toCount(double v);
+}
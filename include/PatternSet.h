@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ─── PatternSet ───────────────────────────────────────────────────────────────
+// Aho-Corasick automaton over many literal patterns: one pass over the text
+// reports every occurrence of every pattern, however many there are.  Bytes
+// are first mapped to equivalence classes (all bytes no pattern uses share
+// one), which keeps transition rows short.  When the full transition table
+// fits the budget it is built outright and each byte costs one lookup;
+// larger sets keep resolved rows for the shallow states, where most of the
+// time is spent, and sparse edges plus failure links below them.
+//
+// While the automaton sits in its start state, bytes that cannot begin a
+// pattern are skipped in bulk: memchr for a single first byte, otherwise a
+// nibble-mask test over 16 or 32 bytes at a time (SSSE3 / AVX2) when the set
+// of first bytes is small.
+//
+// Scanning is const and may run on several threads at once.
+
+class PatternSet
+{
+public:
+    struct Match
+    {
+        uint32_t pattern; // index into the constructor's list
+        size_t start;
+        size_t end;
+    };
+
+    // Empty patterns are ignored.  caseInsensitive folds ASCII letters.
+    explicit PatternSet(const std::vector<std::string_view> &patterns, bool caseInsensitive = false);
+
+    // Every occurrence, overlapping ones included, ordered by end offset
+    // (longer patterns first at the same end).  Stops after limit matches.
+    void findAll(std::string_view text, std::vector<Match> &out, size_t limit = SIZE_MAX) const;
+    bool any(std::string_view text) const;
+    size_t count(std::string_view text) const;
+
+    size_t size() const { return lengths_.size(); }
+    size_t states() const { return fail_.size(); }
+    // "dfa" when every state has a full row, "hybrid" otherwise.
+    const char *mode() const { return rowCount_ == fail_.size() ? "dfa" : "hybrid"; }
+    // "memchr", "avx2", "ssse3", "table" or "none".
+    const char *prefilter() const;
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    uint32_t step(uint32_t s, uint8_t byte) const;
+    size_t skip(const uint8_t *p, size_t i, size_t n) const;
+    template <typename F>
+    void scan(std::string_view text, F &&onMatch) const;
+
+    std::array<uint8_t, 256> classOf_{};
+    size_t classes_ = 1;
+
+    std::vector<uint32_t> fail_;     // per state
+    std::vector<uint32_t> dictLink_; // nearest suffix state with output, or kNone
+    std::vector<uint32_t> outStart_; // outputs_[outStart_[s] .. outStart_[s + 1])
+    std::vector<uint32_t> outputs_;  // pattern indices
+    std::vector<uint8_t> reports_;   // state or a suffix of it ends a pattern
+    std::vector<uint32_t> lengths_;  // per pattern
+
+    // States are numbered breadth first, so the shallowest rowCount_ of
+    // them have resolved rows: rows_[state * classes_ + class] is the next
+    // state.
+    std::vector<uint32_t> rows_;
+    size_t rowCount_ = 0;
+
+    // Edges of the remaining states, sorted by class; indexed by
+    // state - rowCount_.
+    std::vector<uint32_t> edgeStart_;
+    std::vector<uint16_t> edgeClass_;
+    std::vector<uint32_t> edgeTo_;
+
+    // Start-state prefilter.
+    enum class Skip
+    {
+        None,
+        Memchr,
+        Nibbles
+    } skip_ = Skip::None;
+    uint8_t skipByte_ = 0;
+    std::array<uint8_t, 16> nibbleLo_{};
+    std::array<uint8_t, 16> nibbleHi_{};
+    std::array<bool, 256> starts_{};
+};
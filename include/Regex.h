@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ─── Regex ────────────────────────────────────────────────────────────────────
+// The engine behind the re module and the /pattern/flags forms of str.split
+// and str.test.  Patterns compile to a Thompson NFA; matching runs two lazy
+// DFAs built from it on demand (forward for where the match ends, reversed
+// for where it starts) and a Pike VM only when capture groups are wanted, so
+// every search is linear in the text whatever the pattern.  Backreferences
+// and lookahead cannot be expressed that way and fall back to std::regex.
+// Matching is over bytes: '.' and classes see UTF-8 one byte at a time, and
+// IgnoreCase folds ASCII letters only.
+
+namespace rx
+{
+    enum Flag : unsigned
+    {
+        IgnoreCase = 1,
+        Multiline = 2, // ^ and $ also match at line breaks
+        DotAll = 4,    // . also matches \n
+    };
+
+    // Byte offsets of a group; start is npos when the group did not take part.
+    struct Span
+    {
+        size_t start = std::string_view::npos;
+        size_t end = std::string_view::npos;
+
+        bool matched() const { return start != std::string_view::npos; }
+    };
+
+    enum class Anchor
+    {
+        None,  // leftmost match at or after the start position (search)
+        Start, // match beginning exactly at the start position (match)
+        Both   // match covering everything from the start position (fullmatch)
+    };
+
+    class Regex
+    {
+    public:
+        // nullptr with error set when the pattern does not compile.
+        static std::shared_ptr<Regex> compile(std::string_view pattern, unsigned flags, std::string &error);
+        ~Regex();
+
+        // Find a match in text starting from byte from.  When groups is given
+        // it is resized to groupCount() + 1 with the whole match first.
+        // Assertions see the text before from, as Python's pos argument does.
+        bool exec(std::string_view text, size_t from, Anchor anchor, std::vector<Span> *groups);
+        // Whether any match exists; stops at the first position one ends.
+        bool test(std::string_view text, size_t from = 0);
+        // Where the earliest-ending match ends, or npos; no start or groups
+        // are worked out.  Patterns on the std::regex fallback report the
+        // end of the leftmost match instead.
+        size_t firstEnd(std::string_view text, size_t from = 0);
+
+        const std::string &pattern() const;
+        unsigned flags() const;
+        size_t groupCount() const;
+        // Name of each group, "" when unnamed; index 0 is the whole match.
+        const std::vector<std::string> &groupNames() const;
+        // "dfa", or "backtrack" for patterns handed to std::regex.
+        const char *engine() const;
+
+    private:
+        Regex();
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+
+    // Compiled patterns keyed by pattern and flags, least recently used
+    // dropped first.  One cache per thread: a Regex keeps its lazily built
+    // DFA states in place and is not safe to share.
+    std::shared_ptr<Regex> cached(std::string_view pattern, unsigned flags, std::string &error);
+    void purgeCache();
+    size_t cacheSize();
+
+    // Parses "ims" style flag letters; false on an unknown letter.  'g' and
+    // 'u' are accepted and ignored (they are JavaScript habits, not modes).
+    bool parseFlags(std::string_view letters, unsigned &out);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// ─── SecureRandom ─────────────────────────────────────────────────────────────
+// ChaCha20 keystream generator behind the secure_random_* natives, one per VM.
+// It is seeded from the OS (getrandom / getentropy / RtlGenRandom) and hands
+// out bytes from a 1 KiB buffer.  After each refill the first 40 bytes of the
+// buffer become the next key and nonce and are wiped, so bytes already handed
+// out cannot be recovered from the generator's state.  The generator reseeds
+// from the OS every 16 MiB, and before the first output in a forked child.
+// Not thread-safe.
+
+class SecureRandom
+{
+public:
+    SecureRandom();
+    ~SecureRandom();
+    SecureRandom(const SecureRandom &) = delete;
+    SecureRandom &operator=(const SecureRandom &) = delete;
+
+    void fill(void *out, size_t len);
+    uint64_t next64();
+    // Uniform in [0, bound); bound 0 means the full 64-bit range.
+    uint64_t below(uint64_t bound);
+    // Uniform in [lo, hi] (inclusive, lo <= hi).
+    int64_t between(int64_t lo, int64_t hi);
+
+    // Read len bytes straight from the OS generator.  False only if no
+    // source is available.
+    static bool systemEntropy(void *out, size_t len);
+
+private:
+    void seed();
+    void refill();
+
+    static constexpr size_t kBuffer = 1024;
+    static constexpr size_t kReseedBytes = 16u << 20;
+
+    uint32_t key_[8] = {};
+    uint32_t nonce_[2] = {};
+    uint8_t buf_[kBuffer];
+    size_t avail_ = 0;     // unread bytes at the end of buf_
+    size_t sinceSeed_ = 0; // output since the last OS reseed
+    unsigned forkGen_ = 0;
+};
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -53,6 +55,38 @@ struct QuantumPointer
     }
 };
 
+// ─── Bytes Type ───────────────────────────────────────────────────────────────
+// A view (offset, length) into a shared, mutable byte buffer.  Slicing makes a
+// new view of the same buffer in O(1), so writes through one view show up in
+// every view that overlaps it; copy() detaches.
+
+struct QuantumBytes
+{
+    std::shared_ptr<std::vector<uint8_t>> buf;
+    size_t offset = 0;
+    size_t length = 0;
+
+    QuantumBytes() : buf(std::make_shared<std::vector<uint8_t>>()) {}
+    explicit QuantumBytes(std::vector<uint8_t> bytes)
+        : buf(std::make_shared<std::vector<uint8_t>>(std::move(bytes))), length(buf->size()) {}
+    explicit QuantumBytes(std::string_view s)
+        : buf(std::make_shared<std::vector<uint8_t>>(s.begin(), s.end())), length(s.size()) {}
+
+    uint8_t *data() { return buf->data() + offset; }
+    const uint8_t *data() const { return buf->data() + offset; }
+    size_t size() const { return length; }
+    std::string_view view() const { return {reinterpret_cast<const char *>(data()), length}; }
+
+    // View of [start, end) within this view (caller clamps).
+    std::shared_ptr<QuantumBytes> slice(size_t start, size_t end) const
+    {
+        auto b = std::make_shared<QuantumBytes>(*this);
+        b->offset = offset + start;
+        b->length = end - start;
+        return b;
+    }
+};
+
 struct QuantumValue
 {
     using Data = std::variant<
@@ -67,7 +101,8 @@ struct QuantumValue
         std::shared_ptr<QuantumInstance>,
         std::shared_ptr<QuantumClass>,
         std::shared_ptr<QuantumBoundMethod>,
-        std::shared_ptr<QuantumPointer>>;
+        std::shared_ptr<QuantumPointer>,
+        std::shared_ptr<QuantumBytes>>;
 
     Data data;
 
@@ -85,6 +120,7 @@ struct QuantumValue
     explicit QuantumValue(std::shared_ptr<QuantumClass> c) : data(std::move(c)) {}
     explicit QuantumValue(std::shared_ptr<QuantumBoundMethod> bm) : data(std::move(bm)) {}
     explicit QuantumValue(std::shared_ptr<QuantumPointer> p) : data(std::move(p)) {}
+    explicit QuantumValue(std::shared_ptr<QuantumBytes> b) : data(std::move(b)) {}
 
     // Type checks
     bool isNil() const { return std::holds_alternative<QuantumNil>(data); }
@@ -98,11 +134,12 @@ struct QuantumValue
     bool isClass() const { return std::holds_alternative<std::shared_ptr<QuantumClass>>(data); }
     bool isBoundMethod() const { return std::holds_alternative<std::shared_ptr<QuantumBoundMethod>>(data); }
     bool isPointer() const { return std::holds_alternative<std::shared_ptr<QuantumPointer>>(data); }
+    bool isBytes() const { return std::holds_alternative<std::shared_ptr<QuantumBytes>>(data); }
 
     // Accessors
     bool asBool() const { return std::get<bool>(data); }
     double asNumber() const { return std::get<double>(data); }
-    std::string asString() const { return std::get<std::string>(data); }
+    const std::string &asString() const { return std::get<std::string>(data); }
     std::shared_ptr<Array> asArray() const { return std::get<std::shared_ptr<Array>>(data); }
     std::shared_ptr<Dict> asDict() const { return std::get<std::shared_ptr<Dict>>(data); }
     std::shared_ptr<Closure> asFunction() const { return std::get<std::shared_ptr<Closure>>(data); }
@@ -110,6 +147,11 @@ struct QuantumValue
     std::shared_ptr<QuantumClass> asClass() const { return std::get<std::shared_ptr<QuantumClass>>(data); }
     std::shared_ptr<QuantumBoundMethod> asBoundMethod() const { return std::get<std::shared_ptr<QuantumBoundMethod>>(data); }
     std::shared_ptr<QuantumPointer> asPointer() const { return std::get<std::shared_ptr<QuantumPointer>>(data); }
+    std::shared_ptr<QuantumBytes> asBytes() const { return std::get<std::shared_ptr<QuantumBytes>>(data); }
+
+    // Raw contents of a string or bytes value without copying; anything else
+    // is printed into scratch.  Valid while this value (or scratch) lives.
+    std::string_view bytesView(std::string &scratch) const;
 
     bool isNative() const;
     std::shared_ptr<QuantumNative> asNative() const;
@@ -2,12 +2,24 @@
 #include "Opcode.h"
 #include "Value.h"
 #include "Error.h"
+#include "EventLoop.h"
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <functional>
 #include <string>
 
+class TcpStream;
+class HttpClient;
+class SecureRandom;
+struct HttpServer;
+struct HttpConnection;
+struct HttpExchange;
+namespace net
+{
+    struct Address;
+}
+
 // ─── Upvalue (heap cell for captured variables) ───────────────────────────────
 struct Upvalue
 {
@@ -47,6 +59,32 @@ struct ExceptionHandler
     size_t stackDepth; // value stack depth to restore
 };
 
+// ─── Lazy iterators ───────────────────────────────────────────────────────────
+// Natives named "__iter__" return the next value on each call and nil once
+// exhausted.  An iterator that can yield nil itself (a JSON null) returns
+// iterNil() in its place, which FOR_ITER hands to the loop as nil.
+QuantumValue iterNil();
+bool isIterNil(const QuantumValue &v);
+
+// ─── PromiseState ─────────────────────────────────────────────────────────────
+// Backing state of a script-visible Promise object.  Reactions queued while
+// pending run on the VM thread when the promise settles.
+struct PromiseState
+{
+    enum class Status
+    {
+        Pending,
+        Fulfilled,
+        Rejected
+    };
+    Status status = Status::Pending;
+    QuantumValue value;
+    std::vector<std::function<void()>> reactions;
+};
+
+// Produces an async operation's result on the VM thread (see VM::startAsync).
+using AsyncResult = std::function<QuantumValue()>;
+
 // ─── VM ───────────────────────────────────────────────────────────────────────
 class VM
 {
@@ -74,9 +112,24 @@ private:
 
     // ── Native registration ───────────────────────────────────────────────────
     void registerNatives();
+    void registerFileNatives();
+    void registerAsyncNatives();
+    void registerNetNatives();
+    void registerHttpNatives();
+    void registerHashNatives();
+    void registerCryptoNatives();
+    void registerIpNatives();
+    void registerRegexNatives();
+    void registerScanNatives();
+    void registerJsonNatives();
+    void registerCsvNatives();
+    void registerMarshalNatives();
+    void registerKvNatives();
+    void registerMemoNatives();
 
     // ── Execution ────────────────────────────────────────────────────────────
     void runFrame(size_t stopDepth = 0);
+    void dispatch(size_t stopDepth);
 
     // ── Stack helpers ─────────────────────────────────────────────────────────
     void push(QuantumValue v);
@@ -101,6 +154,53 @@ private:
     QuantumValue callDictMethod(std::shared_ptr<Dict> d,
                                 const std::string &method,
                                 std::vector<QuantumValue> args);
+    QuantumValue callBytesMethod(std::shared_ptr<QuantumBytes> b,
+                                 const std::string &method,
+                                 std::vector<QuantumValue> args);
+    // bytes.from_hex(...) and friends, reached through the bytes() native.
+    QuantumValue callBytesStatic(const std::string &method, std::vector<QuantumValue> args);
+
+    // Call any callable value from native code and return its result.
+    QuantumValue callFunction(const QuantumValue &fn, std::vector<QuantumValue> args);
+
+    // ── Event loop & promises ─────────────────────────────────────────────────
+    std::unique_ptr<EventLoop> loop_;
+    EventLoop &eventLoop();
+    // Run completions until nothing is pending (end of script).
+    void drainEventLoop();
+    QuantumValue makePromise(const std::shared_ptr<PromiseState> &state);
+    void settlePromise(const std::shared_ptr<PromiseState> &state, QuantumValue value, bool rejected);
+    // Block (while running completions) until `value` settles if it is a promise.
+    QuantumValue awaitValue(const QuantumValue &value);
+    // Run `work` on the I/O pool.  It must not touch VM state; the function it
+    // returns builds the result on the VM thread (throw to reject).  Returns a
+    // promise, and calls callback(err, result) too when one is given.
+    QuantumValue startAsync(std::function<AsyncResult()> work, QuantumValue callback = QuantumValue());
+
+    // ── Networking (VmNetNatives.cpp) ─────────────────────────────────────────
+    // Resolve host (on the I/O pool unless it is a numeric literal) and report
+    // back on the VM thread.
+    void resolveHost(const std::string &host, int port,
+                     std::function<void(const net::Address *addr, const std::string &err)> done);
+    // Script object for a connected TCP stream (send / recv / on / close ...).
+    QuantumValue wrapTcpStream(const std::shared_ptr<TcpStream> &stream);
+
+    // ── HTTP server (VmHttpNatives.cpp) ───────────────────────────────────────
+    void acceptHttpConnection(const std::shared_ptr<HttpServer> &server, EventLoop::Handle fd);
+    // Parse and dispatch buffered requests, one at a time, in arrival order.
+    void pumpHttpConnection(const std::shared_ptr<HttpConnection> &conn);
+    QuantumValue makeHttpResponse(const std::shared_ptr<HttpExchange> &ex);
+    // Finish a response from a handler's return value (string, dict or promise).
+    void applyHttpResult(const std::shared_ptr<HttpExchange> &ex, const QuantumValue &result);
+
+    // ── HTTP client (fetch) ───────────────────────────────────────────────────
+    // Declared after loop_ so pooled connections are released first.
+    std::shared_ptr<HttpClient> httpClient_;
+    HttpClient &httpClient();
+
+    // ── Secure random (VmCryptoNatives.cpp) ───────────────────────────────────
+    std::shared_ptr<SecureRandom> secureRandom_;
+    SecureRandom &secureRandom();
 
     // ── Upvalue helpers ───────────────────────────────────────────────────────
     std::shared_ptr<Upvalue> captureUpvalue(size_t stackIdx);
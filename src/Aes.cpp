@@ -0,0 +1,918 @@
+#include "Aes.h"
+#include "Cpu.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_AES_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define QUANTUM_TARGET_AES
+#else
+#define QUANTUM_TARGET_AES __attribute__((target("aes,pclmul,sse4.1,ssse3")))
+#endif
+#endif
+
+namespace
+{
+    // ─── Bitsliced core ──────────────────────────────────────────────────────
+    // Four blocks are held as eight 64-bit planes: bit j of q[i] is bit i of
+    // byte j, where bytes 0..15 are the first block in FIPS-197 order, 16..31
+    // the second, and so on.  Every step is plain boolean logic.
+
+    inline uint64_t loadLE64(const uint8_t *p)
+    {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--)
+            v = (v << 8) | p[i];
+        return v;
+    }
+
+    inline void storeLE64(uint8_t *p, uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+            p[i] = uint8_t(v >> (8 * i));
+    }
+
+    // Transpose an 8x8 bit matrix: bit 8r+c <-> bit 8c+r.
+    inline uint64_t transpose8(uint64_t x)
+    {
+        uint64_t t;
+        t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+        x ^= t ^ (t << 28);
+        return x;
+    }
+
+    void pack(const uint8_t in[64], uint64_t q[8])
+    {
+        for (int i = 0; i < 8; i++)
+            q[i] = 0;
+        for (int g = 0; g < 8; g++)
+        {
+            uint64_t x = transpose8(loadLE64(in + 8 * g));
+            for (int i = 0; i < 8; i++)
+                q[i] |= ((x >> (8 * i)) & 0xFF) << (8 * g);
+        }
+    }
+
+    void unpack(const uint64_t q[8], uint8_t out[64])
+    {
+        for (int g = 0; g < 8; g++)
+        {
+            uint64_t x = 0;
+            for (int i = 0; i < 8; i++)
+                x |= ((q[i] >> (8 * g)) & 0xFF) << (8 * i);
+            storeLE64(out + 8 * g, transpose8(x));
+        }
+    }
+
+    // S-box as a 113-gate circuit (Boyar–Peralta): a linear layer, the
+    // GF(2^8) inversion in the tower field, and a second linear layer.
+    void subBytes(uint64_t q[8])
+    {
+        uint64_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4];
+        uint64_t x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+        uint64_t y14 = x3 ^ x5;
+        uint64_t y13 = x0 ^ x6;
+        uint64_t y9 = x0 ^ x3;
+        uint64_t y8 = x0 ^ x5;
+        uint64_t t0 = x1 ^ x2;
+        uint64_t y1 = t0 ^ x7;
+        uint64_t y4 = y1 ^ x3;
+        uint64_t y12 = y13 ^ y14;
+        uint64_t y2 = y1 ^ x0;
+        uint64_t y5 = y1 ^ x6;
+        uint64_t y3 = y5 ^ y8;
+        uint64_t t1 = x4 ^ y12;
+        uint64_t y15 = t1 ^ x5;
+        uint64_t y20 = t1 ^ x1;
+        uint64_t y6 = y15 ^ x7;
+        uint64_t y10 = y15 ^ t0;
+        uint64_t y11 = y20 ^ y9;
+        uint64_t y7 = x7 ^ y11;
+        uint64_t y17 = y10 ^ y11;
+        uint64_t y19 = y10 ^ y8;
+        uint64_t y16 = t0 ^ y11;
+        uint64_t y21 = y13 ^ y16;
+        uint64_t y18 = x0 ^ y16;
+
+        uint64_t t2 = y12 & y15;
+        uint64_t t3 = y3 & y6;
+        uint64_t t4 = t3 ^ t2;
+        uint64_t t5 = y4 & x7;
+        uint64_t t6 = t5 ^ t2;
+        uint64_t t7 = y13 & y16;
+        uint64_t t8 = y5 & y1;
+        uint64_t t9 = t8 ^ t7;
+        uint64_t t10 = y2 & y7;
+        uint64_t t11 = t10 ^ t7;
+        uint64_t t12 = y9 & y11;
+        uint64_t t13 = y14 & y17;
+        uint64_t t14 = t13 ^ t12;
+        uint64_t t15 = y8 & y10;
+        uint64_t t16 = t15 ^ t12;
+        uint64_t t17 = t4 ^ t14;
+        uint64_t t18 = t6 ^ t16;
+        uint64_t t19 = t9 ^ t14;
+        uint64_t t20 = t11 ^ t16;
+        uint64_t t21 = t17 ^ y20;
+        uint64_t t22 = t18 ^ y19;
+        uint64_t t23 = t19 ^ y21;
+        uint64_t t24 = t20 ^ y18;
+
+        uint64_t t25 = t21 ^ t22;
+        uint64_t t26 = t21 & t23;
+        uint64_t t27 = t24 ^ t26;
+        uint64_t t28 = t25 & t27;
+        uint64_t t29 = t28 ^ t22;
+        uint64_t t30 = t23 ^ t24;
+        uint64_t t31 = t22 ^ t26;
+        uint64_t t32 = t31 & t30;
+        uint64_t t33 = t32 ^ t24;
+        uint64_t t34 = t23 ^ t33;
+        uint64_t t35 = t27 ^ t33;
+        uint64_t t36 = t24 & t35;
+        uint64_t t37 = t36 ^ t34;
+        uint64_t t38 = t27 ^ t36;
+        uint64_t t39 = t29 & t38;
+        uint64_t t40 = t25 ^ t39;
+
+        uint64_t t41 = t40 ^ t37;
+        uint64_t t42 = t29 ^ t33;
+        uint64_t t43 = t29 ^ t40;
+        uint64_t t44 = t33 ^ t37;
+        uint64_t t45 = t42 ^ t41;
+        uint64_t z0 = t44 & y15;
+        uint64_t z1 = t37 & y6;
+        uint64_t z2 = t33 & x7;
+        uint64_t z3 = t43 & y16;
+        uint64_t z4 = t40 & y1;
+        uint64_t z5 = t29 & y7;
+        uint64_t z6 = t42 & y11;
+        uint64_t z7 = t45 & y17;
+        uint64_t z8 = t41 & y10;
+        uint64_t z9 = t44 & y12;
+        uint64_t z10 = t37 & y3;
+        uint64_t z11 = t33 & y4;
+        uint64_t z12 = t43 & y13;
+        uint64_t z13 = t40 & y5;
+        uint64_t z14 = t29 & y2;
+        uint64_t z15 = t42 & y9;
+        uint64_t z16 = t45 & y14;
+        uint64_t z17 = t41 & y8;
+
+        uint64_t t46 = z15 ^ z16;
+        uint64_t t47 = z10 ^ z11;
+        uint64_t t48 = z5 ^ z13;
+        uint64_t t49 = z9 ^ z10;
+        uint64_t t50 = z2 ^ z12;
+        uint64_t t51 = z2 ^ z5;
+        uint64_t t52 = z7 ^ z8;
+        uint64_t t53 = z0 ^ z3;
+        uint64_t t54 = z6 ^ z7;
+        uint64_t t55 = z16 ^ z17;
+        uint64_t t56 = z12 ^ t48;
+        uint64_t t57 = t50 ^ t53;
+        uint64_t t58 = z4 ^ t46;
+        uint64_t t59 = z3 ^ t54;
+        uint64_t t60 = t46 ^ t57;
+        uint64_t t61 = z14 ^ t57;
+        uint64_t t62 = t52 ^ t58;
+        uint64_t t63 = t49 ^ t58;
+        uint64_t t64 = z4 ^ t59;
+        uint64_t t65 = t61 ^ t62;
+        uint64_t t66 = z1 ^ t63;
+        uint64_t s0 = t59 ^ t63;
+        uint64_t s6 = t56 ^ ~t62;
+        uint64_t s7 = t48 ^ ~t60;
+        uint64_t t67 = t64 ^ t65;
+        uint64_t s3 = t53 ^ t66;
+        uint64_t s4 = t51 ^ t66;
+        uint64_t s5 = t47 ^ t65;
+        uint64_t s1 = t64 ^ ~s3;
+        uint64_t s2 = t55 ^ ~t67;
+
+        q[7] = s0;
+        q[6] = s1;
+        q[5] = s2;
+        q[4] = s3;
+        q[3] = s4;
+        q[2] = s5;
+        q[1] = s6;
+        q[0] = s7;
+    }
+
+    // Inverse of the S-box's affine step: InvSubBytes = A⁻¹ ∘ S ∘ A⁻¹.
+    void invAffine(uint64_t q[8])
+    {
+        uint64_t r[8];
+        for (int i = 0; i < 8; i++)
+            r[i] = q[(i + 2) & 7] ^ q[(i + 5) & 7] ^ q[(i + 7) & 7];
+        r[0] = ~r[0];
+        r[2] = ~r[2];
+        for (int i = 0; i < 8; i++)
+            q[i] = r[i];
+    }
+
+    void invSubBytes(uint64_t q[8])
+    {
+        invAffine(q);
+        subBytes(q);
+        invAffine(q);
+    }
+
+    // Byte r + 4c of a block sits at bit r + 4c of its 16-bit lane, so rows
+    // are bit positions mod 4 and columns are nibbles.
+    constexpr uint64_t kRow0 = 0x1111111111111111ULL;
+
+    inline uint64_t rotrLanes16(uint64_t x, int s)
+    {
+        if (s == 0)
+            return x;
+        const uint64_t low = (0xFFFFULL >> s) * 0x0001000100010001ULL;
+        return ((x >> s) & low) | ((x << (16 - s)) & ~low);
+    }
+
+    inline uint64_t shiftRowsPlane(uint64_t x, bool inverse)
+    {
+        uint64_t out = x & kRow0;
+        for (int r = 1; r < 4; r++)
+            out |= rotrLanes16(x & (kRow0 << r), inverse ? 16 - 4 * r : 4 * r);
+        return out;
+    }
+
+    void shiftRows(uint64_t q[8], bool inverse)
+    {
+        for (int i = 0; i < 8; i++)
+            q[i] = shiftRowsPlane(q[i], inverse);
+    }
+
+    // Row r takes row r+k of the same column.
+    inline uint64_t rotRows(uint64_t x, int k)
+    {
+        switch (k)
+        {
+        case 1:
+            return ((x >> 1) & 0x7777777777777777ULL) | ((x << 3) & 0x8888888888888888ULL);
+        case 2:
+            return ((x >> 2) & 0x3333333333333333ULL) | ((x << 2) & 0xCCCCCCCCCCCCCCCCULL);
+        default:
+            return ((x >> 3) & 0x1111111111111111ULL) | ((x << 1) & 0xEEEEEEEEEEEEEEEEULL);
+        }
+    }
+
+    // Multiply every byte by x in GF(2^8).
+    inline void xtime(const uint64_t a[8], uint64_t out[8])
+    {
+        out[0] = a[7];
+        out[1] = a[0] ^ a[7];
+        out[2] = a[1];
+        out[3] = a[2] ^ a[7];
+        out[4] = a[3] ^ a[7];
+        out[5] = a[4];
+        out[6] = a[5];
+        out[7] = a[6];
+    }
+
+    // b_r = 2·a_r ^ 3·a_{r+1} ^ a_{r+2} ^ a_{r+3} = 2·(a_r ^ a_{r+1}) ^ a_{r+1} ^ a_{r+2} ^ a_{r+3}
+    void mixColumns(uint64_t q[8])
+    {
+        uint64_t r1[8], d[8], x[8];
+        for (int i = 0; i < 8; i++)
+        {
+            r1[i] = rotRows(q[i], 1);
+            d[i] = q[i] ^ r1[i];
+        }
+        xtime(d, x);
+        for (int i = 0; i < 8; i++)
+            q[i] = x[i] ^ r1[i] ^ rotRows(q[i], 2) ^ rotRows(q[i], 3);
+    }
+
+    // InvMixColumns = MixColumns ∘ (a_r ^ 4·(a_r ^ a_{r+2})).
+    void invMixColumns(uint64_t q[8])
+    {
+        uint64_t d[8], x[8], x2[8];
+        for (int i = 0; i < 8; i++)
+            d[i] = q[i] ^ rotRows(q[i], 2);
+        xtime(d, x);
+        xtime(x, x2);
+        for (int i = 0; i < 8; i++)
+            q[i] ^= x2[i];
+        mixColumns(q);
+    }
+
+    inline void addRoundKey(uint64_t q[8], const uint64_t rk[8])
+    {
+        for (int i = 0; i < 8; i++)
+            q[i] ^= rk[i];
+    }
+
+    void encrypt4(const uint64_t rk[][8], int rounds, const uint8_t in[64], uint8_t out[64])
+    {
+        uint64_t q[8];
+        pack(in, q);
+        addRoundKey(q, rk[0]);
+        for (int r = 1; r < rounds; r++)
+        {
+            subBytes(q);
+            shiftRows(q, false);
+            mixColumns(q);
+            addRoundKey(q, rk[r]);
+        }
+        subBytes(q);
+        shiftRows(q, false);
+        addRoundKey(q, rk[rounds]);
+        unpack(q, out);
+    }
+
+    void decrypt4(const uint64_t rk[][8], int rounds, const uint8_t in[64], uint8_t out[64])
+    {
+        uint64_t q[8];
+        pack(in, q);
+        addRoundKey(q, rk[rounds]);
+        for (int r = rounds - 1; r >= 0; r--)
+        {
+            shiftRows(q, true);
+            invSubBytes(q);
+            addRoundKey(q, rk[r]);
+            if (r > 0)
+                invMixColumns(q);
+        }
+        unpack(q, out);
+    }
+
+    // S-box on up to 64 bytes through the same circuit; used by the key
+    // schedule so it too avoids table lookups.
+    void subBytesCT(uint8_t *bytes, size_t n)
+    {
+        uint8_t buf[64] = {};
+        std::memcpy(buf, bytes, n);
+        uint64_t q[8];
+        pack(buf, q);
+        subBytes(q);
+        unpack(q, buf);
+        std::memcpy(bytes, buf, n);
+    }
+
+    inline void increment(uint8_t counter[16], bool inc32)
+    {
+        int stop = inc32 ? 12 : 0;
+        for (int i = 15; i >= stop; i--)
+            if (++counter[i] != 0)
+                break;
+    }
+
+    // ─── GHASH ───────────────────────────────────────────────────────────────
+    // Portable: 64x64 carry-less products from integer multiplies on operands
+    // with every fourth bit kept, so carries land in the gaps and are masked
+    // away.  The upper half of each product comes from bit-reversed inputs.
+
+    inline uint64_t bmul64(uint64_t x, uint64_t y)
+    {
+        const uint64_t m0 = 0x1111111111111111ULL, m1 = m0 << 1, m2 = m0 << 2, m3 = m0 << 3;
+        uint64_t x0 = x & m0, x1 = x & m1, x2 = x & m2, x3 = x & m3;
+        uint64_t y0 = y & m0, y1 = y & m1, y2 = y & m2, y3 = y & m3;
+        uint64_t z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+        uint64_t z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+        uint64_t z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+        uint64_t z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+        return (z0 & m0) | (z1 & m1) | (z2 & m2) | (z3 & m3);
+    }
+
+    inline uint64_t rev64(uint64_t x)
+    {
+        x = ((x & 0x5555555555555555ULL) << 1) | ((x >> 1) & 0x5555555555555555ULL);
+        x = ((x & 0x3333333333333333ULL) << 2) | ((x >> 2) & 0x3333333333333333ULL);
+        x = ((x & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+        x = ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+        x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+        return (x << 32) | (x >> 32);
+    }
+
+    inline uint64_t loadBE64(const uint8_t *p)
+    {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++)
+            v = (v << 8) | p[i];
+        return v;
+    }
+
+    inline void storeBE64(uint8_t *p, uint64_t v)
+    {
+        for (int i = 7; i >= 0; i--, v >>= 8)
+            p[i] = uint8_t(v);
+    }
+
+    void ghashPortable(uint8_t y[16], const uint8_t hb[16], const uint8_t *data, size_t blocks)
+    {
+        uint64_t y1 = loadBE64(y), y0 = loadBE64(y + 8);
+        uint64_t h1 = loadBE64(hb), h0 = loadBE64(hb + 8);
+        uint64_t h0r = rev64(h0), h1r = rev64(h1);
+        uint64_t h2 = h0 ^ h1, h2r = h0r ^ h1r;
+
+        for (; blocks; --blocks, data += 16)
+        {
+            y1 ^= loadBE64(data);
+            y0 ^= loadBE64(data + 8);
+
+            uint64_t y0r = rev64(y0), y1r = rev64(y1);
+            uint64_t y2 = y0 ^ y1, y2r = y0r ^ y1r;
+
+            // Karatsuba: three products for each half.
+            uint64_t z0 = bmul64(y0, h0);
+            uint64_t z1 = bmul64(y1, h1);
+            uint64_t z2 = bmul64(y2, h2);
+            uint64_t z0h = bmul64(y0r, h0r);
+            uint64_t z1h = bmul64(y1r, h1r);
+            uint64_t z2h = bmul64(y2r, h2r);
+            z2 ^= z0 ^ z1;
+            z2h ^= z0h ^ z1h;
+            z0h = rev64(z0h) >> 1;
+            z1h = rev64(z1h) >> 1;
+            z2h = rev64(z2h) >> 1;
+
+            uint64_t v0 = z0;
+            uint64_t v1 = z0h ^ z2;
+            uint64_t v2 = z1 ^ z2h;
+            uint64_t v3 = z1h;
+
+            // GHASH bit order is reflected: shift left one, then reduce
+            // modulo x^128 + x^7 + x^2 + x + 1.
+            v3 = (v3 << 1) | (v2 >> 63);
+            v2 = (v2 << 1) | (v1 >> 63);
+            v1 = (v1 << 1) | (v0 >> 63);
+            v0 = (v0 << 1);
+
+            v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+            v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+            v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+            v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+            y0 = v2;
+            y1 = v3;
+        }
+        storeBE64(y, y1);
+        storeBE64(y + 8, y0);
+    }
+
+#ifdef QUANTUM_AES_X86
+    // ─── AES-NI / PCLMULQDQ ──────────────────────────────────────────────────
+
+    QUANTUM_TARGET_AES inline __m128i byteSwap(__m128i x)
+    {
+        return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    }
+
+    // GF(2^128) multiply of byte-reversed operands (Intel CLMUL white paper,
+    // algorithm 5): schoolbook product, shift left one bit for the
+    // reflection, then reduce.
+    QUANTUM_TARGET_AES __m128i gfmul(__m128i a, __m128i b)
+    {
+        __m128i lo = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+        __m128i hi = _mm_clmulepi64_si128(a, b, 0x11);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+        hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+        __m128i c1 = _mm_srli_epi32(lo, 31);
+        __m128i c2 = _mm_srli_epi32(hi, 31);
+        lo = _mm_slli_epi32(lo, 1);
+        hi = _mm_slli_epi32(hi, 1);
+        __m128i carry = _mm_srli_si128(c1, 12);
+        c2 = _mm_slli_si128(c2, 4);
+        c1 = _mm_slli_si128(c1, 4);
+        lo = _mm_or_si128(lo, c1);
+        hi = _mm_or_si128(_mm_or_si128(hi, c2), carry);
+
+        __m128i t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+        __m128i t2 = _mm_srli_si128(t, 4);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+        __m128i u = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+        u = _mm_xor_si128(u, t2);
+        lo = _mm_xor_si128(lo, u);
+        return _mm_xor_si128(hi, lo);
+    }
+
+    // hpow holds byte-reversed H, H^2, H^3, H^4; four blocks are folded per
+    // step as (Y^X1)·H^4 ^ X2·H^3 ^ X3·H^2 ^ X4·H.
+    QUANTUM_TARGET_AES void ghashClmul(uint8_t y[16], const uint8_t hpow[4][16], const uint8_t *data, size_t blocks)
+    {
+        const __m128i h1 = _mm_load_si128(reinterpret_cast<const __m128i *>(hpow[0]));
+        const __m128i h2 = _mm_load_si128(reinterpret_cast<const __m128i *>(hpow[1]));
+        const __m128i h3 = _mm_load_si128(reinterpret_cast<const __m128i *>(hpow[2]));
+        const __m128i h4 = _mm_load_si128(reinterpret_cast<const __m128i *>(hpow[3]));
+        __m128i acc = byteSwap(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y)));
+
+        auto load = [&](size_t i)
+        { return byteSwap(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16 * i))); };
+
+        for (; blocks >= 4; blocks -= 4, data += 64)
+        {
+            __m128i p = gfmul(_mm_xor_si128(acc, load(0)), h4);
+            p = _mm_xor_si128(p, gfmul(load(1), h3));
+            p = _mm_xor_si128(p, gfmul(load(2), h2));
+            acc = _mm_xor_si128(p, gfmul(load(3), h1));
+        }
+        for (; blocks; --blocks, data += 16)
+            acc = gfmul(_mm_xor_si128(acc, load(0)), h1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(y), byteSwap(acc));
+    }
+
+    QUANTUM_TARGET_AES void ghashPowers(const uint8_t h[16], uint8_t hpow[4][16])
+    {
+        __m128i h1 = byteSwap(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h)));
+        __m128i p = h1;
+        for (int i = 0; i < 4; i++)
+        {
+            _mm_store_si128(reinterpret_cast<__m128i *>(hpow[i]), p);
+            p = gfmul(p, h1);
+        }
+    }
+
+    QUANTUM_TARGET_AES void invertKeys(const uint8_t *enc, uint8_t *dec, int rounds)
+    {
+        auto at = [](const uint8_t *base, int r)
+        { return _mm_load_si128(reinterpret_cast<const __m128i *>(base + 16 * r)); };
+        _mm_store_si128(reinterpret_cast<__m128i *>(dec), at(enc, rounds));
+        for (int r = 1; r < rounds; r++)
+            _mm_store_si128(reinterpret_cast<__m128i *>(dec + 16 * r), _mm_aesimc_si128(at(enc, rounds - r)));
+        _mm_store_si128(reinterpret_cast<__m128i *>(dec + 16 * rounds), at(enc, 0));
+    }
+
+    QUANTUM_TARGET_AES void encryptNi(const uint8_t *rk, int rounds, const uint8_t *in, uint8_t *out, size_t blocks)
+    {
+        __m128i k[15];
+        for (int r = 0; r <= rounds; r++)
+            k[r] = _mm_load_si128(reinterpret_cast<const __m128i *>(rk + 16 * r));
+        for (; blocks; --blocks, in += 16, out += 16)
+        {
+            __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)), k[0]);
+            for (int r = 1; r < rounds; r++)
+                x = _mm_aesenc_si128(x, k[r]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_aesenclast_si128(x, k[rounds]));
+        }
+    }
+
+    QUANTUM_TARGET_AES void decryptNi(const uint8_t *rk, int rounds, const uint8_t *in, uint8_t *out, size_t blocks)
+    {
+        __m128i k[15];
+        for (int r = 0; r <= rounds; r++)
+            k[r] = _mm_load_si128(reinterpret_cast<const __m128i *>(rk + 16 * r));
+        for (; blocks; --blocks, in += 16, out += 16)
+        {
+            __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)), k[0]);
+            for (int r = 1; r < rounds; r++)
+                x = _mm_aesdec_si128(x, k[r]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_aesdeclast_si128(x, k[rounds]));
+        }
+    }
+
+    // Eight counter blocks in flight keep the AES unit's pipeline full.
+    QUANTUM_TARGET_AES void ctrNi(const uint8_t *rk, int rounds, uint8_t counter[16], const uint8_t *in, uint8_t *out,
+                                  size_t blocks, bool inc32)
+    {
+        __m128i k[15];
+        for (int r = 0; r <= rounds; r++)
+            k[r] = _mm_load_si128(reinterpret_cast<const __m128i *>(rk + 16 * r));
+        alignas(16) uint8_t ctrs[8][16];
+        while (blocks)
+        {
+            size_t n = blocks < 8 ? blocks : 8;
+            __m128i x[8];
+            for (size_t i = 0; i < n; i++)
+            {
+                std::memcpy(ctrs[i], counter, 16);
+                increment(counter, inc32);
+                x[i] = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i *>(ctrs[i])), k[0]);
+            }
+            for (int r = 1; r < rounds; r++)
+                for (size_t i = 0; i < n; i++)
+                    x[i] = _mm_aesenc_si128(x[i], k[r]);
+            for (size_t i = 0; i < n; i++)
+            {
+                __m128i ks = _mm_aesenclast_si128(x[i], k[rounds]);
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16 * i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16 * i), _mm_xor_si128(v, ks));
+            }
+            in += 16 * n;
+            out += 16 * n;
+            blocks -= n;
+        }
+    }
+#endif
+
+    bool useNi()
+    {
+#ifdef QUANTUM_AES_X86
+        static const bool ni = cpu::hasAesNi();
+        return ni;
+#else
+        return false;
+#endif
+    }
+}
+
+namespace aes
+{
+    // ─── Key ─────────────────────────────────────────────────────────────────
+
+    std::shared_ptr<const Key> Key::create(const uint8_t *key, size_t len)
+    {
+        if (len != 16 && len != 24 && len != 32)
+            return nullptr;
+        std::shared_ptr<Key> k(new Key());
+        const int nk = static_cast<int>(len / 4);
+        k->rounds_ = nk + 6;
+        const int words = 4 * (k->rounds_ + 1);
+
+        uint8_t *w = k->enc_;
+        std::memcpy(w, key, len);
+        uint8_t rcon = 1;
+        for (int i = nk; i < words; i++)
+        {
+            uint8_t t[4];
+            std::memcpy(t, w + 4 * (i - 1), 4);
+            if (i % nk == 0)
+            {
+                uint8_t r = t[0];
+                t[0] = t[1];
+                t[1] = t[2];
+                t[2] = t[3];
+                t[3] = r;
+                subBytesCT(t, 4);
+                t[0] ^= rcon;
+                rcon = uint8_t((rcon << 1) ^ ((rcon >> 7) * 0x1b));
+            }
+            else if (nk > 6 && i % nk == 4)
+                subBytesCT(t, 4);
+            for (int j = 0; j < 4; j++)
+                w[4 * i + j] = w[4 * (i - nk) + j] ^ t[j];
+        }
+
+        // Bitsliced round keys: each round key repeated for all four lanes.
+        for (int r = 0; r <= k->rounds_; r++)
+        {
+            uint8_t lanes[64];
+            for (int b = 0; b < 4; b++)
+                std::memcpy(lanes + 16 * b, k->enc_ + 16 * r, 16);
+            pack(lanes, k->planes_[r]);
+        }
+#ifdef QUANTUM_AES_X86
+        if (useNi())
+            invertKeys(k->enc_, k->dec_, k->rounds_);
+#endif
+        return k;
+    }
+
+    void Key::encryptBlocks(const uint8_t *in, uint8_t *out, size_t blocks) const
+    {
+#ifdef QUANTUM_AES_X86
+        if (useNi())
+        {
+            encryptNi(enc_, rounds_, in, out, blocks);
+            return;
+        }
+#endif
+        uint8_t buf[64];
+        while (blocks)
+        {
+            size_t n = blocks < 4 ? blocks : 4;
+            std::memset(buf, 0, sizeof(buf));
+            std::memcpy(buf, in, 16 * n);
+            encrypt4(planes_, rounds_, buf, buf);
+            std::memcpy(out, buf, 16 * n);
+            in += 16 * n;
+            out += 16 * n;
+            blocks -= n;
+        }
+    }
+
+    void Key::decryptBlocks(const uint8_t *in, uint8_t *out, size_t blocks) const
+    {
+#ifdef QUANTUM_AES_X86
+        if (useNi())
+        {
+            decryptNi(dec_, rounds_, in, out, blocks);
+            return;
+        }
+#endif
+        uint8_t buf[64];
+        while (blocks)
+        {
+            size_t n = blocks < 4 ? blocks : 4;
+            std::memset(buf, 0, sizeof(buf));
+            std::memcpy(buf, in, 16 * n);
+            decrypt4(planes_, rounds_, buf, buf);
+            std::memcpy(out, buf, 16 * n);
+            in += 16 * n;
+            out += 16 * n;
+            blocks -= n;
+        }
+    }
+
+    void Key::ctrBlocks(uint8_t counter[16], const uint8_t *in, uint8_t *out, size_t blocks, bool inc32) const
+    {
+#ifdef QUANTUM_AES_X86
+        if (useNi())
+        {
+            ctrNi(enc_, rounds_, counter, in, out, blocks, inc32);
+            return;
+        }
+#endif
+        uint8_t ks[64];
+        while (blocks)
+        {
+            size_t n = blocks < 4 ? blocks : 4;
+            for (size_t i = 0; i < n; i++)
+            {
+                std::memcpy(ks + 16 * i, counter, 16);
+                increment(counter, inc32);
+            }
+            encrypt4(planes_, rounds_, ks, ks);
+            for (size_t i = 0; i < 16 * n; i++)
+                out[i] = in[i] ^ ks[i];
+            in += 16 * n;
+            out += 16 * n;
+            blocks -= n;
+        }
+    }
+
+    // ─── Ctr ─────────────────────────────────────────────────────────────────
+
+    Ctr::Ctr(std::shared_ptr<const Key> key, const uint8_t iv[16], bool inc32)
+        : key_(std::move(key)), inc32_(inc32)
+    {
+        std::memcpy(counter_, iv, 16);
+    }
+
+    void Ctr::process(const uint8_t *in, uint8_t *out, size_t len)
+    {
+        while (len && used_ < 16)
+        {
+            *out++ = *in++ ^ stream_[used_++];
+            --len;
+        }
+        if (len >= 16)
+        {
+            size_t blocks = len / 16;
+            key_->ctrBlocks(counter_, in, out, blocks, inc32_);
+            in += 16 * blocks;
+            out += 16 * blocks;
+            len -= 16 * blocks;
+        }
+        if (len)
+        {
+            static const uint8_t zeros[16] = {};
+            key_->ctrBlocks(counter_, zeros, stream_, 1, inc32_);
+            used_ = 0;
+            while (len--)
+                *out++ = *in++ ^ stream_[used_++];
+        }
+    }
+
+    // ─── Gcm ─────────────────────────────────────────────────────────────────
+
+    Gcm::Gcm(std::shared_ptr<const Key> key, const uint8_t *nonce, size_t nonceLen, bool encrypt)
+        : key_(std::move(key)), encrypt_(encrypt)
+    {
+        uint8_t h[16] = {};
+        key_->encryptBlocks(h, h, 1);
+        std::memcpy(h_[0], h, 16);
+#ifdef QUANTUM_AES_X86
+        if (useNi())
+            ghashPowers(h, h_);
+#endif
+        std::memset(y_, 0, sizeof(y_));
+
+        if (nonceLen == 12)
+        {
+            std::memcpy(j0_, nonce, 12);
+            j0_[12] = j0_[13] = j0_[14] = 0;
+            j0_[15] = 1;
+        }
+        else
+        {
+            // J0 = GHASH(nonce || pad || [0]64 || [len(nonce)]64)
+            ghash(nonce, nonceLen);
+            ghashFlush();
+            uint8_t lens[16] = {};
+            storeBE64(lens + 8, uint64_t(nonceLen) * 8);
+            ghash(lens, 16);
+            std::memcpy(j0_, y_, 16);
+            std::memset(y_, 0, sizeof(y_));
+        }
+
+        uint8_t start[16];
+        std::memcpy(start, j0_, 16);
+        increment(start, true);
+        ctr_ = std::make_unique<Ctr>(key_, start, true);
+    }
+
+    void Gcm::ghash(const uint8_t *data, size_t len)
+    {
+        auto blocks = [&](const uint8_t *p, size_t n)
+        {
+#ifdef QUANTUM_AES_X86
+            if (useNi())
+            {
+                ghashClmul(y_, h_, p, n);
+                return;
+            }
+#endif
+            ghashPortable(y_, h_[0], p, n);
+        };
+
+        if (bufLen_)
+        {
+            size_t take = std::min(len, 16 - bufLen_);
+            std::memcpy(buf_ + bufLen_, data, take);
+            bufLen_ += take;
+            data += take;
+            len -= take;
+            if (bufLen_ < 16)
+                return;
+            blocks(buf_, 1);
+            bufLen_ = 0;
+        }
+        if (len >= 16)
+        {
+            blocks(data, len / 16);
+            data += len & ~size_t(15);
+            len &= 15;
+        }
+        if (len)
+        {
+            std::memcpy(buf_, data, len);
+            bufLen_ = len;
+        }
+    }
+
+    // Zero-pad a partial block (end of AAD, end of text).
+    void Gcm::ghashFlush()
+    {
+        static const uint8_t zeros[16] = {};
+        if (bufLen_)
+            ghash(zeros, 16 - bufLen_);
+    }
+
+    void Gcm::aad(const uint8_t *data, size_t len)
+    {
+        ghash(data, len);
+        aadLen_ += len;
+    }
+
+    void Gcm::update(const uint8_t *in, uint8_t *out, size_t len)
+    {
+        if (!started_)
+        {
+            ghashFlush();
+            started_ = true;
+        }
+        textLen_ += len;
+        if (encrypt_)
+        {
+            ctr_->process(in, out, len);
+            ghash(out, len);
+        }
+        else
+        {
+            // Hash the ciphertext before it may be overwritten in place.
+            ghash(in, len);
+            ctr_->process(in, out, len);
+        }
+    }
+
+    void Gcm::tag(uint8_t out[16])
+    {
+        ghashFlush();
+        uint8_t lens[16];
+        storeBE64(lens, aadLen_ * 8);
+        storeBE64(lens + 8, textLen_ * 8);
+        ghash(lens, 16);
+        key_->encryptBlocks(j0_, out, 1);
+        for (int i = 0; i < 16; i++)
+            out[i] ^= y_[i];
+    }
+
+    bool Gcm::verify(const uint8_t *expected, size_t len)
+    {
+        if (len < 12 || len > 16)
+            return false;
+        uint8_t actual[16];
+        tag(actual);
+        uint8_t diff = 0;
+        for (size_t i = 0; i < len; i++)
+            diff |= actual[i] ^ expected[i];
+        return diff == 0;
+    }
+
+    const char *backend()
+    {
+        return useNi() ? "aes-ni" : "bitsliced";
+    }
+}
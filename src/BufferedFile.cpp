@@ -0,0 +1,188 @@
+#include "BufferedFile.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define QFSEEK _fseeki64
+#define QFTELL _ftelli64
+#else
+#define QFSEEK fseeko
+#define QFTELL ftello
+#endif
+
+// ─── BufferedFile ─────────────────────────────────────────────────────────────
+
+bool BufferedFile::validMode(const std::string &mode)
+{
+    std::string m;
+    for (char c : mode)
+        if (c != 'b')
+            m += c;
+    return m == "r" || m == "w" || m == "a" || m == "r+" || m == "w+" || m == "a+";
+}
+
+std::shared_ptr<BufferedFile> BufferedFile::open(const std::string &path, const std::string &mode)
+{
+    if (!validMode(mode))
+        return nullptr;
+
+    std::string m;
+    for (char c : mode)
+        if (c != 'b')
+            m += c;
+    std::string cmode = m.substr(0, 1) + "b" + m.substr(1);
+
+    std::FILE *f = std::fopen(path.c_str(), cmode.c_str());
+    if (!f)
+        return nullptr;
+
+    std::shared_ptr<BufferedFile> bf(new BufferedFile());
+    bf->stream_ = f;
+    bf->buffer_.reset(new char[kBufferSize]);
+    std::setvbuf(f, bf->buffer_.get(), _IOFBF, kBufferSize);
+    bool plus = m.size() > 1;
+    bf->readable_ = m[0] == 'r' || plus;
+    bf->writable_ = m[0] != 'r' || plus;
+    return bf;
+}
+
+BufferedFile::~BufferedFile()
+{
+    close();
+}
+
+void BufferedFile::switchTo(LastOp op)
+{
+    if (last_ != LastOp::None && last_ != op)
+        QFSEEK(stream_, 0, SEEK_CUR);
+    last_ = op;
+}
+
+bool BufferedFile::write(std::string_view data)
+{
+    if (!stream_ || !writable_)
+        return false;
+    switchTo(LastOp::Write);
+    return std::fwrite(data.data(), 1, data.size(), stream_) == data.size();
+}
+
+std::string BufferedFile::read(size_t n)
+{
+    std::string out;
+    if (!stream_ || !readable_ || n == 0)
+        return out;
+    switchTo(LastOp::Read);
+    constexpr size_t kChunk = 64 * 1024;
+    if (n <= kChunk)
+    {
+        out.resize(n);
+        out.resize(std::fread(&out[0], 1, n, stream_));
+        return out;
+    }
+    // Grow as data arrives: a large n on a small file allocates only what
+    // the file holds.
+    char chunk[kChunk];
+    while (out.size() < n)
+    {
+        size_t want = std::min(kChunk, n - out.size());
+        size_t got = std::fread(chunk, 1, want, stream_);
+        out.append(chunk, got);
+        if (got < want)
+            break;
+    }
+    return out;
+}
+
+std::string BufferedFile::readAll()
+{
+    std::string out;
+    if (!stream_ || !readable_)
+        return out;
+    switchTo(LastOp::Read);
+    char chunk[64 * 1024];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), stream_)) > 0)
+        out.append(chunk, n);
+    return out;
+}
+
+bool BufferedFile::readLine(std::string &line)
+{
+    line.clear();
+    if (!stream_ || !readable_)
+        return false;
+    switchTo(LastOp::Read);
+    // fgets() scans the stdio buffer for '\n' a chunk at a time.  Filling the
+    // chunk with '\n' first shows where its data ends even when the line
+    // holds NUL bytes: the first '\n' is either the line's own, followed by
+    // fgets' terminator, or filler just past the terminator at end of file.
+    char chunk[512];
+    bool any = false;
+    for (;;)
+    {
+        std::memset(chunk, '\n', sizeof chunk);
+        if (!std::fgets(chunk, sizeof chunk, stream_))
+            break;
+        any = true;
+        auto nl = static_cast<const char *>(std::memchr(chunk, '\n', sizeof chunk));
+        if (!nl)
+        {
+            line.append(chunk, sizeof chunk - 1); // chunk full, line goes on
+            continue;
+        }
+        size_t k = static_cast<size_t>(nl - chunk);
+        if (k + 1 < sizeof chunk && chunk[k + 1] == '\0')
+            line.append(chunk, k); // through the newline
+        else
+            line.append(chunk, k - 1); // last line, no newline
+        break;
+    }
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+    return any;
+}
+
+bool BufferedFile::seek(int64_t offset, int whence)
+{
+    if (!stream_)
+        return false;
+    int w = whence == 1 ? SEEK_CUR : whence == 2 ? SEEK_END : SEEK_SET;
+    last_ = LastOp::None;
+    return QFSEEK(stream_, offset, w) == 0;
+}
+
+int64_t BufferedFile::tell()
+{
+    if (!stream_)
+        return -1;
+    return static_cast<int64_t>(QFTELL(stream_));
+}
+
+int64_t BufferedFile::size()
+{
+    if (!stream_)
+        return -1;
+    int64_t here = tell();
+    if (QFSEEK(stream_, 0, SEEK_END) != 0)
+        return -1;
+    int64_t end = tell();
+    QFSEEK(stream_, here, SEEK_SET);
+    last_ = LastOp::None;
+    return end;
+}
+
+bool BufferedFile::flush()
+{
+    return stream_ && std::fflush(stream_) == 0;
+}
+
+bool BufferedFile::close()
+{
+    if (!stream_)
+        return false;
+    // fclose flushes through buffer_, so it must run before the buffer is freed.
+    bool ok = std::fclose(stream_) == 0;
+    stream_ = nullptr;
+    buffer_.reset();
+    return ok;
+}
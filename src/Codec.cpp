@@ -0,0 +1,603 @@
+#include "Codec.h"
+#include "Cpu.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_CODEC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define QUANTUM_TARGET_SSSE3
+#define QUANTUM_TARGET_AVX2
+#else
+#define QUANTUM_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define QUANTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const char kHex[] = "0123456789abcdef";
+    const char kHexUpper[] = "0123456789ABCDEF";
+
+    // -1 = not in the alphabet, -2 = '='
+    struct Base64Table
+    {
+        int8_t v[256];
+        Base64Table()
+        {
+            std::memset(v, -1, sizeof(v));
+            for (int i = 0; i < 64; i++)
+                v[static_cast<uint8_t>(kBase64[i])] = static_cast<int8_t>(i);
+            v[static_cast<uint8_t>('=')] = -2;
+        }
+    };
+    const Base64Table kBase64Decode;
+
+    inline int hexValue(uint8_t c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        c |= 0x20;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    inline bool urlSafe(uint8_t c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+               c == '-' || c == '_' || c == '.' || c == '~';
+    }
+
+    inline int countBits(unsigned x)
+    {
+        int n = 0;
+        for (; x; x &= x - 1)
+            n++;
+        return n;
+    }
+
+    inline int lowestBit(unsigned x)
+    {
+#ifdef _MSC_VER
+        unsigned long i;
+        _BitScanForward(&i, x);
+        return static_cast<int>(i);
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+
+    enum Level
+    {
+        Portable,
+        Ssse3,
+        Avx2
+    };
+
+    Level level()
+    {
+#ifdef QUANTUM_CODEC_X86
+        static const Level l = cpu::hasAvx2() ? Avx2 : cpu::hasSsse3() ? Ssse3
+                                                                        : Portable;
+        return l;
+#else
+        return Portable;
+#endif
+    }
+
+#ifdef QUANTUM_CODEC_X86
+    // ─── SSSE3 / AVX2 kernels ────────────────────────────────────────────────
+    // Base64 follows Muła and Lemire ("Faster Base64 Encoding and Decoding
+    // Using AVX2 Instructions"): PSHUFB spreads each 3-byte group over a
+    // 32-bit lane, two multiplies move the four sextets into place, and a
+    // 16-entry table indexed by a coarse range class turns sextets into ASCII
+    // (and back).
+
+    // 12 input bytes (reads 16) -> 16 characters.
+    QUANTUM_TARGET_SSSE3 size_t base64EncodeSsse3(const uint8_t *src, size_t n, char *dst)
+    {
+        const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        const __m128i shiftLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                               '/' - 63, 'A', 0, 0);
+        size_t i = 0;
+        for (; n - i >= 16; i += 12, dst += 16)
+        {
+            __m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), spread);
+            __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+            __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+            __m128i idx = _mm_or_si128(t0, t1);
+
+            __m128i cls = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+            __m128i lower = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+            cls = _mm_or_si128(cls, _mm_and_si128(lower, _mm_set1_epi8(13)));
+            __m128i out = _mm_add_epi8(_mm_shuffle_epi8(shiftLut, cls), idx);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), out);
+        }
+        return i;
+    }
+
+    // 24 input bytes (reads 28) -> 32 characters.
+    QUANTUM_TARGET_AVX2 size_t base64EncodeAvx2(const uint8_t *src, size_t n, char *dst)
+    {
+        const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        const __m256i shiftLut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                  '/' - 63, 'A', 0, 0,
+                                                  'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                  '/' - 63, 'A', 0, 0);
+        size_t i = 0;
+        for (; n - i >= 28; i += 24, dst += 32)
+        {
+            __m256i in = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 12)), 1);
+            in = _mm256_shuffle_epi8(in, spread);
+            __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                                            _mm256_set1_epi32(0x04000040));
+            __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                                            _mm256_set1_epi32(0x01000010));
+            __m256i idx = _mm256_or_si256(t0, t1);
+
+            __m256i cls = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+            __m256i lower = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+            cls = _mm256_or_si256(cls, _mm256_and_si256(lower, _mm256_set1_epi8(13)));
+            __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLut, cls), idx);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), out);
+        }
+        return i;
+    }
+
+    // 16 characters -> 12 bytes (writes 16).  False, with nothing written,
+    // if any character is outside the alphabet.
+    QUANTUM_TARGET_SSSE3 bool base64DecodeSsse3(const uint8_t *src, uint8_t *dst)
+    {
+        const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+        __m128i lo = _mm_and_si128(in, nibble);
+        __m128i bad = _mm_and_si128(_mm_shuffle_epi8(lutLo, lo), _mm_shuffle_epi8(lutHi, hi));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(bad, _mm_setzero_si128())))
+            return false;
+
+        __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        __m128i values = _mm_add_epi8(in, _mm_shuffle_epi8(lutRoll, _mm_add_epi8(slash, hi)));
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), packed);
+        return true;
+    }
+
+    // 32 characters -> 24 bytes (writes 32).
+    QUANTUM_TARGET_AVX2 bool base64DecodeAvx2(const uint8_t *src, uint8_t *dst)
+    {
+        const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                               0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                               0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                               0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                               0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                               0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                               0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble);
+        __m256i lo = _mm256_and_si256(in, nibble);
+        __m256i bad = _mm256_and_si256(_mm256_shuffle_epi8(lutLo, lo), _mm256_shuffle_epi8(lutHi, hi));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(bad, _mm256_setzero_si256())))
+            return false;
+
+        __m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+        __m256i values = _mm256_add_epi8(in, _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(slash, hi)));
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        // Each lane holds 12 bytes; close the gap between them.
+        packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), packed);
+        return true;
+    }
+
+    QUANTUM_TARGET_SSSE3 size_t hexEncodeSsse3(const uint8_t *src, size_t n, char *dst)
+    {
+        const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(kHex));
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; n - i >= 16; i += 16, dst += 32)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, nibble));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+        return i;
+    }
+
+    QUANTUM_TARGET_AVX2 size_t hexEncodeAvx2(const uint8_t *src, size_t n, char *dst)
+    {
+        const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kHex)));
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; n - i >= 32; i += 32, dst += 64)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble));
+            __m256i a = _mm256_unpacklo_epi8(hi, lo); // bytes 0-7 | 16-23
+            __m256i b = _mm256_unpackhi_epi8(hi, lo); // bytes 8-15 | 24-31
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        }
+        return i;
+    }
+
+    // Nibble values of 16 hex characters; false if any is not a hex digit.
+    QUANTUM_TARGET_SSSE3 inline bool hexNibbles(__m128i c, __m128i &out)
+    {
+        __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+        __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xFFFF)
+            return false;
+        out = _mm_or_si128(_mm_and_si128(isDigit, d), _mm_and_si128(isAlpha, _mm_add_epi8(l, _mm_set1_epi8(10))));
+        return true;
+    }
+
+    // 32 characters -> 16 bytes, only if every character is a hex digit.
+    QUANTUM_TARGET_SSSE3 bool hexDecodeSsse3(const uint8_t *src, uint8_t *dst)
+    {
+        __m128i a, b;
+        if (!hexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), a) ||
+            !hexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16)), b))
+            return false;
+        const __m128i weights = _mm_set1_epi16(0x0110); // high nibble * 16 + low nibble
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), bytes);
+        return true;
+    }
+
+    // Bit i set when src[i] may appear unescaped in a URL.
+    QUANTUM_TARGET_SSSE3 unsigned urlSafeMask(const uint8_t *src)
+    {
+        // All ranges sit in 0x2D..0x7E, so signed compares also reject bytes
+        // >= 0x80.
+        auto in = [](__m128i c, char lo, char hi)
+        {
+            return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                                 _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(hi + 1)), c));
+        };
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        __m128i ok = _mm_or_si128(_mm_or_si128(in(c, '0', '9'), in(c, 'A', 'Z')), in(c, 'a', 'z'));
+        ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('-')), _mm_cmpeq_epi8(c, _mm_set1_epi8('_'))));
+        ok = _mm_or_si128(ok, _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('.')), _mm_cmpeq_epi8(c, _mm_set1_epi8('~'))));
+        return static_cast<unsigned>(_mm_movemask_epi8(ok));
+    }
+
+    // Bit i set when src[i] is '%' or '+'.
+    QUANTUM_TARGET_SSSE3 unsigned urlSpecialMask(const uint8_t *src)
+    {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('%')), _mm_cmpeq_epi8(c, _mm_set1_epi8('+')));
+        return static_cast<unsigned>(_mm_movemask_epi8(m));
+    }
+#endif
+
+    inline void escape(char *&d, uint8_t c)
+    {
+        d[0] = '%';
+        d[1] = kHexUpper[c >> 4];
+        d[2] = kHexUpper[c & 0xF];
+        d += 3;
+    }
+}
+
+namespace codec
+{
+    // ─── Base64 ──────────────────────────────────────────────────────────────
+
+    std::string base64Encode(std::string_view in)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(in.data());
+        const size_t n = in.size();
+        std::string out(4 * ((n + 2) / 3), '\0');
+        char *d = &out[0];
+        size_t i = 0;
+#ifdef QUANTUM_CODEC_X86
+        if (level() == Avx2)
+        {
+            size_t used = base64EncodeAvx2(s, n, d);
+            i += used;
+            d += used / 3 * 4;
+        }
+        if (level() >= Ssse3)
+        {
+            size_t used = base64EncodeSsse3(s + i, n - i, d);
+            i += used;
+            d += used / 3 * 4;
+        }
+#endif
+        for (; n - i >= 3; i += 3, d += 4)
+        {
+            uint32_t v = uint32_t(s[i]) << 16 | uint32_t(s[i + 1]) << 8 | s[i + 2];
+            d[0] = kBase64[v >> 18];
+            d[1] = kBase64[(v >> 12) & 63];
+            d[2] = kBase64[(v >> 6) & 63];
+            d[3] = kBase64[v & 63];
+        }
+        if (n - i == 1)
+        {
+            d[0] = kBase64[s[i] >> 2];
+            d[1] = kBase64[(s[i] & 3) << 4];
+            d[2] = d[3] = '=';
+        }
+        else if (n - i == 2)
+        {
+            d[0] = kBase64[s[i] >> 2];
+            d[1] = kBase64[((s[i] & 3) << 4) | (s[i + 1] >> 4)];
+            d[2] = kBase64[(s[i + 1] & 15) << 2];
+            d[3] = '=';
+        }
+        return out;
+    }
+
+    std::string base64Decode(std::string_view in)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(in.data());
+        const size_t n = in.size();
+        // Vector stores run up to 8 bytes past the data they produce.
+        std::string out(n / 4 * 3 + 3 + 32, '\0');
+        uint8_t *d = reinterpret_cast<uint8_t *>(&out[0]);
+        size_t o = 0;
+        uint32_t val = 0;
+        int bits = -8; // -8: on a quantum boundary
+        const Level lvl = level();
+        size_t i = 0;
+        while (i < n)
+        {
+#ifdef QUANTUM_CODEC_X86
+            // Whole runs of alphabet characters go through the vector path;
+            // anything else (line breaks, '=') is handled one byte at a time.
+            if (bits == -8)
+            {
+                if (lvl == Avx2 && n - i >= 32 && base64DecodeAvx2(s + i, d + o))
+                {
+                    i += 32;
+                    o += 24;
+                    continue;
+                }
+                if (lvl >= Ssse3 && n - i >= 16 && base64DecodeSsse3(s + i, d + o))
+                {
+                    i += 16;
+                    o += 12;
+                    continue;
+                }
+            }
+#endif
+            int v = kBase64Decode.v[s[i++]];
+            if (v == -1)
+                continue;
+            if (v == -2)
+                break;
+            val = ((val << 6) | static_cast<uint32_t>(v)) & 0xFFFFFF;
+            bits += 6;
+            if (bits >= 0)
+            {
+                d[o++] = static_cast<uint8_t>(val >> bits);
+                bits -= 8;
+            }
+        }
+        out.resize(o);
+        return out;
+    }
+
+    // ─── Hex ─────────────────────────────────────────────────────────────────
+
+    std::string hexEncode(std::string_view in)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(in.data());
+        const size_t n = in.size();
+        std::string out(2 * n, '\0');
+        char *d = &out[0];
+        size_t i = 0;
+#ifdef QUANTUM_CODEC_X86
+        if (level() == Avx2)
+            i = hexEncodeAvx2(s, n, d);
+        if (level() >= Ssse3)
+            i += hexEncodeSsse3(s + i, n - i, d + 2 * i);
+#endif
+        for (; i < n; i++)
+        {
+            d[2 * i] = kHex[s[i] >> 4];
+            d[2 * i + 1] = kHex[s[i] & 15];
+        }
+        return out;
+    }
+
+    std::string hexDecode(std::string_view in)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(in.data());
+        const size_t n = in.size() / 2;
+        std::string out(n, '\0');
+        uint8_t *d = reinterpret_cast<uint8_t *>(&out[0]);
+        size_t i = 0;
+#ifdef QUANTUM_CODEC_X86
+        if (level() >= Ssse3)
+            for (; n - i >= 16 && hexDecodeSsse3(s + 2 * i, d + i); i += 16)
+                ;
+#endif
+        for (; i < n; i++)
+        {
+            uint8_t a = s[2 * i], b = s[2 * i + 1];
+            int hi = hexValue(a), lo = hexValue(b);
+            if (hi >= 0)
+                d[i] = static_cast<uint8_t>(lo >= 0 ? hi * 16 + lo : hi);
+            else if (a == ' ' || (a >= '\t' && a <= '\r') || a == '+')
+                d[i] = static_cast<uint8_t>(lo >= 0 ? lo : 0);
+            else if (a == '-')
+                d[i] = static_cast<uint8_t>(lo >= 0 ? -lo : 0);
+            else
+                d[i] = 0;
+        }
+        return out;
+    }
+
+    // ─── URL ─────────────────────────────────────────────────────────────────
+
+    std::string urlEncode(std::string_view in)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(in.data());
+        const size_t n = in.size();
+        const bool simd = level() >= Ssse3;
+
+        // Pass 1: count the bytes that need escaping to size the output.
+        size_t escapes = 0, i = 0;
+#ifdef QUANTUM_CODEC_X86
+        if (simd)
+            for (; n - i >= 16; i += 16)
+                escapes += 16 - countBits(urlSafeMask(s + i));
+#endif
+        for (; i < n; i++)
+            escapes += !urlSafe(s[i]);
+        if (!escapes)
+            return std::string(in);
+
+        // Pass 2: copy safe runs, escape the rest.
+        std::string out(n + 2 * escapes, '\0');
+        char *d = &out[0];
+        i = 0;
+#ifdef QUANTUM_CODEC_X86
+        if (simd)
+            for (; n - i >= 16; i += 16)
+            {
+                unsigned safe = urlSafeMask(s + i);
+                if (safe == 0xFFFF)
+                {
+                    std::memcpy(d, s + i, 16);
+                    d += 16;
+                    continue;
+                }
+                for (int k = 0; k < 16; k++)
+                    if (safe >> k & 1)
+                        *d++ = static_cast<char>(s[i + k]);
+                    else
+                        escape(d, s[i + k]);
+            }
+#endif
+        for (; i < n; i++)
+            if (urlSafe(s[i]))
+                *d++ = static_cast<char>(s[i]);
+            else
+                escape(d, s[i]);
+        (void)simd;
+        return out;
+    }
+
+    std::string urlDecode(std::string_view in)
+    {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(in.data());
+        const size_t n = in.size();
+        std::string out(n, '\0');
+        char *d = &out[0];
+        size_t i = 0;
+        while (i < n)
+        {
+            // Copy up to the next '%' or '+'.
+            size_t j = i;
+#ifdef QUANTUM_CODEC_X86
+            if (level() >= Ssse3)
+            {
+                unsigned m = 0;
+                for (; n - j >= 16 && !(m = urlSpecialMask(s + j)); j += 16)
+                    ;
+                if (m)
+                    j += lowestBit(m);
+            }
+#endif
+            while (j < n && s[j] != '%' && s[j] != '+')
+                j++;
+            std::memcpy(d, s + i, j - i);
+            d += j - i;
+            if (j == n)
+                break;
+            if (s[j] == '+')
+            {
+                *d++ = ' ';
+                i = j + 1;
+            }
+            else if (j + 2 < n)
+            {
+                int hi = hexValue(s[j + 1]), lo = hexValue(s[j + 2]);
+                *d++ = static_cast<char>(((hi < 0 ? 0 : hi) << 4) | (lo < 0 ? 0 : lo));
+                i = j + 3;
+            }
+            else
+            {
+                *d++ = '%';
+                i = j + 1;
+            }
+        }
+        out.resize(static_cast<size_t>(d - out.data()));
+        return out;
+    }
+
+    // ─── XOR ─────────────────────────────────────────────────────────────────
+
+    void xorInPlace(uint8_t *d, size_t n, std::string_view key)
+    {
+        const size_t k = key.size();
+        if (!k || !n)
+            return;
+        // Tile short keys into a pad of at least 256 bytes so the inner loop
+        // is a plain byte-wise XOR the compiler vectorises.
+        std::string pad(key);
+        while (pad.size() < 256)
+            pad.append(key);
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(pad.data());
+        const size_t step = pad.size();
+        for (size_t i = 0; i < n; i += step)
+        {
+            size_t len = n - i < step ? n - i : step;
+            for (size_t j = 0; j < len; j++)
+                d[i + j] ^= p[j];
+        }
+    }
+
+    std::string xorRepeat(std::string_view data, std::string_view key)
+    {
+        std::string out(data);
+        xorInPlace(reinterpret_cast<uint8_t *>(&out[0]), out.size(), key);
+        return out;
+    }
+
+    const char *backend()
+    {
+        switch (level())
+        {
+        case Avx2:
+            return "avx2";
+        case Ssse3:
+            return "ssse3";
+        default:
+            return "portable";
+        }
+    }
+}
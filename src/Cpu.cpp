@@ -0,0 +1,109 @@
+#include "Cpu.h"
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_CPU_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+    struct Features
+    {
+        bool sha = false;
+        bool aes = false;
+        bool pclmul = false;
+        bool sse2 = false;
+        bool ssse3 = false;
+        bool sse41 = false;
+        bool avx2 = false;
+
+        Features()
+        {
+            if (std::getenv("QUANTUM_NO_SIMD"))
+                return;
+#ifdef QUANTUM_CPU_X86
+            unsigned ecx1 = 0, edx1 = 0, ebx7 = 0;
+            unsigned long long xcr0 = 0;
+#ifdef _MSC_VER
+            int r[4];
+            __cpuid(r, 0);
+            int maxLeaf = r[0];
+            __cpuid(r, 1);
+            ecx1 = static_cast<unsigned>(r[2]);
+            edx1 = static_cast<unsigned>(r[3]);
+            if (maxLeaf >= 7)
+            {
+                __cpuidex(r, 7, 0);
+                ebx7 = static_cast<unsigned>(r[1]);
+            }
+            if ((ecx1 >> 27) & 1)
+                xcr0 = _xgetbv(0);
+#else
+            unsigned a, b, c, d;
+            if (__get_cpuid(1, &a, &b, &c, &d))
+            {
+                ecx1 = c;
+                edx1 = d;
+            }
+            if (__get_cpuid_count(7, 0, &a, &b, &c, &d))
+                ebx7 = b;
+            if ((ecx1 >> 27) & 1) // OSXSAVE
+            {
+                unsigned lo, hi;
+                __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+                xcr0 = (static_cast<unsigned long long>(hi) << 32) | lo;
+            }
+#endif
+            sse2 = (edx1 >> 26) & 1;
+            ssse3 = (ecx1 >> 9) & 1;
+            sse41 = (ecx1 >> 19) & 1;
+            pclmul = (ecx1 >> 1) & 1;
+            aes = (ecx1 >> 25) & 1;
+            sha = (ebx7 >> 29) & 1;
+            avx2 = ((ebx7 >> 5) & 1) && (xcr0 & 6) == 6;
+#endif
+        }
+    };
+
+    const Features &features()
+    {
+        static const Features f;
+        return f;
+    }
+}
+
+namespace cpu
+{
+    bool hasShaNi()
+    {
+        const Features &f = features();
+        return f.sha && f.ssse3 && f.sse41;
+    }
+
+    bool hasAesNi()
+    {
+        const Features &f = features();
+        return f.aes && f.pclmul && f.ssse3 && f.sse41;
+    }
+
+    bool hasSse2()
+    {
+        return features().sse2;
+    }
+
+    bool hasSsse3()
+    {
+        return features().ssse3;
+    }
+
+    bool hasAvx2()
+    {
+        return features().avx2;
+    }
+}
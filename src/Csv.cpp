@@ -0,0 +1,381 @@
+#include "Csv.h"
+#include "Cpu.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_CSV_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define QUANTUM_TARGET_SSE2
+#define QUANTUM_TARGET_AVX2
+#else
+#define QUANTUM_TARGET_SSE2 __attribute__((target("sse2")))
+#define QUANTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace csv
+{
+    namespace
+    {
+        constexpr size_t kChunk = 1 << 20; // stream read size
+        constexpr size_t kBlock = 64;      // bytes per structural mask
+
+        inline int lowestBit(uint64_t x)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long i;
+            _BitScanForward64(&i, x);
+            return static_cast<int>(i);
+#elif defined(_MSC_VER)
+            unsigned long i;
+            if (_BitScanForward(&i, static_cast<unsigned long>(x)))
+                return static_cast<int>(i);
+            _BitScanForward(&i, static_cast<unsigned long>(x >> 32));
+            return static_cast<int>(i) + 32;
+#else
+            return __builtin_ctzll(x);
+#endif
+        }
+
+        enum Level
+        {
+            Portable,
+            Sse2,
+            Avx2
+        };
+
+        Level level()
+        {
+#ifdef QUANTUM_CSV_X86
+            static const Level l = cpu::hasAvx2() ? Avx2 : cpu::hasSse2() ? Sse2
+                                                                          : Portable;
+            return l;
+#else
+            return Portable;
+#endif
+        }
+
+        // Bit i set when p[i] is the delimiter, the quote, CR or LF.  With
+        // quoting off the quote is passed as the delimiter.
+        uint64_t blockPortable(const uint8_t *p, size_t n, uint8_t d, uint8_t q)
+        {
+            uint64_t m = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                uint8_t c = p[i];
+                if (c == d || c == q || c == '\n' || c == '\r')
+                    m |= uint64_t(1) << i;
+            }
+            return m;
+        }
+
+#ifdef QUANTUM_CSV_X86
+        QUANTUM_TARGET_SSE2 uint64_t blockSse2(const uint8_t *p, uint8_t d, uint8_t q)
+        {
+            const __m128i vd = _mm_set1_epi8(static_cast<char>(d)), vq = _mm_set1_epi8(static_cast<char>(q));
+            const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+            uint64_t m = 0;
+            for (int k = 0; k < 4; k++)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * k));
+                __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vd), _mm_cmpeq_epi8(v, vq)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+                m |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(hit))) << (16 * k);
+            }
+            return m;
+        }
+
+        QUANTUM_TARGET_AVX2 uint64_t blockAvx2(const uint8_t *p, uint8_t d, uint8_t q)
+        {
+            const __m256i vd = _mm256_set1_epi8(static_cast<char>(d)), vq = _mm256_set1_epi8(static_cast<char>(q));
+            const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+            uint64_t m = 0;
+            for (int k = 0; k < 2; k++)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * k));
+                __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, vd), _mm256_cmpeq_epi8(v, vq)),
+                                              _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+                m |= static_cast<uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(hit))) << (32 * k);
+            }
+            return m;
+        }
+#endif
+
+        // Mask of the n bytes at p (a whole block when n >= kBlock).
+        uint64_t block(const char *data, size_t n, char delimiter, char quote)
+        {
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+            uint8_t d = static_cast<uint8_t>(delimiter);
+            uint8_t q = static_cast<uint8_t>(quote ? quote : delimiter);
+#ifdef QUANTUM_CSV_X86
+            if (n >= kBlock)
+            {
+                switch (level())
+                {
+                case Avx2:
+                    return blockAvx2(p, d, q);
+                case Sse2:
+                    return blockSse2(p, d, q);
+                default:
+                    break;
+                }
+            }
+#endif
+            return blockPortable(p, std::min(n, kBlock), d, q);
+        }
+    }
+
+    // ─── Reader ──────────────────────────────────────────────────────────────
+
+    Reader::Reader(std::string_view text, char delimiter, char quote)
+        : data_(text.data()), size_(text.size()), delimiter_(delimiter), quote_(quote) {}
+
+    Reader::Reader(std::shared_ptr<MappedFile> file, char delimiter, char quote)
+        : file_(std::move(file)), delimiter_(delimiter), quote_(quote)
+    {
+        if (file_->isMapped())
+        {
+            data_ = file_->data();
+            size_ = file_->size();
+        }
+        else
+            eof_ = false;
+    }
+
+    // Stream mode only: drops what has been consumed and appends a chunk,
+    // at least as large as what is kept so a long record costs amortised
+    // linear time to assemble.
+    bool Reader::more()
+    {
+        if (eof_)
+            return false;
+        base_ += pos_;
+        buf_.erase(0, pos_);
+        pos_ = 0;
+        maskBase_ = SIZE_MAX;
+        mask_ = 0;
+        size_t have = buf_.size();
+        size_t want = std::max(kChunk, have);
+        buf_.resize(have + want);
+        size_t got = file_->readSome(&buf_[have], want);
+        buf_.resize(have + got);
+        eof_ = got == 0;
+        data_ = buf_.data();
+        size_ = buf_.size();
+        return got > 0;
+    }
+
+    // Next delimiter, quote or line break at or after pos, or size_.  The
+    // common case is answered from the current block's mask.
+    inline size_t Reader::find(size_t pos)
+    {
+        size_t off = pos - maskBase_; // wraps to huge when pos < maskBase_
+        if (off < kBlock)
+        {
+            uint64_t m = mask_ >> off;
+            if (m)
+                return pos + static_cast<size_t>(lowestBit(m));
+        }
+        return scan(pos);
+    }
+
+    size_t Reader::scan(size_t pos)
+    {
+        if (pos >= maskBase_ && pos - maskBase_ < kBlock)
+            pos = maskBase_ + kBlock;
+        for (; pos < size_; pos += kBlock)
+        {
+            maskBase_ = pos;
+            mask_ = block(data_ + pos, size_ - pos, delimiter_, quote_);
+            if (mask_)
+                return pos + static_cast<size_t>(lowestBit(mask_));
+        }
+        return size_;
+    }
+
+    Reader::Status Reader::record(std::vector<std::string_view> &fields)
+    {
+        fields.clear();
+        copies_.clear();
+        scratch_.clear();
+        while (pos_ < size_ && (data_[pos_] == '\n' || data_[pos_] == '\r'))
+            pos_++;
+        if (pos_ >= size_)
+            return eof_ ? Status::End : Status::NeedMore;
+
+        size_t i = pos_;
+        for (;;)
+        {
+            // Plain fields ended by a delimiter or LF take no other branch.
+            size_t j = find(i);
+            if (j < size_ && data_[j] == delimiter_)
+            {
+                fields.emplace_back(data_ + i, j - i);
+                i = j + 1;
+                continue;
+            }
+            if (j < size_ && data_[j] == '\n')
+            {
+                fields.emplace_back(data_ + i, j - i);
+                pos_ = j + 1;
+                return Status::Done;
+            }
+
+            if (quote_ && j == i && j < size_ && data_[j] == quote_)
+            {
+                size_t start = i + 1, run = start;
+                bool copied = false;
+                size_t at = 0;
+                j = start;
+                for (;;)
+                {
+                    j = find(j);
+                    while (j < size_ && data_[j] != quote_)
+                        j = find(j + 1);
+                    if (j >= size_ || (j + 1 >= size_ && !eof_))
+                    {
+                        if (!eof_)
+                            return Status::NeedMore;
+                        error_ = "unterminated quoted field in record " + std::to_string(records_ + 1);
+                        return Status::Failed;
+                    }
+                    if (j + 1 < size_ && data_[j + 1] == quote_)
+                    {
+                        // "" stands for one quote: copy up to and including the first
+                        if (!copied)
+                            at = scratch_.size();
+                        copied = true;
+                        scratch_.append(data_ + run, j + 1 - run);
+                        run = j = j + 2;
+                        continue;
+                    }
+                    break;
+                }
+                if (copied)
+                    scratch_.append(data_ + run, j - run);
+                i = j + 1;
+                if (i < size_ && data_[i] != delimiter_ && data_[i] != '\n' && data_[i] != '\r')
+                {
+                    // Text after the closing quote is kept as is.
+                    size_t k = find(i);
+                    while (k < size_ && data_[k] == quote_)
+                        k = find(k + 1);
+                    if (k >= size_ && !eof_)
+                        return Status::NeedMore;
+                    if (!copied)
+                    {
+                        at = scratch_.size();
+                        scratch_.append(data_ + start, j - start);
+                    }
+                    copied = true;
+                    scratch_.append(data_ + i, k - i);
+                    i = k;
+                }
+                if (copied)
+                {
+                    // scratch_ may still move; point the view at it once the record is done
+                    copies_.push_back({fields.size(), at});
+                    fields.emplace_back(nullptr, scratch_.size() - at);
+                }
+                else
+                    fields.emplace_back(data_ + start, j - start);
+            }
+            else
+            {
+                // A quote inside an unquoted field is kept as is.
+                while (quote_ && j < size_ && data_[j] == quote_)
+                    j = find(j + 1);
+                if (j >= size_ && !eof_)
+                    return Status::NeedMore;
+                fields.emplace_back(data_ + i, j - i);
+                i = j;
+            }
+
+            if (i < size_ && data_[i] == delimiter_)
+            {
+                i++;
+                continue;
+            }
+            if (i < size_ && data_[i] == '\r')
+            {
+                if (i + 1 >= size_ && !eof_)
+                    return Status::NeedMore;
+                if (i + 1 < size_ && data_[i + 1] == '\n')
+                    i++;
+            }
+            pos_ = std::min(i + 1, size_);
+            return Status::Done;
+        }
+    }
+
+    bool Reader::next(std::vector<std::string_view> &fields)
+    {
+        if (!error_.empty())
+        {
+            fields.clear();
+            return false;
+        }
+        for (;;)
+        {
+            Status s = record(fields);
+            if (s == Status::Done)
+                break;
+            if (s != Status::NeedMore)
+            {
+                fields.clear();
+                return false;
+            }
+            more();
+        }
+        for (auto [field, at] : copies_)
+            fields[field] = std::string_view(scratch_.data() + at, fields[field].size());
+        records_++;
+        return true;
+    }
+
+    // ─── Writing ─────────────────────────────────────────────────────────────
+
+    void appendField(std::string &out, std::string_view s, char delimiter, char quote)
+    {
+        bool plain = true;
+        if (quote)
+            for (size_t i = 0; i < s.size() && plain; i += kBlock)
+                plain = block(s.data() + i, s.size() - i, delimiter, quote) == 0;
+        if (plain)
+        {
+            out.append(s.data(), s.size());
+            return;
+        }
+        out += quote;
+        for (size_t i = 0;;)
+        {
+            size_t q = s.find(quote, i);
+            if (q == std::string_view::npos)
+            {
+                out.append(s.data() + i, s.size() - i);
+                break;
+            }
+            out.append(s.data() + i, q + 1 - i);
+            out += quote;
+            i = q + 1;
+        }
+        out += quote;
+    }
+
+    const char *backend()
+    {
+        switch (level())
+        {
+        case Avx2:
+            return "avx2";
+        case Sse2:
+            return "sse2";
+        default:
+            return "portable";
+        }
+    }
+}
@@ -0,0 +1,480 @@
+#include "EventLoop.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#endif
+
+// ─── EventLoop ────────────────────────────────────────────────────────────────
+
+EventLoop::EventLoop(size_t workers)
+{
+    if (workers == 0)
+    {
+        size_t hw = std::thread::hardware_concurrency();
+        workers = std::min<size_t>(std::max<size_t>(hw, 2), 8);
+    }
+    workerCount_ = workers;
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+    initPoller();
+}
+
+void EventLoop::initPoller()
+{
+#if defined(_WIN32)
+    // A UDP socket that sends to itself stands in for a self-pipe.
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s != INVALID_SOCKET)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int len = sizeof(addr);
+        if (bind(s, reinterpret_cast<sockaddr *>(&addr), len) == 0 &&
+            getsockname(s, reinterpret_cast<sockaddr *>(&addr), &len) == 0 &&
+            connect(s, reinterpret_cast<sockaddr *>(&addr), len) == 0)
+        {
+            u_long nb = 1;
+            ioctlsocket(s, FIONBIO, &nb);
+            wakeRead_ = wakeWrite_ = static_cast<Handle>(s);
+        }
+        else
+            closesocket(s);
+    }
+#elif defined(__linux__)
+    pollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (efd >= 0)
+    {
+        wakeRead_ = wakeWrite_ = efd;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = efd;
+        epoll_ctl(pollFd_, EPOLL_CTL_ADD, efd, &ev);
+    }
+#else
+    int fds[2];
+    if (pipe(fds) == 0)
+    {
+        for (int fd : fds)
+        {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        wakeRead_ = fds[0];
+        wakeWrite_ = fds[1];
+    }
+#endif
+}
+
+EventLoop::~EventLoop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workReady_.notify_all();
+    for (auto &t : workers_)
+        t.join();
+    closePoller();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void EventLoop::closePoller()
+{
+#if defined(_WIN32)
+    if (wakeRead_ != -1)
+        closesocket(static_cast<SOCKET>(wakeRead_));
+#else
+    if (wakeRead_ != -1)
+        ::close(static_cast<int>(wakeRead_));
+    if (wakeWrite_ != -1 && wakeWrite_ != wakeRead_)
+        ::close(static_cast<int>(wakeWrite_));
+    if (pollFd_ != -1)
+        ::close(pollFd_);
+#endif
+    wakeRead_ = wakeWrite_ = -1;
+    pollFd_ = -1;
+}
+
+bool EventLoop::canFork() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return workers_.empty() && pending_ == 0 && watchers_.empty() && timers_.empty();
+}
+
+void EventLoop::afterFork()
+{
+    // The parent's epoll instance and eventfd are shared with the child after
+    // fork(); replace them so the two processes never see each other's events.
+    closePoller();
+    initPoller();
+}
+
+// ── Thread pool ──────────────────────────────────────────────────────────────
+
+void EventLoop::startWorkers()
+{
+    // Called with mutex_ held.
+    while (workers_.size() < workerCount_)
+        workers_.emplace_back([this]
+                              { workerMain(); });
+}
+
+void EventLoop::submit(Work work)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (workers_.empty())
+            startWorkers();
+        work_.push_back(std::move(work));
+        ++pending_;
+    }
+    workReady_.notify_one();
+}
+
+void EventLoop::post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.push_back(std::move(task));
+        ++pending_;
+    }
+    wake();
+}
+
+void EventLoop::wake()
+{
+    if (wakeWrite_ == -1)
+        return;
+#if defined(_WIN32)
+    char b = 1;
+    send(static_cast<SOCKET>(wakeWrite_), &b, 1, 0);
+#elif defined(__linux__)
+    uint64_t one = 1;
+    (void)!::write(static_cast<int>(wakeWrite_), &one, sizeof(one));
+#else
+    char b = 1;
+    (void)!::write(static_cast<int>(wakeWrite_), &b, 1);
+#endif
+}
+
+void EventLoop::workerMain()
+{
+    for (;;)
+    {
+        Work work;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workReady_.wait(lock, [this]
+                            { return stopping_ || !work_.empty(); });
+            if (stopping_)
+                return;
+            work = std::move(work_.front());
+            work_.pop_front();
+        }
+
+        Task done;
+        try
+        {
+            done = work();
+        }
+        catch (std::exception &e)
+        {
+            std::string msg = e.what();
+            done = [msg]
+            { throw std::runtime_error(msg); };
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.push_back(done ? std::move(done) : Task([] {}));
+        }
+        wake();
+    }
+}
+
+bool EventLoop::hasPending() const
+{
+    if (keepAlive_ > 0 || !timers_.empty())
+        return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_ > 0;
+}
+
+// ── Reactor ──────────────────────────────────────────────────────────────────
+
+void EventLoop::watch(Handle fd, int events, FdCallback cb, bool keepAlive)
+{
+    auto it = watchers_.find(fd);
+    if (it != watchers_.end())
+    {
+        if (it->second->keepAlive)
+            --keepAlive_;
+        it->second->cb = std::move(cb);
+        it->second->keepAlive = keepAlive;
+        if (keepAlive)
+            ++keepAlive_;
+        modify(fd, events);
+        return;
+    }
+    auto w = std::make_shared<Watcher>();
+    w->events = events;
+    w->keepAlive = keepAlive;
+    w->cb = std::move(cb);
+    watchers_[fd] = w;
+    if (keepAlive)
+        ++keepAlive_;
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = (events & Readable ? EPOLLIN : 0u) | (events & Writable ? EPOLLOUT : 0u);
+    ev.data.fd = static_cast<int>(fd);
+    epoll_ctl(pollFd_, EPOLL_CTL_ADD, static_cast<int>(fd), &ev);
+#endif
+}
+
+void EventLoop::modify(Handle fd, int events)
+{
+    auto it = watchers_.find(fd);
+    if (it == watchers_.end())
+        return;
+    if (it->second->events == events)
+        return;
+    it->second->events = events;
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = (events & Readable ? EPOLLIN : 0u) | (events & Writable ? EPOLLOUT : 0u);
+    ev.data.fd = static_cast<int>(fd);
+    epoll_ctl(pollFd_, EPOLL_CTL_MOD, static_cast<int>(fd), &ev);
+#endif
+}
+
+void EventLoop::unwatch(Handle fd)
+{
+    auto it = watchers_.find(fd);
+    if (it == watchers_.end())
+        return;
+    if (it->second->keepAlive)
+        --keepAlive_;
+    watchers_.erase(it);
+#ifdef __linux__
+    epoll_ctl(pollFd_, EPOLL_CTL_DEL, static_cast<int>(fd), nullptr);
+#endif
+}
+
+uint64_t EventLoop::addTimer(double delayMs, Task task)
+{
+    uint64_t id = nextTimerId_++;
+    auto due = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(std::max(0.0, delayMs) * 1000.0));
+    timerQueue_.emplace(due, id);
+    timers_[id] = std::move(task);
+    return id;
+}
+
+void EventLoop::cancelTimer(uint64_t id)
+{
+    // The queue entry is skipped lazily when it comes due.
+    timers_.erase(id);
+}
+
+int EventLoop::nextTimerTimeout(int timeoutMs) const
+{
+    for (auto &[due, id] : timerQueue_)
+    {
+        if (!timers_.count(id))
+            continue;
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(due - Clock::now()).count();
+        int t = static_cast<int>(std::max<int64_t>(0, ms + 1));
+        return timeoutMs < 0 ? t : std::min(t, timeoutMs);
+    }
+    return timeoutMs;
+}
+
+size_t EventLoop::runTimers()
+{
+    size_t ran = 0;
+    auto now = Clock::now();
+    while (!timerQueue_.empty() && timerQueue_.begin()->first <= now)
+    {
+        uint64_t id = timerQueue_.begin()->second;
+        timerQueue_.erase(timerQueue_.begin());
+        auto it = timers_.find(id);
+        if (it == timers_.end())
+            continue;
+        Task task = std::move(it->second);
+        timers_.erase(it);
+        ++ran;
+        task();
+    }
+    return ran;
+}
+
+size_t EventLoop::runCompletions()
+{
+    std::deque<Task> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready.swap(done_);
+    }
+
+    size_t ran = 0;
+    while (!ready.empty())
+    {
+        Task task = std::move(ready.front());
+        ready.pop_front();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+        ++ran;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            // Put back what was not run so a caught error does not lose work.
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.insert(done_.begin(), std::make_move_iterator(ready.begin()),
+                         std::make_move_iterator(ready.end()));
+            throw;
+        }
+    }
+    return ran;
+}
+
+size_t EventLoop::pollOnce(int timeoutMs)
+{
+    // Dispatch a readiness event, looking the watcher up again in case an
+    // earlier callback in the same batch removed it.
+    auto dispatchFd = [this](Handle fd, int events) -> size_t
+    {
+        auto it = watchers_.find(fd);
+        if (it == watchers_.end())
+            return 0;
+        std::shared_ptr<Watcher> w = it->second;
+        int wanted = (w->events & events) | (events & Error);
+        if (!wanted)
+            return 0;
+        w->cb(wanted);
+        return 1;
+    };
+
+    auto drainWake = [this]()
+    {
+        char buf[64];
+#ifdef _WIN32
+        while (recv(static_cast<SOCKET>(wakeRead_), buf, sizeof(buf), 0) > 0)
+        {
+        }
+#else
+        while (::read(static_cast<int>(wakeRead_), buf, sizeof(buf)) > 0)
+        {
+        }
+#endif
+    };
+
+    size_t ran = 0;
+#ifdef __linux__
+    epoll_event events[256];
+    int n = epoll_wait(pollFd_, events, 256, timeoutMs);
+    for (int i = 0; i < n; ++i)
+    {
+        int fd = events[i].data.fd;
+        if (fd == wakeRead_)
+        {
+            drainWake();
+            continue;
+        }
+        uint32_t e = events[i].events;
+        int ev = (e & (EPOLLIN | EPOLLRDHUP) ? Readable : 0) | (e & EPOLLOUT ? Writable : 0) |
+                 (e & (EPOLLERR | EPOLLHUP) ? Error : 0);
+        ran += dispatchFd(fd, ev);
+    }
+#else
+#ifdef _WIN32
+    using PollFd = WSAPOLLFD;
+#else
+    using PollFd = pollfd;
+#endif
+    std::vector<PollFd> fds;
+    fds.reserve(watchers_.size() + 1);
+    if (wakeRead_ != -1)
+    {
+        PollFd p{};
+        p.fd = static_cast<decltype(p.fd)>(wakeRead_);
+        p.events = POLLIN;
+        fds.push_back(p);
+    }
+    for (auto &[fd, w] : watchers_)
+    {
+        PollFd p{};
+        p.fd = static_cast<decltype(p.fd)>(fd);
+        p.events = static_cast<short>((w->events & Readable ? POLLIN : 0) | (w->events & Writable ? POLLOUT : 0));
+        fds.push_back(p);
+    }
+#ifdef _WIN32
+    int n = fds.empty() ? (Sleep(timeoutMs < 0 ? 10 : timeoutMs), 0)
+                        : WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+#else
+    int n = ::poll(fds.data(), fds.size(), timeoutMs);
+#endif
+    for (size_t i = 0; n > 0 && i < fds.size(); ++i)
+    {
+        if (!fds[i].revents)
+            continue;
+        --n;
+        Handle fd = static_cast<Handle>(fds[i].fd);
+        if (fd == wakeRead_)
+        {
+            drainWake();
+            continue;
+        }
+        short e = fds[i].revents;
+        int ev = (e & POLLIN ? Readable : 0) | (e & POLLOUT ? Writable : 0) |
+                 (e & (POLLERR | POLLHUP | POLLNVAL) ? Error : 0);
+        ran += dispatchFd(fd, ev);
+    }
+#endif
+    return ran;
+}
+
+size_t EventLoop::runOnce(int timeoutMs)
+{
+    size_t ran = runCompletions() + runTimers();
+    if (ran)
+        timeoutMs = 0; // still poll sockets, but do not block
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!done_.empty())
+            timeoutMs = 0;
+    }
+    if (wakeRead_ == -1 && (timeoutMs < 0 || timeoutMs > 10))
+        timeoutMs = 10; // no wake-up channel: poll the completion queue instead
+    ran += pollOnce(nextTimerTimeout(timeoutMs));
+    ran += runCompletions() + runTimers();
+    return ran;
+}
@@ -0,0 +1,277 @@
+#include "Fuzzy.h"
+#include "Cpu.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_FUZZY_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define QUANTUM_TARGET_SSE2
+#define QUANTUM_TARGET_AVX2
+#else
+#define QUANTUM_TARGET_SSE2 __attribute__((target("sse2")))
+#define QUANTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    inline int countBits(unsigned x)
+    {
+        int n = 0;
+        for (; x; x &= x - 1)
+            n++;
+        return n;
+    }
+
+    enum Level
+    {
+        Portable,
+        Sse2,
+        Avx2
+    };
+
+    Level level()
+    {
+#ifdef QUANTUM_FUZZY_X86
+        static const Level l = cpu::hasAvx2() ? Avx2 : cpu::hasSse2() ? Sse2
+                                                                       : Portable;
+        return l;
+#else
+        return Portable;
+#endif
+    }
+
+    // Mismatches in the first n bytes of a and b.
+    size_t mismatchesPortable(const uint8_t *a, const uint8_t *b, size_t n)
+    {
+        size_t d = 0;
+        for (size_t i = 0; i < n; i++)
+            d += a[i] != b[i];
+        return d;
+    }
+
+#ifdef QUANTUM_FUZZY_X86
+    QUANTUM_TARGET_SSE2 size_t mismatchesSse2(const uint8_t *a, const uint8_t *b, size_t n)
+    {
+        size_t d = 0, i = 0;
+        for (; n - i >= 16; i += 16)
+        {
+            __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+            d += 16 - countBits(static_cast<unsigned>(_mm_movemask_epi8(eq)));
+        }
+        return d + mismatchesPortable(a + i, b + i, n - i);
+    }
+
+    QUANTUM_TARGET_AVX2 size_t mismatchesAvx2(const uint8_t *a, const uint8_t *b, size_t n)
+    {
+        size_t d = 0, i = 0;
+        for (; n - i >= 32; i += 32)
+        {
+            __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+            d += 32 - countBits(static_cast<unsigned>(_mm256_movemask_epi8(eq)));
+        }
+        return d + mismatchesSse2(a + i, b + i, n - i);
+    }
+#endif
+
+    // One column step of Hyyrö's bit-vector recurrence for a 64-row block.
+    // hin is the horizontal delta entering the block's top row (-1, 0, +1);
+    // the delta leaving the row selected by high is returned.
+    inline int advanceBlock(uint64_t &pv, uint64_t &mv, uint64_t eq, int hin, uint64_t high)
+    {
+        const uint64_t hinNeg = hin < 0 ? 1 : 0;
+        const uint64_t xv = eq | mv;
+        eq |= hinNeg;
+        const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        int hout = (ph & high) ? 1 : (mh & high) ? -1
+                                                 : 0;
+        ph = (ph << 1) | (hin > 0 ? 1 : 0);
+        mh = (mh << 1) | hinNeg;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        return hout;
+    }
+
+    // True once score can no longer come back within maxDist: each of the
+    // remaining columns lowers the bottom row by at most one.
+    inline bool hopeless(size_t score, size_t remaining, size_t maxDist)
+    {
+        return score > remaining && score - remaining > maxDist;
+    }
+}
+
+namespace fuzzy
+{
+    Matcher::Matcher(std::string_view pattern)
+        : m_(pattern.size()), words_((pattern.size() + 63) / 64)
+    {
+        if (words_ == 1)
+        {
+            for (size_t i = 0; i < m_; i++)
+                peq1_[static_cast<uint8_t>(pattern[i])] |= uint64_t(1) << i;
+        }
+        else if (words_ > 1)
+        {
+            peq_.assign(256 * words_, 0);
+            for (size_t i = 0; i < m_; i++)
+                peq_[static_cast<uint8_t>(pattern[i]) * words_ + i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+
+    size_t Matcher::distance(std::string_view text, size_t maxDist) const
+    {
+        size_t n = text.size();
+        size_t gap = m_ > n ? m_ - n : n - m_;
+        if (gap > maxDist)
+            return maxDist + 1;
+        if (m_ == 0)
+            return n;
+        return words_ == 1 ? singleWord(text, maxDist) : multiWord(text, maxDist);
+    }
+
+    size_t Matcher::singleWord(std::string_view text, size_t maxDist) const
+    {
+        const uint64_t high = uint64_t(1) << (m_ - 1);
+        const size_t n = text.size();
+        uint64_t pv = ~uint64_t(0), mv = 0;
+        size_t score = m_;
+        for (size_t j = 0; j < n; j++)
+        {
+            score += advanceBlock(pv, mv, peq1_[static_cast<uint8_t>(text[j])], 1, high);
+            if (hopeless(score, n - j - 1, maxDist))
+                return maxDist + 1;
+        }
+        return score;
+    }
+
+    size_t Matcher::multiWord(std::string_view text, size_t maxDist) const
+    {
+        const uint64_t top = uint64_t(1) << 63;
+        const uint64_t lastHigh = uint64_t(1) << ((m_ - 1) % 64);
+        const size_t n = text.size();
+        std::vector<uint64_t> pv(words_, ~uint64_t(0)), mv(words_, 0);
+        size_t score = m_;
+        for (size_t j = 0; j < n; j++)
+        {
+            const uint64_t *eq = &peq_[static_cast<uint8_t>(text[j]) * words_];
+            int carry = 1; // row 0 grows by one per column
+            for (size_t w = 0; w < words_; w++)
+                carry = advanceBlock(pv[w], mv[w], eq[w], carry, w + 1 == words_ ? lastHigh : top);
+            score += carry;
+            if (hopeless(score, n - j - 1, maxDist))
+                return maxDist + 1;
+        }
+        return score;
+    }
+
+    size_t editDistance(std::string_view a, std::string_view b, size_t maxDist)
+    {
+        if (a.size() > b.size())
+            std::swap(a, b);
+        return Matcher(a).distance(b, maxDist);
+    }
+
+    size_t hamming(std::string_view a, std::string_view b)
+    {
+        size_t n = std::min(a.size(), b.size());
+        size_t d = std::max(a.size(), b.size()) - n;
+        const uint8_t *pa = reinterpret_cast<const uint8_t *>(a.data());
+        const uint8_t *pb = reinterpret_cast<const uint8_t *>(b.data());
+        switch (level())
+        {
+#ifdef QUANTUM_FUZZY_X86
+        case Avx2:
+            return d + mismatchesAvx2(pa, pb, n);
+        case Sse2:
+            return d + mismatchesSse2(pa, pb, n);
+#endif
+        default:
+            return d + mismatchesPortable(pa, pb, n);
+        }
+    }
+
+    std::vector<Match> search(std::string_view query, const std::vector<std::string_view> &candidates,
+                              size_t maxDist, Metric metric, size_t threads)
+    {
+        const Matcher matcher(query);
+        const size_t m = query.size();
+
+        auto score = [&](std::string_view c) -> size_t
+        {
+            size_t gap = m > c.size() ? m - c.size() : c.size() - m;
+            if (gap > maxDist)
+                return maxDist + 1;
+            if (metric == Metric::Hamming)
+                return hamming(query, c);
+            // Equal lengths: Hamming bounds Levenshtein from above, and at
+            // 0 or 1 the two agree, so near-identical candidates skip the
+            // bit-vector pass.
+            if (gap == 0)
+            {
+                size_t h = hamming(query, c);
+                if (h <= 1)
+                    return h;
+            }
+            return matcher.distance(c, maxDist);
+        };
+
+        // Workers claim fixed-size chunks from a shared cursor and keep
+        // their matches locally; the lists are merged at the end.
+        const size_t chunk = 4096;
+        const size_t chunks = (candidates.size() + chunk - 1) / chunk;
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max<size_t>(1, std::min(threads, chunks));
+
+        std::vector<std::vector<Match>> found(threads);
+        std::atomic<size_t> next{0};
+        auto worker = [&](size_t t)
+        {
+            for (size_t k = next++; k < chunks; k = next++)
+            {
+                size_t end = std::min(candidates.size(), (k + 1) * chunk);
+                for (size_t i = k * chunk; i < end; i++)
+                {
+                    size_t d = score(candidates[i]);
+                    if (d <= maxDist)
+                        found[t].push_back({i, d});
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < threads; t++)
+            pool.emplace_back(worker, t);
+        worker(0); // the calling thread takes a share too
+        for (auto &t : pool)
+            t.join();
+
+        std::vector<Match> out;
+        for (auto &f : found)
+            out.insert(out.end(), f.begin(), f.end());
+        std::sort(out.begin(), out.end(), [](const Match &x, const Match &y)
+                  { return x.distance != y.distance ? x.distance < y.distance : x.index < y.index; });
+        return out;
+    }
+
+    const char *backend()
+    {
+        switch (level())
+        {
+        case Avx2:
+            return "avx2";
+        case Sse2:
+            return "sse2";
+        default:
+            return "portable";
+        }
+    }
+}
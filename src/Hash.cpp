@@ -0,0 +1,692 @@
+#include "Hash.h"
+#include "Cpu.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_HASH_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define QUANTUM_TARGET_SHA
+#else
+#define QUANTUM_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+// The round loops index the message registers with the loop counter; they
+// must be fully unrolled for those to stay in registers.
+#if defined(__clang__)
+#define QUANTUM_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define QUANTUM_UNROLL _Pragma("GCC unroll 20")
+#else
+#define QUANTUM_UNROLL
+#endif
+#endif
+
+namespace
+{
+    inline uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+    inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    inline uint32_t loadBE32(const uint8_t *p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    inline uint32_t loadLE32(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    inline void storeBE32(uint8_t *p, uint32_t v)
+    {
+        p[0] = uint8_t(v >> 24);
+        p[1] = uint8_t(v >> 16);
+        p[2] = uint8_t(v >> 8);
+        p[3] = uint8_t(v);
+    }
+
+    inline void storeLE32(uint8_t *p, uint32_t v)
+    {
+        p[0] = uint8_t(v);
+        p[1] = uint8_t(v >> 8);
+        p[2] = uint8_t(v >> 16);
+        p[3] = uint8_t(v >> 24);
+    }
+
+    // ─── SHA-256 kernels ─────────────────────────────────────────────────────
+
+    alignas(16) const uint32_t K256[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    void sha256Portable(uint32_t H[8], const uint8_t *p, size_t blocks)
+    {
+        for (; blocks; --blocks, p += 64)
+        {
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++)
+                w[i] = loadBE32(p + i * 4);
+            for (int i = 16; i < 64; i++)
+            {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
+            for (int i = 0; i < 64; i++)
+            {
+                uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+                uint32_t ch = (e & f) ^ (~e & g);
+                uint32_t t1 = h + S1 + ch + K256[i] + w[i];
+                uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+                uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+                uint32_t t2 = S0 + maj;
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+            H[0] += a;
+            H[1] += b;
+            H[2] += c;
+            H[3] += d;
+            H[4] += e;
+            H[5] += f;
+            H[6] += g;
+            H[7] += h;
+        }
+    }
+
+#ifdef QUANTUM_HASH_X86
+    // Four rounds per step; the message schedule for step i+1..i+3 is
+    // computed alongside with sha256msg1/msg2 (Intel SHA extensions guide).
+    QUANTUM_TARGET_SHA void sha256ShaNi(uint32_t H[8], const uint8_t *p, size_t blocks)
+    {
+        const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+        __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&H[0]));
+        __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&H[4]));
+        tmp = _mm_shuffle_epi32(tmp, 0xB1);           // CDAB
+        state1 = _mm_shuffle_epi32(state1, 0x1B);     // EFGH
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);  // CDGH
+
+        for (; blocks; --blocks, p += 64)
+        {
+            const __m128i abefSave = state0, cdghSave = state1;
+            __m128i m[4];
+            for (int i = 0; i < 4; i++)
+                m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i)), MASK);
+
+            QUANTUM_UNROLL
+            for (int i = 0; i < 16; i++)
+            {
+                __m128i &cur = m[i & 3];
+                __m128i &prev = m[(i + 3) & 3];
+                __m128i &next = m[(i + 1) & 3];
+                __m128i msg = _mm_add_epi32(cur, _mm_load_si128(reinterpret_cast<const __m128i *>(&K256[4 * i])));
+                state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+                if (i >= 3 && i <= 14)
+                {
+                    next = _mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4));
+                    next = _mm_sha256msg2_epu32(next, cur);
+                }
+                msg = _mm_shuffle_epi32(msg, 0x0E);
+                state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+                if (i >= 1 && i <= 12)
+                    prev = _mm_sha256msg1_epu32(prev, cur);
+            }
+
+            state0 = _mm_add_epi32(state0, abefSave);
+            state1 = _mm_add_epi32(state1, cdghSave);
+        }
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+        state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+        state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+        state1 = _mm_alignr_epi8(state1, tmp, 8);     // ABEF
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&H[0]), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&H[4]), state1);
+    }
+#endif
+
+    // ─── SHA-1 kernels ───────────────────────────────────────────────────────
+
+    void sha1Portable(uint32_t H[5], const uint8_t *p, size_t blocks)
+    {
+        for (; blocks; --blocks, p += 64)
+        {
+            uint32_t w[80];
+            for (int i = 0; i < 16; i++)
+                w[i] = loadBE32(p + i * 4);
+            for (int i = 16; i < 80; i++)
+                w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4];
+            for (int i = 0; i < 80; i++)
+            {
+                uint32_t f, k;
+                if (i < 20)
+                {
+                    f = (b & c) | (~b & d);
+                    k = 0x5A827999;
+                }
+                else if (i < 40)
+                {
+                    f = b ^ c ^ d;
+                    k = 0x6ED9EBA1;
+                }
+                else if (i < 60)
+                {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8F1BBCDC;
+                }
+                else
+                {
+                    f = b ^ c ^ d;
+                    k = 0xCA62C1D6;
+                }
+                uint32_t t = rotl(a, 5) + f + e + k + w[i];
+                e = d;
+                d = c;
+                c = rotl(b, 30);
+                b = a;
+                a = t;
+            }
+            H[0] += a;
+            H[1] += b;
+            H[2] += c;
+            H[3] += d;
+            H[4] += e;
+        }
+    }
+
+#ifdef QUANTUM_HASH_X86
+    QUANTUM_TARGET_SHA inline __m128i sha1Rounds(__m128i abcd, __m128i e, int func)
+    {
+        // sha1rnds4 takes the round function as an immediate.
+        switch (func)
+        {
+        case 0:
+            return _mm_sha1rnds4_epu32(abcd, e, 0);
+        case 1:
+            return _mm_sha1rnds4_epu32(abcd, e, 1);
+        case 2:
+            return _mm_sha1rnds4_epu32(abcd, e, 2);
+        default:
+            return _mm_sha1rnds4_epu32(abcd, e, 3);
+        }
+    }
+
+    QUANTUM_TARGET_SHA void sha1ShaNi(uint32_t H[5], const uint8_t *p, size_t blocks)
+    {
+        const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+        __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(H)), 0x1B);
+        __m128i e0 = _mm_set_epi32(static_cast<int>(H[4]), 0, 0, 0);
+
+        for (; blocks; --blocks, p += 64)
+        {
+            const __m128i abcdSave = abcd, eSave = e0;
+            __m128i m[4];
+            for (int i = 0; i < 4; i++)
+                m[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i)), MASK);
+
+            // e[0] / e[1] alternate between carrying E into the next four
+            // rounds and saving the pre-round ABCD.
+            __m128i e[2] = {_mm_add_epi32(e0, m[0]), abcd};
+            abcd = sha1Rounds(abcd, e[0], 0);
+            QUANTUM_UNROLL
+            for (int i = 1; i < 20; i++)
+            {
+                __m128i &cur = m[i & 3];
+                __m128i &use = e[i & 1];
+                __m128i &save = e[(i + 1) & 1];
+                use = _mm_sha1nexte_epu32(use, cur);
+                save = abcd;
+                if (i >= 3 && i <= 18)
+                    m[(i + 1) & 3] = _mm_sha1msg2_epu32(m[(i + 1) & 3], cur);
+                abcd = sha1Rounds(abcd, use, i / 5);
+                if (i <= 16)
+                    m[(i + 3) & 3] = _mm_sha1msg1_epu32(m[(i + 3) & 3], cur);
+                if (i >= 2 && i <= 17)
+                    m[(i + 2) & 3] = _mm_xor_si128(m[(i + 2) & 3], cur);
+            }
+
+            e0 = _mm_sha1nexte_epu32(e[0], eSave);
+            abcd = _mm_add_epi32(abcd, abcdSave);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(H), _mm_shuffle_epi32(abcd, 0x1B));
+        H[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+    }
+#endif
+
+    using Kernel256 = void (*)(uint32_t *, const uint8_t *, size_t);
+
+    struct Dispatch
+    {
+        Kernel256 sha256 = sha256Portable;
+        Kernel256 sha1 = sha1Portable;
+        bool accelerated = false;
+
+        Dispatch()
+        {
+#ifdef QUANTUM_HASH_X86
+            if (cpu::hasShaNi())
+            {
+                sha256 = sha256ShaNi;
+                sha1 = sha1ShaNi;
+                accelerated = true;
+            }
+#endif
+        }
+    };
+
+    const Dispatch &kernels()
+    {
+        static const Dispatch d;
+        return d;
+    }
+
+    // ─── MD5 kernel ──────────────────────────────────────────────────────────
+
+    void md5Compress(uint32_t H[4], const uint8_t *p, size_t blocks)
+    {
+        static const uint32_t T[64] = {
+            0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+            0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+            0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+            0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+            0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+            0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+            0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+            0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+        static const int S[64] = {7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+                                  5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+                                  4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+                                  6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+        for (; blocks; --blocks, p += 64)
+        {
+            uint32_t M[16];
+            for (int i = 0; i < 16; i++)
+                M[i] = loadLE32(p + i * 4);
+            uint32_t A = H[0], B = H[1], C = H[2], D = H[3];
+            for (int i = 0; i < 64; i++)
+            {
+                uint32_t F;
+                int g;
+                if (i < 16)
+                {
+                    F = (B & C) | (~B & D);
+                    g = i;
+                }
+                else if (i < 32)
+                {
+                    F = (D & B) | (~D & C);
+                    g = (5 * i + 1) % 16;
+                }
+                else if (i < 48)
+                {
+                    F = B ^ C ^ D;
+                    g = (3 * i + 5) % 16;
+                }
+                else
+                {
+                    F = C ^ (B | ~D);
+                    g = (7 * i) % 16;
+                }
+                F += A + T[i] + M[g];
+                A = D;
+                D = C;
+                C = B;
+                B += rotl(F, S[i]);
+            }
+            H[0] += A;
+            H[1] += B;
+            H[2] += C;
+            H[3] += D;
+        }
+    }
+
+    // ─── Block framing ───────────────────────────────────────────────────────
+    // Merkle–Damgård buffering and padding shared by all three digests.
+
+    class BlockHasher : public hash::Hasher
+    {
+    public:
+        void update(const void *data, size_t len) override
+        {
+            const uint8_t *p = static_cast<const uint8_t *>(data);
+            total_ += len;
+            if (used_)
+            {
+                size_t take = std::min(len, sizeof(buf_) - used_);
+                std::memcpy(buf_ + used_, p, take);
+                used_ += take;
+                p += take;
+                len -= take;
+                if (used_ < sizeof(buf_))
+                    return;
+                compress(buf_, 1);
+                used_ = 0;
+            }
+            if (len >= 64)
+            {
+                compress(p, len / 64);
+                p += len & ~size_t(63);
+                len &= 63;
+            }
+            if (len)
+            {
+                std::memcpy(buf_, p, len);
+                used_ = len;
+            }
+        }
+
+        void digest(uint8_t *out) const override
+        {
+            auto copy = clone();
+            static_cast<BlockHasher &>(*copy).finish(out);
+        }
+
+        size_t blockSize() const override { return 64; }
+
+    protected:
+        explicit BlockHasher(bool bigEndian) : bigEndian_(bigEndian) {}
+
+        virtual void compress(const uint8_t *blocks, size_t count) = 0;
+        virtual void output(uint8_t *out) const = 0;
+
+        void clearBuffer()
+        {
+            used_ = 0;
+            total_ = 0;
+        }
+
+    private:
+        void finish(uint8_t *out)
+        {
+            uint64_t bits = total_ * 8;
+            uint8_t pad[72] = {0x80};
+            size_t padLen = (used_ < 56 ? 56 : 120) - used_;
+            for (int i = 0; i < 8; i++)
+                pad[padLen + i] = uint8_t(bits >> (bigEndian_ ? 56 - 8 * i : 8 * i));
+            update(pad, padLen + 8);
+            output(out);
+        }
+
+        uint8_t buf_[64];
+        size_t used_ = 0;
+        uint64_t total_ = 0;
+        bool bigEndian_;
+    };
+
+    class Sha256 final : public BlockHasher
+    {
+    public:
+        Sha256() : BlockHasher(true) { reset(); }
+
+        void reset() override
+        {
+            static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+            std::memcpy(H_, init, sizeof(H_));
+            clearBuffer();
+        }
+        std::unique_ptr<hash::Hasher> clone() const override { return std::make_unique<Sha256>(*this); }
+        size_t digestSize() const override { return 32; }
+        std::string name() const override { return "sha256"; }
+
+    protected:
+        void compress(const uint8_t *blocks, size_t count) override { kernels().sha256(H_, blocks, count); }
+        void output(uint8_t *out) const override
+        {
+            for (int i = 0; i < 8; i++)
+                storeBE32(out + 4 * i, H_[i]);
+        }
+
+    private:
+        uint32_t H_[8];
+    };
+
+    class Sha1 final : public BlockHasher
+    {
+    public:
+        Sha1() : BlockHasher(true) { reset(); }
+
+        void reset() override
+        {
+            static const uint32_t init[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+            std::memcpy(H_, init, sizeof(H_));
+            clearBuffer();
+        }
+        std::unique_ptr<hash::Hasher> clone() const override { return std::make_unique<Sha1>(*this); }
+        size_t digestSize() const override { return 20; }
+        std::string name() const override { return "sha1"; }
+
+    protected:
+        void compress(const uint8_t *blocks, size_t count) override { kernels().sha1(H_, blocks, count); }
+        void output(uint8_t *out) const override
+        {
+            for (int i = 0; i < 5; i++)
+                storeBE32(out + 4 * i, H_[i]);
+        }
+
+    private:
+        uint32_t H_[5];
+    };
+
+    class Md5 final : public BlockHasher
+    {
+    public:
+        Md5() : BlockHasher(false) { reset(); }
+
+        void reset() override
+        {
+            static const uint32_t init[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+            std::memcpy(H_, init, sizeof(H_));
+            clearBuffer();
+        }
+        std::unique_ptr<hash::Hasher> clone() const override { return std::make_unique<Md5>(*this); }
+        size_t digestSize() const override { return 16; }
+        std::string name() const override { return "md5"; }
+
+    protected:
+        void compress(const uint8_t *blocks, size_t count) override { md5Compress(H_, blocks, count); }
+        void output(uint8_t *out) const override
+        {
+            for (int i = 0; i < 4; i++)
+                storeLE32(out + 4 * i, H_[i]);
+        }
+
+    private:
+        uint32_t H_[4];
+    };
+
+    // ─── HMAC ────────────────────────────────────────────────────────────────
+    // Both pads are absorbed up front, so digest() is one inner finish plus
+    // one outer block.
+
+    class Hmac final : public hash::Hasher
+    {
+    public:
+        Hmac(std::unique_ptr<hash::Hasher> inner, std::string_view key) : inner_(std::move(inner))
+        {
+            const size_t B = inner_->blockSize();
+            std::string k(key);
+            if (k.size() > B)
+            {
+                inner_->update(k);
+                k = inner_->digestBytes();
+                inner_->reset();
+            }
+            k.resize(B, '\0');
+            std::string ipad(B, '\x36'), opad(B, '\x5c');
+            for (size_t i = 0; i < B; i++)
+            {
+                ipad[i] ^= k[i];
+                opad[i] ^= k[i];
+            }
+            outer_ = inner_->clone();
+            inner_->update(ipad);
+            outer_->update(opad);
+            innerStart_ = inner_->clone();
+        }
+
+        Hmac(const Hmac &o)
+            : inner_(o.inner_->clone()), outer_(o.outer_->clone()), innerStart_(o.innerStart_->clone()) {}
+
+        void update(const void *data, size_t len) override { inner_->update(data, len); }
+
+        void digest(uint8_t *out) const override
+        {
+            uint8_t innerDigest[64];
+            inner_->digest(innerDigest);
+            auto outer = outer_->clone();
+            outer->update(innerDigest, inner_->digestSize());
+            outer->digest(out);
+        }
+
+        void reset() override { inner_ = innerStart_->clone(); }
+        std::unique_ptr<hash::Hasher> clone() const override { return std::make_unique<Hmac>(*this); }
+        size_t digestSize() const override { return inner_->digestSize(); }
+        size_t blockSize() const override { return inner_->blockSize(); }
+        std::string name() const override { return "hmac-" + inner_->name(); }
+
+    private:
+        std::unique_ptr<hash::Hasher> inner_;
+        std::unique_ptr<hash::Hasher> outer_;      // key absorbed; finished per digest()
+        std::unique_ptr<hash::Hasher> innerStart_; // key absorbed; for reset()
+    };
+}
+
+namespace hash
+{
+    std::string Hasher::digestBytes() const
+    {
+        uint8_t out[64];
+        digest(out);
+        return std::string(reinterpret_cast<const char *>(out), digestSize());
+    }
+
+    std::string Hasher::hexdigest() const
+    {
+        uint8_t out[64];
+        digest(out);
+        return toHex(out, digestSize());
+    }
+
+    std::unique_ptr<Hasher> create(std::string_view algorithm)
+    {
+        std::string a;
+        for (char c : algorithm)
+            if (c != '-' && c != '_')
+                a += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (a == "sha256")
+            return std::make_unique<Sha256>();
+        if (a == "sha1")
+            return std::make_unique<Sha1>();
+        if (a == "md5")
+            return std::make_unique<Md5>();
+        return nullptr;
+    }
+
+    std::unique_ptr<Hasher> createHmac(std::string_view algorithm, std::string_view key)
+    {
+        auto inner = create(algorithm);
+        if (!inner)
+            return nullptr;
+        return std::make_unique<Hmac>(std::move(inner), key);
+    }
+
+    std::string toHex(const uint8_t *data, size_t len)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(len * 2, '\0');
+        for (size_t i = 0; i < len; i++)
+        {
+            out[2 * i] = digits[data[i] >> 4];
+            out[2 * i + 1] = digits[data[i] & 0xF];
+        }
+        return out;
+    }
+
+    std::string hexOf(std::string_view algorithm, std::string_view data)
+    {
+        auto h = create(algorithm);
+        if (!h)
+            return std::string();
+        h->update(data);
+        return h->hexdigest();
+    }
+
+    bool hashFile(Hasher &h, const std::string &path)
+    {
+        auto mf = MappedFile::open(path);
+        if (!mf)
+            return false;
+        if (mf->isMapped())
+        {
+            mf->adviseSequential();
+            h.update(mf->data(), mf->size());
+            return true;
+        }
+        std::string buf(1 << 20, '\0');
+        while (size_t n = mf->readSome(&buf[0], buf.size()))
+            h.update(buf.data(), n);
+        return true;
+    }
+
+    std::vector<FileResult> hashFiles(const std::vector<FileJob> &jobs, size_t threads,
+                                      const std::function<void(size_t index)> &onDone)
+    {
+        std::vector<FileResult> results(jobs.size());
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, jobs.size());
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < jobs.size(); i = next++)
+            {
+                auto h = create(jobs[i].algorithm);
+                if (h && hashFile(*h, jobs[i].path))
+                {
+                    results[i].hex = h->hexdigest();
+                    results[i].ok = true;
+                }
+                if (onDone)
+                    onDone(i);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < threads; t++)
+            pool.emplace_back(worker);
+        if (threads)
+            worker(); // the calling thread takes a share too
+        for (auto &t : pool)
+            t.join();
+        return results;
+    }
+
+    const char *backend()
+    {
+        return kernels().accelerated ? "sha-ni" : "portable";
+    }
+}
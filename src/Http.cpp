@@ -0,0 +1,572 @@
+#include "Http.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// ─── Helpers ─────────────────────────────────────────────────────────────────
+
+namespace
+{
+    char lower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c;
+    }
+
+    std::string_view trim(std::string_view s)
+    {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+            s.remove_suffix(1);
+        return s;
+    }
+
+    bool containsToken(std::string_view value, std::string_view token)
+    {
+        // Comma-separated list, case-insensitive ("keep-alive, Upgrade").
+        while (!value.empty())
+        {
+            size_t comma = value.find(',');
+            std::string_view item = trim(value.substr(0, comma));
+            if (http::iequals(item, token))
+                return true;
+            if (comma == std::string_view::npos)
+                break;
+            value.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+
+    bool parseSize(std::string_view s, size_t &out, int base)
+    {
+        if (s.empty() || s.size() > 16)
+            return false;
+        size_t v = 0;
+        for (char c : s)
+        {
+            int d;
+            if (c >= '0' && c <= '9')
+                d = c - '0';
+            else if (base == 16 && lower(c) >= 'a' && lower(c) <= 'f')
+                d = lower(c) - 'a' + 10;
+            else
+                return false;
+            v = v * base + d;
+        }
+        out = v;
+        return true;
+    }
+}
+
+// ─── http ────────────────────────────────────────────────────────────────────
+
+namespace http
+{
+    bool iequals(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (lower(a[i]) != lower(b[i]))
+                return false;
+        return true;
+    }
+
+    long parseRequestHead(std::string_view data, HttpRequestHead &out)
+    {
+        out.headers.clear();
+        out.contentLength = 0;
+        out.chunked = false;
+
+        size_t pos = 0;
+        bool first = true;
+        for (;;)
+        {
+            const void *nl = std::memchr(data.data() + pos, '\n', data.size() - pos);
+            if (!nl)
+                return 0;
+            size_t end = static_cast<const char *>(nl) - data.data();
+            std::string_view line = data.substr(pos, end - pos);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            pos = end + 1;
+
+            if (first)
+            {
+                // Tolerate stray blank lines between pipelined requests.
+                if (line.empty())
+                    continue;
+                size_t sp1 = line.find(' ');
+                size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+                if (sp2 == std::string_view::npos)
+                    return -1;
+                out.method = line.substr(0, sp1);
+                out.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+                out.version = line.substr(sp2 + 1);
+                if (out.method.empty() || out.target.empty() || out.version.substr(0, 5) != "HTTP/")
+                    return -1;
+                out.keepAlive = out.version != "HTTP/1.0";
+                first = false;
+                continue;
+            }
+
+            if (line.empty())
+                return static_cast<long>(pos);
+
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0)
+                return -1;
+            HttpHeader h{line.substr(0, colon), trim(line.substr(colon + 1))};
+            out.headers.push_back(h);
+
+            if (iequals(h.name, "content-length"))
+            {
+                if (!parseSize(h.value, out.contentLength, 10))
+                    return -1;
+            }
+            else if (iequals(h.name, "transfer-encoding"))
+                out.chunked = containsToken(h.value, "chunked");
+            else if (iequals(h.name, "connection"))
+            {
+                if (containsToken(h.value, "close"))
+                    out.keepAlive = false;
+                else if (containsToken(h.value, "keep-alive"))
+                    out.keepAlive = true;
+            }
+        }
+    }
+
+    long parseResponseHead(std::string_view data, HttpResponseHead &out)
+    {
+        out.headers.clear();
+        out.contentLength = -1;
+        out.chunked = false;
+
+        size_t pos = 0;
+        bool first = true;
+        for (;;)
+        {
+            const void *nl = std::memchr(data.data() + pos, '\n', data.size() - pos);
+            if (!nl)
+                return 0;
+            size_t end = static_cast<const char *>(nl) - data.data();
+            std::string_view line = data.substr(pos, end - pos);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            pos = end + 1;
+
+            if (first)
+            {
+                // "HTTP/1.1 200 OK" — the reason phrase may be empty.
+                size_t sp1 = line.find(' ');
+                if (sp1 == std::string_view::npos || line.substr(0, 5) != "HTTP/")
+                    return -1;
+                size_t sp2 = line.find(' ', sp1 + 1);
+                std::string_view code = line.substr(sp1 + 1, sp2 == std::string_view::npos ? std::string_view::npos : sp2 - sp1 - 1);
+                size_t status = 0;
+                if (code.size() != 3 || !parseSize(code, status, 10))
+                    return -1;
+                out.version = std::string(line.substr(0, sp1));
+                out.status = static_cast<int>(status);
+                out.reason = sp2 == std::string_view::npos ? std::string() : std::string(line.substr(sp2 + 1));
+                out.keepAlive = out.version != "HTTP/1.0";
+                first = false;
+                continue;
+            }
+
+            if (line.empty())
+                return static_cast<long>(pos);
+
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0)
+                return -1;
+            std::string_view name = line.substr(0, colon);
+            std::string_view value = trim(line.substr(colon + 1));
+            out.headers.emplace_back(std::string(name), std::string(value));
+
+            if (iequals(name, "content-length"))
+            {
+                size_t n = 0;
+                if (!parseSize(value, n, 10))
+                    return -1;
+                out.contentLength = static_cast<long long>(n);
+            }
+            else if (iequals(name, "transfer-encoding"))
+                out.chunked = containsToken(value, "chunked");
+            else if (iequals(name, "connection"))
+            {
+                if (containsToken(value, "close"))
+                    out.keepAlive = false;
+                else if (containsToken(value, "keep-alive"))
+                    out.keepAlive = true;
+            }
+        }
+    }
+
+    const char *reasonPhrase(int status)
+    {
+        switch (status)
+        {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 422: return "Unprocessable Entity";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Unknown";
+        }
+    }
+
+    void appendResponseHead(std::string &out, int status,
+                            const std::vector<std::pair<std::string, std::string>> &headers,
+                            long long bodyLength, bool keepAlive)
+    {
+        out += "HTTP/1.1 ";
+        out += std::to_string(status);
+        out += ' ';
+        out += reasonPhrase(status);
+        out += "\r\n";
+        for (auto &[k, v] : headers)
+        {
+            out += k;
+            out += ": ";
+            out += v;
+            out += "\r\n";
+        }
+        if (bodyLength >= 0)
+        {
+            out += "Content-Length: ";
+            out += std::to_string(bodyLength);
+            out += "\r\n";
+        }
+        else
+            out += "Transfer-Encoding: chunked\r\n";
+        out += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    }
+
+    void appendChunk(std::string &out, std::string_view data)
+    {
+        if (data.empty())
+            return; // a zero-length chunk would terminate the body
+        char hex[20];
+        int n = std::snprintf(hex, sizeof(hex), "%zx\r\n", data.size());
+        out.append(hex, static_cast<size_t>(n));
+        out.append(data.data(), data.size());
+        out += "\r\n";
+    }
+}
+
+std::string_view HttpRequestHead::header(std::string_view name) const
+{
+    for (auto &h : headers)
+        if (http::iequals(h.name, name))
+            return h.value;
+    return {};
+}
+
+std::string HttpResponseHead::header(std::string_view name) const
+{
+    for (auto &h : headers)
+        if (http::iequals(h.first, name))
+            return h.second;
+    return {};
+}
+
+// ─── HttpRequestParser ───────────────────────────────────────────────────────
+
+HttpRequestParser::Status HttpRequestParser::fail(int status)
+{
+    errorStatus_ = status;
+    return Status::Error;
+}
+
+HttpRequestParser::Status HttpRequestParser::parse()
+{
+    std::string_view data(buf_.data() + start_, buf_.size() - start_);
+    if (headLen_ == 0)
+    {
+        long n = http::parseRequestHead(data, head_);
+        if (n < 0)
+            return fail(400);
+        if (n == 0)
+            return data.size() > maxHeaderBytes ? fail(431) : Status::NeedMore;
+        if (static_cast<size_t>(n) > maxHeaderBytes)
+            return fail(431);
+        if (!head_.chunked && head_.contentLength > maxBodyBytes)
+            return fail(413);
+        headLen_ = static_cast<size_t>(n);
+        chunkPos_ = start_ + headLen_;
+        chunkedBody_.clear();
+    }
+    else
+    {
+        // The buffer may have moved since the head was parsed; refresh views.
+        http::parseRequestHead(data, head_);
+    }
+
+    size_t bodyStart = start_ + headLen_;
+    if (!head_.chunked)
+    {
+        if (buf_.size() - bodyStart < head_.contentLength)
+            return Status::NeedMore;
+        body_ = std::string_view(buf_.data() + bodyStart, head_.contentLength);
+        bodyEnd_ = bodyStart + head_.contentLength;
+        return Status::Done;
+    }
+
+    for (;;)
+    {
+        size_t nl = buf_.find('\n', chunkPos_);
+        if (nl == std::string::npos)
+            return buf_.size() - chunkPos_ > 1024 ? fail(400) : Status::NeedMore;
+        std::string_view line(buf_.data() + chunkPos_, nl - chunkPos_);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        size_t semi = line.find(';');
+        if (semi != std::string_view::npos)
+            line = line.substr(0, semi);
+        size_t size = 0;
+        if (!parseSize(trim(line), size, 16))
+            return fail(400);
+
+        size_t dataStart = nl + 1;
+        if (size == 0)
+        {
+            // Optional trailers, then an empty line.
+            size_t p = dataStart;
+            for (;;)
+            {
+                size_t e = buf_.find('\n', p);
+                if (e == std::string::npos)
+                    return Status::NeedMore;
+                bool blank = e == p || (e == p + 1 && buf_[p] == '\r');
+                p = e + 1;
+                if (blank)
+                    break;
+            }
+            body_ = chunkedBody_;
+            bodyEnd_ = p;
+            return Status::Done;
+        }
+        if (chunkedBody_.size() + size > maxBodyBytes)
+            return fail(413);
+        if (buf_.size() < dataStart + size + 1)
+            return Status::NeedMore;
+        chunkedBody_.append(buf_, dataStart, size);
+        size_t after = dataStart + size;
+        if (buf_[after] == '\r')
+        {
+            if (buf_.size() < after + 2)
+            {
+                chunkedBody_.resize(chunkedBody_.size() - size);
+                return Status::NeedMore;
+            }
+            ++after;
+        }
+        if (buf_[after] != '\n')
+            return fail(400);
+        chunkPos_ = after + 1;
+    }
+}
+
+void HttpRequestParser::consume()
+{
+    start_ = bodyEnd_;
+    headLen_ = 0;
+    body_ = {};
+    if (start_ >= buf_.size())
+    {
+        buf_.clear();
+        start_ = 0;
+    }
+    else if (start_ > 64 * 1024 && start_ * 2 > buf_.size())
+    {
+        buf_.erase(0, start_);
+        start_ = 0;
+    }
+}
+
+// ─── HttpResponseParser ──────────────────────────────────────────────────────
+
+HttpResponseParser::Status HttpResponseParser::fail(const std::string &msg)
+{
+    error_ = msg;
+    return Status::Error;
+}
+
+void HttpResponseParser::feed(const char *data, size_t len)
+{
+    // Views handed out by the previous parse() die here, so consumed bytes
+    // can be dropped before appending.
+    if (pos_ == buf_.size())
+    {
+        buf_.clear();
+        pos_ = 0;
+    }
+    else if (pos_ > 64 * 1024)
+    {
+        buf_.erase(0, pos_);
+        pos_ = 0;
+    }
+    buf_.append(data, len);
+}
+
+void HttpResponseParser::skipBody()
+{
+    if (state_ != State::Head)
+        state_ = State::Finished;
+}
+
+HttpResponseParser::Status HttpResponseParser::parse()
+{
+    data_ = {};
+    for (;;)
+    {
+        size_t avail = buf_.size() - pos_;
+        switch (state_)
+        {
+        case State::Head:
+        {
+            std::string_view view(buf_.data() + pos_, avail);
+            long n = http::parseResponseHead(view, head_);
+            if (n < 0)
+                return fail("malformed response head");
+            if (n == 0)
+            {
+                if (avail > maxHeaderBytes)
+                    return fail("response head too large");
+                if (eof_)
+                    return fail(avail ? "connection closed mid-response" : "connection closed");
+                return Status::NeedMore;
+            }
+            pos_ += static_cast<size_t>(n);
+            if (head_.status >= 100 && head_.status < 200 && head_.status != 101)
+                continue; // interim response; the real one follows
+
+            if (head_.status == 204 || head_.status == 304 || head_.status < 200)
+                state_ = State::Finished;
+            else if (head_.chunked)
+                state_ = State::ChunkSize;
+            else if (head_.contentLength >= 0)
+            {
+                remaining_ = static_cast<unsigned long long>(head_.contentLength);
+                state_ = remaining_ ? State::Body : State::Finished;
+            }
+            else
+            {
+                state_ = State::UntilClose;
+                head_.keepAlive = false;
+            }
+            return Status::Head;
+        }
+
+        case State::Body:
+        case State::ChunkData:
+        {
+            if (remaining_ == 0)
+            {
+                state_ = state_ == State::Body ? State::Finished : State::ChunkEnd;
+                continue;
+            }
+            if (avail == 0)
+                return eof_ ? fail("connection closed mid-body") : Status::NeedMore;
+            size_t n = static_cast<size_t>(std::min<unsigned long long>(remaining_, avail));
+            data_ = std::string_view(buf_.data() + pos_, n);
+            pos_ += n;
+            remaining_ -= n;
+            return Status::Data;
+        }
+
+        case State::UntilClose:
+            if (avail)
+            {
+                data_ = std::string_view(buf_.data() + pos_, avail);
+                pos_ += avail;
+                return Status::Data;
+            }
+            if (!eof_)
+                return Status::NeedMore;
+            state_ = State::Finished;
+            continue;
+
+        case State::ChunkSize:
+        {
+            size_t nl = buf_.find('\n', pos_);
+            if (nl == std::string::npos)
+            {
+                if (avail > 1024)
+                    return fail("malformed chunk size");
+                return eof_ ? fail("connection closed mid-body") : Status::NeedMore;
+            }
+            std::string_view line(buf_.data() + pos_, nl - pos_);
+            size_t semi = line.find(';');
+            if (semi != std::string_view::npos)
+                line = line.substr(0, semi);
+            size_t size = 0;
+            if (!parseSize(trim(line), size, 16))
+                return fail("malformed chunk size");
+            pos_ = nl + 1;
+            remaining_ = size;
+            state_ = size ? State::ChunkData : State::Trailers;
+            continue;
+        }
+
+        case State::ChunkEnd:
+            if (avail && buf_[pos_] == '\r')
+            {
+                if (avail < 2)
+                    return eof_ ? fail("connection closed mid-body") : Status::NeedMore;
+                ++pos_;
+                --avail;
+            }
+            if (avail == 0)
+                return eof_ ? fail("connection closed mid-body") : Status::NeedMore;
+            if (buf_[pos_] != '\n')
+                return fail("malformed chunk terminator");
+            ++pos_;
+            state_ = State::ChunkSize;
+            continue;
+
+        case State::Trailers:
+        {
+            size_t nl = buf_.find('\n', pos_);
+            if (nl == std::string::npos)
+                return eof_ ? fail("connection closed mid-body") : Status::NeedMore;
+            bool blank = nl == pos_ || (nl == pos_ + 1 && buf_[pos_] == '\r');
+            pos_ = nl + 1;
+            if (blank)
+                state_ = State::Finished;
+            continue;
+        }
+
+        case State::Finished:
+            state_ = State::Head;
+            return Status::Done;
+        }
+    }
+}
@@ -0,0 +1,424 @@
+#include "HttpClient.h"
+#include "Net.h"
+#include <algorithm>
+
+// ─── HttpClient::Request ─────────────────────────────────────────────────────
+
+void HttpClient::Request::pause()
+{
+    if (auto s = stream_.lock())
+        s->pause();
+}
+
+void HttpClient::Request::resume()
+{
+    if (auto s = stream_.lock())
+        s->resume();
+}
+
+// ─── Helpers ─────────────────────────────────────────────────────────────────
+
+std::string HttpClient::keyOf(const Request &req)
+{
+    return req.host + ":" + std::to_string(req.port);
+}
+
+bool HttpClient::idempotent(const std::string &method)
+{
+    return method == "GET" || method == "HEAD" || method == "OPTIONS" ||
+           method == "PUT" || method == "DELETE";
+}
+
+std::string HttpClient::serialize(const Request &req)
+{
+    std::string out;
+    out.reserve(128 + req.target.size() + req.body.size());
+    out += req.method;
+    out += ' ';
+    out += req.target;
+    out += " HTTP/1.1\r\n";
+
+    bool hasHost = false, hasLength = false;
+    for (auto &[k, v] : req.headers)
+    {
+        hasHost = hasHost || http::iequals(k, "host");
+        hasLength = hasLength || http::iequals(k, "content-length");
+        out += k;
+        out += ": ";
+        out += v;
+        out += "\r\n";
+    }
+    if (!hasHost)
+    {
+        bool v6 = req.host.find(':') != std::string::npos;
+        out += "Host: ";
+        out += v6 ? "[" + req.host + "]" : req.host;
+        if (req.port != 80)
+            out += ":" + std::to_string(req.port);
+        out += "\r\n";
+    }
+    if (!hasLength && (!req.body.empty() || req.method == "POST" || req.method == "PUT" || req.method == "PATCH"))
+        out += "Content-Length: " + std::to_string(req.body.size()) + "\r\n";
+    out += "\r\n";
+    out += req.body;
+    return out;
+}
+
+// ─── Dispatch ────────────────────────────────────────────────────────────────
+
+void HttpClient::send(const std::shared_ptr<Request> &req)
+{
+    ++req->attempts_;
+    if (req->timeoutMs > 0 && !req->timer_)
+    {
+        std::weak_ptr<HttpClient> weakSelf = shared_from_this();
+        std::weak_ptr<Request> weakReq = req;
+        req->timer_ = loop_.addTimer(req->timeoutMs, [weakSelf, weakReq]()
+                                     {
+            auto self = weakSelf.lock();
+            auto r = weakReq.lock();
+            if (self && r)
+            {
+                r->timer_ = 0;
+                self->timedOut(r);
+            } });
+    }
+    if (!place(req))
+        hosts_[keyOf(*req)].waiting.push_back(req);
+}
+
+bool HttpClient::place(const std::shared_ptr<Request> &req)
+{
+    const std::string key = keyOf(*req);
+    Host &h = hosts_[key];
+    auto now = Clock::now();
+
+    // 1. An idle pooled connection (dropping ones that idled too long).
+    for (size_t i = 0; i < h.conns.size(); ++i)
+    {
+        auto conn = h.conns[i];
+        if (!conn->stream || conn->stream->isConnecting() || !conn->reusable || !conn->inflight.empty())
+            continue;
+        std::chrono::duration<double, std::milli> idle = now - conn->idleSince;
+        if (idle.count() > idleTimeoutMs || !conn->stream->isOpen())
+        {
+            discard(conn);
+            --i;
+            continue;
+        }
+        assign(conn, req);
+        return true;
+    }
+
+    // 2. A new connection, while under the per-host cap.
+    if (h.conns.size() < maxConnectionsPerHost)
+    {
+        auto conn = std::make_shared<Conn>();
+        conn->key = key;
+        h.conns.push_back(conn);
+        assign(conn, req);
+        open(conn, req->host, req->port);
+        return true;
+    }
+
+    // 3. Pipeline behind the least busy connection.
+    if (req->pipeline && idempotent(req->method))
+    {
+        std::shared_ptr<Conn> best;
+        for (auto &conn : h.conns)
+        {
+            if (!conn->reusable || conn->inflight.size() >= maxPipelineDepth)
+                continue;
+            bool safe = std::all_of(conn->inflight.begin(), conn->inflight.end(),
+                                    [](const std::shared_ptr<Request> &r)
+                                    { return r->pipeline && idempotent(r->method); });
+            if (safe && (!best || conn->inflight.size() < best->inflight.size()))
+                best = conn;
+        }
+        if (best)
+        {
+            assign(best, req);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HttpClient::assign(const std::shared_ptr<Conn> &conn, const std::shared_ptr<Request> &req)
+{
+    conn->inflight.push_back(req);
+    req->responding_ = false;
+    std::string bytes = serialize(*req);
+    if (conn->stream)
+    {
+        req->stream_ = conn->stream;
+        conn->stream->setHoldsLoop(true);
+        conn->stream->write(bytes);
+    }
+    else
+        conn->pendingOut += bytes;
+}
+
+void HttpClient::open(const std::shared_ptr<Conn> &conn, const std::string &host, int port)
+{
+    std::weak_ptr<HttpClient> weakSelf = shared_from_this();
+    std::weak_ptr<Conn> weakConn = conn;
+    resolve_(host, port, [weakSelf, weakConn](const net::Address *addr, const std::string &rerr)
+             {
+        auto self = weakSelf.lock();
+        auto conn = weakConn.lock();
+        if (!self || !conn || conn->dead)
+            return;
+        if (!addr)
+        {
+            self->connDead(conn, rerr, false);
+            return;
+        }
+        std::string err;
+        auto stream = TcpStream::connect(self->loop_, *addr, err);
+        if (!stream)
+        {
+            self->connDead(conn, err, false);
+            return;
+        }
+        ++self->opened_;
+        conn->stream = stream;
+        for (auto &r : conn->inflight)
+            r->stream_ = stream;
+
+        stream->onData = [weakSelf, weakConn](const char *data, size_t len)
+        {
+            auto self = weakSelf.lock();
+            auto conn = weakConn.lock();
+            if (!self || !conn || conn->dead)
+                return;
+            conn->parser.feed(data, len);
+            self->onResponseBytes(conn);
+        };
+        stream->onEnd = [weakSelf, weakConn]()
+        {
+            auto self = weakSelf.lock();
+            auto conn = weakConn.lock();
+            if (!self || !conn || conn->dead)
+                return;
+            conn->parser.finish();
+            if (!conn->inflight.empty())
+                self->onResponseBytes(conn);
+            self->connDead(conn, "connection closed by server", false);
+        };
+        stream->onError = [weakConn](const std::string &msg)
+        {
+            if (auto conn = weakConn.lock())
+                conn->error = msg;
+        };
+        stream->onClose = [weakSelf, weakConn]()
+        {
+            auto self = weakSelf.lock();
+            auto conn = weakConn.lock();
+            if (self && conn && !conn->dead)
+                self->connDead(conn, conn->error.empty() ? "connection closed" : conn->error, false);
+        };
+        stream->write(conn->pendingOut);
+        conn->pendingOut.clear();
+        stream->start(); });
+}
+
+// ─── Responses ───────────────────────────────────────────────────────────────
+
+void HttpClient::onResponseBytes(const std::shared_ptr<Conn> &conn)
+{
+    auto self = shared_from_this();
+    while (!conn->dead)
+    {
+        if (conn->inflight.empty())
+        {
+            if (!conn->parser.idle())
+                connDead(conn, "unexpected data from server", false);
+            return;
+        }
+        auto req = conn->inflight.front();
+        auto status = conn->parser.parse();
+        switch (status)
+        {
+        case HttpResponseParser::Status::NeedMore:
+            return;
+        case HttpResponseParser::Status::Error:
+            connDead(conn, conn->parser.error(), false);
+            return;
+        case HttpResponseParser::Status::Head:
+        {
+            req->responding_ = true;
+            const HttpResponseHead &head = conn->parser.head();
+            if (req->method == "HEAD")
+                conn->parser.skipBody();
+            if (!head.keepAlive)
+                conn->reusable = false;
+            if (!req->finished_ && req->onHead)
+                req->onHead(head);
+            break;
+        }
+        case HttpResponseParser::Status::Data:
+            if (!req->finished_ && req->onData)
+            {
+                std::string_view d = conn->parser.data();
+                req->onData(d.data(), d.size());
+            }
+            break;
+        case HttpResponseParser::Status::Done:
+        {
+            conn->inflight.pop_front();
+            ++conn->completed;
+            bool reuse = conn->reusable;
+            if (reuse && conn->inflight.empty())
+            {
+                conn->idleSince = Clock::now();
+                conn->stream->setHoldsLoop(false);
+            }
+            finish(req, nullptr);
+            if (!reuse)
+            {
+                // Anything pipelined behind this response is retried.
+                connDead(conn, "connection closed by server", true);
+                return;
+            }
+            if (conn->inflight.empty())
+                pump(conn->key);
+            break;
+        }
+        }
+    }
+}
+
+void HttpClient::finish(const std::shared_ptr<Request> &req, const std::string *error)
+{
+    if (req->finished_)
+        return;
+    req->finished_ = true;
+    if (req->timer_)
+    {
+        loop_.cancelTimer(req->timer_);
+        req->timer_ = 0;
+    }
+    auto onDone = std::move(req->onDone);
+    auto onError = std::move(req->onError);
+    req->onHead = nullptr;
+    req->onData = nullptr;
+    req->onDone = nullptr;
+    req->onError = nullptr;
+    if (error)
+    {
+        if (onError)
+            onError(*error);
+    }
+    else if (onDone)
+        onDone();
+}
+
+void HttpClient::discard(std::shared_ptr<Conn> conn)
+{
+    conn->dead = true;
+    auto hit = hosts_.find(conn->key);
+    if (hit != hosts_.end())
+    {
+        auto &conns = hit->second.conns;
+        conns.erase(std::remove(conns.begin(), conns.end(), conn), conns.end());
+    }
+    if (conn->stream)
+        conn->stream->close();
+}
+
+void HttpClient::connDead(std::shared_ptr<Conn> conn, const std::string &msg, bool retryAll)
+{
+    if (conn->dead)
+        return;
+    auto self = shared_from_this();
+    discard(conn);
+
+    auto inflight = std::move(conn->inflight);
+    conn->inflight.clear();
+    for (auto &req : inflight)
+    {
+        if (req->finished_)
+            continue;
+        // Retry only what the server never answered, and only when the
+        // connection had already proved itself (a stale keep-alive socket) or
+        // the request was simply queued behind a response that closed it.
+        // The server may still have acted on a request it did not answer, so
+        // a POST or PATCH is never replayed: it fails with the error instead.
+        bool retry = !req->responding_ && req->attempts_ < 3 && idempotent(req->method) &&
+                     (retryAll || conn->completed > 0);
+        if (retry)
+            send(req);
+        else
+            finish(req, &msg);
+    }
+    pump(conn->key);
+}
+
+void HttpClient::pump(const std::string &key)
+{
+    auto hit = hosts_.find(key);
+    if (hit == hosts_.end())
+        return;
+    while (!hit->second.waiting.empty())
+    {
+        auto req = hit->second.waiting.front();
+        if (req->finished_)
+        {
+            hit->second.waiting.pop_front();
+            continue;
+        }
+        if (!place(req))
+            break;
+        hit->second.waiting.pop_front();
+    }
+}
+
+void HttpClient::timedOut(const std::shared_ptr<Request> &req)
+{
+    if (req->finished_)
+        return;
+    std::string msg = "request timed out";
+    Host &h = hosts_[keyOf(*req)];
+    for (auto &conn : h.conns)
+    {
+        if (std::find(conn->inflight.begin(), conn->inflight.end(), req) == conn->inflight.end())
+            continue;
+        finish(req, &msg);
+        // The connection's remaining responses can no longer be matched up.
+        connDead(conn, msg, true);
+        return;
+    }
+    auto &w = h.waiting;
+    w.erase(std::remove(w.begin(), w.end(), req), w.end());
+    finish(req, &msg);
+}
+
+void HttpClient::closeIdle()
+{
+    auto self = shared_from_this();
+    for (auto &[key, h] : hosts_)
+    {
+        auto conns = h.conns;
+        for (auto &conn : conns)
+            if (conn->inflight.empty())
+                discard(conn);
+    }
+}
+
+size_t HttpClient::openConnections() const
+{
+    size_t n = 0;
+    for (auto &[key, h] : hosts_)
+        n += h.conns.size();
+    return n;
+}
+
+size_t HttpClient::idleConnections() const
+{
+    size_t n = 0;
+    for (auto &[key, h] : hosts_)
+        for (auto &conn : h.conns)
+            n += conn->inflight.empty() && conn->stream ? 1 : 0;
+    return n;
+}
@@ -0,0 +1,405 @@
+#include "IpSet.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    int hexDigit(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        c |= 0x20;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    // Network masks for a prefix length within the address's family.
+    void maskFor(const ipaddr::Address &a, int length, uint64_t &hiMask, uint64_t &loMask)
+    {
+        if (!a.v6)
+        {
+            hiMask = 0;
+            loMask = length == 0 ? 0 : (0xFFFFFFFFull << (32 - length)) & 0xFFFFFFFFull;
+            return;
+        }
+        hiMask = length >= 64 ? ~0ull : length == 0 ? 0 : ~0ull << (64 - length);
+        loMask = length <= 64 ? 0 : length == 128 ? ~0ull : ~0ull << (128 - length);
+    }
+
+    bool parseV6(std::string_view s, ipaddr::Address &out)
+    {
+        size_t pct = s.find('%');
+        if (pct != std::string_view::npos)
+            s = s.substr(0, pct);
+        if (s.empty())
+            return false;
+
+        uint16_t groups[8] = {};
+        int n = 0, gap = -1;
+        size_t i = 0;
+        if (s.size() >= 2 && s[0] == ':' && s[1] == ':')
+        {
+            gap = 0;
+            i = 2;
+        }
+        else if (s[0] == ':')
+            return false;
+
+        while (i < s.size())
+        {
+            size_t end = s.find(':', i);
+            std::string_view tok = s.substr(i, end == std::string_view::npos ? std::string_view::npos : end - i);
+            if (tok.find('.') != std::string_view::npos)
+            {
+                // Embedded IPv4 tail, e.g. ::ffff:10.0.0.1
+                uint32_t v4;
+                if (end != std::string_view::npos || n > 6 || !ipaddr::parseV4(tok, v4))
+                    return false;
+                groups[n++] = static_cast<uint16_t>(v4 >> 16);
+                groups[n++] = static_cast<uint16_t>(v4);
+                break;
+            }
+            if (tok.empty() || tok.size() > 4 || n == 8)
+                return false;
+            unsigned g = 0;
+            for (char c : tok)
+            {
+                int d = hexDigit(c);
+                if (d < 0)
+                    return false;
+                g = g * 16 + static_cast<unsigned>(d);
+            }
+            groups[n++] = static_cast<uint16_t>(g);
+            if (end == std::string_view::npos)
+                break;
+            i = end + 1;
+            if (i < s.size() && s[i] == ':')
+            {
+                if (gap >= 0)
+                    return false;
+                gap = n;
+                i++;
+            }
+            else if (i == s.size())
+                return false; // trailing single ':'
+        }
+
+        if (gap < 0 ? n != 8 : n > 7)
+            return false;
+        uint16_t full[8] = {};
+        if (gap < 0)
+            std::copy(groups, groups + 8, full);
+        else
+        {
+            std::copy(groups, groups + gap, full);
+            std::copy(groups + gap, groups + n, full + 8 - (n - gap));
+        }
+        out.v6 = true;
+        out.hi = out.lo = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            out.hi = (out.hi << 16) | full[k];
+            out.lo = (out.lo << 16) | full[k + 4];
+        }
+        return true;
+    }
+}
+
+namespace ipaddr
+{
+    bool Prefix::contains(const Address &a) const
+    {
+        if (a.v6 != addr.v6)
+            return false;
+        uint64_t hiMask, loMask;
+        maskFor(addr, length, hiMask, loMask);
+        return (a.hi & hiMask) == addr.hi && (a.lo & loMask) == addr.lo;
+    }
+
+    Address Prefix::last() const
+    {
+        uint64_t hiMask, loMask;
+        maskFor(addr, length, hiMask, loMask);
+        Address a = addr;
+        if (a.v6)
+        {
+            a.hi |= ~hiMask;
+            a.lo |= ~loMask;
+        }
+        else
+            a.lo |= ~loMask & 0xFFFFFFFFull;
+        return a;
+    }
+
+    bool parseV4(std::string_view s, uint32_t &out)
+    {
+        uint32_t v = 0;
+        int parts = 0;
+        size_t i = 0;
+        while (parts < 4)
+        {
+            if (i >= s.size() || s[i] < '0' || s[i] > '9')
+                return false;
+            unsigned octet = 0;
+            size_t start = i;
+            while (i < s.size() && s[i] >= '0' && s[i] <= '9' && i - start < 3)
+                octet = octet * 10 + (s[i++] - '0');
+            if (octet > 255)
+                return false;
+            v = (v << 8) | octet;
+            if (++parts < 4)
+            {
+                if (i >= s.size() || s[i] != '.')
+                    return false;
+                ++i;
+            }
+        }
+        if (i != s.size())
+            return false;
+        out = v;
+        return true;
+    }
+
+    bool parse(std::string_view text, Address &out)
+    {
+        if (text.find(':') != std::string_view::npos)
+            return parseV6(text, out);
+        uint32_t v4;
+        if (!parseV4(text, v4))
+            return false;
+        out = Address();
+        out.lo = v4;
+        return true;
+    }
+
+    bool parsePrefix(std::string_view text, Prefix &out)
+    {
+        size_t slash = text.find('/');
+        if (!parse(text.substr(0, slash), out.addr))
+            return false;
+        out.length = out.addr.bits();
+        if (slash != std::string_view::npos)
+        {
+            std::string_view len = text.substr(slash + 1);
+            if (len.empty() || len.size() > 3)
+                return false;
+            int v = 0;
+            for (char c : len)
+            {
+                if (c < '0' || c > '9')
+                    return false;
+                v = v * 10 + (c - '0');
+            }
+            if (v > out.addr.bits())
+                return false;
+            out.length = v;
+        }
+        out = prefixOf(out.addr, out.length);
+        return true;
+    }
+
+    Prefix prefixOf(const Address &a, int length)
+    {
+        uint64_t hiMask, loMask;
+        maskFor(a, length, hiMask, loMask);
+        Prefix p;
+        p.addr = a;
+        p.addr.hi &= hiMask;
+        p.addr.lo &= loMask;
+        p.length = length;
+        return p;
+    }
+
+    std::string formatV4(uint32_t ip)
+    {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u", ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF);
+        return buf;
+    }
+
+    std::string format(const Address &a)
+    {
+        if (!a.v6)
+            return formatV4(static_cast<uint32_t>(a.lo));
+        if (a.hi == 0 && (a.lo >> 32) == 0xFFFF)
+            return "::ffff:" + formatV4(static_cast<uint32_t>(a.lo));
+
+        uint16_t g[8];
+        for (int k = 0; k < 4; k++)
+        {
+            g[k] = static_cast<uint16_t>(a.hi >> (48 - 16 * k));
+            g[k + 4] = static_cast<uint16_t>(a.lo >> (48 - 16 * k));
+        }
+        // Longest run of two or more zero groups (the first on a tie).
+        int bestAt = -1, bestLen = 1;
+        for (int k = 0; k < 8;)
+        {
+            if (g[k])
+            {
+                k++;
+                continue;
+            }
+            int start = k;
+            while (k < 8 && !g[k])
+                k++;
+            if (k - start > bestLen)
+            {
+                bestAt = start;
+                bestLen = k - start;
+            }
+        }
+        std::string out;
+        char buf[8];
+        for (int k = 0; k < 8; k++)
+        {
+            if (k == bestAt)
+            {
+                out += "::";
+                k += bestLen - 1;
+                continue;
+            }
+            if (!out.empty() && out.back() != ':')
+                out += ':';
+            std::snprintf(buf, sizeof(buf), "%x", g[k]);
+            out += buf;
+        }
+        return out;
+    }
+
+    std::string format(const Prefix &p)
+    {
+        return format(p.addr) + "/" + std::to_string(p.length);
+    }
+
+    Address unmapped(const Address &a)
+    {
+        if (!a.v6 || a.hi != 0 || (a.lo >> 32) != 0xFFFF)
+            return a;
+        Address v4;
+        v4.lo = a.lo & 0xFFFFFFFFull;
+        return v4;
+    }
+
+    Address next(const Address &a)
+    {
+        Address n = a;
+        if (!n.v6)
+            n.lo = (n.lo + 1) & 0xFFFFFFFFull;
+        else if (++n.lo == 0)
+            n.hi++;
+        return n;
+    }
+}
+
+// ─── IpSet ────────────────────────────────────────────────────────────────────
+
+IpSet::IpSet() : v4_(1), v6_(1) {}
+
+bool IpSet::add(const ipaddr::Prefix &p, uint32_t tag)
+{
+    std::vector<Node> &t = trie(p.addr);
+    uint32_t n = 0;
+    for (int i = 0; i < p.length; i++)
+    {
+        int b = p.addr.bit(i);
+        if (!t[n].child[b])
+        {
+            uint32_t c = static_cast<uint32_t>(t.size());
+            t.emplace_back(); // may move t; index before and after
+            t[n].child[b] = c;
+        }
+        n = t[n].child[b];
+    }
+    bool fresh = t[n].tag == kNoTag;
+    t[n].tag = tag;
+    count_ += fresh;
+    return fresh;
+}
+
+bool IpSet::contains(const ipaddr::Address &addr) const
+{
+    const ipaddr::Address a = ipaddr::unmapped(addr);
+    const std::vector<Node> &t = trie(a);
+    const int bits = a.bits();
+    uint32_t n = 0;
+    for (int i = 0;; i++)
+    {
+        if (t[n].tag != kNoTag)
+            return true;
+        if (i == bits || !(n = t[n].child[a.bit(i)]))
+            return false;
+    }
+}
+
+uint32_t IpSet::longestMatch(const ipaddr::Address &addr, ipaddr::Prefix *matched) const
+{
+    const ipaddr::Address a = ipaddr::unmapped(addr);
+    const std::vector<Node> &t = trie(a);
+    const int bits = a.bits();
+    uint32_t n = 0, tag = kNoTag;
+    int depth = -1;
+    for (int i = 0;; i++)
+    {
+        if (t[n].tag != kNoTag)
+        {
+            tag = t[n].tag;
+            depth = i;
+        }
+        if (i == bits || !(n = t[n].child[a.bit(i)]))
+            break;
+    }
+    if (matched && depth >= 0)
+        *matched = ipaddr::prefixOf(a, depth);
+    return tag;
+}
+
+std::vector<std::pair<ipaddr::Prefix, uint32_t>> IpSet::prefixes() const
+{
+    std::vector<std::pair<ipaddr::Prefix, uint32_t>> out;
+    out.reserve(count_);
+    struct Frame
+    {
+        uint32_t node;
+        int depth;
+        ipaddr::Address addr;
+    };
+    for (bool v6 : {false, true})
+    {
+        const std::vector<Node> &t = v6 ? v6_ : v4_;
+        std::vector<Frame> stack;
+        ipaddr::Address root;
+        root.v6 = v6;
+        stack.push_back({0, 0, root});
+        while (!stack.empty())
+        {
+            Frame f = stack.back();
+            stack.pop_back();
+            const Node &node = t[f.node];
+            if (node.tag != kNoTag)
+            {
+                ipaddr::Prefix p;
+                p.addr = f.addr;
+                p.length = f.depth;
+                out.push_back({p, node.tag});
+            }
+            // Push the 1 branch first so the 0 branch comes out first.
+            for (int b = 1; b >= 0; b--)
+            {
+                if (!node.child[b])
+                    continue;
+                ipaddr::Address a = f.addr;
+                int bitPos = a.bits() - 1 - f.depth; // from the least significant end
+                if (b)
+                {
+                    if (bitPos >= 64)
+                        a.hi |= 1ull << (bitPos - 64);
+                    else
+                        a.lo |= 1ull << bitPos;
+                }
+                stack.push_back({node.child[b], f.depth + 1, a});
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,732 @@
+#include "Json.h"
+#include "Cpu.h"
+#include "MappedFile.h"
+#include "Number.h"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_JSON_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define QUANTUM_TARGET_SSE2
+#define QUANTUM_TARGET_AVX2
+#else
+#define QUANTUM_TARGET_SSE2 __attribute__((target("sse2")))
+#define QUANTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace json
+{
+    namespace
+    {
+        constexpr size_t kChunk = 64 * 1024; // stream read size
+
+        inline int lowestBit(unsigned x)
+        {
+#ifdef _MSC_VER
+            unsigned long i;
+            _BitScanForward(&i, x);
+            return static_cast<int>(i);
+#else
+            return __builtin_ctz(x);
+#endif
+        }
+
+        enum Level
+        {
+            Portable,
+            Sse2,
+            Avx2
+        };
+
+        Level level()
+        {
+#ifdef QUANTUM_JSON_X86
+            static const Level l = cpu::hasAvx2() ? Avx2 : cpu::hasSse2() ? Sse2
+                                                                          : Portable;
+            return l;
+#else
+            return Portable;
+#endif
+        }
+
+        // The bytes that end a plain run inside a string: the quote, a
+        // backslash, and when writing, control bytes that must be escaped.
+        inline bool special(uint8_t c, bool controls)
+        {
+            return c == '"' || c == '\\' || (controls && c < 0x20);
+        }
+
+        size_t findSpecialPortable(const uint8_t *p, size_t i, size_t n, bool controls)
+        {
+            while (i < n && !special(p[i], controls))
+                i++;
+            return i;
+        }
+
+#ifdef QUANTUM_JSON_X86
+        QUANTUM_TARGET_SSE2 size_t findSpecialSse2(const uint8_t *p, size_t i, size_t n, bool controls)
+        {
+            const __m128i quote = _mm_set1_epi8('"'), slash = _mm_set1_epi8('\\');
+            const __m128i ctl = _mm_set1_epi8(controls ? 0x1F : 0);
+            const __m128i none = _mm_set1_epi8(controls ? 0 : -1);
+            for (; n - i >= 16; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                // v <= 0x1F unsigned, masked off when controls are not wanted
+                __m128i low = _mm_andnot_si128(none, _mm_cmpeq_epi8(_mm_max_epu8(v, ctl), ctl));
+                __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)), low);
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+                if (mask)
+                    return i + static_cast<size_t>(lowestBit(mask));
+            }
+            return findSpecialPortable(p, i, n, controls);
+        }
+
+        QUANTUM_TARGET_AVX2 size_t findSpecialAvx2(const uint8_t *p, size_t i, size_t n, bool controls)
+        {
+            const __m256i quote = _mm256_set1_epi8('"'), slash = _mm256_set1_epi8('\\');
+            const __m256i ctl = _mm256_set1_epi8(controls ? 0x1F : 0);
+            const __m256i none = _mm256_set1_epi8(controls ? 0 : -1);
+            for (; n - i >= 32; i += 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+                __m256i low = _mm256_andnot_si256(none, _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctl), ctl));
+                __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, slash)), low);
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+                if (mask)
+                    return i + static_cast<size_t>(lowestBit(mask));
+            }
+            // Not the SSE2 kernel: legacy SSE after dirty YMM state stalls.
+            return findSpecialPortable(p, i, n, controls);
+        }
+#endif
+
+        // Offset of the first special byte in [i, n), or n.
+        size_t findSpecial(const char *data, size_t i, size_t n, bool controls)
+        {
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+#ifdef QUANTUM_JSON_X86
+            switch (level())
+            {
+            case Avx2:
+                return findSpecialAvx2(p, i, n, controls);
+            case Sse2:
+                return findSpecialSse2(p, i, n, controls);
+            default:
+                break;
+            }
+#endif
+            return findSpecialPortable(p, i, n, controls);
+        }
+
+        bool isSpace(char c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        int hexValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        bool hex4(const char *p, unsigned &out)
+        {
+            out = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                int h = hexValue(p[i]);
+                if (h < 0)
+                    return false;
+                out = out << 4 | static_cast<unsigned>(h);
+            }
+            return true;
+        }
+
+        void appendUtf8(std::string &out, unsigned cp)
+        {
+            if (cp < 0x80)
+                out += static_cast<char>(cp);
+            else if (cp < 0x800)
+            {
+                out += static_cast<char>(0xC0 | cp >> 6);
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | cp >> 12);
+                out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | cp >> 18);
+                out += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+                out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        bool validNumber(const char *p, const char *end)
+        {
+            if (p < end && *p == '-')
+                p++;
+            if (p == end)
+                return false;
+            if (*p == '0')
+                p++;
+            else if (isDigit(*p))
+                while (p < end && isDigit(*p))
+                    p++;
+            else
+                return false;
+            if (p < end && *p == '.')
+            {
+                if (++p == end || !isDigit(*p))
+                    return false;
+                while (p < end && isDigit(*p))
+                    p++;
+            }
+            if (p < end && (*p == 'e' || *p == 'E'))
+            {
+                if (++p < end && (*p == '+' || *p == '-'))
+                    p++;
+                if (p == end || !isDigit(*p))
+                    return false;
+                while (p < end && isDigit(*p))
+                    p++;
+            }
+            return p == end;
+        }
+    }
+
+    const char *tokenName(Token t)
+    {
+        switch (t)
+        {
+        case Token::BeginObject: return "start_object";
+        case Token::EndObject: return "end_object";
+        case Token::BeginArray: return "start_array";
+        case Token::EndArray: return "end_array";
+        case Token::Key: return "key";
+        case Token::String: return "string";
+        case Token::Number: return "number";
+        case Token::True:
+        case Token::False: return "bool";
+        case Token::Null: return "null";
+        case Token::End: return "end";
+        case Token::Error: return "error";
+        }
+        return "error";
+    }
+
+    // ─── Reader ──────────────────────────────────────────────────────────────
+
+    Reader::Reader(std::string_view text) : data_(text.data()), size_(text.size()) {}
+
+    Reader::Reader(std::shared_ptr<MappedFile> file) : file_(std::move(file))
+    {
+        if (file_->isMapped())
+        {
+            data_ = file_->data();
+            size_ = file_->size();
+        }
+        else
+            eof_ = false;
+    }
+
+    // Stream mode only: drops what has been consumed and appends a chunk.
+    // Positions past pos_ keep their distance from it.
+    bool Reader::more()
+    {
+        if (eof_)
+            return false;
+        base_ += pos_;
+        buf_.erase(0, pos_);
+        pos_ = 0;
+        size_t have = buf_.size();
+        buf_.resize(have + kChunk);
+        size_t got = file_->readSome(&buf_[have], kChunk);
+        buf_.resize(have + got);
+        eof_ = got == 0;
+        data_ = buf_.data();
+        size_ = buf_.size();
+        return got > 0;
+    }
+
+    bool Reader::skipSpace()
+    {
+        for (;;)
+        {
+            while (pos_ < size_)
+            {
+                if (!isSpace(data_[pos_]))
+                    return true;
+                pos_++;
+            }
+            if (!more())
+                return false;
+        }
+    }
+
+    Token Reader::fail(const std::string &what)
+    {
+        if (error_.empty())
+            error_ = what + " at offset " + std::to_string(offset());
+        return Token::Error;
+    }
+
+    Token Reader::next()
+    {
+        if (!error_.empty())
+            return Token::Error;
+        switch (expect_)
+        {
+        case Expect::Done:
+            if (!skipSpace())
+                return Token::End;
+            if (!multiple_)
+                return fail("unexpected data after the value");
+            expect_ = Expect::Value;
+            return value();
+
+        case Expect::Value:
+            if (!skipSpace())
+                return stack_.empty() && (multiple_ || started_) ? Token::End : fail("unexpected end of input");
+            return value();
+
+        case Expect::ValueOrClose:
+            if (!skipSpace())
+                return fail("unexpected end of input");
+            if (data_[pos_] == ']')
+            {
+                pos_++;
+                stack_.pop_back();
+                return afterValue(Token::EndArray);
+            }
+            return value();
+
+        case Expect::KeyOrClose:
+        case Expect::Key:
+            if (!skipSpace())
+                return fail("unexpected end of input");
+            if (data_[pos_] == '}' && expect_ == Expect::KeyOrClose)
+            {
+                pos_++;
+                stack_.pop_back();
+                return afterValue(Token::EndObject);
+            }
+            if (data_[pos_] != '"')
+                return fail("expected a string key");
+            if (!string())
+                return Token::Error;
+            expect_ = Expect::Colon; // read later: text_ may point into buf_
+            return Token::Key;
+
+        case Expect::Colon:
+            if (!skipSpace() || data_[pos_] != ':')
+                return fail("expected ':'");
+            pos_++;
+            expect_ = Expect::Value;
+            return next();
+
+        case Expect::CommaOrClose:
+        {
+            if (!skipSpace())
+                return fail("unexpected end of input");
+            char c = data_[pos_];
+            char close = stack_.back() == '[' ? ']' : '}';
+            if (c == close)
+            {
+                pos_++;
+                stack_.pop_back();
+                return afterValue(close == ']' ? Token::EndArray : Token::EndObject);
+            }
+            if (c != ',')
+                return fail(std::string("expected ',' or '") + close + "'");
+            pos_++;
+            expect_ = close == ']' ? Expect::Value : Expect::Key;
+            return next();
+        }
+        }
+        return fail("internal error");
+    }
+
+    Token Reader::value()
+    {
+        char c = data_[pos_];
+        switch (c)
+        {
+        case '{':
+            pos_++;
+            stack_.push_back('{');
+            expect_ = Expect::KeyOrClose;
+            return Token::BeginObject;
+        case '[':
+            pos_++;
+            stack_.push_back('[');
+            expect_ = Expect::ValueOrClose;
+            return Token::BeginArray;
+        case '"':
+            return string() ? afterValue(Token::String) : Token::Error;
+        case 't':
+            return literal("true") ? afterValue(Token::True) : Token::Error;
+        case 'f':
+            return literal("false") ? afterValue(Token::False) : Token::Error;
+        case 'n':
+            return literal("null") ? afterValue(Token::Null) : Token::Error;
+        default:
+            if (c == '-' || isDigit(c))
+                return numberToken() ? afterValue(Token::Number) : Token::Error;
+            return fail(std::string("unexpected character '") + c + "'");
+        }
+    }
+
+    Token Reader::afterValue(Token t)
+    {
+        expect_ = stack_.empty() ? Expect::Done : Expect::CommaOrClose;
+        started_ = true;
+        return t;
+    }
+
+    // pos_ is on the opening quote.  The closing quote is found first, so a
+    // string split across stream chunks is only decoded once it is whole.
+    bool Reader::string()
+    {
+        size_t i = pos_ + 1;
+        bool escaped = false;
+        for (;;)
+        {
+            if (i < size_)
+                i = findSpecial(data_, i, size_, false);
+            if (i >= size_)
+            {
+                size_t rel = i - pos_;
+                if (!more())
+                {
+                    fail("unterminated string");
+                    return false;
+                }
+                i = pos_ + rel;
+                continue;
+            }
+            if (data_[i] == '"')
+                break;
+            escaped = true;
+            i += 2;
+        }
+
+        const char *p = data_ + pos_ + 1, *end = data_ + i;
+        pos_ = i + 1;
+        if (!escaped)
+        {
+            text_ = std::string_view(p, static_cast<size_t>(end - p));
+            return true;
+        }
+        scratch_.clear();
+        while (p < end)
+        {
+            const char *q = p;
+            while (q < end && *q != '\\')
+                q++;
+            scratch_.append(p, static_cast<size_t>(q - p));
+            if (q == end)
+                break;
+            char e = q[1];
+            p = q + 2;
+            switch (e)
+            {
+            case '"': scratch_ += '"'; break;
+            case '\\': scratch_ += '\\'; break;
+            case '/': scratch_ += '/'; break;
+            case 'b': scratch_ += '\b'; break;
+            case 'f': scratch_ += '\f'; break;
+            case 'n': scratch_ += '\n'; break;
+            case 'r': scratch_ += '\r'; break;
+            case 't': scratch_ += '\t'; break;
+            case 'u':
+            {
+                unsigned cp;
+                if (end - p < 4 || !hex4(p, cp))
+                {
+                    fail("invalid \\u escape");
+                    return false;
+                }
+                p += 4;
+                unsigned lo;
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    hex4(p + 2, lo) && lo >= 0xDC00 && lo < 0xE000)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    p += 6;
+                }
+                else if (cp >= 0xD800 && cp < 0xE000)
+                    cp = 0xFFFD; // lone surrogate
+                appendUtf8(scratch_, cp);
+                break;
+            }
+            default:
+                fail("invalid escape");
+                return false;
+            }
+        }
+        text_ = scratch_;
+        return true;
+    }
+
+    bool Reader::literal(std::string_view word)
+    {
+        while (size_ - pos_ < word.size() && more())
+        {
+        }
+        if (size_ - pos_ < word.size() || std::memcmp(data_ + pos_, word.data(), word.size()) != 0)
+        {
+            fail("invalid literal");
+            return false;
+        }
+        pos_ += word.size();
+        return true;
+    }
+
+    bool Reader::numberToken()
+    {
+        auto numberChar = [](char c)
+        { return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; };
+        size_t i = pos_;
+        for (;;)
+        {
+            while (i < size_ && numberChar(data_[i]))
+                i++;
+            if (i < size_)
+                break;
+            size_t rel = i - pos_;
+            if (!more())
+                break;
+            i = pos_ + rel;
+        }
+        const char *p = data_ + pos_, *end = data_ + i;
+        if (!validNumber(p, end))
+        {
+            fail("invalid number");
+            return false;
+        }
+        auto r = std::from_chars(p, end, number_);
+        if (r.ec == std::errc::result_out_of_range)
+            number_ = std::strtod(std::string(p, end).c_str(), nullptr); // ±inf or 0, as strtod rounds
+        text_ = std::string_view(p, static_cast<size_t>(end - p));
+        pos_ = i;
+        return true;
+    }
+
+    bool Reader::skip()
+    {
+        size_t target = stack_.size();
+        if (target == 0 || expect_ != (stack_.back() == '[' ? Expect::ValueOrClose : Expect::KeyOrClose))
+            return error_.empty();
+        target--;
+        while (stack_.size() > target)
+        {
+            Token t = next();
+            if (t == Token::Error || t == Token::End)
+                return false;
+        }
+        return true;
+    }
+
+    // ─── Writing ─────────────────────────────────────────────────────────────
+
+    void appendString(std::string &out, std::string_view s)
+    {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        size_t i = 0, n = s.size();
+        while (i < n)
+        {
+            size_t j = findSpecial(s.data(), i, n, true);
+            out.append(s.data() + i, j - i);
+            if (j == n)
+                break;
+            char c = s[j];
+            switch (c)
+            {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += hex[static_cast<uint8_t>(c) >> 4];
+                out += hex[c & 0xF];
+                break;
+            }
+            i = j + 1;
+        }
+        out += '"';
+    }
+
+    void appendNumber(std::string &out, double v)
+    {
+        if (!std::isfinite(v))
+            out += "null";
+        else
+            number::append(out, v);
+    }
+
+    const char *backend()
+    {
+        switch (level())
+        {
+        case Avx2: return "avx2";
+        case Sse2: return "sse2";
+        default: return "portable";
+        }
+    }
+
+    // ─── Path ────────────────────────────────────────────────────────────────
+
+    std::unique_ptr<Path> Path::compile(std::string_view expr, std::string &error)
+    {
+        auto path = std::unique_ptr<Path>(new Path());
+        size_t i = 0;
+        auto bad = [&](const std::string &what)
+        {
+            error = what + " at position " + std::to_string(i) + " in '" + std::string(expr) + "'";
+            return nullptr;
+        };
+        if (expr.empty() || expr[0] != '$')
+            return bad("path must start with '$'");
+        i = 1;
+        while (i < expr.size())
+        {
+            Step s{Step::Any, false, {}, 0};
+            if (expr.compare(i, 2, "..") == 0)
+            {
+                s.deep = true;
+                i += 2;
+                if (i < expr.size() && expr[i] == '[')
+                    ; // ..[...] reads the bracket below
+                else if (i < expr.size() && expr[i] == '*')
+                {
+                    i++;
+                    path->steps_.push_back(s);
+                    continue;
+                }
+                else
+                {
+                    size_t j = i;
+                    while (j < expr.size() && expr[j] != '.' && expr[j] != '[')
+                        j++;
+                    if (j == i)
+                        return bad("expected a name");
+                    s.kind = Step::Name;
+                    s.name = std::string(expr.substr(i, j - i));
+                    i = j;
+                    path->steps_.push_back(s);
+                    continue;
+                }
+            }
+            else if (expr[i] == '.')
+            {
+                i++;
+                if (i < expr.size() && expr[i] == '*')
+                {
+                    i++;
+                    path->steps_.push_back(s);
+                    continue;
+                }
+                size_t j = i;
+                while (j < expr.size() && expr[j] != '.' && expr[j] != '[')
+                    j++;
+                if (j == i)
+                    return bad("expected a name");
+                s.kind = Step::Name;
+                s.name = std::string(expr.substr(i, j - i));
+                i = j;
+                path->steps_.push_back(s);
+                continue;
+            }
+            if (i >= expr.size() || expr[i] != '[')
+                return bad("expected '.' or '['");
+            i++;
+            if (i < expr.size() && expr[i] == '*')
+                i++;
+            else if (i < expr.size() && (expr[i] == '\'' || expr[i] == '"'))
+            {
+                char q = expr[i++];
+                size_t j = expr.find(q, i);
+                if (j == std::string_view::npos)
+                    return bad("unterminated name");
+                s.kind = Step::Name;
+                s.name = std::string(expr.substr(i, j - i));
+                i = j + 1;
+            }
+            else
+            {
+                size_t j = i;
+                while (j < expr.size() && isDigit(expr[j]))
+                    j++;
+                if (j == i)
+                    return bad("expected an index, a quoted name or '*'");
+                s.kind = Step::Index;
+                s.index = std::strtoull(std::string(expr.substr(i, j - i)).c_str(), nullptr, 10);
+                i = j;
+            }
+            if (i >= expr.size() || expr[i] != ']')
+                return bad("expected ']'");
+            i++;
+            path->steps_.push_back(s);
+        }
+        if (path->steps_.size() > 62)
+            return bad("too many steps");
+        return path;
+    }
+
+    template <typename Eq>
+    uint64_t Path::advance(uint64_t states, Eq eq) const
+    {
+        uint64_t out = 0;
+        for (size_t i = 0; i < steps_.size(); i++)
+        {
+            if (!(states >> i & 1))
+                continue;
+            const Step &s = steps_[i];
+            if (s.deep)
+                out |= uint64_t(1) << i;
+            if (s.kind == Step::Any || eq(s))
+                out |= uint64_t(1) << (i + 1);
+        }
+        return out;
+    }
+
+    uint64_t Path::step(uint64_t states, std::string_view key) const
+    {
+        return advance(states, [key](const Step &s)
+                       { return s.kind == Step::Name && s.name == key; });
+    }
+
+    uint64_t Path::step(uint64_t states, size_t index) const
+    {
+        return advance(states, [index](const Step &s)
+                       { return s.kind == Step::Index && s.index == index; });
+    }
+}
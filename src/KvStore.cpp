@@ -0,0 +1,437 @@
+#include "KvStore.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#define QFSYNC(f) _commit(_fileno(f))
+#define QFSEEK _fseeki64
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#define QFSYNC(f) fsync(fileno(f))
+#define QFSEEK fseeko
+#endif
+
+// ─── Log format ───────────────────────────────────────────────────────────────
+// "QKVS", version byte, then records:
+//   crc32 (u32) | type (u8) | key length (u32) | value length (u32) | key | value
+// Integers are little-endian; the CRC covers everything after itself.  A
+// delete record has no value.
+
+namespace kv
+{
+    namespace
+    {
+        constexpr char kMagic[4] = {'Q', 'K', 'V', 'S'};
+        constexpr uint8_t kVersion = 1;
+        constexpr size_t kRecordHeader = 13;
+        constexpr uint32_t kMaxLength = 0x7FFFFFFF;
+        constexpr int64_t kSyncIntervalMs = 1000;
+
+        enum Type : uint8_t
+        {
+            Put = 1,
+            Delete = 2
+        };
+
+        struct CrcTable
+        {
+            uint32_t t[256];
+            CrcTable()
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; k++)
+                        c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[i] = c;
+                }
+            }
+        };
+
+        uint32_t crc32(const char *data, size_t n, uint32_t crc = 0)
+        {
+            static const CrcTable table;
+            crc = ~crc;
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+            for (size_t i = 0; i < n; i++)
+                crc = table.t[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        uint32_t readU32(const char *p)
+        {
+            const uint8_t *b = reinterpret_cast<const uint8_t *>(p);
+            return uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+        }
+
+        void putU32(std::string &out, uint32_t v)
+        {
+            for (int i = 0; i < 4; i++)
+                out += static_cast<char>(v >> (8 * i));
+        }
+
+        int64_t nowMs()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        // Encodes one record into out (replacing its contents).
+        void encode(std::string &out, uint8_t type, std::string_view key, std::string_view value)
+        {
+            out.clear();
+            out.reserve(kRecordHeader + key.size() + value.size());
+            out.append(4, '\0');
+            out += static_cast<char>(type);
+            putU32(out, static_cast<uint32_t>(key.size()));
+            putU32(out, static_cast<uint32_t>(value.size()));
+            out.append(key.data(), key.size());
+            out.append(value.data(), value.size());
+            uint32_t crc = crc32(out.data() + 4, out.size() - 4);
+            for (int i = 0; i < 4; i++)
+                out[i] = static_cast<char>(crc >> (8 * i));
+        }
+
+        // Makes a rename or new file durable by syncing its directory.
+        void syncDirectory(const std::string &path)
+        {
+#ifndef _WIN32
+            std::string dir = std::filesystem::path(path).parent_path().string();
+            int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+            if (fd >= 0)
+            {
+                fsync(fd);
+                ::close(fd);
+            }
+#else
+            (void)path;
+#endif
+        }
+    }
+
+    // ─── Opening ─────────────────────────────────────────────────────────────
+
+    std::unique_ptr<Store> Store::open(const std::string &path, Sync sync)
+    {
+        std::unique_ptr<Store> s(new Store());
+        s->path_ = path;
+        s->sync_ = sync;
+        if (!s->replay())
+            return nullptr;
+        s->file_ = std::fopen(path.c_str(), "ab");
+        if (!s->file_)
+            return nullptr;
+        s->lastSync_ = nowMs();
+        return s;
+    }
+
+    Store::~Store()
+    {
+        close();
+    }
+
+    // Rebuilds the index from the log.  The log is cut back to the end of the
+    // last record whose length and checksum are sound: anything after that
+    // is a write the previous run did not finish.
+    bool Store::replay()
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(path_, ec) || std::filesystem::file_size(path_, ec) == 0)
+        {
+            std::FILE *f = std::fopen(path_.c_str(), "wb");
+            if (!f)
+                return false;
+            bool ok = std::fwrite(kMagic, 1, sizeof kMagic, f) == sizeof kMagic && std::fputc(kVersion, f) != EOF &&
+                      std::fflush(f) == 0 && QFSYNC(f) == 0;
+            ok = std::fclose(f) == 0 && ok;
+            syncDirectory(path_);
+            end_ = kHeaderSize;
+            return ok;
+        }
+
+        map_ = MappedFile::open(path_);
+        if (!map_)
+            return false;
+        map_->spool();
+        const char *data = map_->data();
+        size_t size = map_->size();
+        if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof kMagic) != 0 || data[4] != kVersion)
+        {
+            map_.reset();
+            return false;
+        }
+
+        size_t pos = kHeaderSize;
+        while (size - pos >= kRecordHeader)
+        {
+            const char *r = data + pos;
+            uint8_t type = static_cast<uint8_t>(r[4]);
+            uint64_t keyLen = readU32(r + 5), valLen = readU32(r + 9);
+            uint64_t total = kRecordHeader + keyLen + valLen;
+            if ((type != Put && type != Delete) || total > size - pos ||
+                crc32(r + 4, static_cast<size_t>(total - 4)) != readU32(r))
+                break;
+
+            std::string key(r + kRecordHeader, static_cast<size_t>(keyLen));
+            auto it = index_.find(key);
+            if (it != index_.end())
+            {
+                dead_ += it->second.record;
+                if (type == Delete)
+                    index_.erase(it);
+            }
+            if (type == Put)
+            {
+                Entry &e = index_[std::move(key)];
+                e.offset = pos + kRecordHeader + keyLen;
+                e.size = static_cast<uint32_t>(valLen);
+                e.record = static_cast<uint32_t>(total);
+                if (valLen <= kInlineMax)
+                    e.value.assign(data + e.offset, static_cast<size_t>(valLen));
+                else
+                    e.value.clear();
+            }
+            else
+                dead_ += total;
+            pos += static_cast<size_t>(total);
+        }
+
+        end_ = pos;
+        if (pos < size)
+        {
+            map_.reset(); // Windows will not resize a mapped file
+            std::filesystem::resize_file(path_, pos, ec);
+            if (ec)
+                return false;
+        }
+        else if (!map_->isMapped())
+            map_.reset(); // a spooled copy is no use once the log grows
+        return true;
+    }
+
+    // ─── Reading ─────────────────────────────────────────────────────────────
+
+    const char *Store::mapped(uint64_t end)
+    {
+        if (!map_ || !map_->isMapped() || map_->size() < end)
+        {
+            if (file_ && std::fflush(file_) != 0)
+                return nullptr;
+            map_ = MappedFile::open(path_);
+            if (!map_ || !map_->isMapped() || map_->size() < end)
+            {
+                map_.reset();
+                return nullptr;
+            }
+        }
+        return map_->data();
+    }
+
+    bool Store::has(std::string_view key) const
+    {
+        return index_.find(std::string(key)) != index_.end();
+    }
+
+    bool Store::get(std::string_view key, std::string &value)
+    {
+        auto it = index_.find(std::string(key));
+        if (it == index_.end())
+            return false;
+        const Entry &e = it->second;
+        if (e.size <= kInlineMax)
+        {
+            value = e.value;
+            return true;
+        }
+        const char *data = mapped(e.offset + e.size);
+        if (!data)
+        {
+            // No mapping to be had: read the value through a stream instead.
+            std::FILE *f = std::fopen(path_.c_str(), "rb");
+            value.resize(e.size);
+            bool ok = f && QFSEEK(f, static_cast<int64_t>(e.offset), SEEK_SET) == 0 &&
+                      std::fread(&value[0], 1, e.size, f) == e.size;
+            if (f)
+                std::fclose(f);
+            return ok;
+        }
+        value.assign(data + e.offset, e.size);
+        return true;
+    }
+
+    std::vector<std::string> Store::keys() const
+    {
+        std::vector<std::string> out;
+        out.reserve(index_.size());
+        for (const auto &[key, e] : index_)
+            out.push_back(key);
+        return out;
+    }
+
+    // ─── Writing ─────────────────────────────────────────────────────────────
+
+    bool Store::append(uint8_t type, std::string_view key, std::string_view value)
+    {
+        if (!file_ || key.size() > kMaxLength || value.size() > kMaxLength - key.size())
+            return false;
+        encode(record_, type, key, value);
+        if (std::fwrite(record_.data(), 1, record_.size(), file_) != record_.size())
+            return false;
+        end_ += record_.size();
+        dirty_ = true;
+        return true;
+    }
+
+    bool Store::set(std::string_view key, std::string_view value)
+    {
+        uint64_t at = end_;
+        if (!append(Put, key, value))
+            return false;
+        auto [it, fresh] = index_.try_emplace(std::string(key));
+        Entry &e = it->second;
+        if (!fresh)
+            dead_ += e.record;
+        e.offset = at + kRecordHeader + key.size();
+        e.size = static_cast<uint32_t>(value.size());
+        e.record = static_cast<uint32_t>(record_.size());
+        if (value.size() <= kInlineMax)
+            e.value.assign(value.data(), value.size());
+        else
+            e.value.clear();
+        return afterWrite();
+    }
+
+    bool Store::erase(std::string_view key)
+    {
+        auto it = index_.find(std::string(key));
+        if (it == index_.end())
+            return true;
+        if (!append(Delete, key, {}))
+            return false;
+        dead_ += it->second.record + record_.size();
+        index_.erase(it);
+        return afterWrite();
+    }
+
+    bool Store::afterWrite()
+    {
+        if (sync_ == Sync::Always)
+        {
+            if (!sync())
+                return false;
+        }
+        else if (sync_ == Sync::Interval)
+        {
+            if (std::fflush(file_) != 0)
+                return false;
+            if (nowMs() - lastSync_ >= kSyncIntervalMs && !sync())
+                return false;
+        }
+        if (end_ > kCompactMin && dead_ > liveBytes())
+            return compact();
+        return true;
+    }
+
+    bool Store::sync()
+    {
+        if (!file_)
+            return false;
+        if (std::fflush(file_) != 0 || QFSYNC(file_) != 0)
+            return false;
+        dirty_ = false;
+        lastSync_ = nowMs();
+        return true;
+    }
+
+    bool Store::flush()
+    {
+        return !dirty_ || sync();
+    }
+
+    // ─── Compaction ──────────────────────────────────────────────────────────
+
+    // The live records go to path.compact, which is synced before it is
+    // renamed over the log: a crash at any point leaves either the old log
+    // or the new one, both complete.
+    bool Store::compact()
+    {
+        if (!file_)
+            return false;
+        if (std::fflush(file_) != 0)
+            return false;
+
+        std::string tmp = path_ + ".compact";
+        std::FILE *out = std::fopen(tmp.c_str(), "wb");
+        if (!out)
+            return false;
+        bool ok = std::fwrite(kMagic, 1, sizeof kMagic, out) == sizeof kMagic && std::fputc(kVersion, out) != EOF;
+        uint64_t pos = kHeaderSize;
+        std::unordered_map<std::string, Entry> moved;
+        moved.reserve(index_.size());
+        std::string value;
+        for (const auto &[key, e] : index_)
+        {
+            if (!ok)
+                break;
+            std::string_view v;
+            if (e.size <= kInlineMax)
+                v = e.value;
+            else
+            {
+                ok = get(key, value);
+                v = value;
+            }
+            encode(record_, Put, key, v);
+            ok = ok && std::fwrite(record_.data(), 1, record_.size(), out) == record_.size();
+            Entry &n = moved[key];
+            n.offset = pos + kRecordHeader + key.size();
+            n.size = e.size;
+            n.record = e.record;
+            n.value = e.value;
+            pos += record_.size();
+        }
+        ok = ok && std::fflush(out) == 0 && QFSYNC(out) == 0;
+        ok = std::fclose(out) == 0 && ok;
+
+        std::error_code ec;
+        if (ok)
+        {
+            map_.reset();
+            std::fclose(file_);
+            file_ = nullptr;
+            std::filesystem::rename(tmp, path_, ec);
+            ok = !ec;
+        }
+        if (!ok)
+        {
+            std::filesystem::remove(tmp, ec);
+            if (!file_)
+                file_ = std::fopen(path_.c_str(), "ab");
+            return false;
+        }
+        syncDirectory(path_);
+        file_ = std::fopen(path_.c_str(), "ab");
+        index_ = std::move(moved);
+        end_ = pos;
+        dead_ = 0;
+        dirty_ = false;
+        lastSync_ = nowMs();
+        return file_ != nullptr;
+    }
+
+    bool Store::close()
+    {
+        if (!file_)
+            return true;
+        bool ok = flush();
+        ok = std::fclose(file_) == 0 && ok;
+        file_ = nullptr;
+        map_.reset();
+        return ok;
+    }
+}
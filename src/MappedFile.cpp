@@ -0,0 +1,200 @@
+#include "MappedFile.h"
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr size_t kStreamChunk = 64 * 1024;
+}
+
+// ─── MappedFile ───────────────────────────────────────────────────────────────
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path)
+{
+    std::shared_ptr<MappedFile> mf(new MappedFile());
+
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+        return nullptr;
+    // CreateFileMapping refuses zero-length files; they are read as a stream.
+    LARGE_INTEGER sz{};
+    if (GetFileType(h) == FILE_TYPE_DISK && GetFileSizeEx(h, &sz) && sz.QuadPart > 0)
+    {
+        HANDLE m = CreateFileMappingA(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m)
+        {
+            void *p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+            if (p)
+            {
+                mf->fileHandle_ = h;
+                mf->mapHandle_ = m;
+                mf->data_ = static_cast<const char *>(p);
+                mf->size_ = static_cast<size_t>(sz.QuadPart);
+                mf->mapped_ = true;
+                return mf;
+            }
+            CloseHandle(m);
+        }
+    }
+    CloseHandle(h);
+    mf->stream_ = std::fopen(path.c_str(), "rb");
+    if (!mf->stream_)
+        return nullptr;
+    return mf;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st{};
+    // procfs and sysfs files report a size of 0 but still have contents.
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            ::close(fd); // the mapping outlives the descriptor
+            mf->data_ = static_cast<const char *>(p);
+            mf->size_ = static_cast<size_t>(st.st_size);
+            mf->mapped_ = true;
+            return mf;
+        }
+    }
+    mf->stream_ = fdopen(fd, "rb");
+    if (!mf->stream_)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    return mf;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (mapped_ && data_)
+        UnmapViewOfFile(data_);
+    if (mapHandle_)
+        CloseHandle(mapHandle_);
+    if (fileHandle_)
+        CloseHandle(fileHandle_);
+#else
+    if (mapped_ && data_)
+        munmap(const_cast<char *>(data_), size_);
+#endif
+    if (stream_)
+        std::fclose(stream_);
+}
+
+size_t MappedFile::readSome(char *dst, size_t n)
+{
+    if (!stream_)
+        return 0;
+    return std::fread(dst, 1, n, stream_);
+}
+
+void MappedFile::spool()
+{
+    if (!stream_)
+        return;
+    size_t n;
+    do
+    {
+        size_t old = spooled_.size();
+        spooled_.resize(old + kStreamChunk);
+        n = std::fread(&spooled_[old], 1, kStreamChunk, stream_);
+        spooled_.resize(old + n);
+    } while (n > 0);
+    data_ = spooled_.data();
+    size_ = spooled_.size();
+}
+
+void MappedFile::adviseSequential() const
+{
+#ifndef _WIN32
+    if (mapped_ && data_)
+        posix_madvise(const_cast<char *>(data_), size_, POSIX_MADV_SEQUENTIAL);
+#endif
+}
+
+// ─── LineReader ───────────────────────────────────────────────────────────────
+
+LineReader::LineReader(std::shared_ptr<MappedFile> file) : file_(std::move(file))
+{
+    file_->adviseSequential();
+}
+
+bool LineReader::next(std::string_view &line)
+{
+    if (file_->isMapped())
+    {
+        size_t size = file_->size();
+        if (pos_ >= size)
+            return false;
+        const char *base = file_->data() + pos_;
+        const char *nl = static_cast<const char *>(std::memchr(base, '\n', size - pos_));
+        size_t len = nl ? static_cast<size_t>(nl - base) : size - pos_;
+        pos_ += len + (nl ? 1 : 0);
+        if (len && base[len - 1] == '\r')
+            --len;
+        line = std::string_view(base, len);
+        ++lineNo_;
+        return true;
+    }
+
+    // Stream mode: buf_[pos_..] is unconsumed input.
+    size_t scan = pos_;
+    for (;;)
+    {
+        size_t nl = buf_.find('\n', scan);
+        if (nl != std::string::npos)
+        {
+            size_t len = nl - pos_;
+            if (len && buf_[nl - 1] == '\r')
+                --len;
+            line = std::string_view(buf_.data() + pos_, len);
+            pos_ = nl + 1;
+            ++lineNo_;
+            return true;
+        }
+        if (eof_)
+        {
+            if (pos_ >= buf_.size())
+                return false;
+            size_t len = buf_.size() - pos_;
+            if (buf_.back() == '\r')
+                --len;
+            line = std::string_view(buf_.data() + pos_, len);
+            pos_ = buf_.size();
+            ++lineNo_;
+            return true;
+        }
+        if (pos_ > 0)
+        {
+            buf_.erase(0, pos_);
+            pos_ = 0;
+        }
+        scan = buf_.size();
+        buf_.resize(scan + kStreamChunk);
+        size_t n = file_->readSome(&buf_[scan], kStreamChunk);
+        buf_.resize(scan + n);
+        if (n == 0)
+            eof_ = true;
+    }
+}
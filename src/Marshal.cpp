@@ -0,0 +1,375 @@
+#include "Marshal.h"
+#include "Error.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+namespace marshal
+{
+    namespace
+    {
+        constexpr char kMagic[4] = {'Q', 'M', 'S', 'H'};
+        constexpr uint8_t kVersion = 1;
+
+        enum Tag : uint8_t
+        {
+            Nil,
+            False,
+            True,
+            Int,    // zigzag varint
+            Double, // 8 bytes, little-endian
+            String, // string reference, see Writer::string
+            Bytes,  // varint length, raw bytes
+            List,   // varint count, values
+            Map,    // varint count, (string reference, value) pairs
+            Object, // string reference (class name), then as Map
+            Ref,    // varint index of an earlier Shared value
+            Shared = 0x80 // on Bytes, List, Map, Object: Ref may name this one
+        };
+
+        // Largest magnitude below which every whole double is exact.
+        constexpr double kExactInt = 9007199254740992.0; // 2^53
+
+        class Writer
+        {
+        public:
+            explicit Writer(std::vector<uint8_t> &out) : out_(out) {}
+
+            void value(const QuantumValue &v, size_t depth)
+            {
+                if (depth > kMaxDepth)
+                    throw RuntimeError("marshal.dumps(): nesting deeper than " + std::to_string(kMaxDepth) +
+                                       " levels");
+                if (v.isNil())
+                    out_.push_back(Nil);
+                else if (v.isBool())
+                    out_.push_back(v.asBool() ? True : False);
+                else if (v.isNumber())
+                    number(v.asNumber());
+                else if (v.isString())
+                {
+                    out_.push_back(String);
+                    string(v.asString());
+                }
+                else if (v.isBytes())
+                {
+                    if (seen(sharedObject<QuantumBytes>(v), Bytes))
+                        return;
+                    std::string_view b = v.asBytes()->view();
+                    varint(b.size());
+                    out_.insert(out_.end(), b.begin(), b.end());
+                }
+                else if (v.isArray())
+                {
+                    if (seen(sharedObject<Array>(v), List))
+                        return;
+                    const Array &arr = *v.asArray();
+                    varint(arr.size());
+                    for (const auto &item : arr)
+                        value(item, depth + 1);
+                }
+                else if (v.isDict())
+                {
+                    if (seen(sharedObject<Dict>(v), Map))
+                        return;
+                    fields(*v.asDict(), depth);
+                }
+                else if (v.isInstance())
+                {
+                    if (seen(sharedObject<QuantumInstance>(v), Object))
+                        return;
+                    const QuantumInstance &inst = *v.asInstance();
+                    string(inst.klass->name);
+                    fields(inst.fields, depth);
+                }
+                else
+                    throw RuntimeError("marshal.dumps(): cannot encode a value of type " + v.typeName());
+            }
+
+        private:
+            void varint(uint64_t n)
+            {
+                while (n >= 0x80)
+                {
+                    out_.push_back(static_cast<uint8_t>(n | 0x80));
+                    n >>= 7;
+                }
+                out_.push_back(static_cast<uint8_t>(n));
+            }
+
+            void number(double d)
+            {
+                // -0.0 and NaN payloads only survive as raw doubles.
+                if (d == std::trunc(d) && std::fabs(d) < kExactInt && !(d == 0 && std::signbit(d)))
+                {
+                    int64_t i = static_cast<int64_t>(d);
+                    out_.push_back(Int);
+                    varint((static_cast<uint64_t>(i) << 1) ^ static_cast<uint64_t>(i >> 63));
+                    return;
+                }
+                uint64_t bits;
+                std::memcpy(&bits, &d, 8);
+                out_.push_back(Double);
+                for (int i = 0; i < 8; i++)
+                    out_.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+            }
+
+            // One varint: a new string is 2 * length followed by its bytes,
+            // a repeat is 2 * index + 1.
+            void string(const std::string &s)
+            {
+                auto [it, fresh] = strings_.emplace(std::string_view(s), static_cast<uint32_t>(strings_.size()));
+                if (!fresh)
+                {
+                    varint(uint64_t(it->second) << 1 | 1);
+                    return;
+                }
+                varint(uint64_t(s.size()) << 1);
+                out_.insert(out_.end(), s.begin(), s.end());
+            }
+
+            void fields(const std::unordered_map<std::string, QuantumValue> &map, size_t depth)
+            {
+                varint(map.size());
+                for (const auto &[key, item] : map)
+                {
+                    string(key);
+                    value(item, depth + 1);
+                }
+            }
+
+            // The object v holds when something besides its container owns
+            // it too, else nullptr: an object with a single owner cannot be
+            // met twice, so it needs no number.
+            template <typename T>
+            static const void *sharedObject(const QuantumValue &v)
+            {
+                const auto &ptr = std::get<std::shared_ptr<T>>(v.data);
+                return ptr.use_count() > 1 ? ptr.get() : nullptr;
+            }
+
+            // Writes a Ref and returns true when p was written before;
+            // otherwise writes tag, numbering p for later Refs when set.
+            bool seen(const void *p, Tag tag)
+            {
+                if (!p)
+                {
+                    out_.push_back(tag);
+                    return false;
+                }
+                auto [it, fresh] = objects_.emplace(p, static_cast<uint32_t>(objects_.size()));
+                if (fresh)
+                {
+                    out_.push_back(tag | Shared);
+                    return false;
+                }
+                out_.push_back(Ref);
+                varint(it->second);
+                return true;
+            }
+
+            std::vector<uint8_t> &out_;
+            // Views into the strings being written, which outlive the Writer.
+            std::unordered_map<std::string_view, uint32_t> strings_;
+            std::unordered_map<const void *, uint32_t> objects_;
+        };
+
+        class Reader
+        {
+        public:
+            Reader(std::string_view data, const std::shared_ptr<Environment> &globals)
+                : p_(reinterpret_cast<const uint8_t *>(data.data())), end_(p_ + data.size()), globals_(globals) {}
+
+            void header()
+            {
+                if (static_cast<size_t>(end_ - p_) < sizeof kMagic + 1 || std::memcmp(p_, kMagic, sizeof kMagic) != 0)
+                    fail("not marshal data");
+                if (p_[sizeof kMagic] != kVersion)
+                    fail("unsupported format version " + std::to_string(p_[sizeof kMagic]));
+                p_ += sizeof kMagic + 1;
+            }
+
+            bool done() const { return p_ == end_; }
+
+            QuantumValue value(size_t depth)
+            {
+                if (depth > kMaxDepth)
+                    fail("nesting deeper than " + std::to_string(kMaxDepth) + " levels");
+                uint8_t tag = byte();
+                bool shared = tag & Shared;
+                switch (tag & ~Shared)
+                {
+                case Nil:
+                    return QuantumValue();
+                case False:
+                    return QuantumValue(false);
+                case True:
+                    return QuantumValue(true);
+                case Int:
+                {
+                    uint64_t z = varint();
+                    return QuantumValue(static_cast<double>(static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1)));
+                }
+                case Double:
+                {
+                    need(8);
+                    uint64_t bits = 0;
+                    for (int i = 0; i < 8; i++)
+                        bits |= uint64_t(p_[i]) << (8 * i);
+                    p_ += 8;
+                    double d;
+                    std::memcpy(&d, &bits, 8);
+                    return QuantumValue(d);
+                }
+                case String:
+                    return QuantumValue(string());
+                case Bytes:
+                {
+                    size_t n = count(1);
+                    auto b = std::make_shared<QuantumBytes>(std::vector<uint8_t>(p_, p_ + n));
+                    p_ += n;
+                    if (shared)
+                        objects_.emplace_back(b);
+                    return QuantumValue(b);
+                }
+                case List:
+                {
+                    size_t n = count(1);
+                    auto arr = std::make_shared<Array>();
+                    arr->reserve(n);
+                    if (shared)
+                        objects_.emplace_back(arr); // before the items, which may refer back to it
+                    for (size_t i = 0; i < n; i++)
+                        arr->push_back(value(depth + 1));
+                    return QuantumValue(arr);
+                }
+                case Map:
+                {
+                    auto dict = std::make_shared<Dict>();
+                    if (shared)
+                        objects_.emplace_back(dict);
+                    fields(*dict, depth);
+                    return QuantumValue(dict);
+                }
+                case Object:
+                {
+                    std::string name = string();
+                    QuantumValue klass = globals_ && globals_->has(name) ? globals_->get(name) : QuantumValue();
+                    if (!klass.isClass())
+                        fail("class '" + name + "' is not defined");
+                    auto inst = std::make_shared<QuantumInstance>();
+                    inst->klass = klass.asClass();
+                    inst->env = std::make_shared<Environment>(globals_);
+                    if (shared)
+                        objects_.emplace_back(inst);
+                    fields(inst->fields, depth);
+                    return QuantumValue(inst);
+                }
+                case Ref:
+                {
+                    uint64_t i = varint();
+                    if (i >= objects_.size())
+                        fail("reference to an object not yet read");
+                    return objects_[i];
+                }
+                default:
+                    fail("unknown tag " + std::to_string(tag));
+                }
+                return QuantumValue();
+            }
+
+        private:
+            [[noreturn]] void fail(const std::string &what)
+            {
+                throw RuntimeError("marshal.loads(): " + what);
+            }
+
+            void need(size_t n)
+            {
+                if (static_cast<size_t>(end_ - p_) < n)
+                    fail("truncated data");
+            }
+
+            uint8_t byte()
+            {
+                need(1);
+                return *p_++;
+            }
+
+            uint64_t varint()
+            {
+                uint64_t n = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    uint8_t b = byte();
+                    n |= uint64_t(b & 0x7F) << shift;
+                    if (!(b & 0x80))
+                        return n;
+                }
+                fail("malformed varint");
+            }
+
+            // An element count, checked against what is left so corrupt
+            // input cannot ask for a huge allocation.
+            size_t count(size_t minSize)
+            {
+                uint64_t n = varint();
+                if (n > static_cast<uint64_t>(end_ - p_) / minSize)
+                    fail("truncated data");
+                return static_cast<size_t>(n);
+            }
+
+            std::string string()
+            {
+                uint64_t ref = varint();
+                if (ref & 1)
+                {
+                    if ((ref >> 1) >= strings_.size())
+                        fail("reference to a string not yet read");
+                    return strings_[ref >> 1];
+                }
+                size_t n = static_cast<size_t>(ref >> 1);
+                need(n);
+                strings_.emplace_back(reinterpret_cast<const char *>(p_), n);
+                p_ += n;
+                return strings_.back();
+            }
+
+            void fields(std::unordered_map<std::string, QuantumValue> &map, size_t depth)
+            {
+                size_t n = count(2);
+                map.reserve(n);
+                for (size_t i = 0; i < n; i++)
+                {
+                    std::string key = string();
+                    map.insert_or_assign(std::move(key), value(depth + 1));
+                }
+            }
+
+            const uint8_t *p_;
+            const uint8_t *end_;
+            std::shared_ptr<Environment> globals_;
+            std::vector<std::string> strings_;
+            std::vector<QuantumValue> objects_;
+        };
+    }
+
+    void dump(std::vector<uint8_t> &out, const QuantumValue &v)
+    {
+        out.insert(out.end(), kMagic, kMagic + sizeof kMagic);
+        out.push_back(kVersion);
+        Writer(out).value(v, 0);
+    }
+
+    QuantumValue load(std::string_view data, const std::shared_ptr<Environment> &globals)
+    {
+        Reader r(data, globals);
+        r.header();
+        QuantumValue v = r.value(0);
+        if (!r.done())
+            throw RuntimeError("marshal.loads(): trailing data after the value");
+        return v;
+    }
+}
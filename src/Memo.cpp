@@ -0,0 +1,287 @@
+#include "Memo.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace memo
+{
+    namespace
+    {
+        inline size_t mix(size_t h, size_t v)
+        {
+            return h ^ (v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2));
+        }
+
+        // The object a reference-typed value points at; nullptr otherwise.
+        const void *identity(const QuantumValue &v)
+        {
+            return std::visit([](const auto &x) -> const void *
+                              {
+                using T = std::decay_t<decltype(x)>;
+                if constexpr (std::is_same_v<T, QuantumNil> || std::is_same_v<T, bool> ||
+                              std::is_same_v<T, double> || std::is_same_v<T, std::string>)
+                    return nullptr;
+                else
+                    return x.get(); },
+                              v.data);
+        }
+
+        size_t hashAt(const QuantumValue &v, int depth)
+        {
+            size_t h = v.data.index();
+            if (v.isNil())
+                return h;
+            if (v.isBool())
+                return mix(h, v.asBool());
+            if (v.isNumber())
+            {
+                double d = v.asNumber();
+                if (d == 0)
+                    d = 0; // -0 and 0 are one key
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof bits);
+                return mix(h, std::hash<uint64_t>()(bits));
+            }
+            if (v.isString())
+                return mix(h, std::hash<std::string_view>()(v.asString()));
+            if (v.isBytes())
+                return mix(h, std::hash<std::string_view>()(v.asBytes()->view()));
+            if (depth < kMaxDepth && v.isArray())
+            {
+                const Array &arr = *v.asArray();
+                h = mix(h, arr.size());
+                for (const auto &item : arr)
+                    h = mix(h, hashAt(item, depth + 1));
+                return h;
+            }
+            if (depth < kMaxDepth && v.isDict())
+            {
+                // Summed so that entry order does not matter.
+                size_t sum = 0;
+                for (const auto &[key, item] : *v.asDict())
+                    sum += mix(std::hash<std::string>()(key), hashAt(item, depth + 1));
+                return mix(mix(h, v.asDict()->size()), sum);
+            }
+            return mix(h, std::hash<const void *>()(identity(v)));
+        }
+
+        bool equalAt(const QuantumValue &a, const QuantumValue &b, int depth)
+        {
+            if (a.data.index() != b.data.index())
+                return false;
+            if (a.isNil())
+                return true;
+            if (a.isBool())
+                return a.asBool() == b.asBool();
+            if (a.isNumber())
+            {
+                double x = a.asNumber(), y = b.asNumber();
+                return x == y || (std::isnan(x) && std::isnan(y));
+            }
+            if (a.isString())
+                return a.asString() == b.asString();
+            if (a.isBytes())
+                return a.asBytes()->view() == b.asBytes()->view();
+            if (identity(a) == identity(b))
+                return true;
+            if (depth < kMaxDepth && a.isArray())
+            {
+                const Array &x = *a.asArray(), &y = *b.asArray();
+                if (x.size() != y.size())
+                    return false;
+                for (size_t i = 0; i < x.size(); i++)
+                    if (!equalAt(x[i], y[i], depth + 1))
+                        return false;
+                return true;
+            }
+            if (depth < kMaxDepth && a.isDict())
+            {
+                const Dict &x = *a.asDict(), &y = *b.asDict();
+                if (x.size() != y.size())
+                    return false;
+                for (const auto &[key, item] : x)
+                {
+                    auto it = y.find(key);
+                    if (it == y.end() || !equalAt(item, it->second, depth + 1))
+                        return false;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        // A copy of v that shares no array or dict with it.
+        QuantumValue freeze(const QuantumValue &v, int depth)
+        {
+            if (depth >= kMaxDepth)
+                return v;
+            if (v.isArray())
+            {
+                auto arr = std::make_shared<Array>();
+                arr->reserve(v.asArray()->size());
+                for (const auto &item : *v.asArray())
+                    arr->push_back(freeze(item, depth + 1));
+                return QuantumValue(arr);
+            }
+            if (v.isDict())
+            {
+                auto dict = std::make_shared<Dict>();
+                for (const auto &[key, item] : *v.asDict())
+                    (*dict)[key] = freeze(item, depth + 1);
+                return QuantumValue(dict);
+            }
+            return v;
+        }
+
+        // Rough heap footprint, for byte-bounded caches.
+        size_t footprint(const QuantumValue &v, int depth)
+        {
+            size_t n = sizeof(QuantumValue);
+            if (v.isString())
+                n += v.asString().size();
+            else if (v.isBytes())
+                n += v.asBytes()->size();
+            else if (depth < kMaxDepth && v.isArray())
+                for (const auto &item : *v.asArray())
+                    n += footprint(item, depth + 1);
+            else if (depth < kMaxDepth && v.isDict())
+                for (const auto &[key, item] : *v.asDict())
+                    n += 32 + key.size() + footprint(item, depth + 1);
+            return n;
+        }
+
+        double now()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    size_t hash(const QuantumValue &v)
+    {
+        return hashAt(v, 0);
+    }
+
+    bool equal(const QuantumValue &a, const QuantumValue &b)
+    {
+        return equalAt(a, b, 0);
+    }
+
+    Key::Key(std::vector<QuantumValue> vs) : values(std::move(vs))
+    {
+        hash = values.size();
+        for (const auto &v : values)
+            hash = mix(hash, hashAt(v, 0));
+    }
+
+    // ─── Cache ───────────────────────────────────────────────────────────────
+
+    Cache::Cache(size_t maxEntries, size_t maxBytes, double ttl)
+        : maxEntries_(maxEntries), maxBytes_(maxBytes), ttl_(ttl) {}
+
+    bool Cache::KeyEq::operator()(const Key *a, const Key *b) const
+    {
+        if (a->hash != b->hash || a->values.size() != b->values.size())
+            return false;
+        for (size_t i = 0; i < a->values.size(); i++)
+            if (!equalAt(a->values[i], b->values[i], 0))
+                return false;
+        return true;
+    }
+
+    Cache::Order::iterator Cache::find(const Key &key)
+    {
+        auto it = index_.find(&key);
+        if (it == index_.end())
+            return order_.end();
+        Order::iterator e = it->second;
+        if (e->expires != 0 && e->expires <= now())
+        {
+            remove(e);
+            return order_.end();
+        }
+        return e;
+    }
+
+    const QuantumValue *Cache::get(const Key &key)
+    {
+        auto e = find(key);
+        if (e == order_.end())
+        {
+            stats_.misses++;
+            return nullptr;
+        }
+        stats_.hits++;
+        order_.splice(order_.begin(), order_, e);
+        return &e->value;
+    }
+
+    const QuantumValue *Cache::peek(const Key &key)
+    {
+        auto e = find(key);
+        return e == order_.end() ? nullptr : &e->value;
+    }
+
+    void Cache::put(Key key, QuantumValue value)
+    {
+        auto old = index_.find(&key);
+        if (old != index_.end())
+            remove(old->second);
+
+        for (auto &v : key.values)
+            v = freeze(v, 0);
+        size_t bytes = sizeof(Entry) + footprint(value, 0);
+        for (const auto &v : key.values)
+            bytes += footprint(v, 0);
+        order_.push_front({std::move(key), std::move(value), bytes, ttl_ > 0 ? now() + ttl_ : 0});
+        index_.emplace(&order_.front().key, order_.begin());
+        bytes_ += bytes;
+
+        // The entry just added stays even when it alone exceeds maxBytes.
+        while (order_.size() > 1 && ((maxEntries_ && order_.size() > maxEntries_) || (maxBytes_ && bytes_ > maxBytes_)))
+        {
+            remove(std::prev(order_.end()));
+            stats_.evictions++;
+        }
+    }
+
+    bool Cache::erase(const Key &key)
+    {
+        auto e = find(key);
+        if (e == order_.end())
+            return false;
+        remove(e);
+        return true;
+    }
+
+    void Cache::clear()
+    {
+        index_.clear();
+        order_.clear();
+        bytes_ = 0;
+    }
+
+    void Cache::remove(Order::iterator it)
+    {
+        bytes_ -= it->bytes;
+        index_.erase(&it->key);
+        order_.erase(it);
+    }
+
+    void Cache::expire()
+    {
+        if (ttl_ <= 0)
+            return;
+        double t = now();
+        for (auto it = order_.begin(); it != order_.end();)
+        {
+            auto next = std::next(it);
+            if (it->expires <= t)
+                remove(it);
+            it = next;
+        }
+    }
+}
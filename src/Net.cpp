@@ -0,0 +1,798 @@
+#include "Net.h"
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socklen_t = int;
+#define QSOCK(h) static_cast<SOCKET>(h)
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define QSOCK(h) static_cast<int>(h)
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define QSEND_FLAGS MSG_NOSIGNAL
+#else
+#define QSEND_FLAGS 0
+#endif
+
+namespace
+{
+    int lastErrorCode()
+    {
+#ifdef _WIN32
+        return WSAGetLastError();
+#else
+        return errno;
+#endif
+    }
+
+    bool wouldBlock(int code)
+    {
+#ifdef _WIN32
+        return code == WSAEWOULDBLOCK;
+#else
+        return code == EAGAIN || code == EWOULDBLOCK;
+#endif
+    }
+
+    bool connectPending(int code)
+    {
+#ifdef _WIN32
+        return code == WSAEWOULDBLOCK || code == WSAEINPROGRESS;
+#else
+        return code == EINPROGRESS;
+#endif
+    }
+
+    bool setNonBlocking(net::Handle h)
+    {
+#ifdef _WIN32
+        u_long nb = 1;
+        return ioctlsocket(QSOCK(h), FIONBIO, &nb) == 0;
+#else
+        int flags = fcntl(QSOCK(h), F_GETFL);
+        fcntl(QSOCK(h), F_SETFD, FD_CLOEXEC);
+        return flags >= 0 && fcntl(QSOCK(h), F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    void setNoDelay(net::Handle h)
+    {
+        int one = 1;
+        setsockopt(QSOCK(h), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&one), sizeof(one));
+    }
+
+    net::Handle toHandle(
+#ifdef _WIN32
+        SOCKET s
+#else
+        int s
+#endif
+    )
+    {
+#ifdef _WIN32
+        return s == INVALID_SOCKET ? net::kInvalid : static_cast<net::Handle>(s);
+#else
+        return s < 0 ? net::kInvalid : static_cast<net::Handle>(s);
+#endif
+    }
+
+    const sockaddr *sa(const net::Address &a) { return reinterpret_cast<const sockaddr *>(a.data); }
+    sockaddr *sa(net::Address &a) { return reinterpret_cast<sockaddr *>(a.data); }
+
+    // "" and "*" bind every interface; "localhost" is mapped without DNS.
+    bool bindAddress(const std::string &host, int port, bool udp, net::Address &out, std::string &err)
+    {
+        if (host.empty() || host == "*" || host == "0.0.0.0")
+            return net::parseAddress("0.0.0.0", port, out);
+        if (host == "localhost")
+            return net::parseAddress("127.0.0.1", port, out);
+        return net::resolve(host, port, udp, out, err);
+    }
+
+    template <class F, class... A>
+    void fire(const F &f, A &&...args)
+    {
+        // Call through a copy: the callback may replace or clear itself.
+        if (f)
+        {
+            F copy = f;
+            copy(std::forward<A>(args)...);
+        }
+    }
+}
+
+// ─── net helpers ─────────────────────────────────────────────────────────────
+
+namespace net
+{
+    void startup()
+    {
+        static bool done = false;
+        if (done)
+            return;
+        done = true;
+#ifdef _WIN32
+        WSADATA wsa;
+        WSAStartup(MAKEWORD(2, 2), &wsa);
+#elif !defined(MSG_NOSIGNAL)
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+    }
+
+    std::string Address::host() const
+    {
+        char buf[INET6_ADDRSTRLEN] = {};
+        auto *s = reinterpret_cast<const sockaddr *>(data);
+        if (s->sa_family == AF_INET)
+            inet_ntop(AF_INET, const_cast<in_addr *>(&reinterpret_cast<const sockaddr_in *>(data)->sin_addr), buf, sizeof(buf));
+        else if (s->sa_family == AF_INET6)
+            inet_ntop(AF_INET6, const_cast<in6_addr *>(&reinterpret_cast<const sockaddr_in6 *>(data)->sin6_addr), buf, sizeof(buf));
+        return buf;
+    }
+
+    int Address::port() const
+    {
+        auto *s = reinterpret_cast<const sockaddr *>(data);
+        if (s->sa_family == AF_INET)
+            return ntohs(reinterpret_cast<const sockaddr_in *>(data)->sin_port);
+        if (s->sa_family == AF_INET6)
+            return ntohs(reinterpret_cast<const sockaddr_in6 *>(data)->sin6_port);
+        return 0;
+    }
+
+    void Address::setPort(int port)
+    {
+        auto *s = reinterpret_cast<sockaddr *>(data);
+        if (s->sa_family == AF_INET)
+            reinterpret_cast<sockaddr_in *>(data)->sin_port = htons(static_cast<uint16_t>(port));
+        else if (s->sa_family == AF_INET6)
+            reinterpret_cast<sockaddr_in6 *>(data)->sin6_port = htons(static_cast<uint16_t>(port));
+    }
+
+    bool parseAddress(const std::string &host, int port, Address &out)
+    {
+        out = Address();
+        auto *v4 = reinterpret_cast<sockaddr_in *>(out.data);
+        if (inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1)
+        {
+            v4->sin_family = AF_INET;
+            v4->sin_port = htons(static_cast<uint16_t>(port));
+            out.len = sizeof(sockaddr_in);
+            return true;
+        }
+        std::string h = host;
+        if (h.size() > 2 && h.front() == '[' && h.back() == ']')
+            h = h.substr(1, h.size() - 2);
+        out = Address();
+        auto *v6 = reinterpret_cast<sockaddr_in6 *>(out.data);
+        if (inet_pton(AF_INET6, h.c_str(), &v6->sin6_addr) == 1)
+        {
+            v6->sin6_family = AF_INET6;
+            v6->sin6_port = htons(static_cast<uint16_t>(port));
+            out.len = sizeof(sockaddr_in6);
+            return true;
+        }
+        return false;
+    }
+
+    bool resolve(const std::string &host, int port, bool udp, Address &out, std::string &err)
+    {
+        startup();
+        if (parseAddress(host, port, out))
+            return true;
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = udp ? SOCK_DGRAM : SOCK_STREAM;
+        addrinfo *res = nullptr;
+        std::string service = std::to_string(port);
+        int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &res);
+        if (rc != 0 || !res)
+        {
+            err = "cannot resolve host '" + host + "'";
+            return false;
+        }
+        // Prefer IPv4 — loopback services commonly listen on 0.0.0.0 only.
+        addrinfo *pick = res;
+        for (addrinfo *p = res; p; p = p->ai_next)
+            if (p->ai_family == AF_INET)
+            {
+                pick = p;
+                break;
+            }
+        out = Address();
+        std::memcpy(out.data, pick->ai_addr, pick->ai_addrlen);
+        out.len = static_cast<int>(pick->ai_addrlen);
+        freeaddrinfo(res);
+        return true;
+    }
+
+    void closeSocket(Handle h)
+    {
+        if (h == kInvalid)
+            return;
+#ifdef _WIN32
+        closesocket(QSOCK(h));
+#else
+        ::close(QSOCK(h));
+#endif
+    }
+
+    std::string errorString(int code)
+    {
+#ifdef _WIN32
+        char buf[256] = {};
+        FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, code, 0, buf, sizeof(buf), nullptr);
+        std::string s = buf;
+        while (!s.empty() && (s.back() == '\n' || s.back() == '\r' || s.back() == '.'))
+            s.pop_back();
+        return s;
+#else
+        return std::strerror(code);
+#endif
+    }
+
+    std::string lastError()
+    {
+        return errorString(lastErrorCode());
+    }
+
+    Handle startConnect(const Address &addr, std::string &err, int *code)
+    {
+        startup();
+        Handle h = toHandle(socket(sa(addr)->sa_family, SOCK_STREAM, IPPROTO_TCP));
+        if (h == kInvalid)
+        {
+            if (code)
+                *code = lastErrorCode();
+            err = lastError();
+            return kInvalid;
+        }
+        setNonBlocking(h);
+        setNoDelay(h);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(QSOCK(h), SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        if (::connect(QSOCK(h), sa(addr), static_cast<socklen_t>(addr.len)) != 0)
+        {
+            int e = lastErrorCode();
+            if (!connectPending(e))
+            {
+                if (code)
+                    *code = e;
+                err = errorString(e);
+                closeSocket(h);
+                return kInvalid;
+            }
+        }
+        return h;
+    }
+
+    bool isRefused(int code)
+    {
+#ifdef _WIN32
+        return code == WSAECONNREFUSED;
+#else
+        return code == ECONNREFUSED;
+#endif
+    }
+
+    int connectResult(Handle h)
+    {
+        int code = 0;
+        socklen_t len = sizeof(code);
+        if (getsockopt(QSOCK(h), SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&code), &len) != 0)
+            return lastErrorCode();
+        return code;
+    }
+}
+
+// ─── TcpStream ───────────────────────────────────────────────────────────────
+
+TcpStream::TcpStream(EventLoop &loop, net::Handle fd) : loop_(loop), fd_(fd) {}
+
+TcpStream::~TcpStream()
+{
+    net::closeSocket(fd_);
+}
+
+std::shared_ptr<TcpStream> TcpStream::connect(EventLoop &loop, const net::Address &addr, std::string &err)
+{
+    net::Handle h = net::startConnect(addr, err);
+    if (h == net::kInvalid)
+        return nullptr;
+    std::shared_ptr<TcpStream> s(new TcpStream(loop, h));
+    s->connecting_ = true;
+    s->remoteHost_ = addr.host();
+    s->remotePort_ = addr.port();
+    s->updateInterest();
+    return s;
+}
+
+std::shared_ptr<TcpStream> TcpStream::adopt(EventLoop &loop, net::Handle fd)
+{
+    std::shared_ptr<TcpStream> s(new TcpStream(loop, fd));
+    s->fillPeer();
+    return s;
+}
+
+void TcpStream::fillPeer()
+{
+    net::Address a;
+    socklen_t len = sizeof(a.data);
+    if (getpeername(QSOCK(fd_), sa(a), &len) == 0)
+    {
+        a.len = static_cast<int>(len);
+        remoteHost_ = a.host();
+        remotePort_ = a.port();
+    }
+}
+
+int TcpStream::localPort() const
+{
+    if (fd_ == net::kInvalid)
+        return 0;
+    net::Address a;
+    socklen_t len = sizeof(a.data);
+    if (getsockname(QSOCK(fd_), sa(a), &len) != 0)
+        return 0;
+    return a.port();
+}
+
+void TcpStream::start()
+{
+    started_ = true;
+    updateInterest();
+}
+
+void TcpStream::updateInterest()
+{
+    if (fd_ == net::kInvalid)
+        return;
+    int ev = 0;
+    if (connecting_)
+        ev = EventLoop::Writable;
+    else
+    {
+        if (started_ && !paused_ && !eof_)
+            ev |= EventLoop::Readable;
+        if (buffered() > 0)
+            ev |= EventLoop::Writable;
+    }
+    if (loop_.isWatched(fd_))
+        loop_.modify(fd_, ev);
+    else
+    {
+        // The watcher owns a strong reference so the stream lives while open.
+        auto self = shared_from_this();
+        loop_.watch(fd_, ev, [self](int events)
+                    { self->onEvents(events); }, holdsLoop_);
+    }
+}
+
+void TcpStream::setHoldsLoop(bool hold)
+{
+    if (holdsLoop_ == hold)
+        return;
+    holdsLoop_ = hold;
+    if (fd_ != net::kInvalid && loop_.isWatched(fd_))
+    {
+        auto self = shared_from_this();
+        loop_.unwatch(fd_);
+        updateInterest();
+    }
+}
+
+void TcpStream::onEvents(int events)
+{
+    auto self = shared_from_this(); // callbacks may drop the last outside reference
+    if (connecting_)
+    {
+        int code = net::connectResult(fd_);
+        if (code != 0)
+        {
+            fail("connect to " + remoteHost_ + ":" + std::to_string(remotePort_) + " failed: " + net::errorString(code));
+            return;
+        }
+        connecting_ = false;
+        fillPeer();
+        updateInterest();
+        fire(onConnect);
+        return;
+    }
+    if (events & EventLoop::Writable)
+    {
+        flushOut();
+        if (closed_)
+            return;
+    }
+    if (events & (EventLoop::Readable | EventLoop::Error))
+        handleReadable();
+}
+
+void TcpStream::handleReadable()
+{
+    if (readBuf_.size() < kReadChunk)
+        readBuf_.resize(kReadChunk);
+
+    // Bounded so one busy connection cannot starve the rest of the loop.
+    for (int i = 0; i < 16 && !closed_ && !paused_ && !eof_; ++i)
+    {
+#ifdef _WIN32
+        int n = recv(QSOCK(fd_), &readBuf_[0], static_cast<int>(kReadChunk), 0);
+#else
+        ssize_t n = recv(QSOCK(fd_), &readBuf_[0], kReadChunk, 0);
+#endif
+        if (n > 0)
+        {
+            fire(onData, readBuf_.data(), static_cast<size_t>(n));
+            if (static_cast<size_t>(n) < kReadChunk)
+                break;
+            continue;
+        }
+        if (n == 0)
+        {
+            eof_ = true;
+            updateInterest();
+            if (onEnd)
+                fire(onEnd);
+            else
+                end();
+            return;
+        }
+        int code = lastErrorCode();
+        if (wouldBlock(code))
+            break;
+        fail(net::errorString(code));
+        return;
+    }
+}
+
+bool TcpStream::write(std::string_view data)
+{
+    if (fd_ == net::kInvalid || ending_)
+        return false;
+    if (data.empty())
+        return !aboveHighWater_;
+
+    if (buffered() == 0 && !connecting_)
+    {
+#ifdef _WIN32
+        int n = send(QSOCK(fd_), data.data(), static_cast<int>(data.size()), QSEND_FLAGS);
+#else
+        ssize_t n = send(QSOCK(fd_), data.data(), data.size(), QSEND_FLAGS);
+#endif
+        if (n < 0)
+        {
+            int code = lastErrorCode();
+            if (!wouldBlock(code))
+            {
+                fail(net::errorString(code));
+                return false;
+            }
+            n = 0;
+        }
+        data.remove_prefix(static_cast<size_t>(n));
+        if (data.empty())
+            return true;
+    }
+
+    if (outPos_ > 0 && outPos_ == out_.size())
+    {
+        out_.clear();
+        outPos_ = 0;
+    }
+    out_.append(data.data(), data.size());
+    updateInterest();
+    if (buffered() >= highWater_)
+        aboveHighWater_ = true;
+    return !aboveHighWater_;
+}
+
+bool TcpStream::flushOut()
+{
+    while (outPos_ < out_.size())
+    {
+        size_t left = out_.size() - outPos_;
+#ifdef _WIN32
+        int n = send(QSOCK(fd_), out_.data() + outPos_, static_cast<int>(left), QSEND_FLAGS);
+#else
+        ssize_t n = send(QSOCK(fd_), out_.data() + outPos_, left, QSEND_FLAGS);
+#endif
+        if (n < 0)
+        {
+            int code = lastErrorCode();
+            if (wouldBlock(code))
+                break;
+            fail(net::errorString(code));
+            return false;
+        }
+        outPos_ += static_cast<size_t>(n);
+    }
+
+    if (outPos_ == out_.size())
+    {
+        out_.clear();
+        outPos_ = 0;
+    }
+    else if (outPos_ > (1 << 20) && outPos_ * 2 > out_.size())
+    {
+        out_.erase(0, outPos_);
+        outPos_ = 0;
+    }
+    updateInterest();
+
+    if (buffered() == 0)
+    {
+        if (ending_)
+        {
+            close();
+            return true;
+        }
+        if (aboveHighWater_)
+        {
+            aboveHighWater_ = false;
+            fire(onDrain);
+        }
+    }
+    return true;
+}
+
+void TcpStream::end()
+{
+    if (fd_ == net::kInvalid)
+        return;
+    ending_ = true;
+    if (buffered() == 0 && !connecting_)
+        close();
+}
+
+void TcpStream::pause()
+{
+    paused_ = true;
+    updateInterest();
+}
+
+void TcpStream::resume()
+{
+    if (!paused_)
+        return;
+    paused_ = false;
+    updateInterest();
+}
+
+void TcpStream::fail(const std::string &msg)
+{
+    auto self = shared_from_this();
+    fire(onError, msg);
+    close();
+}
+
+void TcpStream::close()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+    auto self = shared_from_this(); // unwatch() drops the watcher's reference
+    if (fd_ != net::kInvalid)
+    {
+        loop_.unwatch(fd_);
+#ifdef _WIN32
+        shutdown(QSOCK(fd_), SD_SEND);
+#else
+        shutdown(QSOCK(fd_), SHUT_WR);
+#endif
+        net::closeSocket(fd_);
+        fd_ = net::kInvalid;
+    }
+    out_.clear();
+    outPos_ = 0;
+    auto closed = onClose;
+    // Drop script callbacks so closures that captured this stream are freed.
+    onConnect = nullptr;
+    onData = nullptr;
+    onEnd = nullptr;
+    onDrain = nullptr;
+    onError = nullptr;
+    onClose = nullptr;
+    if (closed)
+        closed();
+}
+
+// ─── TcpListener ─────────────────────────────────────────────────────────────
+
+std::shared_ptr<TcpListener> TcpListener::listen(EventLoop &loop, const std::string &host, int port,
+                                                 int backlog, bool reusePort, std::string &err)
+{
+    net::startup();
+    net::Address addr;
+    if (!bindAddress(host, port, false, addr, err))
+    {
+        if (err.empty())
+            err = "invalid address '" + host + "'";
+        return nullptr;
+    }
+    net::Handle h = toHandle(socket(sa(addr)->sa_family, SOCK_STREAM, IPPROTO_TCP));
+    if (h == net::kInvalid)
+    {
+        err = net::lastError();
+        return nullptr;
+    }
+    int one = 1;
+#ifndef _WIN32
+    setsockopt(QSOCK(h), SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+#ifdef SO_REUSEPORT
+    if (reusePort)
+        setsockopt(QSOCK(h), SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char *>(&one), sizeof(one));
+#else
+    (void)reusePort;
+#endif
+    if (::bind(QSOCK(h), sa(addr), static_cast<socklen_t>(addr.len)) != 0 ||
+        ::listen(QSOCK(h), backlog > 0 ? backlog : SOMAXCONN) != 0)
+    {
+        err = net::lastError();
+        net::closeSocket(h);
+        return nullptr;
+    }
+    setNonBlocking(h);
+
+    net::Address bound;
+    socklen_t len = sizeof(bound.data);
+    getsockname(QSOCK(h), sa(bound), &len);
+    return std::shared_ptr<TcpListener>(new TcpListener(loop, h, bound.port()));
+}
+
+TcpListener::~TcpListener()
+{
+    net::closeSocket(fd_);
+}
+
+void TcpListener::start()
+{
+    if (fd_ == net::kInvalid || loop_.isWatched(fd_))
+        return;
+    auto self = shared_from_this();
+    loop_.watch(fd_, EventLoop::Readable, [self](int)
+                { self->acceptAll(); });
+}
+
+void TcpListener::acceptAll()
+{
+    auto self = shared_from_this();
+    for (int i = 0; i < 256 && fd_ != net::kInvalid; ++i)
+    {
+        net::Handle c = toHandle(::accept(QSOCK(fd_), nullptr, nullptr));
+        if (c == net::kInvalid)
+            break; // EAGAIN, or out of descriptors — retried on the next wakeup
+        setNonBlocking(c);
+        setNoDelay(c);
+        if (onAccept)
+            fire(onAccept, c);
+        else
+            net::closeSocket(c);
+    }
+}
+
+void TcpListener::stop()
+{
+    if (fd_ != net::kInvalid)
+        loop_.unwatch(fd_);
+}
+
+void TcpListener::close()
+{
+    if (fd_ == net::kInvalid)
+        return;
+    auto self = shared_from_this();
+    loop_.unwatch(fd_);
+    net::closeSocket(fd_);
+    fd_ = net::kInvalid;
+    onAccept = nullptr;
+}
+
+// ─── UdpSocket ───────────────────────────────────────────────────────────────
+
+std::shared_ptr<UdpSocket> UdpSocket::bind(EventLoop &loop, const std::string &host, int port, std::string &err)
+{
+    net::startup();
+    net::Address addr;
+    if (!bindAddress(host, port, true, addr, err))
+    {
+        if (err.empty())
+            err = "invalid address '" + host + "'";
+        return nullptr;
+    }
+    net::Handle h = toHandle(socket(sa(addr)->sa_family, SOCK_DGRAM, IPPROTO_UDP));
+    if (h == net::kInvalid)
+    {
+        err = net::lastError();
+        return nullptr;
+    }
+    if (::bind(QSOCK(h), sa(addr), static_cast<socklen_t>(addr.len)) != 0)
+    {
+        err = net::lastError();
+        net::closeSocket(h);
+        return nullptr;
+    }
+    setNonBlocking(h);
+    net::Address bound;
+    socklen_t len = sizeof(bound.data);
+    getsockname(QSOCK(h), sa(bound), &len);
+    return std::shared_ptr<UdpSocket>(new UdpSocket(loop, h, bound.port()));
+}
+
+UdpSocket::~UdpSocket()
+{
+    net::closeSocket(fd_);
+}
+
+void UdpSocket::start()
+{
+    if (fd_ == net::kInvalid || loop_.isWatched(fd_))
+        return;
+    auto self = shared_from_this();
+    loop_.watch(fd_, EventLoop::Readable, [self](int)
+                { self->readAll(); });
+}
+
+void UdpSocket::readAll()
+{
+    auto self = shared_from_this();
+    if (readBuf_.size() < 65536)
+        readBuf_.resize(65536);
+    for (int i = 0; i < 64 && fd_ != net::kInvalid; ++i)
+    {
+        net::Address from;
+        socklen_t len = sizeof(from.data);
+#ifdef _WIN32
+        int n = recvfrom(QSOCK(fd_), &readBuf_[0], static_cast<int>(readBuf_.size()), 0, sa(from), &len);
+#else
+        ssize_t n = recvfrom(QSOCK(fd_), &readBuf_[0], readBuf_.size(), 0, sa(from), &len);
+#endif
+        if (n < 0)
+            break;
+        from.len = static_cast<int>(len);
+        fire(onMessage, readBuf_.data(), static_cast<size_t>(n), from);
+    }
+}
+
+bool UdpSocket::sendTo(std::string_view data, const net::Address &to)
+{
+    if (fd_ == net::kInvalid)
+        return false;
+#ifdef _WIN32
+    int n = sendto(QSOCK(fd_), data.data(), static_cast<int>(data.size()), 0, sa(to), to.len);
+#else
+    ssize_t n = sendto(QSOCK(fd_), data.data(), data.size(), QSEND_FLAGS, sa(to), static_cast<socklen_t>(to.len));
+#endif
+    return n == static_cast<decltype(n)>(data.size());
+}
+
+void UdpSocket::close()
+{
+    if (fd_ == net::kInvalid)
+        return;
+    auto self = shared_from_this();
+    loop_.unwatch(fd_);
+    net::closeSocket(fd_);
+    fd_ = net::kInvalid;
+    onMessage = nullptr;
+}
@@ -0,0 +1,146 @@
+#include "Number.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace number
+{
+    void append(std::string &out, double v)
+    {
+        if (std::isnan(v))
+        {
+            out += "nan";
+            return;
+        }
+        if (std::isinf(v))
+        {
+            out += v < 0 ? "-inf" : "inf";
+            return;
+        }
+        char buf[32];
+        if (v == std::floor(v) && std::fabs(v) < 9007199254740992.0) // 2^53: exact integers
+        {
+            auto r = std::to_chars(buf, buf + sizeof buf, static_cast<int64_t>(v));
+            out.append(buf, r.ptr);
+            return;
+        }
+
+        auto r = std::to_chars(buf, buf + sizeof buf, v, std::chars_format::scientific);
+        const char *p = buf, *end = r.ptr;
+        if (*p == '-')
+        {
+            out += '-';
+            p++;
+        }
+        char digits[20];
+        int k = 0;
+        for (; p < end && *p != 'e'; p++)
+            if (*p != '.')
+                digits[k++] = *p;
+        // p is at "e+NN" or "e-NN"
+        int exp = 0;
+        for (const char *q = p + 2; q < end; q++)
+            exp = exp * 10 + (*q - '0');
+        if (p[1] == '-')
+            exp = -exp;
+
+        int point = exp + 1; // digits before the decimal point
+        if (point > 0 && point <= 21)
+        {
+            if (k <= point)
+            {
+                out.append(digits, static_cast<size_t>(k));
+                out.append(static_cast<size_t>(point - k), '0');
+            }
+            else
+            {
+                out.append(digits, static_cast<size_t>(point));
+                out += '.';
+                out.append(digits + point, static_cast<size_t>(k - point));
+            }
+        }
+        else if (point <= 0 && point > -6)
+        {
+            out += "0.";
+            out.append(static_cast<size_t>(-point), '0');
+            out.append(digits, static_cast<size_t>(k));
+        }
+        else
+        {
+            out += digits[0];
+            if (k > 1)
+            {
+                out += '.';
+                out.append(digits + 1, static_cast<size_t>(k - 1));
+            }
+            out += exp < 0 ? "e-" : "e+";
+            char e[8];
+            auto er = std::to_chars(e, e + sizeof e, exp < 0 ? -exp : exp);
+            out.append(e, er.ptr);
+        }
+    }
+
+    std::string format(double v)
+    {
+        std::string s;
+        append(s, v);
+        return s;
+    }
+
+    void appendFixed(std::string &out, double v, int places)
+    {
+        if (!std::isfinite(v))
+        {
+            append(out, v);
+            return;
+        }
+        // 309 integer digits for DBL_MAX, a sign, the point and 100 places
+        char buf[512];
+        auto r = std::to_chars(buf, buf + sizeof buf, v, std::chars_format::fixed, std::clamp(places, 0, 100));
+        out.append(buf, r.ptr);
+    }
+
+    bool parse(std::string_view s, double &v, size_t *used)
+    {
+        size_t i = 0;
+        while (i < s.size() && (s[i] == ' ' || (s[i] >= '\t' && s[i] <= '\r')))
+            i++;
+        bool neg = false;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-'))
+            neg = s[i++] == '-';
+        const char *p = s.data() + i, *end = s.data() + s.size();
+        if (p == end || *p == '-' || *p == '+')
+            return false;
+
+        double d = 0;
+        std::from_chars_result r;
+        if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+        {
+            r = std::from_chars(p + 2, end, d, std::chars_format::hex);
+            if (r.ec == std::errc::invalid_argument) // "0x" and no digits: just the 0
+                r = std::from_chars(p, p + 1, d);
+        }
+        else
+            r = std::from_chars(p, end, d);
+        if (r.ec == std::errc::invalid_argument)
+            return false;
+        if (r.ec == std::errc::result_out_of_range)
+            d = std::strtod(std::string(p, r.ptr).c_str(), nullptr); // ±inf or 0, as strtod rounds
+
+        v = neg ? -d : d;
+        if (used)
+            *used = static_cast<size_t>(r.ptr - s.data());
+        return true;
+    }
+
+    size_t toCount(double v)
+    {
+        if (!(v > 0))
+            return 0;
+        if (v >= static_cast<double>(SIZE_MAX))
+            return SIZE_MAX;
+        return static_cast<size_t>(v);
+    }
+}
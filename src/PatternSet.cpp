@@ -0,0 +1,365 @@
+#include "PatternSet.h"
+#include "Cpu.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define QUANTUM_PATTERNS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define QUANTUM_TARGET_SSSE3
+#define QUANTUM_TARGET_AVX2
+#else
+#define QUANTUM_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define QUANTUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    constexpr size_t kRowBudget = size_t(1) << 22; // resolved-row entries (16 MB)
+    constexpr size_t kMaxNibbleStarts = 16;         // first bytes the SIMD prefilter takes
+
+    inline uint8_t foldByte(uint8_t b)
+    {
+        return b >= 'A' && b <= 'Z' ? static_cast<uint8_t>(b + 32) : b;
+    }
+
+    inline int lowestBit(unsigned x)
+    {
+#ifdef _MSC_VER
+        unsigned long i;
+        _BitScanForward(&i, x);
+        return static_cast<int>(i);
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+
+    enum Level
+    {
+        Portable,
+        Ssse3,
+        Avx2
+    };
+
+    Level level()
+    {
+#ifdef QUANTUM_PATTERNS_X86
+        static const Level l = cpu::hasAvx2() ? Avx2 : cpu::hasSsse3() ? Ssse3
+                                                                        : Portable;
+        return l;
+#else
+        return Portable;
+#endif
+    }
+
+    size_t nextStartPortable(const uint8_t *p, size_t i, size_t n, const bool *starts)
+    {
+        while (i < n && !starts[p[i]])
+            i++;
+        return i;
+    }
+
+#ifdef QUANTUM_PATTERNS_X86
+    // A byte is a candidate when the bucket bits its low and high nibbles
+    // select overlap.  Buckets are the high nibble mod 8, so ASCII bytes are
+    // tested exactly; a byte >= 0x80 may pass for its ASCII twin and is then
+    // rejected by the automaton.
+    QUANTUM_TARGET_SSSE3 size_t nextStartSsse3(const uint8_t *p, size_t i, size_t n, const uint8_t *lo,
+                                               const uint8_t *hi, const bool *starts)
+    {
+        const __m128i tlo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lo));
+        const __m128i thi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi));
+        const __m128i low4 = _mm_set1_epi8(0x0f);
+        for (; n - i >= 16; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            __m128i a = _mm_shuffle_epi8(tlo, _mm_and_si128(v, low4));
+            __m128i b = _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi16(v, 4), low4));
+            __m128i miss = _mm_cmpeq_epi8(_mm_and_si128(a, b), _mm_setzero_si128());
+            unsigned hits = ~static_cast<unsigned>(_mm_movemask_epi8(miss)) & 0xFFFFu;
+            if (hits)
+                return i + static_cast<size_t>(lowestBit(hits));
+        }
+        return nextStartPortable(p, i, n, starts);
+    }
+
+    QUANTUM_TARGET_AVX2 size_t nextStartAvx2(const uint8_t *p, size_t i, size_t n, const uint8_t *lo,
+                                             const uint8_t *hi, const bool *starts)
+    {
+        const __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo)));
+        const __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hi)));
+        const __m256i low4 = _mm256_set1_epi8(0x0f);
+        for (; n - i >= 32; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+            __m256i a = _mm256_shuffle_epi8(tlo, _mm256_and_si256(v, low4));
+            __m256i b = _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+            __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(a, b), _mm256_setzero_si256());
+            unsigned hits = ~static_cast<unsigned>(_mm256_movemask_epi8(miss));
+            if (hits)
+                return i + static_cast<size_t>(lowestBit(hits));
+        }
+        return nextStartPortable(p, i, n, starts);
+    }
+#endif
+}
+
+PatternSet::PatternSet(const std::vector<std::string_view> &patterns, bool caseInsensitive)
+{
+    auto fold = [caseInsensitive](char c)
+    {
+        uint8_t b = static_cast<uint8_t>(c);
+        return caseInsensitive ? foldByte(b) : b;
+    };
+
+    // Byte classes: one per byte the patterns use, one shared by the rest.
+    std::array<bool, 256> used{};
+    for (auto p : patterns)
+        for (char c : p)
+            used[fold(c)] = true;
+    size_t k = 0;
+    for (int b = 0; b < 256; b++)
+        if (used[b])
+            classOf_[b] = static_cast<uint8_t>(k++);
+    classes_ = k < 256 ? k + 1 : 256;
+    for (int b = 0; b < 256; b++)
+    {
+        uint8_t f = fold(static_cast<char>(b));
+        classOf_[b] = used[f] ? classOf_[f] : static_cast<uint8_t>(k < 256 ? k : 0);
+    }
+
+    // Trie, in insertion order for now.
+    struct Node
+    {
+        std::vector<std::pair<uint16_t, uint32_t>> next;
+        std::vector<uint32_t> out;
+    };
+    std::vector<Node> trie(1);
+    auto child = [&](uint32_t s, uint16_t c) -> uint32_t
+    {
+        for (auto &e : trie[s].next)
+            if (e.first == c)
+                return e.second;
+        return kNone;
+    };
+    std::vector<uint32_t> rootNext(classes_, kNone);
+    lengths_.reserve(patterns.size());
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+        lengths_.push_back(static_cast<uint32_t>(patterns[i].size()));
+        if (patterns[i].empty())
+            continue;
+        uint32_t s = 0;
+        for (char ch : patterns[i])
+        {
+            uint16_t c = classOf_[static_cast<uint8_t>(ch)];
+            uint32_t t = s == 0 ? rootNext[c] : child(s, c);
+            if (t == kNone)
+            {
+                t = static_cast<uint32_t>(trie.size());
+                trie.emplace_back(); // may move trie; index, not reference
+                trie[s].next.push_back({c, t});
+                if (s == 0)
+                    rootNext[c] = t;
+            }
+            s = t;
+        }
+        trie[s].out.push_back(static_cast<uint32_t>(i));
+    }
+
+    // Breadth-first order gives the final numbering.
+    const size_t n = trie.size();
+    std::vector<uint32_t> order{0}, id(n);
+    order.reserve(n);
+    for (size_t q = 0; q < order.size(); q++)
+    {
+        auto &next = trie[order[q]].next;
+        std::sort(next.begin(), next.end());
+        for (auto &e : next)
+            order.push_back(e.second);
+    }
+    for (size_t q = 0; q < n; q++)
+        id[order[q]] = static_cast<uint32_t>(q);
+
+    // Failure links: the longest proper suffix that is also a trie path.
+    std::vector<uint32_t> fail(n, 0);
+    for (uint32_t u : order)
+    {
+        for (auto &[c, v] : trie[u].next)
+        {
+            if (u == 0)
+                continue;
+            uint32_t f = fail[u];
+            uint32_t t;
+            while ((t = f == 0 ? rootNext[c] : child(f, c)) == kNone && f != 0)
+                f = fail[f];
+            fail[v] = t == kNone ? 0 : t;
+        }
+    }
+
+    // Final arrays in breadth-first numbering.
+    fail_.resize(n);
+    dictLink_.assign(n, kNone);
+    reports_.assign(n, 0);
+    outStart_.assign(n + 1, 0);
+    for (size_t q = 0; q < n; q++)
+    {
+        uint32_t u = order[q];
+        fail_[q] = id[fail[u]];
+        outStart_[q] = static_cast<uint32_t>(outputs_.size());
+        outputs_.insert(outputs_.end(), trie[u].out.begin(), trie[u].out.end());
+        if (q > 0)
+        {
+            uint32_t f = fail_[q];
+            if (f != 0 && trie[order[f]].out.size())
+                dictLink_[q] = f;
+            else
+                dictLink_[q] = dictLink_[f];
+        }
+        reports_[q] = !trie[u].out.empty() || dictLink_[q] != kNone;
+    }
+    outStart_[n] = static_cast<uint32_t>(outputs_.size());
+
+    // Resolved rows for the shallowest states the budget allows.  A
+    // state's failure target is shallower, so its row already exists.
+    rowCount_ = std::max<size_t>(1, std::min(n, kRowBudget / classes_));
+    rows_.assign(rowCount_ * classes_, 0);
+    for (size_t q = 0; q < rowCount_; q++)
+    {
+        uint32_t *row = &rows_[q * classes_];
+        if (q > 0)
+            std::memcpy(row, &rows_[fail_[q] * classes_], classes_ * sizeof(uint32_t));
+        for (auto &[c, v] : trie[order[q]].next)
+            row[c] = id[v];
+    }
+    edgeStart_.assign(n - rowCount_ + 1, 0);
+    for (size_t q = rowCount_; q < n; q++)
+    {
+        edgeStart_[q - rowCount_] = static_cast<uint32_t>(edgeTo_.size());
+        for (auto &[c, v] : trie[order[q]].next)
+        {
+            edgeClass_.push_back(c);
+            edgeTo_.push_back(id[v]);
+        }
+    }
+    edgeStart_[n - rowCount_] = static_cast<uint32_t>(edgeTo_.size());
+
+    // Start-state prefilter from the set of first bytes.
+    size_t distinct = 0;
+    for (int b = 0; b < 256; b++)
+    {
+        starts_[b] = rootNext[classOf_[b]] != kNone;
+        if (starts_[b])
+        {
+            distinct++;
+            skipByte_ = static_cast<uint8_t>(b);
+            nibbleLo_[b & 15] |= static_cast<uint8_t>(1u << ((b >> 4) & 7));
+            nibbleHi_[b >> 4] = static_cast<uint8_t>(1u << ((b >> 4) & 7));
+        }
+    }
+    if (distinct == 1)
+        skip_ = Skip::Memchr;
+    else if (distinct > 1 && distinct <= kMaxNibbleStarts)
+        skip_ = Skip::Nibbles;
+}
+
+uint32_t PatternSet::step(uint32_t s, uint8_t byte) const
+{
+    const uint16_t c = classOf_[byte];
+    for (;;)
+    {
+        if (s < rowCount_)
+            return rows_[s * classes_ + c];
+        size_t e = edgeStart_[s - rowCount_], end = edgeStart_[s - rowCount_ + 1];
+        for (; e < end && edgeClass_[e] < c; e++)
+        {
+        }
+        if (e < end && edgeClass_[e] == c)
+            return edgeTo_[e];
+        s = fail_[s];
+    }
+}
+
+size_t PatternSet::skip(const uint8_t *p, size_t i, size_t n) const
+{
+    if (skip_ == Skip::Memchr)
+    {
+        const void *q = std::memchr(p + i, skipByte_, n - i);
+        return q ? static_cast<size_t>(static_cast<const uint8_t *>(q) - p) : n;
+    }
+    switch (level())
+    {
+#ifdef QUANTUM_PATTERNS_X86
+    case Avx2:
+        return nextStartAvx2(p, i, n, nibbleLo_.data(), nibbleHi_.data(), starts_.data());
+    case Ssse3:
+        return nextStartSsse3(p, i, n, nibbleLo_.data(), nibbleHi_.data(), starts_.data());
+#endif
+    default:
+        return nextStartPortable(p, i, n, starts_.data());
+    }
+}
+
+template <typename F>
+void PatternSet::scan(std::string_view text, F &&onMatch) const
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(text.data());
+    const size_t n = text.size();
+    uint32_t s = 0;
+    for (size_t i = 0; i < n;)
+    {
+        if (s == 0 && skip_ != Skip::None && (i = skip(p, i, n)) == n)
+            break;
+        s = step(s, p[i++]);
+        if (!reports_[s])
+            continue;
+        for (uint32_t t = s; t != kNone; t = dictLink_[t])
+            for (uint32_t k = outStart_[t]; k < outStart_[t + 1]; k++)
+                if (!onMatch(outputs_[k], i))
+                    return;
+    }
+}
+
+void PatternSet::findAll(std::string_view text, std::vector<Match> &out, size_t limit) const
+{
+    if (limit == 0)
+        return;
+    scan(text, [&](uint32_t pattern, size_t end)
+         {
+        out.push_back({pattern, end - lengths_[pattern], end});
+        return --limit > 0; });
+}
+
+bool PatternSet::any(std::string_view text) const
+{
+    bool found = false;
+    scan(text, [&](uint32_t, size_t)
+         { return !(found = true); });
+    return found;
+}
+
+size_t PatternSet::count(std::string_view text) const
+{
+    size_t c = 0;
+    scan(text, [&](uint32_t, size_t)
+         { c++; return true; });
+    return c;
+}
+
+const char *PatternSet::prefilter() const
+{
+    switch (skip_)
+    {
+    case Skip::Memchr:
+        return "memchr";
+    case Skip::Nibbles:
+        return level() == Avx2 ? "avx2" : level() == Ssse3 ? "ssse3"
+                                                           : "table";
+    default:
+        return "none";
+    }
+}
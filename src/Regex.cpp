@@ -0,0 +1,1522 @@
+#include "Regex.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <regex>
+#include <unordered_map>
+
+namespace
+{
+    constexpr size_t npos = std::string_view::npos;
+    constexpr int kMaxRepeat = 1000;      // largest {n,m} bound
+    constexpr size_t kMaxProgram = 200000; // instructions after expanding repeats
+    constexpr size_t kMaxStates = 1024;    // DFA states kept before the cache is reset
+    constexpr size_t kCacheEntries = 128;
+
+    // ─── Byte sets ───────────────────────────────────────────────────────────
+
+    using ByteSet = std::array<uint64_t, 4>;
+
+    inline void setAdd(ByteSet &s, unsigned c) { s[c >> 6] |= uint64_t(1) << (c & 63); }
+    inline bool setHas(const ByteSet &s, unsigned c) { return (s[c >> 6] >> (c & 63)) & 1; }
+
+    void setRange(ByteSet &s, unsigned lo, unsigned hi)
+    {
+        for (unsigned c = lo; c <= hi; c++)
+            setAdd(s, c);
+    }
+
+    void setUnion(ByteSet &s, const ByteSet &o)
+    {
+        for (int k = 0; k < 4; k++)
+            s[k] |= o[k];
+    }
+
+    void setInvert(ByteSet &s)
+    {
+        for (auto &w : s)
+            w = ~w;
+    }
+
+    // The single byte in s, or -1 when s holds none or several.
+    int setSingle(const ByteSet &s)
+    {
+        int found = -1;
+        for (int k = 0; k < 4; k++)
+        {
+            if (!s[k])
+                continue;
+            if (found >= 0 || (s[k] & (s[k] - 1)))
+                return -1;
+            int bit = 0;
+            while (!((s[k] >> bit) & 1))
+                bit++;
+            found = k * 64 + bit;
+        }
+        return found;
+    }
+
+    void setFoldCase(ByteSet &s)
+    {
+        for (unsigned c = 'a'; c <= 'z'; c++)
+        {
+            unsigned u = c - 32;
+            if (setHas(s, c) || setHas(s, u))
+            {
+                setAdd(s, c);
+                setAdd(s, u);
+            }
+        }
+    }
+
+    inline bool isWordByte(int c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    // \d \w \s and their negations.
+    bool classEscape(char e, ByteSet &out)
+    {
+        ByteSet s{};
+        switch (e | 0x20)
+        {
+        case 'd':
+            setRange(s, '0', '9');
+            break;
+        case 'w':
+            for (unsigned c = 0; c < 128; c++)
+                if (isWordByte(static_cast<int>(c)))
+                    setAdd(s, c);
+            break;
+        case 's':
+            for (unsigned c : {' ', '\t', '\n', '\r', '\f', '\v'})
+                setAdd(s, c);
+            break;
+        default:
+            return false;
+        }
+        if (e >= 'A' && e <= 'Z')
+            setInvert(s);
+        setUnion(out, s);
+        return true;
+    }
+
+    // ─── Assertions ──────────────────────────────────────────────────────────
+    // Every assertion depends only on what kind of byte sits on each side of
+    // the position, so the DFA carries the kind of the previous byte in its
+    // state and learns the next one from the transition.
+
+    enum AssertKind : uint8_t
+    {
+        BeginText,
+        EndText,
+        BeginLine,
+        EndLine,
+        WordBoundary,
+        NotWordBoundary
+    };
+
+    enum Ctx : uint8_t
+    {
+        CtxEdge, // start or end of the text
+        CtxNewline,
+        CtxWord,
+        CtxOther
+    };
+
+    inline uint8_t ctxOf(int c)
+    {
+        if (c < 0)
+            return CtxEdge;
+        if (c == '\n')
+            return CtxNewline;
+        return isWordByte(c) ? CtxWord : CtxOther;
+    }
+
+    bool holds(uint8_t kind, uint8_t left, uint8_t right)
+    {
+        switch (kind)
+        {
+        case BeginText:
+            return left == CtxEdge;
+        case EndText:
+            return right == CtxEdge;
+        case BeginLine:
+            return left == CtxEdge || left == CtxNewline;
+        case EndLine:
+            return right == CtxEdge || right == CtxNewline;
+        case WordBoundary:
+            return (left == CtxWord) != (right == CtxWord);
+        default:
+            return (left == CtxWord) == (right == CtxWord);
+        }
+    }
+
+    // ─── Parser ──────────────────────────────────────────────────────────────
+
+    struct Node
+    {
+        enum Kind : uint8_t
+        {
+            Empty,
+            Set,
+            Cat,
+            Alt,
+            Rep,
+            Cap,
+            Assert
+        } kind = Empty;
+        ByteSet set{};
+        std::vector<Node> kids;
+        int min = 0, max = -1; // Rep; max -1 is unbounded
+        bool greedy = true;
+        int cap = 0;
+        uint8_t assertKind = BeginText;
+    };
+
+    struct SyntaxError
+    {
+        std::string message;
+    };
+
+    // Thrown for constructs only a backtracking matcher can run.
+    struct NeedsBacktracking
+    {
+    };
+
+    class Parser
+    {
+    public:
+        Parser(std::string_view pattern, unsigned flags) : p_(pattern), flags_(flags) {}
+
+        Node parse()
+        {
+            Node n = alternation();
+            if (more())
+                fail("unbalanced parenthesis");
+            return n;
+        }
+
+        int groups = 0;
+        std::vector<std::string> names{""};
+
+    private:
+        [[noreturn]] void fail(const std::string &what)
+        {
+            throw SyntaxError{what + " at position " + std::to_string(i_)};
+        }
+
+        bool more() const { return i_ < p_.size(); }
+        char peek() const { return p_[i_]; }
+        bool eat(char c)
+        {
+            if (more() && p_[i_] == c)
+            {
+                i_++;
+                return true;
+            }
+            return false;
+        }
+        bool eat(std::string_view s)
+        {
+            if (p_.substr(i_, s.size()) != s)
+                return false;
+            i_ += s.size();
+            return true;
+        }
+
+        Node alternation()
+        {
+            Node first = sequence();
+            if (!more() || peek() != '|')
+                return first;
+            Node n;
+            n.kind = Node::Alt;
+            n.kids.push_back(std::move(first));
+            while (eat('|'))
+                n.kids.push_back(sequence());
+            return n;
+        }
+
+        Node sequence()
+        {
+            Node n;
+            n.kind = Node::Cat;
+            while (more() && peek() != '|' && peek() != ')')
+                n.kids.push_back(quantified(atom()));
+            if (n.kids.size() == 1)
+                return std::move(n.kids[0]);
+            return n;
+        }
+
+        // {n}, {n,}, {,m} or {n,m}; anything else leaves '{' as a literal.
+        bool braces(int &min, int &max)
+        {
+            size_t save = i_;
+            auto number = [&](int &out) -> bool
+            {
+                size_t start = i_;
+                long v = 0;
+                while (more() && peek() >= '0' && peek() <= '9')
+                {
+                    v = v * 10 + (p_[i_++] - '0');
+                    if (v > kMaxRepeat)
+                        fail("repeat count too large");
+                }
+                out = static_cast<int>(v);
+                return i_ > start;
+            };
+            i_++; // '{'
+            bool hasMin = number(min);
+            if (!hasMin)
+                min = 0;
+            if (eat('}'))
+            {
+                if (hasMin)
+                {
+                    max = min;
+                    return true;
+                }
+            }
+            else if (eat(','))
+            {
+                bool hasMax = number(max);
+                if (!hasMax)
+                    max = -1;
+                if ((hasMin || hasMax) && eat('}'))
+                {
+                    if (hasMax && max < min)
+                        fail("min repeat greater than max repeat");
+                    return true;
+                }
+            }
+            i_ = save;
+            return false;
+        }
+
+        Node quantified(Node atom)
+        {
+            if (!more())
+                return atom;
+            int min, max;
+            switch (peek())
+            {
+            case '*':
+                min = 0, max = -1, i_++;
+                break;
+            case '+':
+                min = 1, max = -1, i_++;
+                break;
+            case '?':
+                min = 0, max = 1, i_++;
+                break;
+            case '{':
+                if (!braces(min, max))
+                    return atom;
+                break;
+            default:
+                return atom;
+            }
+            Node n;
+            n.kind = Node::Rep;
+            n.min = min;
+            n.max = max;
+            n.greedy = !eat('?');
+            if (more() && (peek() == '*' || peek() == '+' || peek() == '?'))
+                fail("multiple repeat");
+            n.kids.push_back(std::move(atom));
+            return n;
+        }
+
+        Node setNode(ByteSet s)
+        {
+            if (flags_ & rx::IgnoreCase)
+                setFoldCase(s);
+            Node n;
+            n.kind = Node::Set;
+            n.set = s;
+            return n;
+        }
+
+        Node literal(unsigned char c)
+        {
+            ByteSet s{};
+            setAdd(s, c);
+            return setNode(s);
+        }
+
+        Node assertion(uint8_t kind)
+        {
+            Node n;
+            n.kind = Node::Assert;
+            n.assertKind = kind;
+            return n;
+        }
+
+        int hexByte()
+        {
+            int v = 0;
+            for (int k = 0; k < 2; k++)
+            {
+                if (!more() || !std::isxdigit(static_cast<unsigned char>(peek())))
+                    fail("bad \\x escape");
+                char c = p_[i_++];
+                v = v * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+            }
+            return v;
+        }
+
+        // The byte an escape stands for, or -1 if e is not a byte escape.
+        int escapedByte(char e)
+        {
+            switch (e)
+            {
+            case 'n':
+                return '\n';
+            case 'r':
+                return '\r';
+            case 't':
+                return '\t';
+            case 'f':
+                return '\f';
+            case 'v':
+                return '\v';
+            case '0':
+                return 0;
+            case 'x':
+                return hexByte();
+            default:
+                if (std::isalnum(static_cast<unsigned char>(e)))
+                    return -1;
+                return static_cast<unsigned char>(e);
+            }
+        }
+
+        Node escape()
+        {
+            if (!more())
+                fail("bad escape (end of pattern)");
+            char e = p_[i_++];
+            ByteSet s{};
+            if (classEscape(e, s))
+                return setNode(s);
+            switch (e)
+            {
+            case 'b':
+                return assertion(WordBoundary);
+            case 'B':
+                return assertion(NotWordBoundary);
+            case 'A':
+                return assertion(BeginText);
+            case 'z':
+            case 'Z':
+                return assertion(EndText);
+            case 'k':
+                throw NeedsBacktracking{};
+            default:
+                break;
+            }
+            if (e >= '1' && e <= '9')
+                throw NeedsBacktracking{};
+            int b = escapedByte(e);
+            if (b < 0)
+                fail(std::string("bad escape \\") + e);
+            return literal(static_cast<unsigned char>(b));
+        }
+
+        bool posixClass(ByteSet &s)
+        {
+            size_t close = p_.find(":]", i_ + 2);
+            if (close == npos)
+                return false;
+            std::string_view name = p_.substr(i_ + 2, close - i_ - 2);
+            int (*test)(int) = nullptr;
+            if (name == "alpha")
+                test = [](int c) { return std::isalpha(c); };
+            else if (name == "digit")
+                test = [](int c) { return std::isdigit(c); };
+            else if (name == "alnum")
+                test = [](int c) { return std::isalnum(c); };
+            else if (name == "upper")
+                test = [](int c) { return std::isupper(c); };
+            else if (name == "lower")
+                test = [](int c) { return std::islower(c); };
+            else if (name == "space")
+                test = [](int c) { return std::isspace(c); };
+            else if (name == "punct")
+                test = [](int c) { return std::ispunct(c); };
+            else if (name == "xdigit")
+                test = [](int c) { return std::isxdigit(c); };
+            else if (name == "cntrl")
+                test = [](int c) { return std::iscntrl(c); };
+            else if (name == "print")
+                test = [](int c) { return std::isprint(c); };
+            else if (name == "graph")
+                test = [](int c) { return std::isgraph(c); };
+            else if (name == "blank")
+                test = [](int c) { return static_cast<int>(c == ' ' || c == '\t'); };
+            else if (name == "word")
+                test = [](int c) { return static_cast<int>(isWordByte(c)); };
+            else
+                fail("unknown character class [:" + std::string(name) + ":]");
+            for (int c = 0; c < 128; c++)
+                if (test(c))
+                    setAdd(s, static_cast<unsigned>(c));
+            i_ = close + 2;
+            return true;
+        }
+
+        // One class member as a byte (for ranges); -1 after adding a whole
+        // class escape such as \d.
+        int classByte(ByteSet &s)
+        {
+            char c = p_[i_++];
+            if (c != '\\')
+                return static_cast<unsigned char>(c);
+            if (!more())
+                fail("bad escape (end of pattern)");
+            char e = p_[i_++];
+            if (classEscape(e, s))
+                return -1;
+            if (e == 'b')
+                return '\b';
+            int b = escapedByte(e);
+            if (b < 0)
+                fail(std::string("bad escape \\") + e);
+            return b;
+        }
+
+        Node charClass()
+        {
+            bool negate = eat('^');
+            ByteSet s{};
+            for (bool first = true;; first = false)
+            {
+                if (!more())
+                    fail("unterminated character set");
+                if (peek() == ']' && !first)
+                {
+                    i_++;
+                    break;
+                }
+                if (peek() == '[' && i_ + 1 < p_.size() && p_[i_ + 1] == ':' && posixClass(s))
+                    continue;
+                int lo = classByte(s);
+                if (lo < 0)
+                    continue;
+                if (i_ + 1 < p_.size() && peek() == '-' && p_[i_ + 1] != ']')
+                {
+                    i_++;
+                    int hi = classByte(s);
+                    if (hi < 0 || hi < lo)
+                        fail("bad character range");
+                    setRange(s, static_cast<unsigned>(lo), static_cast<unsigned>(hi));
+                }
+                else
+                    setAdd(s, static_cast<unsigned>(lo));
+            }
+            if (flags_ & rx::IgnoreCase)
+                setFoldCase(s);
+            if (negate)
+                setInvert(s);
+            Node n;
+            n.kind = Node::Set;
+            n.set = s;
+            return n;
+        }
+
+        Node scoped(unsigned flags, int cap)
+        {
+            unsigned saved = flags_;
+            flags_ = flags;
+            Node body = alternation();
+            flags_ = saved;
+            if (!eat(')'))
+                fail("missing ), unterminated subpattern");
+            if (cap < 0)
+                return body;
+            Node n;
+            n.kind = Node::Cap;
+            n.cap = cap;
+            n.kids.push_back(std::move(body));
+            return n;
+        }
+
+        Node group()
+        {
+            if (!eat('?'))
+            {
+                names.push_back("");
+                return scoped(flags_, ++groups);
+            }
+            if (eat(':'))
+                return scoped(flags_, -1);
+            if (eat('#'))
+            {
+                size_t close = p_.find(')', i_);
+                if (close == npos)
+                    fail("missing ), unterminated comment");
+                i_ = close + 1;
+                return Node();
+            }
+            if (more() && (peek() == '=' || peek() == '!'))
+                throw NeedsBacktracking{}; // lookahead
+            if (eat("<=") || eat("<!"))
+                fail("lookbehind is not supported");
+            if (eat("P="))
+                throw NeedsBacktracking{};
+            if (eat("P<") || eat('<'))
+            {
+                size_t close = p_.find('>', i_);
+                if (close == npos)
+                    fail("missing >, unterminated name");
+                std::string name(p_.substr(i_, close - i_));
+                bool ok = !name.empty() && !std::isdigit(static_cast<unsigned char>(name[0]));
+                for (char c : name)
+                    ok = ok && isWordByte(static_cast<unsigned char>(c));
+                if (!ok)
+                    fail("bad group name '" + name + "'");
+                if (std::find(names.begin(), names.end(), name) != names.end())
+                    fail("redefinition of group name '" + name + "'");
+                i_ = close + 1;
+                names.push_back(name);
+                return scoped(flags_, ++groups);
+            }
+
+            // (?ims-ims) for the rest of the enclosing group, or (?ims-ims:...)
+            unsigned on = 0, off = 0;
+            bool minus = false;
+            while (more() && peek() != ':' && peek() != ')')
+            {
+                char f = p_[i_++];
+                if (f == '-' && !minus)
+                {
+                    minus = true;
+                    continue;
+                }
+                unsigned bit = 0;
+                rx::parseFlags(std::string_view(&f, 1), bit);
+                if (f == 'g' || f == 'u')
+                    bit = 0;
+                if (!bit)
+                    fail(std::string("unknown flag '") + f + "'");
+                (minus ? off : on) |= bit;
+            }
+            unsigned flags = (flags_ | on) & ~off;
+            if (eat(')'))
+            {
+                flags_ = flags;
+                return Node();
+            }
+            if (!eat(':'))
+                fail("missing ), unterminated subpattern");
+            return scoped(flags, -1);
+        }
+
+        Node atom()
+        {
+            char c = p_[i_++];
+            switch (c)
+            {
+            case '(':
+                return group();
+            case '[':
+                return charClass();
+            case '.':
+            {
+                ByteSet s{};
+                setInvert(s);
+                if (!(flags_ & rx::DotAll))
+                    s['\n' >> 6] &= ~(uint64_t(1) << ('\n' & 63));
+                Node n;
+                n.kind = Node::Set;
+                n.set = s;
+                return n;
+            }
+            case '^':
+                return assertion(flags_ & rx::Multiline ? BeginLine : BeginText);
+            case '$':
+                return assertion(flags_ & rx::Multiline ? EndLine : EndText);
+            case '\\':
+                return escape();
+            case '*':
+            case '+':
+            case '?':
+                i_--;
+                fail("nothing to repeat");
+            default:
+                return literal(static_cast<unsigned char>(c));
+            }
+        }
+
+        std::string_view p_;
+        size_t i_ = 0;
+        unsigned flags_;
+    };
+
+    // ─── Programs ────────────────────────────────────────────────────────────
+
+    enum Op : uint8_t
+    {
+        OpByte,   // arg
+        OpSet,    // sets[x]
+        OpSplit,  // x first, then y
+        OpJmp,    // x
+        OpLoop,   // back to split x of a loop; to its exit y if x was already
+                  // reached at this position (the iteration matched nothing)
+        OpSave,   // capture slot x
+        OpAssert, // arg is an AssertKind
+        OpMatch
+    };
+
+    struct Inst
+    {
+        Op op;
+        uint8_t arg = 0;
+        int32_t x = 0, y = 0;
+    };
+
+    struct Prog
+    {
+        std::vector<Inst> code;
+        std::vector<ByteSet> sets;
+        int start = 0;
+        bool hasAsserts = false;
+
+        bool accepts(const Inst &in, unsigned c) const
+        {
+            return in.op == OpByte ? in.arg == c : setHas(sets[in.x], c);
+        }
+    };
+
+    enum ProgKind
+    {
+        Unanchored, // (?s:.)*? prefix, leftmost-first
+        Anchored,
+        Full,    // anchored and followed by \z
+        Reverse, // body reversed, for finding where a match starts
+        kProgKinds
+    };
+
+    class Emitter
+    {
+    public:
+        Emitter(Prog &p, bool reverse, bool saves) : p_(p), reverse_(reverse), saves_(saves) {}
+
+        int emit(Op op, int32_t x = 0, int32_t y = 0, uint8_t arg = 0)
+        {
+            if (p_.code.size() >= kMaxProgram)
+                throw SyntaxError{"pattern too large"};
+            Inst in;
+            in.op = op;
+            in.x = x;
+            in.y = y;
+            in.arg = arg;
+            p_.code.push_back(in);
+            return static_cast<int>(p_.code.size() - 1);
+        }
+
+        int here() const { return static_cast<int>(p_.code.size()); }
+
+        void node(const Node &n)
+        {
+            switch (n.kind)
+            {
+            case Node::Empty:
+                break;
+            case Node::Set:
+            {
+                int b = setSingle(n.set);
+                if (b >= 0)
+                    emit(OpByte, 0, 0, static_cast<uint8_t>(b));
+                else
+                {
+                    p_.sets.push_back(n.set);
+                    emit(OpSet, static_cast<int32_t>(p_.sets.size() - 1));
+                }
+                break;
+            }
+            case Node::Cat:
+                if (reverse_)
+                    for (auto it = n.kids.rbegin(); it != n.kids.rend(); ++it)
+                        node(*it);
+                else
+                    for (auto &k : n.kids)
+                        node(k);
+                break;
+            case Node::Alt:
+            {
+                std::vector<int> exits;
+                for (size_t k = 0; k < n.kids.size(); k++)
+                {
+                    if (k + 1 == n.kids.size())
+                    {
+                        node(n.kids[k]);
+                        break;
+                    }
+                    int split = emit(OpSplit, here() + 1);
+                    node(n.kids[k]);
+                    exits.push_back(emit(OpJmp));
+                    p_.code[split].y = here();
+                }
+                for (int j : exits)
+                    p_.code[j].x = here();
+                break;
+            }
+            case Node::Rep:
+            {
+                const Node &body = n.kids[0];
+                for (int k = 0; k < n.min; k++)
+                    node(body);
+                if (n.max < 0)
+                {
+                    int split = emit(OpSplit);
+                    node(body);
+                    int loop = emit(OpLoop, split);
+                    branch(split, n.greedy);
+                    p_.code[loop].y = here();
+                }
+                else
+                {
+                    // x{0,3} as (x(x(x)?)?)?: every split skips to the end.
+                    std::vector<int> splits;
+                    for (int k = n.min; k < n.max; k++)
+                    {
+                        splits.push_back(emit(OpSplit));
+                        node(body);
+                    }
+                    for (int s : splits)
+                        branch(s, n.greedy);
+                }
+                break;
+            }
+            case Node::Cap:
+                if (saves_)
+                    emit(OpSave, 2 * n.cap);
+                node(n.kids[0]);
+                if (saves_)
+                    emit(OpSave, 2 * n.cap + 1);
+                break;
+            case Node::Assert:
+                emit(OpAssert, 0, 0, n.assertKind);
+                p_.hasAsserts = true;
+                break;
+            }
+        }
+
+    private:
+        // Point a split at the instruction after it and at here(), in the
+        // order the quantifier prefers.
+        void branch(int split, bool greedy)
+        {
+            p_.code[split].x = greedy ? split + 1 : here();
+            p_.code[split].y = greedy ? here() : split + 1;
+        }
+
+        Prog &p_;
+        bool reverse_;
+        bool saves_;
+    };
+
+    std::unique_ptr<Prog> buildProg(const Node &root, ProgKind kind)
+    {
+        auto p = std::make_unique<Prog>();
+        Emitter e(*p, kind == Reverse, kind != Reverse);
+        if (kind == Unanchored)
+        {
+            ByteSet any{};
+            setInvert(any);
+            p->sets.push_back(any);
+            e.emit(OpSplit, 3, 1);
+            e.emit(OpSet, 0);
+            e.emit(OpJmp, 0);
+        }
+        if (kind != Reverse)
+            e.emit(OpSave, 0);
+        e.node(root);
+        if (kind == Full)
+        {
+            e.emit(OpAssert, 0, 0, EndText);
+            p->hasAsserts = true;
+        }
+        if (kind != Reverse)
+            e.emit(OpSave, 1);
+        e.emit(OpMatch);
+        return p;
+    }
+
+    // ─── Pike VM ─────────────────────────────────────────────────────────────
+    // Anchored NFA simulation carrying capture slots per thread.  Threads are
+    // kept in priority order and a match cuts off everything below it, which
+    // gives the same groups a backtracking matcher would report.
+
+    class Pike
+    {
+    public:
+        Pike(const Prog &p, size_t slots) : p_(p), slots_(slots)
+        {
+            for (auto *l : {&a_, &b_})
+                l->sparse.assign(p.code.size(), 0);
+        }
+
+        bool run(std::string_view text, size_t from, std::vector<size_t> &caps)
+        {
+            const size_t n = text.size();
+            auto byteAt = [&](size_t i) -> int
+            { return i < n ? static_cast<unsigned char>(text[i]) : -1; };
+
+            List *cur = &a_, *next = &b_;
+            clear(*cur);
+            std::vector<size_t> scratch(slots_, npos);
+            add(*cur, p_.start, from, scratch, from > 0 ? byteAt(from - 1) : -1, byteAt(from));
+            bool matched = false;
+            for (size_t pos = from; !cur->threads.empty(); pos++)
+            {
+                clear(*next);
+                int c = byteAt(pos);
+                for (size_t t = 0; t < cur->threads.size(); t++)
+                {
+                    const Thread &th = cur->threads[t];
+                    const Inst &in = p_.code[th.pc];
+                    const size_t *tc = &cur->caps[t * slots_];
+                    if (in.op == OpMatch)
+                    {
+                        matched = true;
+                        caps.assign(tc, tc + slots_);
+                        break;
+                    }
+                    if (c >= 0 && p_.accepts(in, static_cast<unsigned>(c)))
+                    {
+                        scratch.assign(tc, tc + slots_);
+                        add(*next, th.pc + 1, pos + 1, scratch, c, byteAt(pos + 1));
+                    }
+                }
+                if (c < 0)
+                    break;
+                std::swap(cur, next);
+            }
+            return matched;
+        }
+
+    private:
+        struct Thread
+        {
+            int pc;
+        };
+
+        struct List
+        {
+            std::vector<int> dense;
+            std::vector<uint32_t> sparse;
+            std::vector<Thread> threads; // runnable pcs in priority order
+            std::vector<size_t> caps;    // slots_ per thread
+        };
+
+        struct Entry
+        {
+            int pc;
+            int slot; // >= 0: restore caps[slot] = value instead
+            size_t value;
+        };
+
+        static void clear(List &l)
+        {
+            l.dense.clear();
+            l.threads.clear();
+            l.caps.clear();
+        }
+
+        static bool seen(const List &l, int pc)
+        {
+            uint32_t i = l.sparse[pc];
+            return i < l.dense.size() && l.dense[i] == pc;
+        }
+
+        static bool visit(List &l, int pc)
+        {
+            if (seen(l, pc))
+                return false;
+            l.sparse[pc] = static_cast<uint32_t>(l.dense.size());
+            l.dense.push_back(pc);
+            return true;
+        }
+
+        // Follow empty transitions from pc at pos, depth first in priority
+        // order.  Save entries are undone on the way back out.
+        void add(List &l, int pc0, size_t pos, std::vector<size_t> &caps, int before, int after)
+        {
+            const uint8_t left = ctxOf(before), right = ctxOf(after);
+            stack_.clear();
+            stack_.push_back({pc0, -1, 0});
+            while (!stack_.empty())
+            {
+                Entry e = stack_.back();
+                stack_.pop_back();
+                if (e.slot >= 0)
+                {
+                    caps[e.slot] = e.value;
+                    continue;
+                }
+                const Inst &in = p_.code[e.pc];
+                // A loop's back edge is not deduplicated: a later, empty
+                // iteration arriving here must still be able to leave.
+                if (in.op == OpLoop)
+                {
+                    stack_.push_back({seen(l, in.x) ? in.y : in.x, -1, 0});
+                    continue;
+                }
+                if (!visit(l, e.pc))
+                    continue;
+                switch (in.op)
+                {
+                case OpJmp:
+                    stack_.push_back({in.x, -1, 0});
+                    break;
+                case OpSplit:
+                    stack_.push_back({in.y, -1, 0});
+                    stack_.push_back({in.x, -1, 0});
+                    break;
+                case OpSave:
+                    if (static_cast<size_t>(in.x) < slots_)
+                    {
+                        stack_.push_back({0, in.x, caps[in.x]});
+                        caps[in.x] = pos;
+                    }
+                    stack_.push_back({e.pc + 1, -1, 0});
+                    break;
+                case OpAssert:
+                    if (holds(in.arg, left, right))
+                        stack_.push_back({e.pc + 1, -1, 0});
+                    break;
+                default:
+                    l.threads.push_back({e.pc});
+                    l.caps.insert(l.caps.end(), caps.begin(), caps.end());
+                    break;
+                }
+            }
+        }
+
+        const Prog &p_;
+        size_t slots_;
+        List a_, b_;
+        std::vector<Entry> stack_;
+    };
+
+    // ─── Lazy DFA ────────────────────────────────────────────────────────────
+    // A state is the ordered list of NFA instructions reached after a byte
+    // (before following empty transitions) plus the kind of that byte.
+    // Transitions are computed the first time they are taken and cached in
+    // the state; when too many states pile up the cache is dropped and
+    // rebuilt, so memory stays bounded and the cost per byte stays
+    // proportional to the pattern.
+    //
+    // Leftmost-first mode drops every thread of lower priority than a match,
+    // which makes the last match position seen the end of the match a
+    // backtracking engine would choose.  Longest mode keeps them all; the
+    // reverse scan uses it to find the leftmost start.
+
+    class Dfa
+    {
+    public:
+        static constexpr int kEnd = 256; // pseudo-byte for the end of the text
+
+        Dfa(const Prog &p, bool reverse, bool longest)
+            : p_(p), reverse_(reverse), longest_(longest), mark_(p.code.size(), 0) {}
+
+        int start(uint8_t prevCtx)
+        {
+            if (!p_.hasAsserts)
+                prevCtx = 0;
+            if (starts_[prevCtx] < 0)
+            {
+                starts_[prevCtx] = intern({p_.start}, prevCtx);
+                states_[starts_[prevCtx]]->isStart = true;
+            }
+            return starts_[prevCtx];
+        }
+
+        // (next state << 1) | whether a match ends before byte c.
+        int32_t step(int s, int c)
+        {
+            int32_t v = states_[s]->next[c];
+            return v >= 0 ? v : compute(s, c);
+        }
+
+        bool dead(int s) const { return states_[s]->kernel.empty(); }
+        bool isStart(int s) const { return states_[s]->isStart; }
+
+        // For a start state: the one byte that leads anywhere else, so the
+        // scan can memchr to it; -1 when there are several.
+        int skipByte(int s)
+        {
+            State &st = *states_[s];
+            if (st.skip != -2)
+                return st.skip;
+            int found = -1, leaving = 0;
+            if (states_.size() + 256 < kMaxStates)
+            {
+                for (int c = 0; c < 256 && leaving < 2; c++)
+                {
+                    int32_t v = step(s, c);
+                    if ((v >> 1) != s || (v & 1))
+                    {
+                        found = c;
+                        leaving++;
+                    }
+                }
+            }
+            states_[s]->skip = leaving == 1 ? found : -1;
+            return states_[s]->skip;
+        }
+
+    private:
+        struct State
+        {
+            std::vector<int> kernel;
+            uint8_t prev = 0;
+            bool isStart = false;
+            int skip = -2;
+            int32_t next[257];
+        };
+
+        int intern(std::vector<int> kernel, uint8_t prev)
+        {
+            std::string key(reinterpret_cast<const char *>(kernel.data()), kernel.size() * sizeof(int));
+            key += static_cast<char>(prev);
+            auto it = index_.find(key);
+            if (it != index_.end())
+                return it->second;
+            auto st = std::make_unique<State>();
+            st->kernel = std::move(kernel);
+            st->prev = prev;
+            std::fill(std::begin(st->next), std::end(st->next), -1);
+            int id = static_cast<int>(states_.size());
+            states_.push_back(std::move(st));
+            index_.emplace(std::move(key), id);
+            return id;
+        }
+
+        // Follow empty transitions from the kernel in priority order;
+        // collects the byte-consuming instructions reached.
+        bool closure(const std::vector<int> &kernel, uint8_t left, uint8_t right)
+        {
+            if (++epoch_ == 0)
+            {
+                std::fill(mark_.begin(), mark_.end(), 0);
+                epoch_ = 1;
+            }
+            consumers_.clear();
+            bool matched = false;
+            for (int pc0 : kernel)
+            {
+                stack_.clear();
+                stack_.push_back(pc0);
+                while (!stack_.empty())
+                {
+                    int pc = stack_.back();
+                    stack_.pop_back();
+                    const Inst &in = p_.code[pc];
+                    if (in.op == OpLoop)
+                    {
+                        stack_.push_back(mark_[in.x] == epoch_ ? in.y : in.x);
+                        continue;
+                    }
+                    if (mark_[pc] == epoch_)
+                        continue;
+                    mark_[pc] = epoch_;
+                    switch (in.op)
+                    {
+                    case OpJmp:
+                        stack_.push_back(in.x);
+                        break;
+                    case OpSplit:
+                        stack_.push_back(in.y);
+                        stack_.push_back(in.x);
+                        break;
+                    case OpSave:
+                        stack_.push_back(pc + 1);
+                        break;
+                    case OpAssert:
+                        if (holds(in.arg, left, right))
+                            stack_.push_back(pc + 1);
+                        break;
+                    case OpMatch:
+                        matched = true;
+                        if (!longest_)
+                            return true;
+                        break;
+                    default:
+                        consumers_.push_back(pc);
+                        break;
+                    }
+                }
+            }
+            return matched;
+        }
+
+        int32_t compute(int s, int c)
+        {
+            if (states_.size() >= kMaxStates)
+            {
+                std::vector<int> kernel = states_[s]->kernel;
+                uint8_t prev = states_[s]->prev;
+                bool wasStart = states_[s]->isStart;
+                states_.clear();
+                index_.clear();
+                std::fill(std::begin(starts_), std::end(starts_), -1);
+                s = intern(std::move(kernel), prev);
+                if (wasStart)
+                {
+                    states_[s]->isStart = true;
+                    starts_[prev] = s;
+                }
+            }
+            const uint8_t prevCtx = states_[s]->prev;
+            const uint8_t nextCtx = c == kEnd ? uint8_t(CtxEdge) : ctxOf(c);
+            bool matched = closure(states_[s]->kernel, reverse_ ? nextCtx : prevCtx, reverse_ ? prevCtx : nextCtx);
+            if (c == kEnd)
+                return states_[s]->next[c] = matched ? 1 : 0;
+
+            std::vector<int> kernel;
+            for (int pc : consumers_)
+                if (p_.accepts(p_.code[pc], static_cast<unsigned>(c)))
+                    kernel.push_back(pc + 1);
+            if (longest_)
+            {
+                std::sort(kernel.begin(), kernel.end());
+                kernel.erase(std::unique(kernel.begin(), kernel.end()), kernel.end());
+            }
+            int t = intern(std::move(kernel), p_.hasAsserts ? ctxOf(c) : 0);
+            return states_[s]->next[c] = (t << 1) | (matched ? 1 : 0);
+        }
+
+        const Prog &p_;
+        bool reverse_;
+        bool longest_;
+        std::vector<std::unique_ptr<State>> states_;
+        std::unordered_map<std::string, int> index_;
+        int starts_[4] = {-1, -1, -1, -1};
+        std::vector<uint32_t> mark_;
+        uint32_t epoch_ = 0;
+        std::vector<int> stack_;
+        std::vector<int> consumers_;
+    };
+
+    // End of the match starting at or after from (leftmost-first), or npos.
+    // earliest returns as soon as any match is known to end.
+    size_t scanForward(Dfa &d, std::string_view text, size_t from, bool earliest)
+    {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(text.data());
+        const size_t n = text.size();
+        int s = d.start(ctxOf(from > 0 ? p[from - 1] : -1));
+        size_t last = npos;
+        for (size_t i = from; i < n; i++)
+        {
+            if (d.isStart(s))
+            {
+                int b = d.skipByte(s);
+                if (b >= 0)
+                {
+                    const void *q = std::memchr(p + i, b, n - i);
+                    if (!q)
+                        break;
+                    i = static_cast<size_t>(static_cast<const uint8_t *>(q) - p);
+                }
+            }
+            int32_t v = d.step(s, p[i]);
+            if (v & 1)
+            {
+                last = i;
+                if (earliest)
+                    return last;
+            }
+            s = v >> 1;
+            if (d.dead(s))
+                return last;
+        }
+        if (d.step(s, Dfa::kEnd) & 1)
+            last = n;
+        return last;
+    }
+
+    // Leftmost start, not before from, of a match ending at end.
+    size_t scanReverse(Dfa &d, std::string_view text, size_t end, size_t from)
+    {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(text.data());
+        int s = d.start(ctxOf(end < text.size() ? p[end] : -1));
+        size_t best = npos;
+        for (size_t i = end; i > from; i--)
+        {
+            int32_t v = d.step(s, p[i - 1]);
+            if (v & 1)
+                best = i;
+            s = v >> 1;
+            if (d.dead(s))
+                return best;
+        }
+        if (d.step(s, from > 0 ? p[from - 1] : Dfa::kEnd) & 1)
+            best = from;
+        return best;
+    }
+}
+
+namespace rx
+{
+    struct Regex::Impl
+    {
+        std::string pattern;
+        unsigned flags = 0;
+        size_t groups = 0;
+        std::vector<std::string> names;
+
+        Node root;
+        std::unique_ptr<Prog> progs[kProgKinds];
+        std::unique_ptr<Dfa> dfas[kProgKinds];
+        std::unique_ptr<Pike> pikes[kProgKinds];
+
+        std::unique_ptr<std::regex> fallback;
+
+        const Prog &prog(ProgKind k)
+        {
+            if (!progs[k])
+                progs[k] = buildProg(root, k);
+            return *progs[k];
+        }
+
+        Dfa &dfa(ProgKind k)
+        {
+            if (!dfas[k])
+                dfas[k] = std::make_unique<Dfa>(prog(k), k == Reverse, k == Reverse);
+            return *dfas[k];
+        }
+
+        Pike &pike(ProgKind k)
+        {
+            if (!pikes[k])
+                pikes[k] = std::make_unique<Pike>(prog(k), 2 * (groups + 1));
+            return *pikes[k];
+        }
+
+        bool execFallback(std::string_view text, size_t from, Anchor anchor, std::vector<Span> *out)
+        {
+            auto mf = std::regex_constants::match_default;
+            if (from > 0)
+                mf |= std::regex_constants::match_prev_avail;
+            const char *b = text.data() + from, *e = text.data() + text.size();
+            std::cmatch m;
+            bool ok;
+            if (anchor == Anchor::Both)
+                ok = std::regex_match(b, e, m, *fallback, mf);
+            else
+            {
+                if (anchor == Anchor::Start)
+                    mf |= std::regex_constants::match_continuous;
+                ok = std::regex_search(b, e, m, *fallback, mf);
+            }
+            if (!ok || !out)
+                return ok;
+            out->assign(groups + 1, Span());
+            for (size_t g = 0; g < m.size() && g <= groups; g++)
+                if (m[g].matched)
+                    (*out)[g] = {static_cast<size_t>(m[g].first - text.data()),
+                                 static_cast<size_t>(m[g].second - text.data())};
+            return true;
+        }
+    };
+
+    Regex::Regex() : impl_(std::make_unique<Impl>()) {}
+    Regex::~Regex() = default;
+
+    std::shared_ptr<Regex> Regex::compile(std::string_view pattern, unsigned flags, std::string &error)
+    {
+        std::shared_ptr<Regex> re(new Regex());
+        Impl &im = *re->impl_;
+        im.pattern = std::string(pattern);
+        im.flags = flags;
+        try
+        {
+            Parser parser(pattern, flags);
+            im.root = parser.parse();
+            im.groups = static_cast<size_t>(parser.groups);
+            im.names = std::move(parser.names);
+            // Expand repeats now so an oversized pattern fails here rather
+            // than at its first search.
+            im.prog(Anchored);
+        }
+        catch (const SyntaxError &e)
+        {
+            error = e.message;
+            return nullptr;
+        }
+        catch (const NeedsBacktracking &)
+        {
+            auto syntax = std::regex::ECMAScript;
+            if (flags & IgnoreCase)
+                syntax |= std::regex::icase;
+            if (flags & Multiline)
+                syntax |= std::regex::multiline;
+            try
+            {
+                im.fallback = std::make_unique<std::regex>(im.pattern, syntax);
+            }
+            catch (const std::regex_error &e)
+            {
+                error = e.what();
+                return nullptr;
+            }
+            im.groups = im.fallback->mark_count();
+            im.names.assign(im.groups + 1, "");
+        }
+        return re;
+    }
+
+    bool Regex::exec(std::string_view text, size_t from, Anchor anchor, std::vector<Span> *groups)
+    {
+        Impl &im = *impl_;
+        if (from > text.size())
+            return false;
+        if (im.fallback)
+            return im.execFallback(text, from, anchor, groups);
+
+        size_t start = from, end;
+        if (anchor == Anchor::None)
+        {
+            end = scanForward(im.dfa(Unanchored), text, from, false);
+            if (end == npos)
+                return false;
+            start = scanReverse(im.dfa(Reverse), text, end, from);
+            if (start == npos)
+                return false;
+        }
+        else
+        {
+            end = scanForward(im.dfa(anchor == Anchor::Both ? Full : Anchored), text, from, false);
+            if (end == npos)
+                return false;
+        }
+        if (!groups)
+            return true;
+
+        groups->assign(im.groups + 1, Span());
+        (*groups)[0] = {start, end};
+        if (im.groups == 0)
+            return true;
+        // The DFAs fixed the span; the Pike VM only fills in the groups.
+        std::vector<size_t> caps;
+        if (im.pike(anchor == Anchor::Both ? Full : Anchored).run(text, start, caps))
+        {
+            for (size_t g = 1; g <= im.groups; g++)
+                if (caps[2 * g] != npos && caps[2 * g + 1] != npos)
+                    (*groups)[g] = {caps[2 * g], caps[2 * g + 1]};
+        }
+        return true;
+    }
+
+    bool Regex::test(std::string_view text, size_t from)
+    {
+        Impl &im = *impl_;
+        if (from > text.size())
+            return false;
+        if (im.fallback)
+            return im.execFallback(text, from, Anchor::None, nullptr);
+        return scanForward(im.dfa(Unanchored), text, from, true) != npos;
+    }
+
+    size_t Regex::firstEnd(std::string_view text, size_t from)
+    {
+        Impl &im = *impl_;
+        if (from > text.size())
+            return npos;
+        if (im.fallback)
+        {
+            std::vector<Span> g;
+            return im.execFallback(text, from, Anchor::None, &g) ? g[0].end : npos;
+        }
+        return scanForward(im.dfa(Unanchored), text, from, true);
+    }
+
+    const std::string &Regex::pattern() const { return impl_->pattern; }
+    unsigned Regex::flags() const { return impl_->flags; }
+    size_t Regex::groupCount() const { return impl_->groups; }
+    const std::vector<std::string> &Regex::groupNames() const { return impl_->names; }
+    const char *Regex::engine() const { return impl_->fallback ? "backtrack" : "dfa"; }
+
+    // ─── Cache ───────────────────────────────────────────────────────────────
+
+    namespace
+    {
+        struct Cache
+        {
+            using Entry = std::pair<std::string, std::shared_ptr<Regex>>;
+            std::list<Entry> order; // most recent first
+            std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        };
+
+        Cache &cache()
+        {
+            thread_local Cache c;
+            return c;
+        }
+    }
+
+    std::shared_ptr<Regex> cached(std::string_view pattern, unsigned flags, std::string &error)
+    {
+        Cache &c = cache();
+        std::string key(1, static_cast<char>('0' + flags));
+        key.append(pattern.data(), pattern.size());
+        auto it = c.index.find(key);
+        if (it != c.index.end())
+        {
+            c.order.splice(c.order.begin(), c.order, it->second);
+            return it->second->second;
+        }
+        auto re = Regex::compile(pattern, flags, error);
+        if (!re)
+            return nullptr;
+        c.order.emplace_front(key, re);
+        c.index[key] = c.order.begin();
+        if (c.order.size() > kCacheEntries)
+        {
+            c.index.erase(c.order.back().first);
+            c.order.pop_back();
+        }
+        return re;
+    }
+
+    void purgeCache()
+    {
+        cache().order.clear();
+        cache().index.clear();
+    }
+
+    size_t cacheSize() { return cache().order.size(); }
+
+    bool parseFlags(std::string_view letters, unsigned &out)
+    {
+        out = 0;
+        for (char c : letters)
+        {
+            switch (c)
+            {
+            case 'i':
+                out |= IgnoreCase;
+                break;
+            case 'm':
+                out |= Multiline;
+                break;
+            case 's':
+                out |= DotAll;
+                break;
+            case 'g':
+            case 'u':
+                break;
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+}
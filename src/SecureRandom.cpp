@@ -0,0 +1,256 @@
+#include "SecureRandom.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+// RtlGenRandom, exported from advapi32 under this name.
+extern "C" BOOLEAN NTAPI SystemFunction036(PVOID buffer, ULONG length);
+#else
+#include <mutex>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+#endif
+
+namespace
+{
+    // Bumped in every forked child; a generator whose snapshot differs has
+    // been duplicated and must not repeat its parent's stream.
+    std::atomic<unsigned> g_forkGeneration{0};
+
+#ifndef _WIN32
+    void watchForks()
+    {
+        static std::once_flag once;
+        std::call_once(once, []
+                       { pthread_atfork(nullptr, nullptr, []
+                                        { g_forkGeneration.fetch_add(1, std::memory_order_relaxed); }); });
+    }
+#endif
+
+    inline uint32_t rotl(uint32_t x, int n)
+    {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    // Four ChaCha20 blocks at once (original layout: 64-bit counter, 64-bit
+    // nonce).  Each state word is a 4-lane array, so the rounds compile to
+    // plain SIMD adds, xors and shifts.
+    void chachaBlocks4(const uint32_t key[8], const uint32_t nonce[2], uint64_t counter, uint8_t out[256])
+    {
+        uint32_t in[16][4], x[16][4];
+        const uint32_t fixed[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+                                    key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+                                    0, 0, nonce[0], nonce[1]};
+        for (int w = 0; w < 16; w++)
+            for (int l = 0; l < 4; l++)
+                in[w][l] = fixed[w];
+        for (int l = 0; l < 4; l++)
+        {
+            in[12][l] = static_cast<uint32_t>(counter + l);
+            in[13][l] = static_cast<uint32_t>((counter + l) >> 32);
+        }
+        std::memcpy(x, in, sizeof(x));
+
+        auto qr = [&x](int a, int b, int c, int d)
+        {
+            for (int l = 0; l < 4; l++)
+            {
+                x[a][l] += x[b][l];
+                x[d][l] = rotl(x[d][l] ^ x[a][l], 16);
+                x[c][l] += x[d][l];
+                x[b][l] = rotl(x[b][l] ^ x[c][l], 12);
+                x[a][l] += x[b][l];
+                x[d][l] = rotl(x[d][l] ^ x[a][l], 8);
+                x[c][l] += x[d][l];
+                x[b][l] = rotl(x[b][l] ^ x[c][l], 7);
+            }
+        };
+        for (int i = 0; i < 10; i++)
+        {
+            qr(0, 4, 8, 12);
+            qr(1, 5, 9, 13);
+            qr(2, 6, 10, 14);
+            qr(3, 7, 11, 15);
+            qr(0, 5, 10, 15);
+            qr(1, 6, 11, 12);
+            qr(2, 7, 8, 13);
+            qr(3, 4, 9, 14);
+        }
+        for (int l = 0; l < 4; l++)
+            for (int w = 0; w < 16; w++)
+            {
+                uint32_t v = x[w][l] + in[w][l];
+                uint8_t *o = out + 64 * l + 4 * w;
+                o[0] = uint8_t(v);
+                o[1] = uint8_t(v >> 8);
+                o[2] = uint8_t(v >> 16);
+                o[3] = uint8_t(v >> 24);
+            }
+    }
+
+    inline uint32_t load32(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+
+    // Zeroing that the optimiser may not drop.
+    void wipe(void *p, size_t n)
+    {
+#ifdef _WIN32
+        SecureZeroMemory(p, n);
+#else
+        std::memset(p, 0, n);
+        __asm__ __volatile__("" : : "r"(p) : "memory");
+#endif
+    }
+}
+
+bool SecureRandom::systemEntropy(void *out, size_t len)
+{
+    uint8_t *p = static_cast<uint8_t *>(out);
+#ifdef _WIN32
+    while (len)
+    {
+        ULONG n = len > 0x10000 ? 0x10000 : static_cast<ULONG>(len);
+        if (!SystemFunction036(p, n))
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+#else
+#if defined(__linux__)
+    while (len)
+    {
+        ssize_t n = getrandom(p, len, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break; // ENOSYS on old kernels: fall through to /dev/urandom
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+#elif defined(__APPLE__) || defined(__OpenBSD__) || defined(__FreeBSD__)
+    while (len)
+    {
+        size_t n = len > 256 ? 256 : len; // getentropy's limit per call
+        if (getentropy(p, n) != 0)
+            break;
+        p += n;
+        len -= n;
+    }
+#endif
+    if (!len)
+        return true;
+    FILE *f = std::fopen("/dev/urandom", "rb");
+    if (!f)
+        return false;
+    size_t got = std::fread(p, 1, len, f);
+    std::fclose(f);
+    return got == len;
+#endif
+}
+
+SecureRandom::SecureRandom()
+{
+#ifndef _WIN32
+    watchForks();
+#endif
+    seed();
+}
+
+SecureRandom::~SecureRandom()
+{
+    wipe(key_, sizeof(key_));
+    wipe(nonce_, sizeof(nonce_));
+    wipe(buf_, sizeof(buf_));
+}
+
+void SecureRandom::seed()
+{
+    uint8_t fresh[40];
+    if (!systemEntropy(fresh, sizeof(fresh)))
+        throw std::runtime_error("secure random: no OS entropy source available");
+    // Mixed into, not replacing, the current key: a reseed can only add
+    // entropy.
+    for (int i = 0; i < 8; i++)
+        key_[i] ^= load32(fresh + 4 * i);
+    nonce_[0] ^= load32(fresh + 32);
+    nonce_[1] ^= load32(fresh + 36);
+    wipe(fresh, sizeof(fresh));
+    wipe(buf_, sizeof(buf_));
+    avail_ = 0;
+    sinceSeed_ = 0;
+    forkGen_ = g_forkGeneration.load(std::memory_order_relaxed);
+}
+
+void SecureRandom::refill()
+{
+    if (sinceSeed_ >= kReseedBytes || forkGen_ != g_forkGeneration.load(std::memory_order_relaxed))
+        seed();
+    for (size_t i = 0; i < kBuffer / 256; i++)
+        chachaBlocks4(key_, nonce_, 4 * i, buf_ + 256 * i);
+    // Fast key erasure: the head of the block becomes the next key.
+    for (int i = 0; i < 8; i++)
+        key_[i] = load32(buf_ + 4 * i);
+    nonce_[0] = load32(buf_ + 32);
+    nonce_[1] = load32(buf_ + 36);
+    wipe(buf_, 40);
+    avail_ = kBuffer - 40;
+    sinceSeed_ += avail_;
+}
+
+void SecureRandom::fill(void *out, size_t len)
+{
+    uint8_t *p = static_cast<uint8_t *>(out);
+    if (forkGen_ != g_forkGeneration.load(std::memory_order_relaxed))
+        avail_ = 0; // buffered bytes are shared with the parent
+    while (len)
+    {
+        if (!avail_)
+            refill();
+        size_t n = len < avail_ ? len : avail_;
+        uint8_t *src = buf_ + kBuffer - avail_;
+        std::memcpy(p, src, n);
+        wipe(src, n);
+        avail_ -= n;
+        p += n;
+        len -= n;
+    }
+}
+
+uint64_t SecureRandom::next64()
+{
+    uint64_t v;
+    fill(&v, sizeof(v));
+    return v;
+}
+
+uint64_t SecureRandom::below(uint64_t bound)
+{
+    if (bound == 0)
+        return next64();
+    // Reject the top sliver that would bias the modulo.
+    const uint64_t limit = -bound % bound; // == 2^64 mod bound
+    for (;;)
+    {
+        uint64_t v = next64();
+        if (v >= limit)
+            return v % bound;
+    }
+}
+
+int64_t SecureRandom::between(int64_t lo, int64_t hi)
+{
+    uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1; // 0 = full range
+    return static_cast<int64_t>(static_cast<uint64_t>(lo) + below(span));
+}
@@ -1,6 +1,7 @@
 #include "../include/Value.h"
 #include "../include/Vm.h"
 #include "../include/Error.h"
+#include "../include/Number.h"
 #include <sstream>
 #include <cmath>
 #include <iomanip>
@@ -19,6 +20,7 @@ bool QuantumValue::isTruthy() const
         if constexpr (std::is_same_v<T, std::string>)   return !v.empty() && !(v.size() == 1 && v[0] == '\0');
         if constexpr (std::is_same_v<T, std::shared_ptr<Array>>) return !v->empty();
         if constexpr (std::is_same_v<T, std::shared_ptr<QuantumPointer>>) return v && !v->isNull();
+        if constexpr (std::is_same_v<T, std::shared_ptr<QuantumBytes>>) return v->size() != 0;
         return true; }, data);
 }
 
@@ -29,13 +31,7 @@ std::string QuantumValue::toString() const
         using T = std::decay_t<decltype(v)>;
         if constexpr (std::is_same_v<T, QuantumNil>)  return "nil";
         if constexpr (std::is_same_v<T, bool>)        return v ? "true" : "false";
-        if constexpr (std::is_same_v<T, double>) {
-            if (std::floor(v) == v && std::abs(v) < 1e15)
-                return std::to_string((long long)v);
-            std::ostringstream oss;
-            oss << std::setprecision(10) << v;
-            return oss.str();
-        }
+        if constexpr (std::is_same_v<T, double>)      return number::format(v);
         if constexpr (std::is_same_v<T, std::string>) return v;
         if constexpr (std::is_same_v<T, std::shared_ptr<Array>>) {
             std::string s = "[";
@@ -83,6 +79,7 @@ std::string QuantumValue::toString() const
                 << (reinterpret_cast<uintptr_t>(v->cell.get()) + (size_t)v->offset * 8);
             return oss.str();
         }
+        if constexpr (std::is_same_v<T, std::shared_ptr<QuantumBytes>>) return std::string(v->view());
         return "?"; }, data);
 }
 
@@ -103,9 +100,20 @@ std::string QuantumValue::typeName() const
         if constexpr (std::is_same_v<T, std::shared_ptr<QuantumClass>>)    return "class";
         if constexpr (std::is_same_v<T, std::shared_ptr<QuantumBoundMethod>>) return "method";
         if constexpr (std::is_same_v<T, std::shared_ptr<QuantumPointer>>)  return "pointer";
+        if constexpr (std::is_same_v<T, std::shared_ptr<QuantumBytes>>)    return "bytes";
         return "unknown"; }, data);
 }
 
+std::string_view QuantumValue::bytesView(std::string &scratch) const
+{
+    if (auto *s = std::get_if<std::string>(&data))
+        return *s;
+    if (auto *b = std::get_if<std::shared_ptr<QuantumBytes>>(&data))
+        return (*b)->view();
+    scratch = toString();
+    return scratch;
+}
+
 // ─── Environment ─────────────────────────────────────────────────────────────
 
 Environment::Environment(std::shared_ptr<Environment> p) : parent(std::move(p)) {}
@@ -25,10 +25,16 @@ void Compiler::compileVarDecl(VarDecl &s, int line)
 
 void Compiler::compileFunctionDecl(FunctionDecl &s, int line)
 {
+    // @a @b fn f() binds f = a(b(f)); as in Python the decorator
+    // expressions are evaluated first, top to bottom.
+    for (auto &decorator : s.decorators)
+        compileExpr(*decorator);
     auto fnChunk = compileFunction(s.name, s.params, s.paramIsRef, s.defaultArgs, s.body.get(), line);
     auto closureTpl = std::make_shared<Closure>(fnChunk);
     emit(Op::LOAD_CONST, addConst(QuantumValue(closureTpl)), line);
     emit(fnChunk->upvalueCount > 0 ? Op::MAKE_CLOSURE : Op::MAKE_FUNCTION, 0, line);
+    for (size_t i = 0; i < s.decorators.size(); i++)
+        emit(Op::CALL, 1, line);
     if (current_->scopeDepth == 0)
     {
         emit(Op::DEFINE_GLOBAL, addStr(s.name), line);
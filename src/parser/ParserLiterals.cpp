@@ -1,4 +1,5 @@
 #include "Parser.h"
+#include "Number.h"
 #include <sstream>
 #include <unordered_set>
 #include <cctype>
@@ -13,8 +14,8 @@ ASTNodePtr Parser::parsePrimary()
         double v;
         if (tok.value.size() > 1 && tok.value[1] == 'x')
             v = (double)std::stoull(tok.value, nullptr, 16);
-        else
-            v = std::stod(tok.value);
+        else if (!number::parse(tok.value, v))
+            throw ParseError("Invalid number literal '" + tok.value + "'", tok.line, tok.col);
         consume();
         if (check(TokenType::IDENTIFIER) &&
             (current().value == "f" || current().value == "F" ||
@@ -1,4 +1,5 @@
 #include "Parser.h"
+#include "Number.h"
 #include <sstream>
 #include <unordered_set>
 #include <cctype>
@@ -7,29 +8,30 @@ ASTNodePtr Parser::parseStatement()
 {
     skipNewlines();
 
-    // Skip Python-style decorators (e.g. @property, @dataclass)
-    while (check(TokenType::DECORATOR))
+    // Python-style decorators.  On a function they are kept and applied
+    // when it is defined; on anything else, and markers such as @property
+    // or @dataclass that mean nothing here, they are skipped.
+    if (check(TokenType::DECORATOR))
     {
-        consume(); // eat @
-        if (check(TokenType::IDENTIFIER))
+        static const std::unordered_set<std::string> markers = {
+            "property", "staticmethod", "classmethod", "dataclass", "abstractmethod", "override", "overload"};
+        std::vector<ASTNodePtr> decorators;
+        while (check(TokenType::DECORATOR))
         {
-            consume(); // eat decorator name
-            // Optional call parens e.g. @decorator(args)
-            if (check(TokenType::LPAREN))
+            consume(); // eat @
+            if (check(TokenType::IDENTIFIER))
             {
-                consume(); // eat (
-                int depth = 1;
-                while (!atEnd() && depth > 0)
-                {
-                    if (check(TokenType::LPAREN))
-                        depth++;
-                    else if (check(TokenType::RPAREN))
-                        depth--;
-                    consume();
-                }
+                bool marker = markers.count(current().value) > 0;
+                auto decorator = parsePostfix(); // name, name.attr or name(args)
+                if (!marker)
+                    decorators.push_back(std::move(decorator));
             }
+            skipNewlines();
         }
-        skipNewlines();
+        auto stmt = parseStatement();
+        if (stmt && stmt->is<FunctionDecl>())
+            stmt->as<FunctionDecl>().decorators = std::move(decorators);
+        return stmt;
     }
 
     int ln = current().line;
@@ -450,7 +452,11 @@ ASTNodePtr Parser::parseStatement()
                             consume();
                         }
                         if (check(TokenType::NUMBER))
-                            eVal = std::stod(consume().value) * (neg ? -1 : 1);
+                        {
+                            double d = 0;
+                            number::parse(consume().value, d);
+                            eVal = d * (neg ? -1 : 1);
+                        }
                         else if (check(TokenType::IDENTIFIER))
                         {
                             // reference to a previously defined enumerator
@@ -223,6 +223,8 @@ QuantumValue VM::callArrayMethod(std::shared_ptr<Array> arr, const std::string &
             runFrame(depth);
             return pop();
         }
+        if (fn.isDict() && fn.asDict()->count("__call__"))
+            return callFunction(fn, std::move(fnArgs));
         throw TypeError("map/filter/reduce: callback is not callable");
     };
 
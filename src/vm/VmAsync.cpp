@@ -0,0 +1,345 @@
+#include "Vm.h"
+#include "Error.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Calling script functions from native code ───────────────────────────────
+
+QuantumValue VM::callFunction(const QuantumValue &fn, std::vector<QuantumValue> args)
+{
+    if (fn.isNative())
+        return fn.asNative()->fn(args);
+    if (fn.isDict())
+    {
+        // Callable objects such as memoize() wrappers.
+        auto it = fn.asDict()->find("__call__");
+        if (it != fn.asDict()->end())
+            return callFunction(it->second, std::move(args));
+    }
+
+    // Callbacks may declare fewer parameters than they are passed; surplus
+    // arguments would otherwise land in the callee's local slots.
+    auto fit = [&args](const std::shared_ptr<Closure> &c, size_t selfSlots)
+    {
+        size_t max = c->chunk->params.size() > selfSlots ? c->chunk->params.size() - selfSlots : 0;
+        if (args.size() > max)
+            args.resize(max);
+    };
+
+    size_t savedFrames = frames_.size();
+    size_t savedStack = stack_.size();
+    // Each call runs on its own step budget, so event-loop callbacks (server
+    // handlers above all) are not charged for every callback before them.
+    // The caller's count resumes once the call returns.
+    long long savedSteps = stepCount_;
+    stepCount_ = 0;
+    try
+    {
+        if (fn.isFunction())
+        {
+            fit(fn.asFunction(), 0);
+            push(fn);
+            for (auto &arg : args)
+                push(arg);
+            callClosure(fn.asFunction(), static_cast<int>(args.size()), 0);
+            runFrame(frames_.size() - 1);
+            stepCount_ = savedSteps;
+            return pop();
+        }
+        if (fn.isBoundMethod())
+        {
+            auto bm = fn.asBoundMethod();
+            fit(bm->method, 1);
+            push(fn);
+            push(bm->self);
+            for (auto &arg : args)
+                push(arg);
+            callClosure(bm->method, static_cast<int>(args.size()) + 1, 0);
+            runFrame(frames_.size() - 1);
+            stepCount_ = savedSteps;
+            return pop();
+        }
+    }
+    catch (...)
+    {
+        // Leave the VM as it was before the call so the caller can recover.
+        while (frames_.size() > savedFrames)
+            frames_.pop_back();
+        while (stack_.size() > savedStack)
+            stack_.pop_back();
+        stepCount_ = savedSteps;
+        throw;
+    }
+    stepCount_ = savedSteps;
+    throw TypeError("Value is not callable: " + fn.typeName());
+}
+
+// ─── Event loop ──────────────────────────────────────────────────────────────
+
+EventLoop &VM::eventLoop()
+{
+    if (!loop_)
+        loop_ = std::make_unique<EventLoop>();
+    return *loop_;
+}
+
+void VM::drainEventLoop()
+{
+    while (loop_ && loop_->hasPending())
+        loop_->runOnce(-1);
+}
+
+// ─── Promises ────────────────────────────────────────────────────────────────
+// A promise is a dict exposing then / catch / finally plus an __await__ native
+// used by await().  Reactions attached to an already-settled promise run
+// immediately, matching the synchronous behaviour of the existing natives.
+
+namespace
+{
+    bool isPromise(const QuantumValue &v)
+    {
+        if (!v.isDict())
+            return false;
+        auto d = v.asDict();
+        auto it = d->find("__await__");
+        return it != d->end() && it->second.isNative();
+    }
+}
+
+QuantumValue VM::makePromise(const std::shared_ptr<PromiseState> &state)
+{
+    auto promise = std::make_shared<Dict>();
+    auto method = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "Promise." + name;
+        nat->fn = std::move(fn);
+        (*promise)[name] = QuantumValue(nat);
+    };
+
+    // Settles `next` from the result of a reaction, adopting returned promises.
+    auto resolveWith = [this](std::shared_ptr<PromiseState> next, QuantumValue result)
+    {
+        if (!isPromise(result))
+        {
+            settlePromise(next, std::move(result), false);
+            return;
+        }
+        auto onFul = std::make_shared<QuantumNative>();
+        onFul->name = "Promise.adopt";
+        onFul->fn = [this, next](std::vector<QuantumValue> a) -> QuantumValue
+        {
+            settlePromise(next, a.empty() ? QuantumValue() : a[0], false);
+            return QuantumValue();
+        };
+        auto onRej = std::make_shared<QuantumNative>();
+        onRej->name = "Promise.adopt";
+        onRej->fn = [this, next](std::vector<QuantumValue> a) -> QuantumValue
+        {
+            settlePromise(next, a.empty() ? QuantumValue() : a[0], true);
+            return QuantumValue();
+        };
+        callFunction((*result.asDict())["then"], {QuantumValue(onFul), QuantumValue(onRej)});
+    };
+
+    auto chain = [this, state, resolveWith](QuantumValue onFulfilled, QuantumValue onRejected, bool passThrough) -> QuantumValue
+    {
+        auto next = std::make_shared<PromiseState>();
+        auto reaction = [this, state, next, onFulfilled, onRejected, passThrough, resolveWith]()
+        {
+            bool rejected = state->status == PromiseState::Status::Rejected;
+            const QuantumValue &handler = rejected ? onRejected : onFulfilled;
+            if (handler.isNil())
+            {
+                settlePromise(next, state->value, rejected);
+                return;
+            }
+            try
+            {
+                QuantumValue r = callFunction(handler, passThrough ? std::vector<QuantumValue>{} : std::vector<QuantumValue>{state->value});
+                if (passThrough)
+                    settlePromise(next, state->value, rejected);
+                else
+                    resolveWith(next, std::move(r));
+            }
+            catch (std::exception &e)
+            {
+                settlePromise(next, QuantumValue(std::string(e.what())), true);
+            }
+        };
+        if (state->status == PromiseState::Status::Pending)
+            state->reactions.push_back(reaction);
+        else
+            reaction();
+        return makePromise(next);
+    };
+
+    method("then", [chain](std::vector<QuantumValue> args) -> QuantumValue
+           { return chain(args.size() > 0 ? args[0] : QuantumValue(),
+                          args.size() > 1 ? args[1] : QuantumValue(), false); });
+    method("catch", [chain](std::vector<QuantumValue> args) -> QuantumValue
+           { return chain(QuantumValue(), args.empty() ? QuantumValue() : args[0], false); });
+    method("finally", [chain](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        QuantumValue cb = args.empty() ? QuantumValue() : args[0];
+        return chain(cb, cb, true); });
+
+    method("__await__", [this, state](std::vector<QuantumValue>) -> QuantumValue
+           {
+        while (state->status == PromiseState::Status::Pending)
+        {
+            if (!loop_ || !loop_->hasPending())
+                throw RuntimeError("await: promise can never settle (nothing pending)");
+            loop_->runOnce(-1);
+        }
+        if (state->status == PromiseState::Status::Rejected)
+            throw RuntimeError(state->value.toString());
+        return state->value; });
+
+    return QuantumValue(promise);
+}
+
+void VM::settlePromise(const std::shared_ptr<PromiseState> &state, QuantumValue value, bool rejected)
+{
+    if (state->status != PromiseState::Status::Pending)
+        return;
+    state->status = rejected ? PromiseState::Status::Rejected : PromiseState::Status::Fulfilled;
+    state->value = std::move(value);
+    auto reactions = std::move(state->reactions);
+    state->reactions.clear();
+    for (auto &r : reactions)
+        r();
+}
+
+QuantumValue VM::awaitValue(const QuantumValue &value)
+{
+    if (!isPromise(value))
+        return value;
+    return (*value.asDict())["__await__"].asNative()->fn({});
+}
+
+QuantumValue VM::startAsync(std::function<AsyncResult()> work, QuantumValue callback)
+{
+    auto state = std::make_shared<PromiseState>();
+    if (!callback.isNil())
+    {
+        // Attached here, on the VM thread, so no script value crosses threads.
+        state->reactions.push_back([this, state, callback]()
+                                   {
+            bool rejected = state->status == PromiseState::Status::Rejected;
+            if (rejected)
+                callFunction(callback, {state->value, QuantumValue()});
+            else
+                callFunction(callback, {QuantumValue(), state->value}); });
+    }
+
+    eventLoop().submit([this, work = std::move(work), state]() -> EventLoop::Task
+                       {
+        AsyncResult result;
+        std::string error;
+        try
+        {
+            result = work();
+        }
+        catch (std::exception &e)
+        {
+            error = e.what();
+            if (error.empty())
+                error = "async operation failed";
+        }
+        return [this, state, result, error]()
+        {
+            if (!error.empty())
+            {
+                settlePromise(state, QuantumValue(error), true);
+                return;
+            }
+            QuantumValue value;
+            try
+            {
+                value = result ? result() : QuantumValue();
+            }
+            catch (std::exception &e)
+            {
+                settlePromise(state, QuantumValue(std::string(e.what())), true);
+                return;
+            }
+            settlePromise(state, std::move(value), false);
+        }; });
+
+    return makePromise(state);
+}
+
+// ─── Promise global ──────────────────────────────────────────────────────────
+
+void VM::registerAsyncNatives()
+{
+    auto promiseDict = std::make_shared<Dict>();
+    auto method = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "Promise." + name;
+        nat->fn = std::move(fn);
+        (*promiseDict)[name] = QuantumValue(nat);
+    };
+
+    method("resolve", [this](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        QuantumValue v = args.empty() ? QuantumValue() : args[0];
+        if (isPromise(v))
+            return v;
+        auto state = std::make_shared<PromiseState>();
+        settlePromise(state, v, false);
+        return makePromise(state); });
+
+    method("reject", [this](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        auto state = std::make_shared<PromiseState>();
+        settlePromise(state, args.empty() ? QuantumValue() : args[0], true);
+        return makePromise(state); });
+
+    // Promise.all(array) — fulfils with an array of results in input order,
+    // or rejects with the first rejection.
+    method("all", [this](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        if (args.empty() || !args[0].isArray())
+            throw RuntimeError("Promise.all() requires an array");
+        auto items = args[0].asArray();
+        auto state = std::make_shared<PromiseState>();
+        auto results = std::make_shared<Array>(items->size());
+        auto remaining = std::make_shared<size_t>(items->size());
+        if (items->empty())
+            settlePromise(state, QuantumValue(results), false);
+        for (size_t i = 0; i < items->size(); ++i)
+        {
+            QuantumValue item = (*items)[i];
+            if (!isPromise(item))
+            {
+                (*results)[i] = item;
+                if (--*remaining == 0)
+                    settlePromise(state, QuantumValue(results), false);
+                continue;
+            }
+            auto onFul = std::make_shared<QuantumNative>();
+            onFul->name = "Promise.all.item";
+            onFul->fn = [this, state, results, remaining, i](std::vector<QuantumValue> a) -> QuantumValue
+            {
+                (*results)[i] = a.empty() ? QuantumValue() : a[0];
+                if (--*remaining == 0)
+                    settlePromise(state, QuantumValue(results), false);
+                return QuantumValue();
+            };
+            auto onRej = std::make_shared<QuantumNative>();
+            onRej->name = "Promise.all.item";
+            onRej->fn = [this, state](std::vector<QuantumValue> a) -> QuantumValue
+            {
+                settlePromise(state, a.empty() ? QuantumValue() : a[0], true);
+                return QuantumValue();
+            };
+            callFunction((*item.asDict())["then"], {QuantumValue(onFul), QuantumValue(onRej)});
+        }
+        return makePromise(state); });
+
+    globals->define("Promise", QuantumValue(promiseDict));
+}
@@ -0,0 +1,291 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Codec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Bytes methods ────────────────────────────────────────────────────────────
+// slice() and subarray() return views of the same buffer; copy() detaches.
+// xor(), fill(), set() and the write* accessors modify the buffer in place and
+// are seen by every overlapping view.
+
+namespace
+{
+    // readUInt32LE / writeInt16BE / readDoubleLE ... decoded from the name.
+    struct Accessor
+    {
+        size_t width = 0; // 0: not an accessor
+        bool isSigned = false;
+        bool isFloat = false;
+        bool bigEndian = false;
+    };
+
+    Accessor parseAccessor(const std::string &name, size_t prefixLen)
+    {
+        static const struct
+        {
+            const char *type;
+            size_t width;
+            bool isSigned, isFloat;
+        } kinds[] = {
+            {"UInt8", 1, false, false},
+            {"Int8", 1, true, false},
+            {"UInt16", 2, false, false},
+            {"Int16", 2, true, false},
+            {"UInt32", 4, false, false},
+            {"Int32", 4, true, false},
+            {"Float", 4, false, true},
+            {"Double", 8, false, true},
+        };
+        Accessor acc;
+        std::string rest = name.substr(prefixLen);
+        for (auto &k : kinds)
+        {
+            size_t tl = std::strlen(k.type);
+            if (rest.compare(0, tl, k.type) != 0)
+                continue;
+            std::string suffix = rest.substr(tl);
+            if (k.width == 1 ? !suffix.empty() : (suffix != "LE" && suffix != "BE"))
+                continue;
+            acc.width = k.width;
+            acc.isSigned = k.isSigned;
+            acc.isFloat = k.isFloat;
+            acc.bigEndian = suffix == "BE";
+            return acc;
+        }
+        return acc;
+    }
+
+    // Start/end arguments clamped the way string slice() clamps them.
+    size_t clampIndex(const std::vector<QuantumValue> &args, size_t i, size_t n, size_t dflt)
+    {
+        if (args.size() <= i || !args[i].isNumber())
+            return dflt;
+        long long v = (long long)args[i].asNumber();
+        if (v < 0)
+            v += (long long)n;
+        return (size_t)std::max(0LL, std::min(v, (long long)n));
+    }
+
+    size_t checkedOffset(const QuantumBytes &b, const std::vector<QuantumValue> &args, size_t i,
+                         size_t width, const std::string &method)
+    {
+        double off = args.size() > i ? args[i].asNumber() : 0.0;
+        if (off < 0 || off != std::floor(off) || off + (double)width > (double)b.size())
+            throw IndexError("bytes." + method + "(): offset " + std::to_string((long long)off) +
+                             " out of range for length " + std::to_string(b.size()));
+        return (size_t)off;
+    }
+
+    QuantumValue readAccessor(const QuantumBytes &b, const Accessor &acc, size_t off)
+    {
+        const uint8_t *p = b.data() + off;
+        uint64_t v = 0;
+        for (size_t i = 0; i < acc.width; i++)
+            v |= (uint64_t)p[acc.bigEndian ? i : acc.width - 1 - i] << (8 * (acc.width - 1 - i));
+        if (acc.isFloat)
+        {
+            if (acc.width == 4)
+            {
+                uint32_t u = (uint32_t)v;
+                float f;
+                std::memcpy(&f, &u, 4);
+                return QuantumValue((double)f);
+            }
+            double d;
+            std::memcpy(&d, &v, 8);
+            return QuantumValue(d);
+        }
+        if (acc.isSigned)
+        {
+            unsigned shift = 64 - 8 * (unsigned)acc.width;
+            return QuantumValue((double)((int64_t)(v << shift) >> shift));
+        }
+        return QuantumValue((double)v);
+    }
+
+    void writeAccessor(QuantumBytes &b, const Accessor &acc, size_t off, double value)
+    {
+        uint64_t v;
+        if (acc.isFloat && acc.width == 4)
+        {
+            float f = (float)value;
+            uint32_t u;
+            std::memcpy(&u, &f, 4);
+            v = u;
+        }
+        else if (acc.isFloat)
+            std::memcpy(&v, &value, 8);
+        else
+            v = (uint64_t)(int64_t)value; // wraps like a C cast to the field width
+        uint8_t *p = b.data() + off;
+        for (size_t i = 0; i < acc.width; i++)
+            p[acc.bigEndian ? acc.width - 1 - i : i] = (uint8_t)(v >> (8 * i));
+    }
+
+    std::shared_ptr<QuantumBytes> toBytes(const QuantumValue &v)
+    {
+        if (v.isBytes())
+            return v.asBytes();
+        std::string scratch;
+        return std::make_shared<QuantumBytes>(v.bytesView(scratch));
+    }
+}
+
+QuantumValue VM::callBytesMethod(std::shared_ptr<QuantumBytes> b, const std::string &m,
+                                 std::vector<QuantumValue> args)
+{
+    const size_t n = b->size();
+    std::string scratch;
+
+    if (m == "length" || m == "size")
+        return QuantumValue((double)n);
+    if (m == "slice" || m == "subarray")
+    {
+        size_t start = clampIndex(args, 0, n, 0);
+        size_t end = std::max(start, clampIndex(args, 1, n, n));
+        return QuantumValue(b->slice(start, end));
+    }
+    if (m == "copy")
+        return QuantumValue(std::make_shared<QuantumBytes>(b->view()));
+    if (m == "to_string" || m == "toString" || m == "decode")
+        return QuantumValue(std::string(b->view()));
+    if (m == "hex")
+        return QuantumValue(codec::hexEncode(b->view()));
+    if (m == "base64")
+        return QuantumValue(codec::base64Encode(b->view()));
+    if (m == "to_array")
+    {
+        auto arr = std::make_shared<Array>();
+        arr->reserve(n);
+        for (size_t i = 0; i < n; i++)
+            arr->push_back(QuantumValue((double)b->data()[i]));
+        return QuantumValue(arr);
+    }
+    if (m == "indexOf" || m == "index_of")
+    {
+        if (args.empty())
+            throw RuntimeError("bytes.indexOf() requires a needle");
+        std::string_view needle;
+        char one;
+        if (args[0].isNumber())
+        {
+            one = (char)(uint8_t)(long long)args[0].asNumber();
+            needle = std::string_view(&one, 1);
+        }
+        else
+            needle = args[0].bytesView(scratch);
+        size_t from = clampIndex(args, 1, n, 0);
+        size_t pos = b->view().find(needle, from);
+        return QuantumValue(pos == std::string_view::npos ? -1.0 : (double)pos);
+    }
+    if (m == "equals")
+    {
+        if (args.empty())
+            return QuantumValue(false);
+        return QuantumValue(b->view() == args[0].bytesView(scratch));
+    }
+
+    // ── In-place edits: return the receiver so calls chain ──────────────────
+    if (m == "fill")
+    {
+        size_t start = clampIndex(args, 1, n, 0);
+        size_t end = std::max(start, clampIndex(args, 2, n, n));
+        uint8_t *d = b->data();
+        if (args.empty() || args[0].isNumber())
+            std::memset(d + start, args.empty() ? 0 : (int)(uint8_t)(long long)args[0].asNumber(), end - start);
+        else
+        {
+            std::string_view pat = args[0].bytesView(scratch);
+            if (pat.empty())
+                throw RuntimeError("bytes.fill(): pattern must not be empty");
+            for (size_t i = start; i < end; i++)
+                d[i] = (uint8_t)pat[(i - start) % pat.size()];
+        }
+        return QuantumValue(b);
+    }
+    if (m == "xor")
+    {
+        if (args.empty())
+            throw RuntimeError("bytes.xor() requires a key");
+        std::string_view key = args[0].bytesView(scratch);
+        if (key.empty())
+            throw RuntimeError("bytes.xor(): key must not be empty");
+        size_t start = clampIndex(args, 1, n, 0);
+        codec::xorInPlace(b->data() + start, n - start, key);
+        return QuantumValue(b);
+    }
+    if (m == "set")
+    {
+        if (args.empty())
+            throw RuntimeError("bytes.set() requires a source");
+        std::string_view src = args[0].bytesView(scratch);
+        double off = args.size() > 1 ? args[1].asNumber() : 0.0;
+        if (off < 0 || off + (double)src.size() > (double)n)
+            throw IndexError("bytes.set(): source does not fit at offset " + std::to_string((long long)off));
+        // memmove: src may be an overlapping view of the same buffer.
+        std::memmove(b->data() + (size_t)off, src.data(), src.size());
+        return QuantumValue(b);
+    }
+
+    // ── Typed accessors ─────────────────────────────────────────────────────
+    if (m.compare(0, 4, "read") == 0)
+    {
+        Accessor acc = parseAccessor(m, 4);
+        if (acc.width)
+            return readAccessor(*b, acc, checkedOffset(*b, args, 0, acc.width, m));
+    }
+    if (m.compare(0, 5, "write") == 0)
+    {
+        Accessor acc = parseAccessor(m, 5);
+        if (acc.width)
+        {
+            if (args.empty() || !args[0].isNumber())
+                throw TypeError("bytes." + m + "() requires a number");
+            size_t off = checkedOffset(*b, args, 1, acc.width, m);
+            writeAccessor(*b, acc, off, args[0].asNumber());
+            return QuantumValue((double)(off + acc.width));
+        }
+    }
+    throw TypeError("Bytes has no method '" + m + "'");
+}
+
+QuantumValue VM::callBytesStatic(const std::string &m, std::vector<QuantumValue> args)
+{
+    std::string scratch;
+    if (m == "from_hex" || m == "fromHex")
+        return QuantumValue(std::make_shared<QuantumBytes>(
+            codec::hexDecode(args.empty() ? std::string_view() : args[0].bytesView(scratch))));
+    if (m == "from_base64" || m == "fromBase64")
+        return QuantumValue(std::make_shared<QuantumBytes>(
+            codec::base64Decode(args.empty() ? std::string_view() : args[0].bytesView(scratch))));
+    if (m == "concat")
+    {
+        // concat(a, b, ...) or concat([a, b, ...])
+        std::vector<QuantumValue> parts = args.size() == 1 && args[0].isArray() ? *args[0].asArray() : args;
+        std::vector<std::shared_ptr<QuantumBytes>> views;
+        size_t total = 0;
+        for (auto &p : parts)
+        {
+            views.push_back(toBytes(p));
+            total += views.back()->size();
+        }
+        std::vector<uint8_t> out;
+        out.reserve(total);
+        for (auto &v : views)
+            out.insert(out.end(), v->data(), v->data() + v->size());
+        return QuantumValue(std::make_shared<QuantumBytes>(std::move(out)));
+    }
+    if (m == "alloc")
+    {
+        double len = args.empty() ? 0.0 : args[0].asNumber();
+        if (len < 0)
+            throw RuntimeError("bytes.alloc(): length must not be negative");
+        return QuantumValue(std::make_shared<QuantumBytes>(std::vector<uint8_t>((size_t)len)));
+    }
+    throw TypeError("bytes has no method '" + m + "'");
+}
@@ -1,5 +1,6 @@
 #include "Vm.h"
 #include "Error.h"
+#include "Number.h"
 #include <iostream>
 #include <sstream>
 #include <cmath>
@@ -33,10 +34,26 @@ extern bool g_testMode;
 #define M_E 2.71828182845904523536
 #endif
 
-// ─── Iterator state tag stored inside a QuantumNative ────────────────────────
-// We encode iterators as a QuantumNative whose fn() never gets called;
-// the VM identifies them by name prefix "__iter__" and stores an IterState
-// keyed by raw pointer.
+// ─── Lazy iterators ──────────────────────────────────────────────────────────
+
+namespace
+{
+    const std::shared_ptr<QuantumNative> &nilMarker()
+    {
+        static const auto marker = std::make_shared<QuantumNative>(QuantumNative{"__iter_nil__", nullptr});
+        return marker;
+    }
+}
+
+QuantumValue iterNil()
+{
+    return QuantumValue(nilMarker());
+}
+
+bool isIterNil(const QuantumValue &v)
+{
+    return v.isNative() && v.asNative() == nilMarker();
+}
 
 // ─── Constructor ─────────────────────────────────────────────────────────────
 
@@ -63,6 +80,9 @@ void VM::run(std::shared_ptr<Chunk> chunk)
     push(QuantumValue(closure));
     frames_.push_back({closure, 0, 1}); // locals start at stack index 1
     runFrame(0);
+
+    // Let outstanding async I/O finish and run its callbacks.
+    drainEventLoop();
 }
 
 // ─── Stack helpers ────────────────────────────────────────────────────────────
@@ -95,16 +115,9 @@ double VM::toNumber(const QuantumValue &v, const std::string &ctx, int line)
 {
     if (v.isNumber())
         return v.asNumber();
-    if (v.isString())
-    {
-        try
-        {
-            return std::stod(v.asString());
-        }
-        catch (...)
-        {
-        }
-    }
+    double d;
+    if (v.isString() && number::parse(v.asString(), d))
+        return d;
     throw TypeError("Expected number in " + ctx + ", got " + v.typeName(), line);
 }
 
@@ -122,6 +135,8 @@ bool VM::valuesEqual(const QuantumValue &a, const QuantumValue &b)
         return a.asString() == b.asString();
     if (a.isArray() && b.isArray())
         return a.asArray() == b.asArray(); // ptr eq
+    if (a.isBytes() && b.isBytes())
+        return a.asBytes()->view() == b.asBytes()->view();
     return false;
 }
 
@@ -129,6 +144,15 @@ bool VM::valuesEqual(const QuantumValue &a, const QuantumValue &b)
 
 QuantumValue VM::execBinary(Op op, const QuantumValue &L, const QuantumValue &R, int line)
 {
+    // Bytes concatenation (into a fresh buffer)
+    if (op == Op::ADD && L.isBytes() && R.isBytes())
+    {
+        auto l = L.asBytes(), r = R.asBytes();
+        std::vector<uint8_t> out(l->data(), l->data() + l->size());
+        out.insert(out.end(), r->data(), r->data() + r->size());
+        return QuantumValue(std::make_shared<QuantumBytes>(std::move(out)));
+    }
+
     // String concatenation
     if (op == Op::ADD && (L.isString() || R.isString()))
         return QuantumValue(L.toString() + R.toString());
@@ -154,33 +178,15 @@ QuantumValue VM::execBinary(Op op, const QuantumValue &L, const QuantumValue &R,
 
     if (L.isNumber())
         l = L.asNumber();
-    else if (L.isString())
-    {
-        try
-        {
-            l = std::stod(L.asString());
-        }
-        catch (...)
-        {
-            l = 0;
-        }
-    }
+    else if (L.isString() && !number::parse(L.asString(), l))
+        l = 0;
     else if (L.isBool())
         l = L.asBool() ? 1.0 : 0.0;
 
     if (R.isNumber())
         r = R.asNumber();
-    else if (R.isString())
-    {
-        try
-        {
-            r = std::stod(R.asString());
-        }
-        catch (...)
-        {
-            r = 0;
-        }
-    }
+    else if (R.isString() && !number::parse(R.asString(), r))
+        r = 0;
     else if (R.isBool())
         r = R.asBool() ? 1.0 : 0.0;
 
@@ -447,9 +453,9 @@ QuantumValue VM::callBuiltinMethod(QuantumValue &obj, const std::string &method,
             int places = args.empty() ? 0 : static_cast<int>(args[0].asNumber());
             if (places < 0)
                 places = 0;
-            std::ostringstream out;
-            out << std::fixed << std::setprecision(places) << obj.asNumber();
-            return QuantumValue(out.str());
+            std::string out;
+            number::appendFixed(out, obj.asNumber(), places);
+            return QuantumValue(out);
         }
         if (method == "toString")
             return QuantumValue(obj.toString());
@@ -470,6 +476,8 @@ QuantumValue VM::callBuiltinMethod(QuantumValue &obj, const std::string &method,
             }
             return QuantumValue(table);
         }
+        if (native->name == "bytes")
+            return callBytesStatic(method, args);
         if (method == "then" || method == "catch" || method == "json")
         {
             if (native->fn)
@@ -486,6 +494,8 @@ QuantumValue VM::callBuiltinMethod(QuantumValue &obj, const std::string &method,
         return callStringMethod(obj.asString(), method, args);
     if (obj.isDict())
         return callDictMethod(obj.asDict(), method, args);
+    if (obj.isBytes())
+        return callBytesMethod(obj.asBytes(), method, args);
     if (obj.isInstance())
     {
         auto inst = obj.asInstance();
@@ -0,0 +1,356 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Aes.h"
+#include "Hash.h"
+#include "SecureRandom.h"
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Crypto natives ───────────────────────────────────────────────────────────
+// The `encrypt` module (AES key objects with CTR and GCM streams), the older
+// aes128_ecb_encrypt / aes128_ecb_decrypt helpers on the same block cipher,
+// and the secure_random_* family backed by the VM's ChaCha20 generator.
+// Keys, IVs and data may be strings or bytes; outputs follow the type of
+// the data argument.
+
+namespace
+{
+    // Keys, IVs and data: strings and bytes are read in place, nil is empty.
+    std::string_view bytesArg(const std::vector<QuantumValue> &args, size_t i, std::string &scratch)
+    {
+        if (i >= args.size() || args[i].isNil())
+            return {};
+        return args[i].bytesView(scratch);
+    }
+
+    // Output in the same type as the data argument: bytes in, bytes out.
+    QuantumValue sameKind(const std::vector<QuantumValue> &args, size_t i, std::string out)
+    {
+        if (i < args.size() && args[i].isBytes())
+            return QuantumValue(std::make_shared<QuantumBytes>(out));
+        return QuantumValue(std::move(out));
+    }
+
+    inline const uint8_t *u8(std::string_view s)
+    {
+        return reinterpret_cast<const uint8_t *>(s.data());
+    }
+
+    inline uint8_t *u8(std::string &s)
+    {
+        return reinterpret_cast<uint8_t *>(&s[0]);
+    }
+
+    // Both ECB helpers predate the encrypt module: the key is cut or
+    // zero-padded to 16 bytes.
+    std::shared_ptr<const aes::Key> legacyKey(std::string_view key)
+    {
+        uint8_t k[16] = {};
+        std::memcpy(k, key.data(), key.size() < 16 ? key.size() : 16);
+        return aes::Key::create(k, 16);
+    }
+
+    std::shared_ptr<const aes::Key> keyFrom(std::string_view key)
+    {
+        auto k = aes::Key::create(u8(key), key.size());
+        if (!k)
+            throw RuntimeError("encrypt.aes(): key must be 16, 24 or 32 bytes, got " + std::to_string(key.size()));
+        return k;
+    }
+
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    // { update(data) -> bytes, finalize() -> "" }
+    QuantumValue makeCtrStream(std::shared_ptr<const aes::Key> key, std::string_view iv)
+    {
+        auto ctr = std::make_shared<aes::Ctr>(std::move(key), u8(iv));
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "ctr.");
+
+        method("update", [ctr](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string scratch;
+            std::string_view in = bytesArg(args, 0, scratch);
+            std::string out(in.size(), '\0');
+            if (!in.empty())
+                ctr->process(u8(in), u8(out), in.size());
+            return sameKind(args, 0, std::move(out)); });
+
+        // CTR has no trailer; finalize() exists so every stream ends the same way.
+        method("finalize", [](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(std::string()); });
+        return QuantumValue(obj);
+    }
+
+    // Encrypting: { update(pt) -> ct, finalize() -> 16-byte tag }
+    // Decrypting: { update(ct) -> pt, finalize(tag) -> true, or throws }
+    QuantumValue makeGcmStream(std::shared_ptr<const aes::Key> key, std::string_view nonce, std::string_view aad,
+                               bool encrypt)
+    {
+        if (nonce.empty())
+            throw RuntimeError("encrypt: GCM nonce must not be empty");
+        auto gcm = std::make_shared<aes::Gcm>(std::move(key), u8(nonce), nonce.size(), encrypt);
+        if (!aad.empty())
+            gcm->aad(u8(aad), aad.size());
+        auto done = std::make_shared<bool>(false);
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, encrypt ? "gcm_encrypt." : "gcm_decrypt.");
+
+        method("update", [gcm, done](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (*done)
+                throw RuntimeError("gcm.update(): stream already finalized");
+            std::string scratch;
+            std::string_view in = bytesArg(args, 0, scratch);
+            std::string out(in.size(), '\0');
+            if (!in.empty())
+                gcm->update(u8(in), u8(out), in.size());
+            return sameKind(args, 0, std::move(out)); });
+
+        if (encrypt)
+        {
+            method("finalize", [gcm, done](std::vector<QuantumValue>) -> QuantumValue
+                   {
+                if (*done)
+                    throw RuntimeError("gcm.finalize(): stream already finalized");
+                *done = true;
+                std::string tag(16, '\0');
+                gcm->tag(u8(tag));
+                return QuantumValue(std::move(tag)); });
+        }
+        else
+        {
+            method("finalize", [gcm, done](std::vector<QuantumValue> args) -> QuantumValue
+                   {
+                if (*done)
+                    throw RuntimeError("gcm.finalize(): stream already finalized");
+                *done = true;
+                std::string scratch;
+                std::string_view tag = bytesArg(args, 0, scratch);
+                if (!gcm->verify(u8(tag), tag.size()))
+                    throw RuntimeError("gcm.finalize(): authentication failed");
+                return QuantumValue(true); });
+        }
+        return QuantumValue(obj);
+    }
+
+    // Byte count argument for the secure_random_* natives.
+    size_t countArg(const std::vector<QuantumValue> &args, size_t i, size_t fallback, const char *fn)
+    {
+        if (i >= args.size() || args[i].isNil())
+            return fallback;
+        double n = args[i].asNumber();
+        if (!(n >= 0) || n > 1e9 || n != std::floor(n))
+            throw RuntimeError(std::string(fn) + "(): count must be a whole number between 0 and 1e9");
+        return static_cast<size_t>(n);
+    }
+
+    // Inclusive integer bounds, limited to what a double holds exactly.
+    void boundsArgs(const std::vector<QuantumValue> &args, size_t i, int64_t &lo, int64_t &hi, const char *fn)
+    {
+        const double maxExact = 9007199254740992.0; // 2^53
+        double l = i < args.size() ? args[i].asNumber() : 0;
+        double h = i + 1 < args.size() ? args[i + 1].asNumber() : 255;
+        if (l != std::floor(l) || h != std::floor(h) || std::fabs(l) > maxExact || std::fabs(h) > maxExact)
+            throw RuntimeError(std::string(fn) + "(): bounds must be integers within ±2^53");
+        if (l > h)
+            throw RuntimeError(std::string(fn) + "(): min must not exceed max");
+        lo = static_cast<int64_t>(l);
+        hi = static_cast<int64_t>(h);
+    }
+
+    QuantumValue makeAesKey(std::shared_ptr<const aes::Key> key)
+    {
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "aes.");
+
+        // ctr(iv) — iv is the full 16-byte initial counter block.
+        method("ctr", [key](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string scratch;
+            std::string_view iv = bytesArg(args, 0, scratch);
+            if (iv.size() != 16)
+                throw RuntimeError("aes.ctr(): iv must be 16 bytes");
+            return makeCtrStream(key, iv); });
+
+        // gcm_encrypt(nonce, aad?) / gcm_decrypt(nonce, aad?)
+        for (bool encrypt : {true, false})
+        {
+            method(encrypt ? "gcm_encrypt" : "gcm_decrypt", [key, encrypt](std::vector<QuantumValue> args) -> QuantumValue
+                   {
+                std::string nonceScratch, aadScratch;
+                return makeGcmStream(key, bytesArg(args, 0, nonceScratch), bytesArg(args, 1, aadScratch), encrypt); });
+        }
+
+        // seal(nonce, plaintext, aad?) — ciphertext with the tag appended.
+        method("seal", [key](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string nonceScratch, ptScratch, aadScratch;
+            std::string_view nonce = bytesArg(args, 0, nonceScratch);
+            std::string_view pt = bytesArg(args, 1, ptScratch);
+            std::string_view aad = bytesArg(args, 2, aadScratch);
+            if (nonce.empty())
+                throw RuntimeError("aes.seal(): nonce must not be empty");
+            aes::Gcm gcm(key, u8(nonce), nonce.size(), true);
+            gcm.aad(u8(aad), aad.size());
+            std::string out(pt.size() + 16, '\0');
+            gcm.update(u8(pt), u8(out), pt.size());
+            gcm.tag(u8(out) + pt.size());
+            return sameKind(args, 1, std::move(out)); });
+
+        // open(nonce, sealed, aad?) — plaintext, or throws if the tag is wrong.
+        method("open", [key](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string nonceScratch, ctScratch, aadScratch;
+            std::string_view nonce = bytesArg(args, 0, nonceScratch);
+            std::string_view sealed = bytesArg(args, 1, ctScratch);
+            std::string_view aad = bytesArg(args, 2, aadScratch);
+            if (nonce.empty())
+                throw RuntimeError("aes.open(): nonce must not be empty");
+            if (sealed.size() < 16)
+                throw RuntimeError("aes.open(): input shorter than the tag");
+            size_t n = sealed.size() - 16;
+            aes::Gcm gcm(key, u8(nonce), nonce.size(), false);
+            gcm.aad(u8(aad), aad.size());
+            std::string out(n, '\0');
+            gcm.update(u8(sealed), u8(out), n);
+            if (!gcm.verify(u8(sealed) + n, 16))
+                throw RuntimeError("aes.open(): authentication failed");
+            return sameKind(args, 1, std::move(out)); });
+
+        (*obj)["bits"] = QuantumValue(static_cast<double>(key->bits()));
+        return QuantumValue(obj);
+    }
+}
+
+SecureRandom &VM::secureRandom()
+{
+    if (!secureRandom_)
+        secureRandom_ = std::make_shared<SecureRandom>();
+    return *secureRandom_;
+}
+
+void VM::registerCryptoNatives()
+{
+    auto reg = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = name;
+        nat->fn = std::move(fn);
+        globals->define(name, QuantumValue(nat));
+    };
+
+    // ---- AES-128 ECB encrypt/decrypt (with PKCS#7 padding) ----
+    reg("aes128_ecb_encrypt", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2) throw RuntimeError("aes128_ecb_encrypt() requires key, plaintext");
+        std::string keyScratch, scratch;
+        auto key = legacyKey(bytesArg(args, 0, keyScratch));
+        std::string_view pt = bytesArg(args, 1, scratch);
+        size_t pad = 16 - pt.size() % 16;
+        std::string ct(pt);
+        ct.append(pad, static_cast<char>(pad));
+        key->encryptBlocks(u8(ct), u8(ct), ct.size() / 16);
+        return sameKind(args, 1, std::move(ct)); });
+
+    reg("aes128_ecb_decrypt", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2) throw RuntimeError("aes128_ecb_decrypt() requires key, ciphertext");
+        std::string keyScratch, scratch;
+        auto key = legacyKey(bytesArg(args, 0, keyScratch));
+        std::string pt(bytesArg(args, 1, scratch));
+        if (pt.size() % 16 != 0) throw RuntimeError("aes128_ecb_decrypt: ciphertext length must be multiple of 16");
+        if (!pt.empty())
+            key->decryptBlocks(u8(pt), u8(pt), pt.size() / 16);
+        // Remove PKCS#7 padding
+        if (!pt.empty()) {
+            uint8_t pad = (uint8_t)pt.back();
+            if (pad > 0 && pad <= 16) {
+                bool valid = true;
+                for (int i = 0; i < pad; i++)
+                    if ((uint8_t)pt[pt.size()-1-i] != pad) { valid = false; break; }
+                if (valid) pt.resize(pt.size() - pad);
+            }
+        }
+        return sameKind(args, 1, std::move(pt)); });
+
+    // ---- Secure random ----
+    // All draw from one buffered generator per VM, so a call costs a copy
+    // out of the buffer rather than a trip to the OS.
+
+    // secure_random_bytes(n) — n random bytes as a bytes value.
+    reg("secure_random_bytes", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        auto out = std::make_shared<QuantumBytes>(std::vector<uint8_t>(countArg(args, 0, 16, "secure_random_bytes")));
+        secureRandom().fill(out->data(), out->size());
+        return QuantumValue(out); });
+
+    // secure_random_hex(n=16) — n random bytes, hex encoded.
+    reg("secure_random_hex", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        std::vector<uint8_t> raw(countArg(args, 0, 16, "secure_random_hex"));
+        secureRandom().fill(raw.data(), raw.size());
+        return QuantumValue(hash::toHex(raw.data(), raw.size())); });
+
+    // secure_random_int(min=0, max=255) — uniform over [min, max].
+    reg("secure_random_int", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        int64_t lo, hi;
+        boundsArgs(args, 0, lo, hi, "secure_random_int");
+        return QuantumValue(static_cast<double>(secureRandom().between(lo, hi))); });
+
+    // secure_random_fill(array, min=0, max=255) — overwrite every element
+    // with a uniform integer in [min, max]; returns the array.
+    reg("secure_random_fill", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty() || !args[0].isArray())
+            throw RuntimeError("secure_random_fill() requires an array");
+        int64_t lo, hi;
+        boundsArgs(args, 1, lo, hi, "secure_random_fill");
+        SecureRandom &rng = secureRandom();
+        auto arr = args[0].asArray();
+        if (lo == 0 && hi == 255)
+        {
+            // Byte-valued fills are the common case: one draw covers the lot.
+            std::vector<uint8_t> raw(arr->size());
+            rng.fill(raw.data(), raw.size());
+            for (size_t i = 0; i < raw.size(); i++)
+                (*arr)[i] = QuantumValue(static_cast<double>(raw[i]));
+        }
+        else
+        {
+            for (auto &v : *arr)
+                v = QuantumValue(static_cast<double>(rng.between(lo, hi)));
+        }
+        return args[0]; });
+
+    // ── encrypt ───────────────────────────────────────────────────────────
+    auto encrypt = std::make_shared<Dict>();
+    auto lib = methodsOf(encrypt, "encrypt.");
+
+    // encrypt.aes(key) — 16/24/32-byte key; the schedule is expanded once
+    // and shared by every stream made from the returned object.
+    lib("aes", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("encrypt.aes() requires a key");
+        std::string scratch;
+        return makeAesKey(keyFrom(bytesArg(args, 0, scratch))); });
+
+    (*encrypt)["backend"] = QuantumValue(std::string(aes::backend()));
+    globals->define("encrypt", QuantumValue(encrypt));
+}
@@ -0,0 +1,552 @@
+#include "Vm.h"
+#include "Error.h"
+#include "BufferedFile.h"
+#include "Csv.h"
+#include "MappedFile.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── CSV natives ──────────────────────────────────────────────────────────────
+// The csv module: reader() streams records from a file a row at a time,
+// parse() does the same for text in memory, columns() pulls chosen columns
+// straight into packed numeric buffers without building a row at all, and
+// writer() quotes fields as needed and batches them into large writes.
+
+namespace
+{
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    constexpr size_t kFlushAt = 64 * 1024; // writer batch size
+
+    const QuantumValue *option(const std::vector<QuantumValue> &args, size_t i, const char *key)
+    {
+        if (args.size() <= i || !args[i].isDict())
+            return nullptr;
+        auto it = args[i].asDict()->find(key);
+        return it == args[i].asDict()->end() ? nullptr : &it->second;
+    }
+
+    struct Dialect
+    {
+        char delimiter = ',';
+        char quote = '"';
+    };
+
+    // {delimiter, quote} from the options at args[i].  A path ending in
+    // .tsv or .tab defaults to tabs; quote "" turns quoting off.
+    Dialect dialectOf(const std::vector<QuantumValue> &args, size_t i, const std::string &path, const std::string &fn)
+    {
+        Dialect d;
+        auto endsWith = [&](const char *ext)
+        {
+            size_t n = std::strlen(ext);
+            return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+        };
+        if (endsWith(".tsv") || endsWith(".tab"))
+            d.delimiter = '\t';
+        if (const QuantumValue *v = option(args, i, "delimiter"))
+        {
+            if (!v->isString() || v->asString().size() != 1)
+                throw RuntimeError(fn + "(): delimiter must be a single character");
+            d.delimiter = v->asString()[0];
+        }
+        if (const QuantumValue *v = option(args, i, "quote"))
+        {
+            if (!v->isNil() && (!v->isString() || v->asString().size() > 1))
+                throw RuntimeError(fn + "(): quote must be a single character or \"\"");
+            d.quote = v->isString() && !v->asString().empty() ? v->asString()[0] : '\0';
+        }
+        if (d.delimiter == '\n' || d.delimiter == '\r' || d.delimiter == '\0' || d.delimiter == d.quote ||
+            d.quote == '\n' || d.quote == '\r')
+            throw RuntimeError(fn + "(): delimiter and quote must differ and cannot be line breaks");
+        return d;
+    }
+
+    // A path, or a file object from open(), which is reopened so the scan
+    // has its own position.
+    std::string pathOf(const std::vector<QuantumValue> &args, const std::string &fn)
+    {
+        if (args.empty())
+            throw RuntimeError(fn + "() requires a path or a file");
+        if (args[0].isDict())
+        {
+            auto it = args[0].asDict()->find("path");
+            if (it == args[0].asDict()->end())
+                throw RuntimeError(fn + "(): expected a path or a file object");
+            return it->second.toString();
+        }
+        return args[0].toString();
+    }
+
+    std::shared_ptr<MappedFile> openFile(const std::string &path, const std::string &fn)
+    {
+        auto mf = MappedFile::open(path);
+        if (!mf)
+            throw RuntimeError(fn + "(): cannot open '" + path + "'");
+        mf->adviseSequential();
+        return mf;
+    }
+
+    struct ReadState
+    {
+        QuantumValue keep; // the text being read, for parse()
+        std::shared_ptr<MappedFile> file;
+        std::unique_ptr<csv::Reader> reader;
+        std::vector<std::string_view> fields;
+        std::vector<std::string> header; // rows are dicts when non-empty
+        std::string fn;
+
+        bool next()
+        {
+            if (reader->next(fields))
+                return true;
+            if (!reader->error().empty())
+                throw RuntimeError(fn + "(): " + reader->error());
+            return false;
+        }
+
+        // header: true takes the names from the first record, an array
+        // gives them; anything else leaves rows as arrays.
+        void readHeader(const QuantumValue *opt)
+        {
+            if (opt && opt->isArray())
+            {
+                for (auto &name : *opt->asArray())
+                    header.push_back(name.toString());
+            }
+            else if (opt && opt->isTruthy() && next())
+            {
+                for (auto f : fields)
+                    header.emplace_back(f);
+            }
+        }
+
+        QuantumValue row() const
+        {
+            if (header.empty())
+            {
+                auto arr = std::make_shared<Array>();
+                arr->reserve(fields.size());
+                for (auto f : fields)
+                    arr->emplace_back(std::string(f));
+                return QuantumValue(arr);
+            }
+            if (fields.size() > header.size())
+                throw RuntimeError(fn + "(): record " + std::to_string(reader->recordNumber()) + " has " +
+                                   std::to_string(fields.size()) + " fields, the header has " +
+                                   std::to_string(header.size()));
+            auto dict = std::make_shared<Dict>();
+            dict->reserve(header.size());
+            for (size_t i = 0; i < header.size(); i++)
+                (*dict)[header[i]] = i < fields.size() ? QuantumValue(std::string(fields[i])) : QuantumValue();
+            return QuantumValue(dict);
+        }
+    };
+
+    // A cell as a number: surrounding blanks and a leading '+' are allowed,
+    // anything else that is not a number gives NaN.
+    double cellNumber(std::string_view s)
+    {
+        // Plain decimals of up to 15 digits, the bulk of most numeric
+        // columns, need no library call: the digits and the power of ten
+        // are both exact, so one division rounds correctly.
+        static const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                        1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+        if (!s.empty() && s.size() <= 16)
+        {
+            size_t i = s[0] == '-';
+            uint64_t v = 0;
+            size_t digits = 0, point = 0;
+            for (; i < s.size(); i++)
+            {
+                unsigned d = static_cast<unsigned>(s[i] - '0');
+                if (d <= 9)
+                {
+                    v = v * 10 + d;
+                    digits++;
+                }
+                else if (s[i] == '.' && !point)
+                    point = i + 1;
+                else
+                    break;
+            }
+            if (i == s.size() && digits && digits <= 15)
+            {
+                double r = static_cast<double>(v);
+                if (point)
+                    r /= kPow10[s.size() - point];
+                return s[0] == '-' ? -r : r;
+            }
+        }
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+            s.remove_suffix(1);
+        if (s.size() > 1 && s[0] == '+' && s[1] != '-')
+            s.remove_prefix(1);
+        double v;
+        auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (s.empty() || ec != std::errc() || end != s.data() + s.size())
+            return std::nan("");
+        return v;
+    }
+
+    // Appends v little-endian, as readDoubleLE / readFloatLE read it back.
+    void pack(std::vector<uint8_t> &out, double v, bool f32)
+    {
+        uint64_t bits;
+        size_t width = f32 ? 4 : 8;
+        if (f32)
+        {
+            float f = static_cast<float>(v);
+            uint32_t u;
+            std::memcpy(&u, &f, 4);
+            bits = u;
+        }
+        else
+            std::memcpy(&bits, &v, 8);
+        size_t at = out.size();
+        out.resize(at + width);
+        for (size_t i = 0; i < width; i++)
+            out[at + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+
+    struct WriteState
+    {
+        std::shared_ptr<BufferedFile> file; // writer(path)
+        QuantumValue sink;                  // writer(file): its write method
+        std::string target;
+        std::vector<std::string> header;
+        Dialect dialect;
+        std::string buf;
+        bool closed = false;
+
+        ~WriteState()
+        {
+            try
+            {
+                flush();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        void flush()
+        {
+            if (buf.empty())
+                return;
+            if (file)
+            {
+                if (!file->write(buf))
+                    throw RuntimeError("csv.writer: write to '" + target + "' failed");
+            }
+            else if (sink.isNative())
+                sink.asNative()->fn({QuantumValue(buf)});
+            buf.clear();
+        }
+
+        void field(const QuantumValue &v)
+        {
+            if (v.isNil())
+                return;
+            if (v.isString())
+                csv::appendField(buf, v.asString(), dialect.delimiter, dialect.quote);
+            else
+            {
+                std::string scratch;
+                csv::appendField(buf, v.isBytes() ? v.bytesView(scratch) : (scratch = v.toString()),
+                                 dialect.delimiter, dialect.quote);
+            }
+        }
+
+        void names(const std::vector<std::string> &cols)
+        {
+            for (size_t i = 0; i < cols.size(); i++)
+            {
+                if (i)
+                    buf += dialect.delimiter;
+                csv::appendField(buf, cols[i], dialect.delimiter, dialect.quote);
+            }
+            buf += '\n';
+        }
+
+        // An array in order, or a dict laid out by the header.
+        void row(const QuantumValue &r)
+        {
+            if (closed)
+                throw RuntimeError("csv.writer: '" + target + "' is closed");
+            if (r.isArray())
+            {
+                auto &arr = *r.asArray();
+                for (size_t i = 0; i < arr.size(); i++)
+                {
+                    if (i)
+                        buf += dialect.delimiter;
+                    field(arr[i]);
+                }
+            }
+            else if (r.isDict())
+            {
+                if (header.empty())
+                    throw RuntimeError("csv.writer: dict rows need a header");
+                auto &d = *r.asDict();
+                for (size_t i = 0; i < header.size(); i++)
+                {
+                    if (i)
+                        buf += dialect.delimiter;
+                    auto it = d.find(header[i]);
+                    if (it != d.end())
+                        field(it->second);
+                }
+            }
+            else
+                throw RuntimeError("csv.writer: a row must be an array or a dict");
+            buf += '\n';
+            if (buf.size() >= kFlushAt)
+                flush();
+        }
+    };
+}
+
+void VM::registerCsvNatives()
+{
+    auto mod = std::make_shared<Dict>();
+    auto lib = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "csv." + name;
+        nat->fn = std::move(fn);
+        (*mod)[name] = QuantumValue(nat);
+    };
+
+    auto iterate = [](std::shared_ptr<ReadState> state)
+    {
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [state](std::vector<QuantumValue>) -> QuantumValue
+        {
+            return state->next() ? state->row() : QuantumValue();
+        };
+        return QuantumValue(iter);
+    };
+
+    // reader(path, {delimiter, quote, header}) — lazy iterator over a CSV or
+    // TSV file's records, as arrays of strings, or as dicts keyed by the
+    // header when header is true (names from the first record) or an array
+    // of names.  path may also be a file object.
+    lib("reader", [iterate](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        std::string path = pathOf(args, "csv.reader");
+        Dialect d = dialectOf(args, 1, path, "csv.reader");
+        auto state = std::make_shared<ReadState>();
+        state->fn = "csv.reader";
+        state->reader = std::make_unique<csv::Reader>(openFile(path, "csv.reader"), d.delimiter, d.quote);
+        state->readHeader(option(args, 1, "header"));
+        return iterate(state); });
+
+    // parse(text, {delimiter, quote, header}) — reader() over a string or
+    // bytes already in memory.
+    lib("parse", [iterate](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty() || (!args[0].isString() && !args[0].isBytes()))
+            throw RuntimeError("csv.parse() requires a string or bytes");
+        Dialect d = dialectOf(args, 1, "", "csv.parse");
+        auto state = std::make_shared<ReadState>();
+        state->fn = "csv.parse";
+        state->keep = std::move(args[0]);
+        std::string scratch; // unused: strings and bytes are viewed in place
+        state->reader = std::make_unique<csv::Reader>(state->keep.bytesView(scratch), d.delimiter, d.quote);
+        state->readHeader(option(args, 1, "header"));
+        return iterate(state); });
+
+    // columns(path, cols, {delimiter, quote, header, type}) — the chosen
+    // columns of every record, each packed into one bytes buffer of
+    // little-endian numbers (type "f64", the default, or "f32"; read them
+    // back with readDoubleLE(8 * i) / readFloatLE(4 * i)).  cols holds
+    // header names or 0-based indices; names imply header: true.  Cells
+    // that are empty, missing or not numbers become NaN.  Returns a dict
+    // keyed by each column as given.
+    lib("columns", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        std::string path = pathOf(args, "csv.columns");
+        if (args.size() < 2 || (!args[1].isArray() && !args[1].isString() && !args[1].isNumber()))
+            throw RuntimeError("csv.columns() requires a path and a list of columns");
+        Dialect d = dialectOf(args, 2, path, "csv.columns");
+        Array cols = args[1].isArray() ? *args[1].asArray() : Array{args[1]};
+        bool f32 = false;
+        if (const QuantumValue *t = option(args, 2, "type"))
+        {
+            std::string type = t->toString();
+            if (type != "f64" && type != "f32")
+                throw RuntimeError("csv.columns(): type must be \"f64\" or \"f32\"");
+            f32 = type == "f32";
+        }
+        bool named = false;
+        for (auto &c : cols)
+            named = named || c.isString();
+        const QuantumValue *headerOpt = option(args, 2, "header");
+        QuantumValue implied(true);
+
+        ReadState state;
+        state.fn = "csv.columns";
+        state.file = openFile(path, "csv.columns");
+        state.reader = std::make_unique<csv::Reader>(state.file, d.delimiter, d.quote);
+        state.readHeader(headerOpt ? headerOpt : named ? &implied : nullptr);
+
+        std::vector<size_t> index;
+        for (auto &c : cols)
+        {
+            if (c.isNumber())
+            {
+                if (c.asNumber() < 0 || c.asNumber() != std::floor(c.asNumber()))
+                    throw RuntimeError("csv.columns(): column indices must be whole numbers >= 0");
+                index.push_back(static_cast<size_t>(c.asNumber()));
+                continue;
+            }
+            std::string name = c.toString();
+            size_t at = 0;
+            while (at < state.header.size() && state.header[at] != name)
+                at++;
+            if (at == state.header.size())
+                throw RuntimeError("csv.columns(): no column named '" + name + "'");
+            index.push_back(at);
+        }
+
+        // Columns are sized from the first records' share of the file, so
+        // a large file is not copied over and over as its buffers grow.
+        constexpr size_t kSample = 1024;
+        uint64_t fileSize = state.file->isMapped() ? state.file->size() : 0;
+        uint64_t start = state.reader->offset();
+        size_t width = f32 ? 4 : 8;
+        std::vector<std::vector<uint8_t>> packed(index.size());
+        for (size_t n = 0; state.next(); n++)
+        {
+            if (n == kSample && fileSize)
+            {
+                double rows = kSample * double(fileSize - start) / double(state.reader->offset() - start);
+                for (auto &col : packed)
+                    col.reserve(static_cast<size_t>(rows * 1.05 + 16) * width);
+            }
+            for (size_t k = 0; k < index.size(); k++)
+                pack(packed[k], index[k] < state.fields.size() ? cellNumber(state.fields[index[k]]) : std::nan(""), f32);
+        }
+
+        auto out = std::make_shared<Dict>();
+        for (size_t k = 0; k < cols.size(); k++)
+        {
+            packed[k].shrink_to_fit();
+            (*out)[cols[k].toString()] = QuantumValue(std::make_shared<QuantumBytes>(std::move(packed[k])));
+        }
+        return QuantumValue(out); });
+
+    // writer(path, {delimiter, quote, header}) — object with write_row(row),
+    // write_rows(rows), flush() and close().  path may also be a file object
+    // opened for writing.  A row is an array, or a dict laid out by the
+    // header array, which is written first.  nil is an empty field; fields
+    // holding the delimiter, a quote or a line break are quoted.  Output is
+    // batched and flushed in large writes, and on close().
+    lib("writer", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("csv.writer() requires a path or a file");
+        auto state = std::make_shared<WriteState>();
+        if (args[0].isDict())
+        {
+            auto &obj = *args[0].asDict();
+            auto w = obj.find("write");
+            if (w == obj.end() || !w->second.isNative())
+                throw RuntimeError("csv.writer(): expected a path or a file object");
+            state->sink = w->second;
+            state->target = obj.count("path") ? obj.at("path").toString() : "file";
+        }
+        else
+        {
+            state->target = args[0].toString();
+            state->file = BufferedFile::open(state->target, "w");
+            if (!state->file)
+                throw RuntimeError("csv.writer(): cannot open '" + state->target + "' for writing");
+        }
+        state->dialect = dialectOf(args, 1, state->target, "csv.writer");
+        if (const QuantumValue *h = option(args, 1, "header"))
+        {
+            if (!h->isArray())
+                throw RuntimeError("csv.writer(): header must be an array of names");
+            for (auto &name : *h->asArray())
+                state->header.push_back(name.toString());
+            state->names(state->header);
+        }
+
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "csv.writer.");
+
+        method("write_row", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            state->row(args.empty() ? QuantumValue() : args[0]);
+            return QuantumValue(); });
+
+        // write_rows(rows) — an array of rows or a lazy iterator; returns the count.
+        method("write_rows", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty())
+                return QuantumValue(0.0);
+            double n = 0;
+            if (args[0].isArray())
+            {
+                for (auto &r : *args[0].asArray())
+                {
+                    state->row(r);
+                    n++;
+                }
+            }
+            else if (args[0].isNative() && args[0].asNative()->name == "__iter__")
+            {
+                auto next = args[0].asNative();
+                for (QuantumValue r = next->fn({}); !r.isNil(); r = next->fn({}))
+                {
+                    state->row(isIterNil(r) ? QuantumValue() : r);
+                    n++;
+                }
+            }
+            else
+                throw RuntimeError("csv.writer.write_rows() requires an array or an iterator");
+            return QuantumValue(n); });
+
+        method("flush", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            state->flush();
+            if (state->file && !state->file->flush())
+                throw RuntimeError("csv.writer: flush of '" + state->target + "' failed");
+            return QuantumValue(true); });
+
+        method("close", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            if (state->closed)
+                return QuantumValue();
+            state->flush();
+            state->closed = true;
+            if (state->file)
+                state->file->close();
+            return QuantumValue(); });
+
+        (*obj)["path"] = QuantumValue(state->target);
+        return QuantumValue(obj); });
+
+    (*mod)["backend"] = QuantumValue(std::string(csv::backend()));
+    globals->define("csv", QuantumValue(mod));
+}
@@ -0,0 +1,493 @@
+#include "Vm.h"
+#include "Error.h"
+#include "MappedFile.h"
+#include "BufferedFile.h"
+#include "Number.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ─── File I/O natives ─────────────────────────────────────────────────────────
+// read_file / read_bytes / write_file / remove_file for whole files, and open() for file objects:
+// read-only opens are memory-mapped and scanned in place, every other mode
+// gets a buffered handle for streaming writes.
+
+namespace
+{
+    struct FileState
+    {
+        std::shared_ptr<MappedFile> file; // reset by close()
+        std::string path;
+        size_t cursor = 0; // read()/seek()/tell() position
+        std::atomic<int> pending{0}; // read_async() calls in flight on the I/O pool
+
+        MappedFile &open(const char *method) const
+        {
+            if (!file)
+                throw RuntimeError(std::string("file.") + method + "(): I/O operation on closed file '" + path + "'");
+            return *file;
+        }
+
+        void idle(const char *method) const
+        {
+            if (pending)
+                throw RuntimeError(std::string("file.") + method + "(): an async operation on '" + path + "' is still pending");
+        }
+
+        MappedFile &get(const char *method) const
+        {
+            MappedFile &f = open(method);
+            idle(method);
+            return f;
+        }
+    };
+
+    struct HandleState
+    {
+        std::shared_ptr<BufferedFile> file;
+        std::string path;
+        std::string mode;
+        std::atomic<bool> busy{false}; // read_async() in flight on the I/O pool
+
+        // BufferedFile has no locking, so nothing else may touch the stream
+        // while the pool thread of a read_async() is using it.
+        void idle(const char *method) const
+        {
+            if (busy)
+                throw RuntimeError(std::string("file.") + method + "(): an async operation on '" + path + "' is still pending");
+        }
+
+        BufferedFile &get(const char *method) const
+        {
+            if (!file || !file->isOpen())
+                throw RuntimeError(std::string("file.") + method + "(): I/O operation on closed file '" + path + "'");
+            idle(method);
+            return *file;
+        }
+    };
+
+    using MethodAdder = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    MethodAdder methodAdder(const std::shared_ptr<Dict> &obj)
+    {
+        return [obj](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = "file." + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    // Clears a state's busy flag when the pool thread finishes with it.
+    struct BusyGuard
+    {
+        std::atomic<bool> &flag;
+        ~BusyGuard() { flag = false; }
+    };
+
+    // Counts a mapped file's read_async() down when its pool task finishes.
+    struct PendingGuard
+    {
+        std::atomic<int> &count;
+        ~PendingGuard() { count--; }
+    };
+
+    using AsyncStarter = std::function<QuantumValue(std::function<AsyncResult()>, QuantumValue)>;
+
+    // A script number as a seek offset.  Clamped to ±2^62 so that adding it
+    // to a position cannot overflow; NaN and the infinities are refused.
+    int64_t toOffset(const QuantumValue &v, const char *method)
+    {
+        if (!v.isNumber())
+            return 0;
+        double d = v.asNumber();
+        if (!std::isfinite(d))
+            throw RuntimeError(std::string("file.") + method + "(): offset must be a finite number");
+        constexpr double limit = 4611686018427387904.0; // 2^62
+        return static_cast<int64_t>(std::clamp(d, -limit, limit));
+    }
+
+    QuantumValue makeFileObject(std::shared_ptr<MappedFile> mf, const std::string &path, AsyncStarter async)
+    {
+        auto state = std::make_shared<FileState>();
+        state->file = std::move(mf);
+        state->path = path;
+
+        auto obj = std::make_shared<Dict>();
+        auto method = methodAdder(obj);
+
+        // lines() — lazy iterator; each line is materialised only when the
+        // loop asks for it, so memory stays flat regardless of file size.
+        method("lines", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            state->get("lines");
+            auto reader = std::make_shared<LineReader>(state->file);
+            auto iter = std::make_shared<QuantumNative>();
+            iter->name = "__iter__";
+            iter->fn = [state, reader](std::vector<QuantumValue>) -> QuantumValue
+            {
+                state->idle("lines");
+                std::string_view line;
+                if (!reader->next(line))
+                    return QuantumValue();
+                return QuantumValue(std::string(line));
+            };
+            return QuantumValue(iter); });
+
+        // slice(offset, len) — bytes [offset, offset+len) without touching the rest.
+        method("slice", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            MappedFile &f = state->get("slice");
+            f.spool();
+            double off = args.empty() ? 0.0 : args[0].asNumber();
+            double len = args.size() > 1 ? args[1].asNumber() : static_cast<double>(f.size());
+            if (!(off >= 0) || off >= static_cast<double>(f.size()) || !(len > 0))
+                return QuantumValue(std::string());
+            size_t start = number::toCount(off);
+            size_t n = std::min(number::toCount(len), f.size() - start);
+            return QuantumValue(std::string(f.data() + start, n)); });
+
+        // find(needle, start=0) — byte offset of the next occurrence, or -1.
+        method("find", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty())
+                throw RuntimeError("file.find() requires a needle");
+            MappedFile &f = state->get("find");
+            f.spool();
+            std::string needle = args[0].toString();
+            size_t start = args.size() > 1 ? number::toCount(args[1].asNumber()) : 0;
+            std::string_view hay(f.data(), f.size());
+            size_t pos = hay.find(needle, start);
+            return QuantumValue(pos == std::string_view::npos ? -1.0 : static_cast<double>(pos)); });
+
+        method("size", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            MappedFile &f = state->get("size");
+            f.spool();
+            return QuantumValue(static_cast<double>(f.size())); });
+
+        // read(n) — next n bytes from the cursor (the rest of the file if omitted).
+        method("read", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            MappedFile &f = state->get("read");
+            f.spool();
+            if (state->cursor >= f.size())
+                return QuantumValue(std::string());
+            size_t avail = f.size() - state->cursor;
+            size_t n = avail;
+            if (!args.empty() && args[0].isNumber())
+                n = std::min(avail, number::toCount(args[0].asNumber()));
+            std::string out(f.data() + state->cursor, n);
+            state->cursor += n;
+            return QuantumValue(out); });
+
+        method("seek", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            MappedFile &f = state->get("seek");
+            f.spool();
+            int64_t off = args.empty() ? 0 : toOffset(args[0], "seek");
+            int whence = args.size() > 1 ? static_cast<int>(toOffset(args[1], "seek")) : 0;
+            int64_t base = whence == 1 ? static_cast<int64_t>(state->cursor)
+                         : whence == 2 ? static_cast<int64_t>(f.size()) : 0;
+            int64_t pos = base + off;
+            if (pos < 0)
+                return QuantumValue(false);
+            state->cursor = static_cast<size_t>(pos);
+            return QuantumValue(true); });
+
+        method("tell", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            state->get("tell");
+            return QuantumValue(static_cast<double>(state->cursor)); });
+
+        // read_async(n, callback?) — read(n) on the I/O pool; returns a promise.
+        // Mapped bytes never change, so the range is claimed here and reads
+        // issued back to back get consecutive chunks.  A streamed file has to
+        // be spooled on the pool thread first and takes one read at a time.
+        method("read_async", [state, async](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            MappedFile &f = state->open("read_async");
+            if (!f.isMapped())
+                state->get("read_async");
+            std::shared_ptr<MappedFile> file = state->file;
+            bool all = args.empty() || !args[0].isNumber();
+            size_t n = all ? 0 : number::toCount(args[0].asNumber());
+            QuantumValue callback = args.size() > 1 ? args[1] : QuantumValue();
+            size_t start = state->cursor;
+            state->pending++;
+            if (f.isMapped())
+            {
+                size_t avail = start < f.size() ? f.size() - start : 0;
+                size_t len = all ? avail : std::min(n, avail);
+                state->cursor += len;
+                return async([state, file, start, len]() -> AsyncResult
+                             {
+                    PendingGuard guard{state->pending};
+                    auto data = std::make_shared<std::string>(file->data() + (len ? start : 0), len);
+                    return [data]() -> QuantumValue
+                    { return QuantumValue(std::move(*data)); }; }, callback);
+            }
+            return async([state, file, all, n, start]() -> AsyncResult
+                         {
+                PendingGuard guard{state->pending};
+                file->spool();
+                size_t avail = start < file->size() ? file->size() - start : 0;
+                size_t len = all ? avail : std::min(n, avail);
+                auto data = std::make_shared<std::string>(file->data() + (avail ? start : 0), len);
+                state->cursor = start + len; // published before the guard clears pending
+                return [data]() -> QuantumValue
+                { return QuantumValue(std::move(*data)); }; }, callback); });
+
+        method("write", [state](std::vector<QuantumValue>) -> QuantumValue
+               { throw RuntimeError("file.write(): '" + state->path + "' was opened read-only"); });
+        method("writeline", [state](std::vector<QuantumValue>) -> QuantumValue
+               { throw RuntimeError("file.writeline(): '" + state->path + "' was opened read-only"); });
+        method("flush", [](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(true); });
+
+        method("close", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            state->file.reset();
+            return QuantumValue(); });
+
+        (*obj)["path"] = QuantumValue(path);
+        (*obj)["mode"] = QuantumValue(std::string("r"));
+        (*obj)["mapped"] = QuantumValue(state->file->isMapped());
+        return QuantumValue(obj);
+    }
+
+    // Buffered handle for every mode other than plain "r".  Writes go through
+    // a 1 MiB stdio buffer; the handle is flushed and closed by close() or when
+    // the last reference to the object goes away.
+    QuantumValue makeHandleObject(std::shared_ptr<BufferedFile> bf, const std::string &path, const std::string &mode, AsyncStarter async)
+    {
+        auto state = std::make_shared<HandleState>();
+        state->file = std::move(bf);
+        state->path = path;
+        state->mode = mode;
+
+        auto obj = std::make_shared<Dict>();
+        auto method = methodAdder(obj);
+
+        // write(a, b, ...) — appends each argument's string form; returns bytes written.
+        method("write", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            BufferedFile &f = state->get("write");
+            if (!f.canWrite())
+                throw RuntimeError("file.write(): '" + state->path + "' is not open for writing");
+            size_t total = 0;
+            for (auto &a : args)
+            {
+                std::string scratch;
+                std::string_view s = a.bytesView(scratch);
+                if (!f.write(s))
+                    throw RuntimeError("file.write(): write to '" + state->path + "' failed");
+                total += s.size();
+            }
+            return QuantumValue(static_cast<double>(total)); });
+
+        method("writeline", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            BufferedFile &f = state->get("writeline");
+            if (!f.canWrite())
+                throw RuntimeError("file.writeline(): '" + state->path + "' is not open for writing");
+            std::string s = args.empty() ? std::string() : (args[0].isString() ? args[0].asString() : args[0].toString());
+            s += '\n';
+            if (!f.write(s))
+                throw RuntimeError("file.writeline(): write to '" + state->path + "' failed");
+            return QuantumValue(static_cast<double>(s.size())); });
+
+        method("read", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            BufferedFile &f = state->get("read");
+            if (!f.canRead())
+                throw RuntimeError("file.read(): '" + state->path + "' is not open for reading");
+            if (args.empty() || !args[0].isNumber())
+                return QuantumValue(f.readAll());
+            return QuantumValue(f.read(number::toCount(args[0].asNumber()))); });
+
+        method("read_async", [state, async](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            BufferedFile &f = state->get("read_async");
+            if (!f.canRead())
+                throw RuntimeError("file.read_async(): '" + state->path + "' is not open for reading");
+            bool all = args.empty() || !args[0].isNumber();
+            size_t n = all ? 0 : number::toCount(args[0].asNumber());
+            QuantumValue callback = args.size() > 1 ? args[1] : QuantumValue();
+            std::shared_ptr<BufferedFile> file = state->file;
+            state->busy = true;
+            return async([state, file, all, n]() -> AsyncResult
+                         {
+                BusyGuard guard{state->busy};
+                auto data = std::make_shared<std::string>(all ? file->readAll() : file->read(n));
+                return [data]() -> QuantumValue
+                { return QuantumValue(std::move(*data)); }; }, callback); });
+
+        method("lines", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            BufferedFile &f = state->get("lines");
+            if (!f.canRead())
+                throw RuntimeError("file.lines(): '" + state->path + "' is not open for reading");
+            auto iter = std::make_shared<QuantumNative>();
+            iter->name = "__iter__";
+            iter->fn = [state](std::vector<QuantumValue>) -> QuantumValue
+            {
+                state->idle("lines");
+                std::string line;
+                if (!state->file || !state->file->readLine(line))
+                    return QuantumValue();
+                return QuantumValue(line);
+            };
+            return QuantumValue(iter); });
+
+        method("seek", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            BufferedFile &f = state->get("seek");
+            int64_t off = args.empty() ? 0 : toOffset(args[0], "seek");
+            int whence = args.size() > 1 ? static_cast<int>(toOffset(args[1], "seek")) : 0;
+            return QuantumValue(f.seek(off, whence)); });
+
+        method("tell", [state](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(static_cast<double>(state->get("tell").tell())); });
+
+        method("size", [state](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(static_cast<double>(state->get("size").size())); });
+
+        method("flush", [state](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(state->get("flush").flush()); });
+
+        method("close", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            state->idle("close");
+            if (state->file)
+                state->file->close();
+            return QuantumValue(); });
+
+        (*obj)["path"] = QuantumValue(path);
+        (*obj)["mode"] = QuantumValue(mode);
+        (*obj)["mapped"] = QuantumValue(false);
+        return QuantumValue(obj);
+    }
+}
+
+void VM::registerFileNatives()
+{
+    auto reg = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = name;
+        nat->fn = std::move(fn);
+        globals->define(name, QuantumValue(nat));
+    };
+
+    reg("write_file", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            return QuantumValue(false);
+        std::ofstream out(args[0].toString(), std::ios::binary);
+        if (!out)
+            return QuantumValue(false);
+        std::string scratch;
+        std::string_view data = args[1].bytesView(scratch);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return QuantumValue(true); });
+
+    reg("read_file", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            return QuantumValue();
+        auto mf = MappedFile::open(args[0].toString());
+        if (!mf)
+            return QuantumValue();
+        mf->spool();
+        return QuantumValue(std::string(mf->data(), mf->size())); });
+
+    // remove_file(path) — deletes a file; false if it could not be removed.
+    reg("remove_file", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            return QuantumValue(false);
+        return QuantumValue(std::remove(args[0].toString().c_str()) == 0); });
+
+    // read_bytes(path) — the whole file as bytes, or nil if it can't be opened.
+    reg("read_bytes", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            return QuantumValue();
+        auto mf = MappedFile::open(args[0].toString());
+        if (!mf)
+            return QuantumValue();
+        mf->spool();
+        return QuantumValue(std::make_shared<QuantumBytes>(std::string_view(mf->data(), mf->size()))); });
+
+    AsyncStarter async = [this](std::function<AsyncResult()> work, QuantumValue callback)
+    {
+        return startAsync(std::move(work), std::move(callback));
+    };
+
+    // read_file_async(path, callback?) — promise for the whole file's contents.
+    reg("read_file_async", [async](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("read_file_async() requires a path");
+        std::string path = args[0].toString();
+        QuantumValue callback = args.size() > 1 ? args[1] : QuantumValue();
+        return async([path]() -> AsyncResult
+                     {
+            auto mf = MappedFile::open(path);
+            if (!mf)
+                throw RuntimeError("read_file_async(): cannot open '" + path + "'");
+            mf->spool();
+            auto data = std::make_shared<std::string>(mf->data(), mf->size());
+            return [data]() -> QuantumValue
+            { return QuantumValue(std::move(*data)); }; }, callback); });
+
+    // write_file_async(path, data, callback?) — promise resolving to true.
+    reg("write_file_async", [async](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("write_file_async() requires a path and data");
+        std::string path = args[0].toString();
+        std::string scratch;
+        auto data = std::make_shared<std::string>(args[1].bytesView(scratch));
+        QuantumValue callback = args.size() > 2 ? args[2] : QuantumValue();
+        return async([path, data]() -> AsyncResult
+                     {
+            std::ofstream out(path, std::ios::binary);
+            if (!out || !out.write(data->data(), static_cast<std::streamsize>(data->size())))
+                throw RuntimeError("write_file_async(): cannot write '" + path + "'");
+            return []() -> QuantumValue
+            { return QuantumValue(true); }; }, callback); });
+
+    // open(path, mode="r") — "r" maps the file (buffered reads for pipes);
+    // "w", "a", "r+", "w+", "a+" return a buffered read/write handle.
+    reg("open", [async](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("open() requires a path");
+        std::string path = args[0].toString();
+        std::string mode = args.size() > 1 ? args[1].toString() : "r";
+        if (!BufferedFile::validMode(mode))
+            throw RuntimeError("open(): invalid mode '" + mode + "'");
+
+        if (mode == "r" || mode == "rb")
+        {
+            auto mf = MappedFile::open(path);
+            if (!mf)
+                throw RuntimeError("open(): cannot open '" + path + "'");
+            return makeFileObject(std::move(mf), path, async);
+        }
+
+        auto bf = BufferedFile::open(path, mode);
+        if (!bf)
+            throw RuntimeError("open(): cannot open '" + path + "' with mode '" + mode + "'");
+        return makeHandleObject(std::move(bf), path, mode, async); });
+}
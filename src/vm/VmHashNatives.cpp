@@ -0,0 +1,422 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Hashing natives ──────────────────────────────────────────────────────────
+// One-shot digests (sha256, sha1, md5, hmac_sha256), incremental hashlib
+// objects, hash_file(), and the batch hash_files() / verify_manifest().  All of
+// them share the streaming implementation in Hash.cpp, so a digest never needs
+// its input in one piece.
+
+namespace
+{
+    // Strings and bytes are hashed in place; anything else is hashed as its
+    // printed form.
+    std::string_view bytesOf(const QuantumValue &v, std::string &scratch)
+    {
+        return v.bytesView(scratch);
+    }
+
+    std::unique_ptr<hash::Hasher> hasherFor(const std::string &algo, const char *fn)
+    {
+        auto h = hash::create(algo);
+        if (!h)
+            throw RuntimeError(std::string(fn) + "(): unsupported hash algorithm '" + algo + "' (sha256, sha1, md5)");
+        return h;
+    }
+
+    struct ManifestEntry
+    {
+        std::string path;     // as written in the manifest
+        std::string expected; // lower-case hex
+        std::string algorithm;
+    };
+
+    const char *algorithmForHexLength(size_t n)
+    {
+        switch (n)
+        {
+        case 64:
+            return "sha256";
+        case 40:
+            return "sha1";
+        case 32:
+            return "md5";
+        default:
+            return nullptr;
+        }
+    }
+
+    bool isHex(std::string_view s)
+    {
+        for (char c : s)
+            if (!std::isxdigit(static_cast<unsigned char>(c)))
+                return false;
+        return !s.empty();
+    }
+
+    // One manifest line: "<hex>  <path>" / "<hex> *<path>" as written by
+    // sha256sum and friends, or the BSD "SHA256 (<path>) = <hex>" form.
+    // Blank lines and '#' comments yield false.
+    bool parseManifestLine(std::string_view line, size_t lineNo, ManifestEntry &out)
+    {
+        while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r'))
+            line.remove_suffix(1);
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+            line.remove_prefix(1);
+        if (line.empty() || line.front() == '#')
+            return false;
+
+        auto bad = [&]()
+        { return RuntimeError("verify_manifest(): malformed line " + std::to_string(lineNo) + ": " + std::string(line)); };
+
+        std::string_view hex, path;
+        size_t open = line.find(" (");
+        size_t close = line.rfind(") = ");
+        if (open != std::string_view::npos && close != std::string_view::npos && close > open &&
+            std::isalpha(static_cast<unsigned char>(line.front())))
+        {
+            path = line.substr(open + 2, close - open - 2);
+            hex = line.substr(close + 4);
+        }
+        else
+        {
+            size_t sp = line.find_first_of(" \t");
+            if (sp == std::string_view::npos)
+                throw bad();
+            hex = line.substr(0, sp);
+            path = line.substr(sp + 1);
+            if (!path.empty() && (path.front() == ' ' || path.front() == '*'))
+                path.remove_prefix(1);
+        }
+
+        const char *algo = algorithmForHexLength(hex.size());
+        if (!algo || !isHex(hex) || path.empty())
+            throw bad();
+        out.path = std::string(path);
+        out.expected.clear();
+        for (char c : hex)
+            out.expected += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        out.algorithm = algo;
+        return true;
+    }
+
+    bool isAbsolutePath(const std::string &p)
+    {
+        return (!p.empty() && (p[0] == '/' || p[0] == '\\')) || (p.size() > 1 && p[1] == ':');
+    }
+
+    std::string directoryOf(const std::string &path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    struct BatchOptions
+    {
+        size_t threads = 0; // 0 = one per core
+        QuantumValue progress;
+        std::string base;
+        bool hasBase = false;
+    };
+
+    BatchOptions batchOptions(const QuantumValue &v)
+    {
+        BatchOptions o;
+        if (!v.isDict())
+            return o;
+        auto d = v.asDict();
+        auto it = d->find("threads");
+        if (it != d->end() && it->second.isNumber() && it->second.asNumber() >= 1)
+            o.threads = static_cast<size_t>(it->second.asNumber());
+        it = d->find("progress");
+        if (it != d->end() && it->second.isFunction())
+            o.progress = it->second;
+        it = d->find("base");
+        if (it != d->end() && !it->second.isNil())
+        {
+            o.base = it->second.toString();
+            o.hasBase = true;
+        }
+        return o;
+    }
+
+    // { update, digest, hexdigest, copy, reset, name, digest_size, block_size }
+    QuantumValue makeHashObject(std::shared_ptr<hash::Hasher> h)
+    {
+        auto obj = std::make_shared<Dict>();
+        std::weak_ptr<Dict> self = obj;
+        auto method = [&](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = "hash." + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+
+        // update(data) — returns the hash object so calls can be chained.  A
+        // temporary object may already be gone by then; a fresh view of the
+        // same state stands in for it.
+        method("update", [h, self](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string scratch;
+            for (auto &a : args)
+                h->update(bytesOf(a, scratch));
+            if (auto o = self.lock())
+                return QuantumValue(o);
+            return makeHashObject(h); });
+
+        method("digest", [h](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(h->digestBytes()); });
+
+        method("hexdigest", [h](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(h->hexdigest()); });
+
+        // copy() — independent snapshot, e.g. to digest a common prefix once.
+        method("copy", [h](std::vector<QuantumValue>) -> QuantumValue
+               { return makeHashObject(std::shared_ptr<hash::Hasher>(h->clone())); });
+
+        method("reset", [h, self](std::vector<QuantumValue>) -> QuantumValue
+               {
+            h->reset();
+            if (auto o = self.lock())
+                return QuantumValue(o);
+            return makeHashObject(h); });
+
+        (*obj)["name"] = QuantumValue(h->name());
+        (*obj)["digest_size"] = QuantumValue(static_cast<double>(h->digestSize()));
+        (*obj)["block_size"] = QuantumValue(static_cast<double>(h->blockSize()));
+        return QuantumValue(obj);
+    }
+}
+
+void VM::registerHashNatives()
+{
+    auto reg = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = name;
+        nat->fn = std::move(fn);
+        globals->define(name, QuantumValue(nat));
+    };
+
+    // sha256(s) / sha1(s) / md5(s) — hex digest of a whole string.
+    for (const char *algo : {"sha256", "sha1", "md5"})
+    {
+        std::string name = algo;
+        reg(name, [name](std::vector<QuantumValue> args) -> QuantumValue
+            {
+            if (args.empty())
+                throw RuntimeError(name + "() requires 1 argument");
+            std::string scratch;
+            return QuantumValue(hash::hexOf(name, bytesOf(args[0], scratch))); });
+    }
+
+    reg("hmac_sha256", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("hmac_sha256() requires 2 arguments: key, message");
+        std::string keyScratch, msgScratch;
+        auto h = hash::createHmac("sha256", bytesOf(args[0], keyScratch));
+        h->update(bytesOf(args[1], msgScratch));
+        return QuantumValue(h->hexdigest()); });
+
+    // hash_file(path, algo="sha256") — hex digest of a file, streamed from a
+    // read-only mapping so the contents never become a script string.
+    reg("hash_file", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("hash_file() requires a path");
+        std::string path = args[0].toString();
+        auto h = hasherFor(args.size() > 1 ? args[1].toString() : "sha256", "hash_file");
+        if (!hash::hashFile(*h, path))
+            throw RuntimeError("hash_file(): cannot open '" + path + "'");
+        return QuantumValue(h->hexdigest()); });
+
+    // Runs a batch on the I/O pool (which fans out to its own hashing
+    // threads) and settles with finish(results) on the VM thread.  progress
+    // is called on the VM thread as (done, total, path) after each file.
+    using BatchFinish = std::function<QuantumValue(std::vector<hash::FileResult> &)>;
+    auto runBatch = [this](std::shared_ptr<std::vector<hash::FileJob>> jobs, const BatchOptions &opts,
+                           BatchFinish finish) -> QuantumValue
+    {
+        auto state = std::make_shared<PromiseState>();
+        QuantumValue promise = makePromise(state);
+
+        std::function<void(size_t)> onDone;
+        if (!opts.progress.isNil())
+        {
+            // The callback is only dereferenced on the VM thread.
+            auto progress = std::make_shared<QuantumValue>(opts.progress);
+            auto done = std::make_shared<std::atomic<size_t>>(0);
+            EventLoop *loop = &eventLoop();
+            onDone = [this, loop, jobs, progress, done](size_t index)
+            {
+                double n = static_cast<double>(++*done);
+                loop->post([this, progress, n, jobs, index]()
+                           { callFunction(*progress, {QuantumValue(n), QuantumValue(static_cast<double>(jobs->size())),
+                                                      QuantumValue((*jobs)[index].path)}); });
+            };
+        }
+
+        size_t threads = opts.threads;
+        eventLoop().submit([this, jobs, threads, onDone, state, finish]() -> EventLoop::Task
+                           {
+            auto results = std::make_shared<std::vector<hash::FileResult>>(hash::hashFiles(*jobs, threads, onDone));
+            return [this, state, results, finish]()
+            { settlePromise(state, finish(*results), false); }; });
+        return promise;
+    };
+
+    // hash_files(paths, algo="sha256", {threads, progress}) — promise for an
+    // array of hex digests in path order (nil where a file can't be read).
+    reg("hash_files", [runBatch](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty() || !args[0].isArray())
+            throw RuntimeError("hash_files() requires an array of paths");
+        std::string algo = "sha256";
+        QuantumValue optsValue;
+        if (args.size() > 1 && args[1].isDict())
+            optsValue = args[1];
+        else
+        {
+            if (args.size() > 1 && !args[1].isNil())
+                algo = args[1].toString();
+            if (args.size() > 2)
+                optsValue = args[2];
+        }
+        hasherFor(algo, "hash_files");
+
+        auto jobs = std::make_shared<std::vector<hash::FileJob>>();
+        jobs->reserve(args[0].asArray()->size());
+        for (auto &p : *args[0].asArray())
+            jobs->push_back({p.toString(), algo});
+
+        return runBatch(jobs, batchOptions(optsValue), [](std::vector<hash::FileResult> &results) -> QuantumValue
+                        {
+            auto out = std::make_shared<Array>();
+            out->reserve(results.size());
+            for (auto &r : results)
+                out->push_back(r.ok ? QuantumValue(std::move(r.hex)) : QuantumValue());
+            return QuantumValue(out); }); });
+
+    // verify_manifest(path, {threads, progress, base}) — checks every file in
+    // a sha256sum-style manifest (sha1 / md5 digests are recognised by
+    // length).  Relative paths resolve against `base`, by default the
+    // manifest's own directory.  Resolves to
+    // {ok, checked, mismatches: [{path, expected, actual}], missing: [path]}.
+    reg("verify_manifest", [runBatch](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("verify_manifest() requires a manifest path");
+        std::string manifestPath = args[0].toString();
+        BatchOptions opts = batchOptions(args.size() > 1 ? args[1] : QuantumValue());
+
+        auto mf = MappedFile::open(manifestPath);
+        if (!mf)
+            throw RuntimeError("verify_manifest(): cannot open '" + manifestPath + "'");
+        std::string base = opts.hasBase ? opts.base : directoryOf(manifestPath);
+        if (!base.empty() && base.back() != '/' && base.back() != '\\')
+            base += '/';
+
+        auto entries = std::make_shared<std::vector<ManifestEntry>>();
+        auto jobs = std::make_shared<std::vector<hash::FileJob>>();
+        LineReader reader(mf);
+        std::string_view line;
+        ManifestEntry entry;
+        while (reader.next(line))
+        {
+            if (!parseManifestLine(line, reader.lineNumber(), entry))
+                continue;
+            jobs->push_back({isAbsolutePath(entry.path) ? entry.path : base + entry.path, entry.algorithm});
+            entries->push_back(entry);
+        }
+
+        return runBatch(jobs, opts, [entries](std::vector<hash::FileResult> &results) -> QuantumValue
+                        {
+            auto mismatches = std::make_shared<Array>();
+            auto missing = std::make_shared<Array>();
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                const ManifestEntry &e = (*entries)[i];
+                if (!results[i].ok)
+                    missing->push_back(QuantumValue(e.path));
+                else if (results[i].hex != e.expected)
+                {
+                    auto m = std::make_shared<Dict>();
+                    (*m)["path"] = QuantumValue(e.path);
+                    (*m)["expected"] = QuantumValue(e.expected);
+                    (*m)["actual"] = QuantumValue(std::move(results[i].hex));
+                    mismatches->push_back(QuantumValue(m));
+                }
+            }
+            auto out = std::make_shared<Dict>();
+            (*out)["ok"] = QuantumValue(mismatches->empty() && missing->empty());
+            (*out)["checked"] = QuantumValue(static_cast<double>(results.size()));
+            (*out)["mismatches"] = QuantumValue(mismatches);
+            (*out)["missing"] = QuantumValue(missing);
+            return QuantumValue(out); }); });
+
+    // ── hashlib ───────────────────────────────────────────────────────────
+    auto hashlib = std::make_shared<Dict>();
+    auto lib = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "hashlib." + name;
+        nat->fn = std::move(fn);
+        (*hashlib)[name] = QuantumValue(nat);
+    };
+
+    // hashlib.sha256(data?) and friends — a fresh hash object, optionally
+    // primed with data.
+    for (const char *algo : {"sha256", "sha1", "md5"})
+    {
+        std::string name = algo;
+        lib(name, [name](std::vector<QuantumValue> args) -> QuantumValue
+            {
+            std::shared_ptr<hash::Hasher> h = hash::create(name);
+            std::string scratch;
+            if (!args.empty())
+                h->update(bytesOf(args[0], scratch));
+            return makeHashObject(std::move(h)); });
+    }
+
+    // hashlib.new(algo, data?)
+    lib("new", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("hashlib.new() requires an algorithm name");
+        std::shared_ptr<hash::Hasher> h = hasherFor(args[0].toString(), "hashlib.new");
+        std::string scratch;
+        if (args.size() > 1)
+            h->update(bytesOf(args[1], scratch));
+        return makeHashObject(std::move(h)); });
+
+    // hashlib.hmac(key, msg?, algo="sha256")
+    lib("hmac", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("hashlib.hmac() requires a key");
+        std::string algo = args.size() > 2 ? args[2].toString() : "sha256";
+        std::string keyScratch, msgScratch;
+        std::shared_ptr<hash::Hasher> h = hash::createHmac(algo, bytesOf(args[0], keyScratch));
+        if (!h)
+            throw RuntimeError("hashlib.hmac(): unsupported hash algorithm '" + algo + "' (sha256, sha1, md5)");
+        if (args.size() > 1 && !args[1].isNil())
+            h->update(bytesOf(args[1], msgScratch));
+        return makeHashObject(std::move(h)); });
+
+    auto algorithms = std::make_shared<Array>();
+    for (const char *algo : {"sha256", "sha1", "md5"})
+        algorithms->push_back(QuantumValue(std::string(algo)));
+    (*hashlib)["algorithms"] = QuantumValue(algorithms);
+    (*hashlib)["backend"] = QuantumValue(std::string(hash::backend()));
+
+    globals->define("hashlib", QuantumValue(hashlib));
+}
@@ -0,0 +1,947 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Http.h"
+#include "HttpClient.h"
+#include "Net.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// ─── http module ─────────────────────────────────────────────────────────────
+// http.serve(port, handler, opts?) — an HTTP/1.1 server on the VM's event
+// loop.  Connections are persistent unless the client asks otherwise, and
+// pipelined requests are answered strictly in order: the next buffered request
+// is parsed only once the current response has ended.  Request bytes stay in
+// the connection's parser buffer; only the fields handed to the script are
+// copied into values.
+
+struct HttpServer
+{
+    std::shared_ptr<TcpListener> listener;
+    QuantumValue handler;
+    size_t maxHeaderBytes = 64 * 1024;
+    size_t maxBodyBytes = 16 * 1024 * 1024;
+    double idleTimeoutMs = 5000;
+    std::unordered_set<std::shared_ptr<HttpConnection>> conns;
+    std::vector<long> children; // prefork worker pids (parent only)
+    bool closed = false;        // close() called: finish in-flight responses only
+};
+
+struct HttpConnection
+{
+    std::shared_ptr<HttpServer> server;
+    std::shared_ptr<TcpStream> stream;
+    HttpRequestParser parser;
+    bool busy = false;      // a response is outstanding
+    bool pumping = false;   // pumpHttpConnection() is on the stack
+    bool closing = false;   // no further requests will be read
+    bool peerEnded = false; // client half-closed; finish what is buffered
+    uint64_t idleTimer = 0;
+};
+
+struct HttpExchange
+{
+    std::shared_ptr<HttpConnection> conn;
+    int status = 200;
+    std::vector<std::pair<std::string, std::string>> headers;
+    bool hasContentType = false;
+    bool headOnly = false; // HEAD request: headers but no body
+    bool keepAlive = true;
+    bool headSent = false; // chunked response in progress
+    bool done = false;
+};
+
+namespace
+{
+    // Past this much unparsed pipelined input the socket stops reading until
+    // the current response is finished.
+    constexpr size_t kPipelineLimit = 4 << 20;
+
+    bool isPromiseValue(const QuantumValue &v)
+    {
+        if (!v.isDict())
+            return false;
+        auto d = v.asDict();
+        auto it = d->find("__await__");
+        return it != d->end() && it->second.isNative() && d->count("then");
+    }
+
+    std::string lowerCase(std::string_view s)
+    {
+        std::string out(s);
+        for (char &c : out)
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c + 32);
+        return out;
+    }
+
+    void setHeader(HttpExchange &ex, std::string name, std::string value)
+    {
+        if (http::iequals(name, "content-type"))
+            ex.hasContentType = true;
+        // Framing headers are owned by the server; a handler can still ask
+        // for the connection to be closed after this response.
+        if (http::iequals(name, "connection"))
+        {
+            if (http::iequals(value, "close"))
+                ex.keepAlive = false;
+            return;
+        }
+        if (http::iequals(name, "content-length") || http::iequals(name, "transfer-encoding"))
+            return;
+        for (auto &h : ex.headers)
+            if (http::iequals(h.first, name))
+            {
+                h.second = std::move(value);
+                return;
+            }
+        ex.headers.emplace_back(std::move(name), std::move(value));
+    }
+
+    // Write a complete (Content-Length) response.
+    void sendWhole(HttpExchange &ex, std::string_view body)
+    {
+        if (!ex.hasContentType && !body.empty())
+            setHeader(ex, "Content-Type", "text/plain; charset=utf-8");
+        std::string out;
+        out.reserve(256 + body.size());
+        http::appendResponseHead(out, ex.status, ex.headers, static_cast<long long>(body.size()), ex.keepAlive);
+        if (!ex.headOnly)
+            out.append(body.data(), body.size());
+        if (ex.conn->stream->isOpen())
+            ex.conn->stream->write(out);
+        ex.done = true;
+    }
+
+    // Stream part of a chunked response.
+    bool sendChunk(HttpExchange &ex, std::string_view data)
+    {
+        std::string out;
+        if (!ex.headSent)
+        {
+            if (!ex.hasContentType)
+                setHeader(ex, "Content-Type", "text/plain; charset=utf-8");
+            http::appendResponseHead(out, ex.status, ex.headers, -1, ex.keepAlive);
+            ex.headSent = true;
+        }
+        if (!ex.headOnly)
+            http::appendChunk(out, data);
+        return ex.conn->stream->isOpen() && ex.conn->stream->write(out);
+    }
+
+    void endChunked(HttpExchange &ex, std::string_view data)
+    {
+        std::string out;
+        if (!ex.headOnly)
+        {
+            http::appendChunk(out, data);
+            http::appendLastChunk(out);
+        }
+        if (ex.conn->stream->isOpen())
+            ex.conn->stream->write(out);
+        ex.done = true;
+    }
+
+    // Answer a request the parser rejected, then hang up.
+    void sendError(HttpConnection &conn, int status)
+    {
+        std::string body = std::string(http::reasonPhrase(status)) + "\n";
+        std::string out;
+        http::appendResponseHead(out, status, {{"Content-Type", "text/plain; charset=utf-8"}},
+                                 static_cast<long long>(body.size()), false);
+        out += body;
+        conn.closing = true;
+        conn.stream->write(out);
+        conn.stream->end();
+    }
+
+    // Release a connection once its response is out: either close it or mark
+    // it ready for the next request.
+    void releaseConnection(const HttpExchange &ex)
+    {
+        auto &conn = *ex.conn;
+        conn.busy = false;
+        if (!ex.keepAlive || conn.server->closed)
+        {
+            conn.closing = true;
+            conn.stream->end();
+        }
+        else if (conn.parser.buffered() < kPipelineLimit)
+            conn.stream->resume();
+    }
+}
+
+void VM::acceptHttpConnection(const std::shared_ptr<HttpServer> &server, EventLoop::Handle fd)
+{
+    auto conn = std::make_shared<HttpConnection>();
+    conn->server = server;
+    conn->stream = TcpStream::adopt(eventLoop(), fd);
+    conn->parser.maxHeaderBytes = server->maxHeaderBytes;
+    conn->parser.maxBodyBytes = server->maxBodyBytes;
+    server->conns.insert(conn);
+    std::weak_ptr<HttpConnection> weak = conn;
+
+    conn->stream->onData = [this, weak](const char *data, size_t len)
+    {
+        auto c = weak.lock();
+        if (!c || c->closing)
+            return;
+        if (c->idleTimer)
+        {
+            eventLoop().cancelTimer(c->idleTimer);
+            c->idleTimer = 0;
+        }
+        c->parser.feed(data, len);
+        if (c->busy && c->parser.buffered() >= kPipelineLimit)
+            c->stream->pause();
+        pumpHttpConnection(c);
+    };
+    conn->stream->onEnd = [this, weak]()
+    {
+        auto c = weak.lock();
+        if (!c)
+            return;
+        c->peerEnded = true;
+        if (c->busy && c->server->closed)
+            c->stream->close(); // nobody left to answer, and no server to wait for
+        else
+            pumpHttpConnection(c);
+    };
+    conn->stream->onClose = [this, weak]()
+    {
+        auto c = weak.lock();
+        if (!c)
+            return;
+        c->closing = true;
+        if (c->idleTimer)
+            eventLoop().cancelTimer(c->idleTimer);
+        c->idleTimer = 0;
+        c->server->conns.erase(c);
+    };
+    conn->stream->start();
+}
+
+void VM::pumpHttpConnection(const std::shared_ptr<HttpConnection> &conn)
+{
+    if (conn->pumping)
+        return;
+    conn->pumping = true;
+    auto &server = *conn->server;
+
+    while (!conn->busy && !conn->closing)
+    {
+        auto status = conn->parser.parse();
+        if (status == HttpRequestParser::Status::NeedMore)
+            break;
+        if (status == HttpRequestParser::Status::Error)
+        {
+            sendError(*conn, conn->parser.errorStatus());
+            break;
+        }
+
+        const HttpRequestHead &head = conn->parser.head();
+        auto ex = std::make_shared<HttpExchange>();
+        ex->conn = conn;
+        ex->keepAlive = head.keepAlive && !conn->peerEnded && !server.closed;
+        ex->headOnly = head.method == "HEAD";
+
+        auto req = std::make_shared<Dict>();
+        std::string_view target = head.target;
+        size_t q = target.find('?');
+        (*req)["method"] = QuantumValue(std::string(head.method));
+        (*req)["path"] = QuantumValue(std::string(target.substr(0, q)));
+        (*req)["query"] = QuantumValue(q == std::string_view::npos ? std::string() : std::string(target.substr(q + 1)));
+        (*req)["version"] = QuantumValue(std::string(head.version));
+        auto headers = std::make_shared<Dict>();
+        for (auto &h : head.headers)
+        {
+            std::string key = lowerCase(h.name);
+            auto it = headers->find(key);
+            if (it == headers->end())
+                (*headers)[key] = QuantumValue(std::string(h.value));
+            else
+                it->second = QuantumValue(it->second.asString() + ", " + std::string(h.value));
+        }
+        (*req)["headers"] = QuantumValue(headers);
+        (*req)["body"] = QuantumValue(std::string(conn->parser.body()));
+        (*req)["remote_address"] = QuantumValue(conn->stream->remoteHost());
+        conn->parser.consume();
+
+        conn->busy = true;
+        QuantumValue res = makeHttpResponse(ex);
+        try
+        {
+            QuantumValue result = callFunction(server.handler, {QuantumValue(req), res});
+            if (!ex->done)
+                applyHttpResult(ex, result);
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << "http.serve: handler error: " << e.what() << "\n";
+            if (!ex->done)
+            {
+                if (ex->headSent)
+                {
+                    // Part of the body is already out; the only honest signal
+                    // left is to drop the connection.
+                    ex->done = true;
+                    conn->closing = true;
+                    conn->stream->close();
+                    break;
+                }
+                ex->status = 500;
+                ex->headers.clear();
+                ex->hasContentType = false;
+                sendWhole(*ex, "Internal Server Error\n");
+                releaseConnection(*ex);
+            }
+        }
+    }
+
+    if (!conn->busy && !conn->closing)
+    {
+        if (conn->peerEnded)
+        {
+            conn->closing = true;
+            conn->stream->end();
+        }
+        else if (!conn->idleTimer && server.idleTimeoutMs > 0)
+        {
+            std::weak_ptr<HttpConnection> weak = conn;
+            conn->idleTimer = eventLoop().addTimer(server.idleTimeoutMs, [weak]()
+                                                   {
+                auto c = weak.lock();
+                if (!c)
+                    return;
+                c->idleTimer = 0;
+                if (!c->busy)
+                    c->stream->close(); });
+        }
+    }
+    conn->pumping = false;
+}
+
+QuantumValue VM::makeHttpResponse(const std::shared_ptr<HttpExchange> &ex)
+{
+    auto res = std::make_shared<Dict>();
+    auto method = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "response." + name;
+        nat->fn = std::move(fn);
+        (*res)[name] = QuantumValue(nat);
+    };
+    auto checkOpen = [ex](const char *fn)
+    {
+        if (ex->done)
+            throw RuntimeError(std::string("response.") + fn + "(): response already ended");
+    };
+
+    // status(code)
+    method("status", [ex, checkOpen](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        checkOpen("status");
+        if (ex->headSent)
+            throw RuntimeError("response.status(): headers already sent");
+        if (args.empty() || !args[0].isNumber())
+            throw RuntimeError("response.status() requires a status code");
+        int code = static_cast<int>(args[0].asNumber());
+        if (code < 100 || code > 999)
+            throw RuntimeError("response.status(): invalid status code " + std::to_string(code));
+        ex->status = code;
+        return QuantumValue(); });
+
+    // header(name, value)
+    method("header", [ex, checkOpen](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        checkOpen("header");
+        if (ex->headSent)
+            throw RuntimeError("response.header(): headers already sent");
+        if (args.size() < 2)
+            throw RuntimeError("response.header() requires a name and a value");
+        setHeader(*ex, args[0].toString(), args[1].toString());
+        return QuantumValue(); });
+
+    // write(chunk) — switches the response to chunked transfer encoding.
+    // Returns false when the socket is backed up.
+    method("write", [ex, checkOpen](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        checkOpen("write");
+        std::string data = args.empty() ? std::string() : (args[0].isString() ? args[0].asString() : args[0].toString());
+        return QuantumValue(sendChunk(*ex, data)); });
+
+    // end(body?)
+    method("end", [this, ex, checkOpen](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        checkOpen("end");
+        std::string body = args.empty() || args[0].isNil() ? std::string()
+                         : (args[0].isString() ? args[0].asString() : args[0].toString());
+        if (ex->headSent)
+            endChunked(*ex, body);
+        else
+            sendWhole(*ex, body);
+        releaseConnection(*ex);
+        pumpHttpConnection(ex->conn);
+        return QuantumValue(); });
+
+    return QuantumValue(res);
+}
+
+void VM::applyHttpResult(const std::shared_ptr<HttpExchange> &ex, const QuantumValue &result)
+{
+    if (ex->done || result.isNil())
+        return; // the handler ends the response itself via res.end()
+
+    if (isPromiseValue(result))
+    {
+        auto onFul = std::make_shared<QuantumNative>();
+        onFul->name = "http.resolve";
+        onFul->fn = [this, ex](std::vector<QuantumValue> a) -> QuantumValue
+        {
+            applyHttpResult(ex, a.empty() ? QuantumValue() : a[0]);
+            return QuantumValue();
+        };
+        auto onRej = std::make_shared<QuantumNative>();
+        onRej->name = "http.reject";
+        onRej->fn = [this, ex](std::vector<QuantumValue> a) -> QuantumValue
+        {
+            std::cerr << "http.serve: handler error: " << (a.empty() ? std::string() : a[0].toString()) << "\n";
+            if (ex->done)
+                return QuantumValue();
+            if (ex->headSent)
+            {
+                ex->done = true;
+                ex->conn->closing = true;
+                ex->conn->stream->close();
+                return QuantumValue();
+            }
+            ex->status = 500;
+            ex->headers.clear();
+            ex->hasContentType = false;
+            sendWhole(*ex, "Internal Server Error\n");
+            releaseConnection(*ex);
+            pumpHttpConnection(ex->conn);
+            return QuantumValue();
+        };
+        callFunction((*result.asDict())["then"], {QuantumValue(onFul), QuantumValue(onRej)});
+        return;
+    }
+
+    if (ex->headSent)
+    {
+        endChunked(*ex, result.isString() ? result.asString() : result.toString());
+        releaseConnection(*ex);
+        pumpHttpConnection(ex->conn);
+        return;
+    }
+
+    QuantumValue body = result;
+    if (result.isDict())
+    {
+        // {status, headers, body}
+        auto d = result.asDict();
+        auto it = d->find("status");
+        if (it != d->end() && it->second.isNumber())
+            ex->status = static_cast<int>(it->second.asNumber());
+        it = d->find("headers");
+        if (it != d->end() && it->second.isDict())
+            for (auto &[k, v] : *it->second.asDict())
+                setHeader(*ex, k, v.toString());
+        it = d->find("body");
+        body = it != d->end() ? it->second : QuantumValue();
+    }
+
+    std::string text;
+    if (body.isDict() || body.isArray())
+    {
+        // Structured bodies go out as JSON.
+        QuantumValue json = globals->get("JSON");
+        if (json.isDict() && json.asDict()->count("stringify"))
+            text = callFunction((*json.asDict())["stringify"], {body}).toString();
+        else
+            text = body.toString();
+        if (!ex->hasContentType)
+            setHeader(*ex, "Content-Type", "application/json");
+    }
+    else if (!body.isNil())
+        text = body.isString() ? body.asString() : body.toString();
+
+    sendWhole(*ex, text);
+    releaseConnection(*ex);
+    pumpHttpConnection(ex->conn);
+}
+
+// ─── fetch ───────────────────────────────────────────────────────────────────
+// fetch(url, opts?) — promise for a response object once the status line and
+// headers are in.  The body keeps streaming into the response afterwards:
+// read() hands it out chunk by chunk, text() / json() / bytes() wait for all
+// of it.  Connections come from the VM-wide HttpClient pool.
+
+namespace
+{
+    // A response nobody is reading stops pulling from the socket once this
+    // much body is buffered; read() resumes it.
+    constexpr size_t kFetchBufferLimit = 4 << 20;
+
+    struct FetchState
+    {
+        std::shared_ptr<HttpClient::Request> req;
+        std::shared_ptr<PromiseState> response; // fetch()'s own promise
+        std::string body;     // received and not yet handed to read()
+        bool streaming = false; // read() has been used: apply backpressure
+        bool done = false;
+        bool paused = false;
+        std::string error;
+        std::deque<std::shared_ptr<PromiseState>> readers;
+        std::vector<std::pair<std::shared_ptr<PromiseState>, int>> waiters; // 0 text, 1 json, 2 bytes
+    };
+
+    // http://host[:port]/path?query  →  host, port, target.
+    std::string parseHttpUrl(const std::string &url, std::string &host, int &port, std::string &target)
+    {
+        std::string rest;
+        if (url.compare(0, 7, "http://") == 0)
+            rest = url.substr(7);
+        else if (url.compare(0, 8, "https://") == 0)
+            return "https is not supported (no TLS in this build)";
+        else if (url.find("://") != std::string::npos)
+            return "unsupported URL scheme in '" + url + "'";
+        else
+            rest = url;
+
+        size_t slash = rest.find_first_of("/?#");
+        std::string authority = rest.substr(0, slash);
+        target = slash == std::string::npos ? "/" : rest.substr(slash);
+        if (!target.empty() && target[0] != '/')
+            target = "/" + target;
+        size_t hash = target.find('#');
+        if (hash != std::string::npos)
+            target.erase(hash);
+
+        size_t at = authority.rfind('@');
+        if (at != std::string::npos)
+            authority.erase(0, at + 1);
+        port = 80;
+        if (!authority.empty() && authority[0] == '[')
+        {
+            size_t close = authority.find(']');
+            if (close == std::string::npos)
+                return "invalid URL '" + url + "'";
+            host = authority.substr(1, close - 1);
+            authority.erase(0, close + 1);
+        }
+        else
+        {
+            size_t colon = authority.find(':');
+            host = authority.substr(0, colon);
+            authority.erase(0, colon == std::string::npos ? authority.size() : colon);
+        }
+        if (!authority.empty())
+        {
+            if (authority[0] != ':' || authority.size() < 2)
+                return "invalid URL '" + url + "'";
+            char *end = nullptr;
+            long p = std::strtol(authority.c_str() + 1, &end, 10);
+            if (*end || p <= 0 || p > 65535)
+                return "invalid port in '" + url + "'";
+            port = static_cast<int>(p);
+        }
+        if (host.empty())
+            return "invalid URL '" + url + "'";
+        return "";
+    }
+}
+
+HttpClient &VM::httpClient()
+{
+    if (!httpClient_)
+    {
+        httpClient_ = std::make_shared<HttpClient>(eventLoop(), [this](const std::string &host, int port, auto done)
+                                                   { resolveHost(host, port, std::move(done)); });
+    }
+    return *httpClient_;
+}
+
+void VM::registerHttpNatives()
+{
+    auto httpDict = std::make_shared<Dict>();
+
+    // http.serve(port, handler, opts?) — handler(req, res) is called for each
+    // request.  req: {method, path, query, version, headers, body,
+    // remote_address} (header names lower-cased).  The handler either returns
+    // the response (a string, a {status, headers, body} dict, or a promise of
+    // either) or drives res.status / res.header / res.write / res.end itself.
+    //
+    // opts: host ("0.0.0.0"), backlog, workers (prefork processes sharing the
+    // listening socket, POSIX only), idle_timeout_ms (5000), max_body (bytes),
+    // max_header (bytes).
+    auto serve = std::make_shared<QuantumNative>();
+    serve->name = "http.serve";
+    serve->fn = [this](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        if (args.size() < 2 || !args[0].isNumber())
+            throw RuntimeError("http.serve() requires a port and a handler");
+        double p = args[0].asNumber();
+        if (p < 0 || p > 65535)
+            throw RuntimeError("http.serve(): port out of range");
+        int port = static_cast<int>(p);
+
+        auto server = std::make_shared<HttpServer>();
+        server->handler = args[1];
+        std::string host = "0.0.0.0";
+        int backlog = 0;
+        int workers = 1;
+        if (args.size() > 2 && args[2].isDict())
+        {
+            auto opts = args[2].asDict();
+            auto num = [&](const char *key, double fallback)
+            {
+                auto it = opts->find(key);
+                return it != opts->end() && it->second.isNumber() ? it->second.asNumber() : fallback;
+            };
+            auto it = opts->find("host");
+            if (it != opts->end() && !it->second.isNil())
+                host = it->second.toString();
+            backlog = static_cast<int>(num("backlog", 0));
+            workers = std::max(1, static_cast<int>(num("workers", 1)));
+            server->idleTimeoutMs = num("idle_timeout_ms", server->idleTimeoutMs);
+            server->maxBodyBytes = static_cast<size_t>(std::max(0.0, num("max_body", static_cast<double>(server->maxBodyBytes))));
+            server->maxHeaderBytes = static_cast<size_t>(std::max(1024.0, num("max_header", static_cast<double>(server->maxHeaderBytes))));
+        }
+
+        std::string err;
+        server->listener = TcpListener::listen(eventLoop(), host, port, backlog, false, err);
+        if (!server->listener)
+            throw RuntimeError("http.serve(): cannot listen on " + host + ":" + std::to_string(port) + ": " + err);
+
+        // Prefork: every worker inherits the listening socket and runs its own
+        // event loop, so the kernel spreads connections across processes.
+        int workerIndex = 0;
+#ifndef _WIN32
+        if (workers > 1)
+        {
+            if (!eventLoop().canFork())
+            {
+                server->listener->close();
+                throw RuntimeError("http.serve(): workers > 1 must be started before any other async I/O");
+            }
+            std::cout.flush();
+            std::fflush(nullptr);
+            for (int i = 1; i < workers; ++i)
+            {
+                pid_t pid = fork();
+                if (pid < 0)
+                    break;
+                if (pid == 0)
+                {
+                    workerIndex = i;
+                    server->children.clear();
+                    eventLoop().afterFork();
+                    break;
+                }
+                server->children.push_back(static_cast<long>(pid));
+            }
+        }
+#else
+        workers = 1; // no fork(); a single process serves everything
+#endif
+
+        server->listener->onAccept = [this, server](net::Handle fd)
+        { acceptHttpConnection(server, fd); };
+        server->listener->start();
+
+        auto obj = std::make_shared<Dict>();
+        auto close = std::make_shared<QuantumNative>();
+        close->name = "server.close";
+        close->fn = [server](std::vector<QuantumValue>) -> QuantumValue
+        {
+            server->listener->close();
+            server->closed = true;
+            // Idle connections go now; busy ones once their response is out,
+            // unless the client has already gone.
+            auto conns = server->conns;
+            for (auto &c : conns)
+                if (!c->busy || c->peerEnded)
+                    c->stream->close();
+#ifndef _WIN32
+            for (long pid : server->children)
+            {
+                kill(static_cast<pid_t>(pid), SIGTERM);
+                waitpid(static_cast<pid_t>(pid), nullptr, 0);
+            }
+#endif
+            server->children.clear();
+            return QuantumValue();
+        };
+        (*obj)["close"] = QuantumValue(close);
+        (*obj)["port"] = QuantumValue(static_cast<double>(server->listener->port()));
+        (*obj)["host"] = QuantumValue(host);
+        (*obj)["worker"] = QuantumValue(static_cast<double>(workerIndex));
+        (*obj)["workers"] = QuantumValue(static_cast<double>(workers));
+        return QuantumValue(obj);
+    };
+    (*httpDict)["serve"] = QuantumValue(serve);
+
+    // http.client_options({max_connections, pipeline_depth, idle_timeout_ms})
+    // tunes the fetch() connection pool.
+    auto clientOptions = std::make_shared<QuantumNative>();
+    clientOptions->name = "http.client_options";
+    clientOptions->fn = [this](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        HttpClient &client = httpClient();
+        if (!args.empty() && args[0].isDict())
+        {
+            auto opts = args[0].asDict();
+            auto num = [&](const char *key) -> double
+            {
+                auto it = opts->find(key);
+                return it != opts->end() && it->second.isNumber() ? it->second.asNumber() : -1;
+            };
+            if (num("max_connections") >= 1)
+                client.maxConnectionsPerHost = static_cast<size_t>(num("max_connections"));
+            if (num("pipeline_depth") >= 1)
+                client.maxPipelineDepth = static_cast<size_t>(num("pipeline_depth"));
+            if (num("idle_timeout_ms") >= 0)
+                client.idleTimeoutMs = num("idle_timeout_ms");
+        }
+        auto out = std::make_shared<Dict>();
+        (*out)["max_connections"] = QuantumValue(static_cast<double>(client.maxConnectionsPerHost));
+        (*out)["pipeline_depth"] = QuantumValue(static_cast<double>(client.maxPipelineDepth));
+        (*out)["idle_timeout_ms"] = QuantumValue(client.idleTimeoutMs);
+        return QuantumValue(out);
+    };
+    (*httpDict)["client_options"] = QuantumValue(clientOptions);
+
+    // http.client_stats() — {opened, open, idle} for the fetch() pool.
+    auto clientStats = std::make_shared<QuantumNative>();
+    clientStats->name = "http.client_stats";
+    clientStats->fn = [this](std::vector<QuantumValue>) -> QuantumValue
+    {
+        HttpClient &client = httpClient();
+        auto out = std::make_shared<Dict>();
+        (*out)["opened"] = QuantumValue(static_cast<double>(client.connectionsOpened()));
+        (*out)["open"] = QuantumValue(static_cast<double>(client.openConnections()));
+        (*out)["idle"] = QuantumValue(static_cast<double>(client.idleConnections()));
+        return QuantumValue(out);
+    };
+    (*httpDict)["client_stats"] = QuantumValue(clientStats);
+
+    globals->define("http", QuantumValue(httpDict));
+
+    // fetch(url, {method, headers, body, timeout, pipeline}) — promise for a
+    // response: {status, ok, status_text, url, headers, read(), text(),
+    // json(), bytes()}.  Dict / array bodies are sent as JSON.
+    auto fetch = std::make_shared<QuantumNative>();
+    fetch->name = "fetch";
+    fetch->fn = [this](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        if (args.empty())
+            throw RuntimeError("fetch() requires a URL");
+        std::string url = args[0].toString();
+        auto req = std::make_shared<HttpClient::Request>();
+        std::string err = parseHttpUrl(url, req->host, req->port, req->target);
+        if (!err.empty())
+            throw RuntimeError("fetch(): " + err);
+
+        if (args.size() > 1 && args[1].isDict())
+        {
+            auto opts = args[1].asDict();
+            auto it = opts->find("method");
+            if (it != opts->end() && !it->second.isNil())
+            {
+                req->method = it->second.toString();
+                for (char &c : req->method)
+                    if (c >= 'a' && c <= 'z')
+                        c = static_cast<char>(c - 32);
+            }
+            bool hasType = false;
+            it = opts->find("headers");
+            if (it != opts->end() && it->second.isDict())
+                for (auto &[k, v] : *it->second.asDict())
+                {
+                    hasType = hasType || http::iequals(k, "content-type");
+                    req->headers.emplace_back(k, v.toString());
+                }
+            it = opts->find("body");
+            if (it != opts->end() && !it->second.isNil())
+            {
+                const QuantumValue &b = it->second;
+                if (b.isDict() || b.isArray())
+                {
+                    QuantumValue json = globals->get("JSON");
+                    req->body = callFunction((*json.asDict())["stringify"], {b}).toString();
+                    if (!hasType)
+                        req->headers.emplace_back("Content-Type", "application/json");
+                }
+                else
+                    req->body = b.isString() ? b.asString() : b.toString();
+                if (req->method == "GET" && !opts->count("method"))
+                    req->method = "POST";
+            }
+            it = opts->find("timeout");
+            if (it != opts->end() && it->second.isNumber())
+                req->timeoutMs = it->second.asNumber();
+            it = opts->find("pipeline");
+            if (it != opts->end() && !it->second.isNil())
+                req->pipeline = it->second.isTruthy();
+        }
+
+        auto st = std::make_shared<FetchState>();
+        st->req = req;
+        st->response = std::make_shared<PromiseState>();
+        QuantumValue promise = makePromise(st->response);
+
+        auto deliver = [this](const std::shared_ptr<FetchState> &st)
+        {
+            while (!st->readers.empty() && !st->body.empty())
+            {
+                auto p = st->readers.front();
+                st->readers.pop_front();
+                std::string chunk;
+                chunk.swap(st->body);
+                settlePromise(p, QuantumValue(std::move(chunk)), false);
+            }
+            if (!st->done && st->error.empty())
+            {
+                if (st->paused && st->body.size() < kFetchBufferLimit)
+                {
+                    st->paused = false;
+                    st->req->resume();
+                }
+                return;
+            }
+            auto readers = std::move(st->readers);
+            st->readers.clear();
+            for (auto &p : readers)
+                settlePromise(p, st->error.empty() ? QuantumValue() : QuantumValue(st->error), !st->error.empty());
+            auto waiters = std::move(st->waiters);
+            st->waiters.clear();
+            for (auto &[p, kind] : waiters)
+            {
+                if (!st->error.empty())
+                {
+                    settlePromise(p, QuantumValue(st->error), true);
+                    continue;
+                }
+                try
+                {
+                    if (kind == 1)
+                    {
+                        QuantumValue json = globals->get("JSON");
+                        settlePromise(p, callFunction((*json.asDict())["parse"], {QuantumValue(st->body)}), false);
+                    }
+                    else if (kind == 2)
+                    {
+                        auto arr = std::make_shared<Array>();
+                        arr->reserve(st->body.size());
+                        for (unsigned char c : st->body)
+                            arr->push_back(QuantumValue(static_cast<double>(c)));
+                        settlePromise(p, QuantumValue(arr), false);
+                    }
+                    else
+                        settlePromise(p, QuantumValue(st->body), false);
+                }
+                catch (std::exception &e)
+                {
+                    settlePromise(p, QuantumValue(std::string(e.what())), true);
+                }
+            }
+        };
+
+        // The request's callbacks own the state until the exchange finishes;
+        // the client clears them then, so nothing outlives the response.
+        req->onHead = [this, st, url, deliver](const HttpResponseHead &head)
+        {
+            auto res = std::make_shared<Dict>();
+            (*res)["status"] = QuantumValue(static_cast<double>(head.status));
+            (*res)["ok"] = QuantumValue(head.status >= 200 && head.status < 300);
+            (*res)["status_text"] = QuantumValue(head.reason);
+            (*res)["url"] = QuantumValue(url);
+            auto headers = std::make_shared<Dict>();
+            for (auto &[k, v] : head.headers)
+            {
+                std::string key = lowerCase(k);
+                auto it = headers->find(key);
+                if (it == headers->end())
+                    (*headers)[key] = QuantumValue(v);
+                else
+                    it->second = QuantumValue(it->second.asString() + ", " + v);
+            }
+            (*res)["headers"] = QuantumValue(headers);
+
+            auto method = [&](const std::string &name, QuantumNativeFunc fn)
+            {
+                auto nat = std::make_shared<QuantumNative>();
+                nat->name = "Response." + name;
+                nat->fn = std::move(fn);
+                (*res)[name] = QuantumValue(nat);
+            };
+            // read() — next chunk of the body, nil at the end.
+            method("read", [this, st, deliver](std::vector<QuantumValue>) -> QuantumValue
+                   {
+                st->streaming = true;
+                auto p = std::make_shared<PromiseState>();
+                st->readers.push_back(p);
+                deliver(st);
+                return makePromise(p); });
+            auto whole = [this, st, deliver](int kind)
+            {
+                auto p = std::make_shared<PromiseState>();
+                st->waiters.emplace_back(p, kind);
+                if (st->paused)
+                {
+                    st->paused = false;
+                    st->req->resume();
+                }
+                deliver(st);
+                return makePromise(p);
+            };
+            method("text", [whole](std::vector<QuantumValue>) -> QuantumValue
+                   { return whole(0); });
+            method("json", [whole](std::vector<QuantumValue>) -> QuantumValue
+                   { return whole(1); });
+            method("bytes", [whole](std::vector<QuantumValue>) -> QuantumValue
+                   { return whole(2); });
+
+            settlePromise(st->response, QuantumValue(res), false);
+        };
+        req->onData = [st, deliver](const char *data, size_t len)
+        {
+            st->body.append(data, len);
+            deliver(st);
+            if (st->streaming && st->waiters.empty() && !st->paused && st->body.size() >= kFetchBufferLimit)
+            {
+                st->paused = true;
+                st->req->pause();
+            }
+        };
+        req->onDone = [st, deliver]()
+        {
+            st->done = true;
+            deliver(st);
+        };
+        req->onError = [this, st, deliver](const std::string &msg)
+        {
+            st->error = "fetch(): " + msg;
+            if (st->response->status == PromiseState::Status::Pending)
+                settlePromise(st->response, QuantumValue(st->error), true);
+            deliver(st);
+        };
+
+        httpClient().send(req);
+        return promise;
+    };
+    globals->define("fetch", QuantumValue(fetch));
+}
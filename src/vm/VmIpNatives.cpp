@@ -0,0 +1,263 @@
+#include "Vm.h"
+#include "Error.h"
+#include "IpSet.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── IP address natives ───────────────────────────────────────────────────────
+// ip_to_int / ip_in_cidr / cidr_hosts, the lazy ip_hosts iterator, and IPSet:
+// a prefix set built once from many CIDRs and matched against address streams
+// without reparsing the rules.
+
+namespace
+{
+    // Strings are parsed (IPv4 or IPv6); numbers are IPv4 addresses as
+    // returned by ip_to_int().
+    bool addressArg(const QuantumValue &v, ipaddr::Address &out)
+    {
+        if (v.isNumber())
+        {
+            double n = v.asNumber();
+            if (n < 0 || n > 4294967295.0)
+                return false;
+            out = ipaddr::Address();
+            out.lo = static_cast<uint64_t>(n);
+            return true;
+        }
+        if (!v.isString())
+            return false;
+        return ipaddr::parse(v.asString(), out);
+    }
+
+    ipaddr::Prefix prefixArg(const QuantumValue &v, const char *fn)
+    {
+        ipaddr::Prefix p;
+        if (!v.isString() || !ipaddr::parsePrefix(v.asString(), p))
+            throw RuntimeError(std::string(fn) + "(): invalid CIDR '" + v.toString() + "'");
+        return p;
+    }
+
+    // The usable hosts of a prefix.  For IPv4 the network and broadcast
+    // addresses are left out unless all is set (or the prefix is /31 or
+    // /32, where there are none to spare).
+    void hostRange(const ipaddr::Prefix &p, bool all, ipaddr::Address &first, ipaddr::Address &last)
+    {
+        first = p.addr;
+        last = p.last();
+        if (!p.addr.v6 && !all && p.length <= 30)
+        {
+            first.lo++;
+            last.lo--;
+        }
+    }
+
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    struct SetState
+    {
+        IpSet set;
+        std::vector<QuantumValue> values; // indexed by prefix tag
+    };
+
+    void addPrefix(SetState &s, const QuantumValue &cidr, QuantumValue value)
+    {
+        ipaddr::Prefix p = prefixArg(cidr, "IPSet.add");
+        // Without an explicit value, lookup() reports the matching rule itself.
+        if (value.isNil())
+            value = QuantumValue(ipaddr::format(p));
+        s.values.push_back(std::move(value));
+        s.set.add(p, static_cast<uint32_t>(s.values.size() - 1));
+    }
+
+    QuantumValue makeIpSet(std::shared_ptr<SetState> state)
+    {
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "IPSet.");
+
+        // add(cidr, value?) — true if the prefix was not already present.
+        method("add", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty())
+                throw RuntimeError("IPSet.add() requires a CIDR");
+            size_t before = state->set.size();
+            addPrefix(*state, args[0], args.size() > 1 ? args[1] : QuantumValue());
+            return QuantumValue(state->set.size() != before); });
+
+        // contains(ip) — false for anything that does not parse as an address.
+        auto contains = [state](std::vector<QuantumValue> args) -> QuantumValue
+        {
+            ipaddr::Address a;
+            return QuantumValue(!args.empty() && addressArg(args[0], a) && state->set.contains(a));
+        };
+        method("contains", contains);
+        method("has", contains);
+
+        // lookup(ip) — value of the most specific matching prefix, or nil.
+        method("lookup", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            ipaddr::Address a;
+            if (args.empty() || !addressArg(args[0], a))
+                return QuantumValue();
+            uint32_t tag = state->set.longestMatch(a);
+            return tag == IpSet::kNoTag ? QuantumValue() : state->values[tag]; });
+
+        // match(ip) — the most specific matching prefix as "addr/len", or nil.
+        method("match", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            ipaddr::Address a;
+            ipaddr::Prefix p;
+            if (args.empty() || !addressArg(args[0], a) || state->set.longestMatch(a, &p) == IpSet::kNoTag)
+                return QuantumValue();
+            return QuantumValue(ipaddr::format(p)); });
+
+        // filter(ips) — the addresses in ips that the set contains, in order.
+        method("filter", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty() || !args[0].isArray())
+                throw RuntimeError("IPSet.filter() requires an array of addresses");
+            auto out = std::make_shared<Array>();
+            ipaddr::Address a;
+            for (auto &v : *args[0].asArray())
+                if (addressArg(v, a) && state->set.contains(a))
+                    out->push_back(v);
+            return QuantumValue(out); });
+
+        method("size", [state](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(static_cast<double>(state->set.size())); });
+
+        // prefixes() — every prefix as "addr/len", IPv4 first, in address order.
+        method("prefixes", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            auto out = std::make_shared<Array>();
+            for (auto &entry : state->set.prefixes())
+                out->push_back(QuantumValue(ipaddr::format(entry.first)));
+            return QuantumValue(out); });
+
+        return QuantumValue(obj);
+    }
+}
+
+void VM::registerIpNatives()
+{
+    auto reg = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = name;
+        nat->fn = std::move(fn);
+        globals->define(name, QuantumValue(nat));
+    };
+
+    reg("ip_to_int", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty()) throw RuntimeError("ip_to_int() requires 1 argument");
+        uint32_t v;
+        if (!ipaddr::parseV4(args[0].toString(), v))
+            throw RuntimeError("ip_to_int(): invalid IPv4 address '" + args[0].toString() + "'");
+        return QuantumValue(static_cast<double>(v)); });
+
+    // ip_in_cidr(ip, cidr) — IPv4 or IPv6; false if either does not parse.
+    // For many checks against the same rules, build an IPSet instead.
+    reg("ip_in_cidr", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2) throw RuntimeError("ip_in_cidr() requires 2 arguments");
+        ipaddr::Address a;
+        ipaddr::Prefix p;
+        if (!addressArg(args[0], a) || !ipaddr::parsePrefix(args[1].toString(), p))
+            return QuantumValue(false);
+        return QuantumValue(p.contains(ipaddr::unmapped(a))); });
+
+    // cidr_hosts(cidr) — every host as a string array.  IPv4 only; prefer
+    // ip_hosts() for anything larger than a few thousand addresses.
+    reg("cidr_hosts", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty()) throw RuntimeError("cidr_hosts() requires 1 argument");
+        auto arr = std::make_shared<Array>();
+        ipaddr::Prefix p;
+        if (!ipaddr::parsePrefix(args[0].toString(), p) || p.addr.v6)
+            return QuantumValue(arr);
+        ipaddr::Address first, last;
+        hostRange(p, false, first, last);
+        arr->reserve(static_cast<size_t>(last.lo - first.lo + 1));
+        for (uint64_t ip = first.lo; ip <= last.lo; ip++)
+            arr->push_back(QuantumValue(ipaddr::formatV4(static_cast<uint32_t>(ip))));
+        return QuantumValue(arr); });
+
+    // ip_hosts(cidr, {as: "string" | "int", all: false}) — lazy iterator over
+    // a prefix's hosts; each address is produced only when the loop asks.
+    // "int" is IPv4 only.
+    reg("ip_hosts", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty()) throw RuntimeError("ip_hosts() requires a CIDR");
+        ipaddr::Prefix p = prefixArg(args[0], "ip_hosts");
+        bool asInt = false, all = false;
+        if (args.size() > 1 && args[1].isDict())
+        {
+            auto &opts = *args[1].asDict();
+            auto it = opts.find("as");
+            if (it != opts.end())
+            {
+                std::string as = it->second.toString();
+                if (as != "int" && as != "string")
+                    throw RuntimeError("ip_hosts(): 'as' must be \"string\" or \"int\"");
+                asInt = as == "int";
+            }
+            if ((it = opts.find("all")) != opts.end())
+                all = it->second.isTruthy();
+        }
+        if (asInt && p.addr.v6)
+            throw RuntimeError("ip_hosts(): integer output is IPv4 only");
+
+        struct Cursor
+        {
+            ipaddr::Address next, last;
+            bool done;
+        };
+        auto cur = std::make_shared<Cursor>();
+        hostRange(p, all, cur->next, cur->last);
+        cur->done = cur->last < cur->next;
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [cur, asInt](std::vector<QuantumValue>) -> QuantumValue
+        {
+            if (cur->done)
+                return QuantumValue();
+            ipaddr::Address a = cur->next;
+            cur->done = a == cur->last;
+            cur->next = ipaddr::next(a);
+            if (asInt)
+                return QuantumValue(static_cast<double>(a.lo));
+            return QuantumValue(ipaddr::format(a));
+        };
+        return QuantumValue(iter); });
+
+    // IPSet(prefixes?) — prefixes is an array of CIDRs or a dict of
+    // {cidr: value} for lookup().
+    reg("IPSet", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        auto state = std::make_shared<SetState>();
+        if (!args.empty() && args[0].isArray())
+        {
+            for (auto &c : *args[0].asArray())
+                addPrefix(*state, c, QuantumValue());
+        }
+        else if (!args.empty() && args[0].isDict())
+        {
+            for (auto &[cidr, value] : *args[0].asDict())
+                addPrefix(*state, QuantumValue(cidr), value);
+        }
+        else if (!args.empty() && !args[0].isNil())
+            throw RuntimeError("IPSet() takes an array of CIDRs or a dict of {cidr: value}");
+        return makeIpSet(state); });
+}
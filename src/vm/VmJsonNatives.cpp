@@ -0,0 +1,362 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Json.h"
+#include "MappedFile.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── JSON natives ─────────────────────────────────────────────────────────────
+// JSON.parse / JSON.stringify, and the json module: streaming counterparts
+// to JSON.parse for input too large or too deep to hold as one tree.
+// events() hands out parser tokens, lines() reads JSON Lines a record at a
+// time, and select() materialises only the values a path picks out,
+// skipping everything else unparsed.
+
+namespace
+{
+    // Deeper values are refused when building trees: freeing one recurses
+    // per level, and that stack is not ours to spend.
+    constexpr size_t kMaxBuildDepth = 1000;
+
+    struct Source
+    {
+        QuantumValue keep; // the text being read, when it came from the script
+        std::unique_ptr<json::Reader> reader;
+    };
+
+    // JSON text (a string or bytes), or a file object from open(), which is
+    // reopened so the scan has its own position.
+    std::shared_ptr<Source> openSource(std::vector<QuantumValue> &args, const std::string &fn)
+    {
+        if (args.empty())
+            throw RuntimeError(fn + "() requires JSON text or a file");
+        auto src = std::make_shared<Source>();
+        QuantumValue &v = args[0];
+        if (v.isDict())
+        {
+            auto it = v.asDict()->find("path");
+            if (it == v.asDict()->end())
+                throw RuntimeError(fn + "(): expected JSON text or a file object");
+            std::string path = it->second.toString();
+            auto mf = MappedFile::open(path);
+            if (!mf)
+                throw RuntimeError(fn + "(): cannot open '" + path + "'");
+            mf->adviseSequential();
+            src->reader = std::make_unique<json::Reader>(std::move(mf));
+            return src;
+        }
+        if (!v.isString() && !v.isBytes())
+            throw RuntimeError(fn + "(): expected JSON text or a file object");
+        src->keep = std::move(v);
+        std::string scratch; // unused: strings and bytes are viewed in place
+        src->reader = std::make_unique<json::Reader>(src->keep.bytesView(scratch));
+        return src;
+    }
+
+    // The value starting with token t, read to its end without recursion.
+    QuantumValue buildValue(json::Reader &r, json::Token t, const std::string &fn)
+    {
+        struct Frame
+        {
+            QuantumValue container;
+            std::string key;
+        };
+        std::vector<Frame> stack;
+        for (;; t = r.next())
+        {
+            QuantumValue v;
+            switch (t)
+            {
+            case json::Token::BeginObject:
+            case json::Token::BeginArray:
+                if (stack.size() >= kMaxBuildDepth)
+                    throw RuntimeError(fn + "(): nesting deeper than " + std::to_string(kMaxBuildDepth) + " levels");
+                if (t == json::Token::BeginObject)
+                    stack.push_back({QuantumValue(std::make_shared<Dict>()), {}});
+                else
+                    stack.push_back({QuantumValue(std::make_shared<Array>()), {}});
+                continue;
+            case json::Token::Key:
+                stack.back().key.assign(r.text());
+                continue;
+            case json::Token::EndObject:
+            case json::Token::EndArray:
+                v = std::move(stack.back().container);
+                stack.pop_back();
+                break;
+            case json::Token::String:
+                v = QuantumValue(std::string(r.text()));
+                break;
+            case json::Token::Number:
+                v = QuantumValue(r.number());
+                break;
+            case json::Token::True:
+            case json::Token::False:
+                v = QuantumValue(t == json::Token::True);
+                break;
+            case json::Token::Null:
+                break;
+            case json::Token::End:
+                throw RuntimeError(fn + "(): unexpected end of input");
+            case json::Token::Error:
+                throw RuntimeError(fn + "(): " + r.error());
+            }
+            if (stack.empty())
+                return v;
+            Frame &f = stack.back();
+            if (f.container.isArray())
+                f.container.asArray()->push_back(std::move(v));
+            else
+                f.container.asDict()->insert_or_assign(f.key, std::move(v));
+        }
+    }
+
+    void stringify(std::string &out, const QuantumValue &v, size_t depth)
+    {
+        if (depth > kMaxBuildDepth)
+            throw RuntimeError("JSON.stringify(): nesting deeper than " + std::to_string(kMaxBuildDepth) +
+                               " levels (is the value cyclic?)");
+        if (v.isNil())
+            out += "null";
+        else if (v.isBool())
+            out += v.asBool() ? "true" : "false";
+        else if (v.isNumber())
+            json::appendNumber(out, v.asNumber());
+        else if (v.isString())
+            json::appendString(out, v.asString());
+        else if (v.isArray())
+        {
+            out += '[';
+            bool first = true;
+            for (auto &item : *v.asArray())
+            {
+                if (!first)
+                    out += ',';
+                first = false;
+                stringify(out, item, depth + 1);
+            }
+            out += ']';
+        }
+        else if (v.isDict())
+        {
+            out += '{';
+            bool first = true;
+            for (auto &[k, item] : *v.asDict())
+            {
+                if (!first)
+                    out += ',';
+                first = false;
+                json::appendString(out, k);
+                out += ':';
+                stringify(out, item, depth + 1);
+            }
+            out += '}';
+        }
+        else
+            json::appendString(out, v.toString());
+    }
+
+    bool optionSet(const std::vector<QuantumValue> &args, size_t i, const char *key)
+    {
+        if (args.size() <= i || !args[i].isDict())
+            return false;
+        auto it = args[i].asDict()->find(key);
+        return it != args[i].asDict()->end() && it->second.isTruthy();
+    }
+}
+
+void VM::registerJsonNatives()
+{
+    auto mod = std::make_shared<Dict>();
+    auto lib = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "json." + name;
+        nat->fn = std::move(fn);
+        (*mod)[name] = QuantumValue(nat);
+    };
+
+    // JSON.parse(text) — nil when text is not a string or not valid JSON.
+    // Strings are viewed in place rather than copied first.
+    auto parse = std::make_shared<QuantumNative>();
+    parse->name = "JSON.parse";
+    parse->fn = [](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        if (args.empty() || !args[0].isString())
+            return QuantumValue();
+        json::Reader r(args[0].asString());
+        try
+        {
+            QuantumValue v = buildValue(r, r.next(), "JSON.parse");
+            return r.next() == json::Token::End ? v : QuantumValue();
+        }
+        catch (const RuntimeError &)
+        {
+            return QuantumValue();
+        }
+    };
+
+    // JSON.stringify(value) — compact, written into one growing buffer.
+    auto stringifyNat = std::make_shared<QuantumNative>();
+    stringifyNat->name = "JSON.stringify";
+    stringifyNat->fn = [](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        std::string out;
+        stringify(out, args.empty() ? QuantumValue() : args[0], 0);
+        return QuantumValue(std::move(out));
+    };
+
+    auto JSON = std::make_shared<Dict>();
+    (*JSON)["parse"] = QuantumValue(parse);
+    (*JSON)["stringify"] = QuantumValue(stringifyNat);
+    globals->define("JSON", QuantumValue(JSON));
+
+    // events(src) — lazy iterator of {event, value, depth}.  event is
+    // start_object / end_object / start_array / end_array / key / string /
+    // number / bool / null; value is set for key and the scalars.  Several
+    // top-level values in a row are read one after another.
+    lib("events", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        auto src = openSource(args, "json.events");
+        src->reader->allowMultiple(true);
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [src](std::vector<QuantumValue>) -> QuantumValue
+        {
+            json::Reader &r = *src->reader;
+            json::Token t = r.next();
+            if (t == json::Token::End)
+                return QuantumValue();
+            if (t == json::Token::Error)
+                throw RuntimeError("json.events(): " + r.error());
+            auto ev = std::make_shared<Dict>();
+            (*ev)["event"] = QuantumValue(std::string(json::tokenName(t)));
+            (*ev)["depth"] = QuantumValue(static_cast<double>(r.depth()));
+            if (t == json::Token::Key || t == json::Token::String)
+                (*ev)["value"] = QuantumValue(std::string(r.text()));
+            else if (t == json::Token::Number)
+                (*ev)["value"] = QuantumValue(r.number());
+            else if (t == json::Token::True || t == json::Token::False)
+                (*ev)["value"] = QuantumValue(t == json::Token::True);
+            return QuantumValue(ev);
+        };
+        return QuantumValue(iter); });
+
+    // lines(path, {skip_invalid}) — lazy iterator over a JSON Lines file,
+    // one parsed record per non-blank line.  path may also be a file
+    // object.  A malformed line is an error naming its line number unless
+    // skip_invalid is set.
+    lib("lines", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("json.lines() requires a path");
+        std::string path = args[0].isDict() && args[0].asDict()->count("path")
+                               ? args[0].asDict()->at("path").toString()
+                               : args[0].toString();
+        auto mf = MappedFile::open(path);
+        if (!mf)
+            throw RuntimeError("json.lines(): cannot open '" + path + "'");
+        mf->adviseSequential();
+        auto lines = std::make_shared<LineReader>(mf);
+        bool skipInvalid = optionSet(args, 1, "skip_invalid");
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [lines, skipInvalid](std::vector<QuantumValue>) -> QuantumValue
+        {
+            std::string_view line;
+            while (lines->next(line))
+            {
+                if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+                    continue;
+                json::Reader r(line);
+                try
+                {
+                    QuantumValue v = buildValue(r, r.next(), "json.lines");
+                    if (r.next() != json::Token::End)
+                        throw RuntimeError("json.lines(): " + r.error());
+                    return v.isNil() ? iterNil() : v; // a null record, not the end
+                }
+                catch (const RuntimeError &e)
+                {
+                    if (!skipInvalid)
+                        throw RuntimeError(std::string(e.what()) + " (line " + std::to_string(lines->lineNumber()) + ")");
+                }
+            }
+            return QuantumValue();
+        };
+        return QuantumValue(iter); });
+
+    // select(src, path) — lazy iterator of the values path picks out, e.g.
+    // "$.items[*].id" or "$..email".  Subtrees the path cannot reach are
+    // skipped without building anything; a match inside another match is
+    // not reported again.
+    lib("select", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2 || !args[1].isString())
+            throw RuntimeError("json.select() requires a source and a path string");
+        std::string error;
+        std::shared_ptr<json::Path> path = json::Path::compile(args[1].asString(), error);
+        if (!path)
+            throw RuntimeError("json.select(): " + error);
+        auto src = openSource(args, "json.select");
+        src->reader->allowMultiple(true);
+
+        struct Level
+        {
+            uint64_t states;
+            bool array;
+            size_t index = 0;
+        };
+        struct Walk
+        {
+            std::vector<Level> levels; // one per container being walked
+            uint64_t keyStates = 0;    // states for the value after a key
+        };
+        auto walk = std::make_shared<Walk>();
+
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [src, path, walk](std::vector<QuantumValue>) -> QuantumValue
+        {
+            json::Reader &r = *src->reader;
+            auto &levels = walk->levels;
+            for (;;)
+            {
+                json::Token t = r.next();
+                switch (t)
+                {
+                case json::Token::End:
+                    return QuantumValue();
+                case json::Token::Error:
+                    throw RuntimeError("json.select(): " + r.error());
+                case json::Token::EndObject:
+                case json::Token::EndArray:
+                    levels.pop_back();
+                    continue;
+                case json::Token::Key:
+                    walk->keyStates = path->step(levels.back().states, r.text());
+                    continue;
+                default:
+                    break;
+                }
+                uint64_t states = levels.empty()         ? path->start()
+                                  : levels.back().array ? path->step(levels.back().states, levels.back().index++)
+                                                        : walk->keyStates;
+                if (path->matches(states))
+                    return t == json::Token::Null ? iterNil() : buildValue(r, t, "json.select");
+                if (t != json::Token::BeginObject && t != json::Token::BeginArray)
+                    continue;
+                if (!path->viable(states))
+                {
+                    if (!r.skip())
+                        throw RuntimeError("json.select(): " + r.error());
+                    continue;
+                }
+                levels.push_back({states, t == json::Token::BeginArray});
+            }
+        };
+        return QuantumValue(iter); });
+
+    globals->define("json", QuantumValue(mod));
+}
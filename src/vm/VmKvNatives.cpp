@@ -0,0 +1,254 @@
+#include "Vm.h"
+#include "Error.h"
+#include "KvStore.h"
+#include "Marshal.h"
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Key-value natives ────────────────────────────────────────────────────────
+// kv.open(path) gives scripts a persistent store backed by kv::Store, and
+// localStorage is one such store at a fixed path, so state written by one run
+// is there for the next.  Strings are stored as they are; any other value is
+// stored in its marshal encoding and comes back as the same kind of value.
+
+namespace
+{
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    // Stored values start with one of these.
+    constexpr char kString = 's';
+    constexpr char kMarshal = 'm';
+
+    std::string encode(const QuantumValue &v)
+    {
+        if (v.isString())
+            return kString + v.asString();
+        std::vector<uint8_t> out;
+        out.push_back(static_cast<uint8_t>(kMarshal));
+        marshal::dump(out, v);
+        return std::string(out.begin(), out.end());
+    }
+
+    QuantumValue decode(const std::string &stored, const std::shared_ptr<Environment> &globals)
+    {
+        if (stored.empty())
+            return QuantumValue();
+        if (stored[0] == kMarshal)
+            return marshal::load(std::string_view(stored).substr(1), globals);
+        return QuantumValue(stored.substr(1));
+    }
+
+    kv::Sync syncOf(const std::vector<QuantumValue> &args, size_t i)
+    {
+        if (args.size() <= i || !args[i].isDict())
+            return kv::Sync::Interval;
+        auto it = args[i].asDict()->find("sync");
+        if (it == args[i].asDict()->end())
+            return kv::Sync::Interval;
+        std::string s = it->second.toString();
+        if (s == "always")
+            return kv::Sync::Always;
+        if (s == "interval")
+            return kv::Sync::Interval;
+        if (s == "none")
+            return kv::Sync::None;
+        throw RuntimeError("kv.open(): sync must be \"always\", \"interval\" or \"none\"");
+    }
+
+    // An opened store, or a store opened on first use.
+    struct Handle
+    {
+        std::string path;
+        kv::Sync sync = kv::Sync::Interval;
+        std::unique_ptr<kv::Store> store;
+        bool closed = false;
+
+        kv::Store &get(const std::string &fn)
+        {
+            if (closed)
+                throw RuntimeError(fn + "(): store is closed");
+            if (!store)
+            {
+                store = kv::Store::open(path, sync);
+                if (!store)
+                    throw RuntimeError(fn + "(): cannot open store '" + path + "'");
+            }
+            return *store;
+        }
+    };
+
+    void check(bool ok, const std::string &fn, const std::string &path)
+    {
+        if (!ok)
+            throw RuntimeError(fn + "(): cannot write to '" + path + "'");
+    }
+
+    std::string keyOf(const std::vector<QuantumValue> &args, const std::string &fn)
+    {
+        if (args.empty())
+            throw RuntimeError(fn + "() requires a key");
+        return args[0].toString();
+    }
+}
+
+void VM::registerKvNatives()
+{
+    auto mod = std::make_shared<Dict>();
+    auto lib = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "kv." + name;
+        nat->fn = std::move(fn);
+        (*mod)[name] = QuantumValue(nat);
+    };
+
+    // open(path, {sync}) — a store object.  sync is "always" (fsync every
+    // write), "interval" (the default: every write reaches the OS, fsync at
+    // most once a second) or "none" (buffered until flush() or close()).
+    lib("open", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("kv.open() requires a path");
+        auto h = std::make_shared<Handle>();
+        h->path = args[0].toString();
+        h->sync = syncOf(args, 1);
+        h->get("kv.open");
+
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "kv.store.");
+        auto globals = this->globals;
+
+        // get(key, default) — the value stored under key, or default (nil).
+        method("get", [h, globals](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string key = keyOf(args, "kv.get");
+            std::string stored;
+            if (!h->get("kv.get").get(key, stored))
+                return args.size() > 1 ? args[1] : QuantumValue();
+            return decode(stored, globals); });
+
+        method("set", [h](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string key = keyOf(args, "kv.set");
+            std::string stored = encode(args.size() > 1 ? args[1] : QuantumValue());
+            check(h->get("kv.set").set(key, stored), "kv.set", h->path);
+            return QuantumValue(); });
+
+        // delete(key) — true if key was present.
+        method("delete", [h](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string key = keyOf(args, "kv.delete");
+            kv::Store &s = h->get("kv.delete");
+            if (!s.has(key))
+                return QuantumValue(false);
+            check(s.erase(key), "kv.delete", h->path);
+            return QuantumValue(true); });
+
+        method("has", [h](std::vector<QuantumValue> args) -> QuantumValue
+               { return QuantumValue(h->get("kv.has").has(keyOf(args, "kv.has"))); });
+
+        method("keys", [h](std::vector<QuantumValue>) -> QuantumValue
+               {
+            auto arr = std::make_shared<Array>();
+            for (auto &k : h->get("kv.keys").keys())
+                arr->push_back(QuantumValue(std::move(k)));
+            return QuantumValue(arr); });
+
+        method("size", [h](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(static_cast<double>(h->get("kv.size").size())); });
+
+        // stats() — {keys, live_bytes, file_bytes}; file_bytes well above
+        // live_bytes means compact() would reclaim space.
+        method("stats", [h](std::vector<QuantumValue>) -> QuantumValue
+               {
+            kv::Store &s = h->get("kv.stats");
+            auto d = std::make_shared<Dict>();
+            (*d)["keys"] = QuantumValue(static_cast<double>(s.size()));
+            (*d)["live_bytes"] = QuantumValue(static_cast<double>(s.liveBytes()));
+            (*d)["file_bytes"] = QuantumValue(static_cast<double>(s.fileBytes()));
+            return QuantumValue(d); });
+
+        method("compact", [h](std::vector<QuantumValue>) -> QuantumValue
+               {
+            check(h->get("kv.compact").compact(), "kv.compact", h->path);
+            return QuantumValue(); });
+
+        method("flush", [h](std::vector<QuantumValue>) -> QuantumValue
+               {
+            check(h->get("kv.flush").flush(), "kv.flush", h->path);
+            return QuantumValue(); });
+
+        method("close", [h](std::vector<QuantumValue>) -> QuantumValue
+               {
+            bool ok = !h->store || h->store->close();
+            h->store.reset();
+            h->closed = true;
+            check(ok, "kv.close", h->path);
+            return QuantumValue(); });
+
+        return QuantumValue(obj); });
+
+    globals->define("kv", QuantumValue(mod));
+
+    // localStorage keeps the web API — string values only — in a store at
+    // $QUANTUM_LOCALSTORAGE or ./.quantum_localstorage, opened on first use
+    // so scripts that never touch it leave no file behind.
+    auto local = std::make_shared<Handle>();
+    const char *env = std::getenv("QUANTUM_LOCALSTORAGE");
+    local->path = env && *env ? env : ".quantum_localstorage";
+
+    auto storage = std::make_shared<Dict>();
+    auto method = methodsOf(storage, "storage.");
+
+    method("setItem", [local](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        if (args.size() >= 2)
+            check(local->get("localStorage.setItem").set(args[0].toString(), kString + args[1].toString()),
+                  "localStorage.setItem", local->path);
+        return QuantumValue(); });
+
+    method("getItem", [local](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        std::string stored;
+        if (args.empty() || !local->get("localStorage.getItem").get(args[0].toString(), stored))
+            return QuantumValue();
+        return QuantumValue(stored.empty() ? stored : stored.substr(1)); });
+
+    method("removeItem", [local](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        if (!args.empty())
+            check(local->get("localStorage.removeItem").erase(args[0].toString()), "localStorage.removeItem",
+                  local->path);
+        return QuantumValue(); });
+
+    method("clear", [local](std::vector<QuantumValue>) -> QuantumValue
+           {
+        kv::Store &s = local->get("localStorage.clear");
+        for (const auto &k : s.keys())
+            check(s.erase(k), "localStorage.clear", local->path);
+        check(s.compact(), "localStorage.clear", local->path);
+        return QuantumValue(); });
+
+    method("keys", [local](std::vector<QuantumValue>) -> QuantumValue
+           {
+        auto arr = std::make_shared<Array>();
+        for (auto &k : local->get("localStorage.keys").keys())
+            arr->push_back(QuantumValue(std::move(k)));
+        return QuantumValue(arr); });
+
+    globals->define("localStorage", QuantumValue(storage));
+}
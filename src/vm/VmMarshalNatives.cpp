@@ -0,0 +1,79 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Marshal.h"
+#include "MappedFile.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Marshal natives ──────────────────────────────────────────────────────────
+// The marshal module: dumps / loads to and from bytes, and dump_file /
+// load_file for caching results between runs.  Loading reads a file in
+// place from its mapping rather than copying it first.
+
+void VM::registerMarshalNatives()
+{
+    auto mod = std::make_shared<Dict>();
+    auto lib = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "marshal." + name;
+        nat->fn = std::move(fn);
+        (*mod)[name] = QuantumValue(nat);
+    };
+
+    // dumps(value) — the encoding as bytes.
+    lib("dumps", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        std::vector<uint8_t> out;
+        marshal::dump(out, args.empty() ? QuantumValue() : args[0]);
+        return QuantumValue(std::make_shared<QuantumBytes>(std::move(out))); });
+
+    // loads(data) — the value encoded in a bytes (or string) value.
+    lib("loads", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty() || (!args[0].isBytes() && !args[0].isString()))
+            throw RuntimeError("marshal.loads() requires bytes");
+        std::string scratch;
+        return marshal::load(args[0].bytesView(scratch), globals); });
+
+    // dump_file(path, value) — writes to a temporary file beside path and
+    // renames it over path, so readers never see a half-written cache.
+    lib("dump_file", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("marshal.dump_file() requires a path and a value");
+        std::string path = args[0].toString();
+        std::vector<uint8_t> out;
+        marshal::dump(out, args[1]);
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f || !f.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size())))
+                throw RuntimeError("marshal.dump_file(): cannot write '" + tmp + "'");
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tmp, ec);
+            throw RuntimeError("marshal.dump_file(): cannot replace '" + path + "'");
+        }
+        return QuantumValue(true); });
+
+    // load_file(path) — the value stored by dump_file().
+    lib("load_file", [this](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("marshal.load_file() requires a path");
+        std::string path = args[0].toString();
+        auto mf = MappedFile::open(path);
+        if (!mf)
+            throw RuntimeError("marshal.load_file(): cannot open '" + path + "'");
+        mf->spool();
+        return marshal::load(std::string_view(mf->data(), mf->size()), globals); });
+
+    globals->define("marshal", QuantumValue(mod));
+}
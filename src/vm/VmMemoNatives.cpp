@@ -0,0 +1,208 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Memo.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Memo natives ─────────────────────────────────────────────────────────────
+// memoize() / cache wrap a function so each distinct argument list is
+// computed once, and LRUCache is the same store as a container.  Both sit on
+// memo::Cache, which keys on the structure of the arguments rather than
+// their string form.
+
+namespace
+{
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    struct Bounds
+    {
+        size_t maxsize = 0;
+        size_t maxBytes = 0;
+        double ttl = 0;
+    };
+
+    // {maxsize, max_bytes, ttl} from a dict of options; absent means unbounded.
+    void readBounds(Bounds &b, const QuantumValue &opts, const std::string &fn)
+    {
+        if (!opts.isDict())
+            return;
+        auto num = [&](const char *key, double &out)
+        {
+            auto it = opts.asDict()->find(key);
+            if (it == opts.asDict()->end() || it->second.isNil())
+                return;
+            if (!it->second.isNumber() || it->second.asNumber() < 0)
+                throw RuntimeError(fn + "(): " + key + " must be a non-negative number");
+            out = it->second.asNumber();
+        };
+        double maxsize = static_cast<double>(b.maxsize), maxBytes = static_cast<double>(b.maxBytes);
+        num("maxsize", maxsize);
+        num("max_bytes", maxBytes);
+        num("ttl", b.ttl);
+        b.maxsize = static_cast<size_t>(maxsize);
+        b.maxBytes = static_cast<size_t>(maxBytes);
+    }
+
+    QuantumValue statsOf(const memo::Cache &c)
+    {
+        auto d = std::make_shared<Dict>();
+        (*d)["hits"] = QuantumValue(static_cast<double>(c.stats().hits));
+        (*d)["misses"] = QuantumValue(static_cast<double>(c.stats().misses));
+        (*d)["evictions"] = QuantumValue(static_cast<double>(c.stats().evictions));
+        (*d)["size"] = QuantumValue(static_cast<double>(c.size()));
+        (*d)["bytes"] = QuantumValue(static_cast<double>(c.bytes()));
+        return QuantumValue(d);
+    }
+
+    memo::Key keyOf(const std::vector<QuantumValue> &args)
+    {
+        return memo::Key({args.empty() ? QuantumValue() : args[0]});
+    }
+}
+
+void VM::registerMemoNatives()
+{
+    // The wrapper is a callable object: calling it goes through the cache,
+    // and it also carries stats(), clear() and the original fn.
+    auto wrap = [this](QuantumValue fn, const Bounds &b) -> QuantumValue
+    {
+        if (!fn.isFunction() && !fn.isBoundMethod() && !fn.isDict())
+            throw RuntimeError("memoize() requires a function");
+        auto cache = std::make_shared<memo::Cache>(b.maxsize, b.maxBytes, b.ttl);
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "memoize.");
+
+        method("__call__", [this, cache, fn](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            // Arguments the function would not receive are not part of the
+            // key, so map(cached) hits regardless of the index it passes.
+            if (fn.isFunction() && !fn.isNative() && args.size() > fn.asFunction()->chunk->params.size())
+                args.resize(fn.asFunction()->chunk->params.size());
+            memo::Key key(std::move(args));
+            if (const QuantumValue *hit = cache->get(key))
+                return *hit;
+            // A throwing call caches nothing.
+            QuantumValue result = callFunction(fn, key.values);
+            cache->put(std::move(key), result);
+            return result; });
+        method("stats", [cache](std::vector<QuantumValue>) -> QuantumValue
+               { return statsOf(*cache); });
+        method("clear", [cache](std::vector<QuantumValue>) -> QuantumValue
+               {
+            cache->clear();
+            return QuantumValue(); });
+        (*obj)["fn"] = fn;
+        return QuantumValue(obj);
+    };
+
+    // memoize(fn, {maxsize, max_bytes, ttl}) — fn with its results cached.
+    // memoize({...}) alone returns a decorator, for @memoize({maxsize: 128}).
+    auto memoize = std::make_shared<QuantumNative>();
+    memoize->name = "memoize";
+    memoize->fn = [wrap](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        if (args.empty())
+            throw RuntimeError("memoize() requires a function or options");
+        Bounds b;
+        if (args[0].isDict() && !args[0].asDict()->count("__call__"))
+        {
+            readBounds(b, args[0], "memoize");
+            auto decorator = std::make_shared<QuantumNative>();
+            decorator->name = "memoize";
+            decorator->fn = [wrap, b](std::vector<QuantumValue> args) -> QuantumValue
+            {
+                if (args.empty())
+                    throw RuntimeError("memoize() requires a function");
+                return wrap(args[0], b);
+            };
+            return QuantumValue(decorator);
+        }
+        if (args.size() > 1)
+            readBounds(b, args[1], "memoize");
+        return wrap(args[0], b);
+    };
+    globals->define("memoize", QuantumValue(memoize));
+
+    // cache(fn) — unbounded memoize, for @cache.
+    auto cacheFn = std::make_shared<QuantumNative>();
+    cacheFn->name = "cache";
+    cacheFn->fn = [wrap](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        if (args.empty())
+            throw RuntimeError("cache() requires a function");
+        return wrap(args[0], Bounds{});
+    };
+    globals->define("cache", QuantumValue(cacheFn));
+
+    // LRUCache(maxsize, {max_bytes, ttl}) or LRUCache({maxsize, max_bytes, ttl}).
+    auto lru = std::make_shared<QuantumNative>();
+    lru->name = "LRUCache";
+    lru->fn = [](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        Bounds b;
+        size_t opts = 0;
+        if (!args.empty() && args[0].isNumber())
+        {
+            if (args[0].asNumber() < 0)
+                throw RuntimeError("LRUCache(): maxsize must be a non-negative number");
+            b.maxsize = static_cast<size_t>(args[0].asNumber());
+            opts = 1;
+        }
+        if (args.size() > opts)
+            readBounds(b, args[opts], "LRUCache");
+        auto cache = std::make_shared<memo::Cache>(b.maxsize, b.maxBytes, b.ttl);
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "LRUCache.");
+
+        // get(key, default) — marks key as most recently used.
+        method("get", [cache](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (const QuantumValue *hit = cache->get(keyOf(args)))
+                return *hit;
+            return args.size() > 1 ? args[1] : QuantumValue(); });
+        auto put = [cache](std::vector<QuantumValue> args) -> QuantumValue
+        {
+            if (args.size() < 2)
+                throw RuntimeError("LRUCache.put() requires a key and a value");
+            cache->put(keyOf(args), args[1]);
+            return QuantumValue();
+        };
+        method("put", put);
+        method("set", put);
+        // has(key) — leaves recency and the hit counts alone.
+        method("has", [cache](std::vector<QuantumValue> args) -> QuantumValue
+               { return QuantumValue(cache->peek(keyOf(args)) != nullptr); });
+        method("delete", [cache](std::vector<QuantumValue> args) -> QuantumValue
+               { return QuantumValue(cache->erase(keyOf(args))); });
+        method("clear", [cache](std::vector<QuantumValue>) -> QuantumValue
+               {
+            cache->clear();
+            return QuantumValue(); });
+        method("size", [cache](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(static_cast<double>(cache->size())); });
+        // keys() — most recently used first.
+        method("keys", [cache](std::vector<QuantumValue>) -> QuantumValue
+               {
+            auto arr = std::make_shared<Array>();
+            cache->forEach([&](const memo::Key &k, const QuantumValue &)
+                           { arr->push_back(k.values[0]); });
+            return QuantumValue(arr); });
+        method("stats", [cache](std::vector<QuantumValue>) -> QuantumValue
+               { return statsOf(*cache); });
+        return QuantumValue(obj);
+    };
+    globals->define("LRUCache", QuantumValue(lru));
+}
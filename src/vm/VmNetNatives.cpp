@@ -0,0 +1,918 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Net.h"
+#include "IpSet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ─── socket module ───────────────────────────────────────────────────────────
+// Non-blocking TCP and UDP sockets on the VM's event loop.  Every callback and
+// promise settles on the VM thread; a script never blocks on the network
+// except inside await().
+
+namespace
+{
+    // Incoming data is parked here until the script asks for it with recv() or
+    // installs a "data" handler.  Past kInboxLimit the socket stops reading,
+    // which pushes back on the sender through TCP flow control.
+    constexpr size_t kInboxLimit = 1 << 20;
+
+    struct ConnState
+    {
+        std::shared_ptr<TcpStream> stream;
+        std::string inbox;
+        bool eof = false;
+        std::string error;
+        struct Reader
+        {
+            std::shared_ptr<PromiseState> promise;
+            size_t max; // 0 = whatever is available
+        };
+        std::deque<Reader> readers;
+        std::unordered_map<std::string, QuantumValue> handlers; // data, end, close, drain, error
+    };
+
+    struct ServerState
+    {
+        std::shared_ptr<TcpListener> listener;
+        QuantumValue onConnection;
+        std::deque<QuantumValue> backlog; // accepted, not yet handed to accept()
+        std::deque<std::shared_ptr<PromiseState>> waiting;
+    };
+
+    struct UdpState
+    {
+        std::shared_ptr<UdpSocket> sock;
+        QuantumValue onMessage;
+        std::deque<QuantumValue> inbox;
+        std::deque<std::shared_ptr<PromiseState>> waiting;
+    };
+
+    QuantumValue handler(const ConnState &st, const char *event)
+    {
+        auto it = st.handlers.find(event);
+        return it == st.handlers.end() ? QuantumValue() : it->second;
+    }
+
+    int portArg(const std::vector<QuantumValue> &args, size_t i, const char *fn)
+    {
+        if (args.size() <= i || !args[i].isNumber())
+            throw RuntimeError(std::string(fn) + "() requires a port number");
+        double p = args[i].asNumber();
+        if (p < 0 || p > 65535)
+            throw RuntimeError(std::string(fn) + "(): port out of range");
+        return static_cast<int>(p);
+    }
+}
+
+// ─── net.probe ───────────────────────────────────────────────────────────────
+// Bulk TCP reachability: a bounded window of non-blocking connects, each with
+// its own timeout.  Targets are expanded lazily from host / CIDR / range specs,
+// so a /16 sweep never builds a 65k-element list up front.
+
+namespace
+{
+    // "80", "80,443", "8000-8010", or a mix.
+    std::vector<int> parsePorts(const std::string &spec)
+    {
+        std::vector<int> ports;
+        size_t pos = 0;
+        while (pos <= spec.size())
+        {
+            size_t comma = spec.find(',', pos);
+            std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t dash = item.find('-');
+            char *end = nullptr;
+            long lo = std::strtol(item.c_str(), &end, 10);
+            long hi = lo;
+            if (dash != std::string::npos)
+                hi = std::strtol(item.c_str() + dash + 1, &end, 10);
+            if (item.empty() || *end || lo < 1 || hi > 65535 || lo > hi)
+                throw RuntimeError("net.probe(): invalid port spec '" + spec + "'");
+            for (long p = lo; p <= hi; ++p)
+                ports.push_back(static_cast<int>(p));
+            if (comma == std::string::npos)
+                break;
+            pos = comma + 1;
+        }
+        return ports;
+    }
+
+    std::vector<int> portsFromValue(const QuantumValue &v)
+    {
+        if (v.isNumber())
+            return parsePorts(std::to_string(static_cast<long>(v.asNumber())));
+        if (v.isArray())
+        {
+            std::vector<int> out;
+            for (auto &p : *v.asArray())
+            {
+                auto more = portsFromValue(p);
+                out.insert(out.end(), more.begin(), more.end());
+            }
+            return out;
+        }
+        return parsePorts(v.toString());
+    }
+
+    // One target spec: a single host, or an IPv4 range, times a port list.
+    struct ProbeSpec
+    {
+        std::string host;
+        uint32_t first = 0, last = 0;
+        bool range = false;
+        std::vector<int> ports;
+    };
+
+    ProbeSpec parseProbeSpec(const std::string &text, const std::vector<int> &defaultPorts)
+    {
+        ProbeSpec spec;
+        std::string hostPart = text;
+        std::string portPart;
+        if (!text.empty() && text[0] == '[')
+        {
+            size_t close = text.find(']');
+            if (close == std::string::npos)
+                throw RuntimeError("net.probe(): invalid target '" + text + "'");
+            hostPart = text.substr(1, close - 1);
+            if (close + 1 < text.size() && text[close + 1] == ':')
+                portPart = text.substr(close + 2);
+        }
+        else if (std::count(text.begin(), text.end(), ':') == 1)
+        {
+            size_t colon = text.find(':');
+            hostPart = text.substr(0, colon);
+            portPart = text.substr(colon + 1);
+        }
+        spec.ports = portPart.empty() ? defaultPorts : parsePorts(portPart);
+
+        size_t slash = hostPart.find('/');
+        size_t dash = hostPart.find('-');
+        uint32_t a = 0, b = 0;
+        if (slash != std::string::npos && ipaddr::parseV4(hostPart.substr(0, slash), a))
+        {
+            // Same host set as cidr_hosts(): network and broadcast excluded
+            // except for /31 and /32.
+            int prefix = std::atoi(hostPart.c_str() + slash + 1);
+            if (prefix < 0 || prefix > 32)
+                throw RuntimeError("net.probe(): invalid CIDR '" + hostPart + "'");
+            uint32_t mask = prefix == 0 ? 0 : (0xFFFFFFFFu << (32 - prefix));
+            uint32_t net = a & mask, bcast = net | ~mask;
+            spec.range = true;
+            spec.first = prefix >= 31 ? net : net + 1;
+            spec.last = prefix >= 31 ? bcast : bcast - 1;
+        }
+        else if (dash != std::string::npos && ipaddr::parseV4(hostPart.substr(0, dash), a) &&
+                 ipaddr::parseV4(hostPart.substr(dash + 1), b) && a <= b)
+        {
+            spec.range = true;
+            spec.first = a;
+            spec.last = b;
+        }
+        else
+            spec.host = hostPart;
+        return spec;
+    }
+
+    class ProbeCursor
+    {
+    public:
+        std::vector<ProbeSpec> specs;
+
+        bool next(std::string &host, int &port)
+        {
+            while (spec_ < specs.size())
+            {
+                const ProbeSpec &s = specs[spec_];
+                uint64_t hosts = s.range ? uint64_t(s.last) - s.first + 1 : 1;
+                if (host_ < hosts)
+                {
+                    host = s.range ? ipaddr::formatV4(static_cast<uint32_t>(s.first + host_)) : s.host;
+                    port = s.ports[port_];
+                    if (++port_ == s.ports.size())
+                    {
+                        port_ = 0;
+                        ++host_;
+                    }
+                    return true;
+                }
+                ++spec_;
+                host_ = 0;
+                port_ = 0;
+            }
+            return false;
+        }
+
+    private:
+        size_t spec_ = 0;
+        uint64_t host_ = 0;
+        size_t port_ = 0;
+    };
+
+    struct Probe : std::enable_shared_from_this<Probe>
+    {
+        enum Status
+        {
+            Open,
+            Closed,
+            Timeout,
+            Failed
+        };
+        struct Row
+        {
+            uint64_t index;
+            std::string host;
+            int port;
+            Status status;
+            double latencyMs;
+        };
+        struct DnsEntry
+        {
+            bool done = false;
+            bool ok = false;
+            net::Address addr;
+            std::vector<std::function<void()>> waiters;
+        };
+        using Clock = std::chrono::steady_clock;
+
+        explicit Probe(EventLoop &l) : loop(l) {}
+
+        EventLoop &loop;
+        ProbeCursor cursor;
+        size_t concurrency = 512;
+        double timeoutMs = 1000;
+        bool openOnly = false;
+        std::function<void(const std::string &, std::function<void(const net::Address *, const std::string &)>)> resolve;
+        std::function<void(std::vector<Row> &)> finished;
+
+        std::vector<Row> rows;
+        std::unordered_map<std::string, std::shared_ptr<DnsEntry>> dns;
+        size_t inflight = 0;
+        uint64_t nextIndex = 0;
+        bool exhausted = false;
+        bool pumping = false;
+        bool again = false;
+        bool done = false;
+
+        void pump()
+        {
+            if (pumping)
+            {
+                again = true;
+                return;
+            }
+            pumping = true;
+            auto self = shared_from_this();
+            do
+            {
+                again = false;
+                std::string host;
+                int port = 0;
+                while (!exhausted && inflight < concurrency)
+                {
+                    if (!cursor.next(host, port))
+                    {
+                        exhausted = true;
+                        break;
+                    }
+                    ++inflight;
+                    start(nextIndex++, host, port);
+                }
+            } while (again);
+            pumping = false;
+            if (exhausted && inflight == 0 && !done)
+            {
+                done = true;
+                std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b)
+                          { return a.index < b.index; });
+                finished(rows);
+            }
+        }
+
+        void record(uint64_t index, const std::string &host, int port, Status status, double ms)
+        {
+            --inflight;
+            if (!openOnly || status == Open)
+                rows.push_back({index, host, port, status, ms});
+            pump();
+        }
+
+        void start(uint64_t index, const std::string &host, int port)
+        {
+            net::Address addr;
+            if (net::parseAddress(host, port, addr))
+            {
+                connect(index, host, addr);
+                return;
+            }
+            auto &entry = dns[host];
+            if (!entry)
+            {
+                entry = std::make_shared<DnsEntry>();
+                auto e = entry;
+                resolve(host, [e](const net::Address *a, const std::string &)
+                        {
+                    e->done = true;
+                    e->ok = a != nullptr;
+                    if (a)
+                        e->addr = *a;
+                    auto waiters = std::move(e->waiters);
+                    e->waiters.clear();
+                    for (auto &w : waiters)
+                        w(); });
+            }
+            auto e = entry;
+            auto self = shared_from_this();
+            auto go = [self, e, index, host, port]()
+            {
+                if (!e->ok)
+                {
+                    self->record(index, host, port, Failed, -1);
+                    return;
+                }
+                net::Address a = e->addr;
+                a.setPort(port);
+                self->connect(index, host, a);
+            };
+            if (e->done)
+                go();
+            else
+                e->waiters.push_back(go);
+        }
+
+        void connect(uint64_t index, const std::string &host, const net::Address &addr)
+        {
+            int port = addr.port();
+            auto t0 = Clock::now();
+            auto elapsed = [t0]()
+            { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); };
+
+            std::string err;
+            int code = 0;
+            net::Handle h = net::startConnect(addr, err, &code);
+            if (h == net::kInvalid)
+            {
+                record(index, host, port, net::isRefused(code) ? Closed : Failed, elapsed());
+                return;
+            }
+
+            struct Attempt
+            {
+                bool done = false;
+                uint64_t timer = 0;
+            };
+            auto att = std::make_shared<Attempt>();
+            auto self = shared_from_this();
+            loop.watch(h, EventLoop::Writable, [self, att, h, index, host, port, elapsed](int)
+                       {
+                if (att->done)
+                    return;
+                att->done = true;
+                self->loop.cancelTimer(att->timer);
+                int result = net::connectResult(h);
+                self->loop.unwatch(h);
+                net::closeSocket(h);
+                Status st = result == 0 ? Open : net::isRefused(result) ? Closed : Failed;
+                self->record(index, host, port, st, elapsed()); });
+            att->timer = loop.addTimer(timeoutMs, [self, att, h, index, host, port]()
+                                       {
+                if (att->done)
+                    return;
+                att->done = true;
+                self->loop.unwatch(h);
+                net::closeSocket(h);
+                self->record(index, host, port, Timeout, -1); });
+        }
+    };
+}
+
+void VM::resolveHost(const std::string &host, int port,
+                     std::function<void(const net::Address *addr, const std::string &err)> done)
+{
+    net::Address addr;
+    if (net::parseAddress(host == "localhost" ? "127.0.0.1" : host, port, addr))
+    {
+        done(&addr, "");
+        return;
+    }
+    // DNS lookups block, so they run on the I/O pool.
+    eventLoop().submit([host, port, done]() -> EventLoop::Task
+                       {
+        auto result = std::make_shared<net::Address>();
+        std::string err;
+        bool ok = net::resolve(host, port, false, *result, err);
+        return [result, err, ok, done]()
+        { done(ok ? result.get() : nullptr, err); }; });
+}
+
+QuantumValue VM::wrapTcpStream(const std::shared_ptr<TcpStream> &stream)
+{
+    auto st = std::make_shared<ConnState>();
+    st->stream = stream;
+    std::weak_ptr<ConnState> weak = st;
+
+    auto deliver = [this, weak]()
+    {
+        auto st = weak.lock();
+        if (!st)
+            return;
+        while (!st->readers.empty() && !st->inbox.empty())
+        {
+            auto r = st->readers.front();
+            st->readers.pop_front();
+            size_t n = r.max ? std::min(r.max, st->inbox.size()) : st->inbox.size();
+            std::string chunk;
+            if (n == st->inbox.size())
+                chunk.swap(st->inbox); // the whole inbox moves, not a copy of it
+            else
+            {
+                chunk = st->inbox.substr(0, n);
+                st->inbox.erase(0, n);
+            }
+            settlePromise(r.promise, QuantumValue(std::move(chunk)), false);
+        }
+        if (st->eof || !st->error.empty())
+        {
+            while (!st->readers.empty())
+            {
+                auto r = st->readers.front();
+                st->readers.pop_front();
+                if (st->error.empty())
+                    settlePromise(r.promise, QuantumValue(), false);
+                else
+                    settlePromise(r.promise, QuantumValue(st->error), true);
+            }
+        }
+        if (st->stream && st->inbox.size() < kInboxLimit)
+            st->stream->resume();
+    };
+
+    stream->onData = [this, weak, deliver](const char *data, size_t len)
+    {
+        auto st = weak.lock();
+        if (!st)
+            return;
+        QuantumValue cb = handler(*st, "data");
+        if (!cb.isNil())
+        {
+            callFunction(cb, {QuantumValue(std::string(data, len))});
+            return;
+        }
+        // A waiting recv() that takes the whole read gets it straight from
+        // the read buffer, without a stop in the inbox.
+        if (st->inbox.empty() && !st->readers.empty() &&
+            (st->readers.front().max == 0 || st->readers.front().max >= len))
+        {
+            auto r = st->readers.front();
+            st->readers.pop_front();
+            settlePromise(r.promise, QuantumValue(std::string(data, len)), false);
+            return;
+        }
+        st->inbox.append(data, len);
+        deliver();
+        if (st->inbox.size() >= kInboxLimit && st->stream)
+            st->stream->pause();
+    };
+    stream->onEnd = [this, weak, deliver]()
+    {
+        auto st = weak.lock();
+        if (!st)
+            return;
+        st->eof = true;
+        deliver();
+        QuantumValue cb = handler(*st, "end");
+        if (!cb.isNil())
+            callFunction(cb, {});
+        else if (st->stream)
+            st->stream->end();
+    };
+    stream->onDrain = [this, weak]()
+    {
+        auto st = weak.lock();
+        if (!st)
+            return;
+        QuantumValue cb = handler(*st, "drain");
+        if (!cb.isNil())
+            callFunction(cb, {});
+    };
+    stream->onError = [this, weak, deliver](const std::string &msg)
+    {
+        auto st = weak.lock();
+        if (!st)
+            return;
+        st->error = msg;
+        deliver();
+        QuantumValue cb = handler(*st, "error");
+        if (!cb.isNil())
+            callFunction(cb, {QuantumValue(msg)});
+    };
+    // The stream (owned by the reactor while open) keeps the script state
+    // alive through this callback; it is released when the stream closes.
+    stream->onClose = [this, st, deliver]()
+    {
+        st->eof = true;
+        deliver();
+        QuantumValue cb = handler(*st, "close");
+        st->handlers.clear();
+        if (!cb.isNil())
+            callFunction(cb, {});
+    };
+
+    auto obj = std::make_shared<Dict>();
+    auto method = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "conn." + name;
+        nat->fn = std::move(fn);
+        (*obj)[name] = QuantumValue(nat);
+    };
+
+    // send(data) — false once the outgoing queue is over the high-water mark;
+    // wait for the "drain" event before sending more.
+    method("send", [st](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        if (args.empty())
+            throw RuntimeError("conn.send() requires data");
+        if (!st->stream->isOpen())
+            throw RuntimeError("conn.send(): connection is closed");
+        const std::string data = args[0].isString() ? args[0].asString() : args[0].toString();
+        return QuantumValue(st->stream->write(data)); });
+
+    // recv(max?) — promise for the next chunk of data, or nil at end of stream.
+    method("recv", [this, st, deliver](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        auto p = std::make_shared<PromiseState>();
+        size_t max = args.empty() || !args[0].isNumber() ? 0 : static_cast<size_t>(std::max(0.0, args[0].asNumber()));
+        st->readers.push_back({p, max});
+        deliver();
+        return makePromise(p); });
+
+    // on(event, fn) — "data", "end", "close", "drain", "error".
+    method("on", [this, st](std::vector<QuantumValue> args) -> QuantumValue
+           {
+        if (args.size() < 2)
+            throw RuntimeError("conn.on() requires an event name and a callback");
+        std::string ev = args[0].toString();
+        if (ev != "data" && ev != "end" && ev != "close" && ev != "drain" && ev != "error")
+            throw RuntimeError("conn.on(): unknown event '" + ev + "'");
+        st->handlers[ev] = args[1];
+        if (ev == "data" && !st->inbox.empty())
+        {
+            std::string pending;
+            pending.swap(st->inbox);
+            callFunction(args[1], {QuantumValue(pending)});
+            if (st->stream)
+                st->stream->resume();
+        }
+        return QuantumValue(); });
+
+    method("end", [st](std::vector<QuantumValue>) -> QuantumValue
+           {
+        st->stream->end();
+        return QuantumValue(); });
+    method("close", [st](std::vector<QuantumValue>) -> QuantumValue
+           {
+        st->stream->close();
+        return QuantumValue(); });
+    method("pause", [st](std::vector<QuantumValue>) -> QuantumValue
+           {
+        st->stream->pause();
+        return QuantumValue(); });
+    method("resume", [st](std::vector<QuantumValue>) -> QuantumValue
+           {
+        st->stream->resume();
+        return QuantumValue(); });
+    method("buffered", [st](std::vector<QuantumValue>) -> QuantumValue
+           { return QuantumValue(static_cast<double>(st->stream->buffered())); });
+    method("is_open", [st](std::vector<QuantumValue>) -> QuantumValue
+           { return QuantumValue(st->stream->isOpen()); });
+
+    (*obj)["remote_address"] = QuantumValue(stream->remoteHost());
+    (*obj)["remote_port"] = QuantumValue(static_cast<double>(stream->remotePort()));
+    (*obj)["local_port"] = QuantumValue(static_cast<double>(stream->localPort()));
+
+    stream->start();
+    return QuantumValue(obj);
+}
+
+void VM::registerNetNatives()
+{
+    auto socketDict = std::make_shared<Dict>();
+    auto fn = [&](const std::string &name, QuantumNativeFunc f)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = "socket." + name;
+        nat->fn = std::move(f);
+        (*socketDict)[name] = QuantumValue(nat);
+    };
+
+    // socket.tcp_connect(host, port, callback?) — promise for a connection.
+    fn("tcp_connect", [this](std::vector<QuantumValue> args) -> QuantumValue
+       {
+        if (args.empty())
+            throw RuntimeError("tcp_connect() requires a host and port");
+        std::string host = args[0].toString();
+        int port = portArg(args, 1, "tcp_connect");
+        QuantumValue callback = args.size() > 2 ? args[2] : QuantumValue();
+
+        auto p = std::make_shared<PromiseState>();
+        QuantumValue promise = makePromise(p);
+        auto finish = [this, p, callback](QuantumValue conn, const std::string &err)
+        {
+            settlePromise(p, err.empty() ? conn : QuantumValue(err), !err.empty());
+            if (!callback.isNil())
+                callFunction(callback, err.empty() ? std::vector<QuantumValue>{QuantumValue(), conn}
+                                                   : std::vector<QuantumValue>{QuantumValue(err), QuantumValue()});
+        };
+
+        resolveHost(host, port, [this, finish](const net::Address *addr, const std::string &rerr)
+                    {
+            if (!addr)
+            {
+                finish(QuantumValue(), "tcp_connect(): " + rerr);
+                return;
+            }
+            std::string err;
+            auto stream = TcpStream::connect(eventLoop(), *addr, err);
+            if (!stream)
+            {
+                finish(QuantumValue(), "tcp_connect(): " + err);
+                return;
+            }
+            std::weak_ptr<TcpStream> weak = stream;
+            stream->onConnect = [this, weak, finish]()
+            {
+                if (auto s = weak.lock())
+                    finish(wrapTcpStream(s), "");
+            };
+            stream->onError = [finish](const std::string &msg)
+            { finish(QuantumValue(), "tcp_connect(): " + msg); }; });
+        return promise; });
+
+    // socket.tcp_listen(host, port, on_connection?, {backlog}) — server object.
+    // Without a callback, connections are taken with `await server.accept()`.
+    fn("tcp_listen", [this](std::vector<QuantumValue> args) -> QuantumValue
+       {
+        std::string host = args.empty() || args[0].isNil() ? "0.0.0.0" : args[0].toString();
+        int port = portArg(args, 1, "tcp_listen");
+        int backlog = 0;
+        if (args.size() > 3 && args[3].isDict())
+        {
+            auto opts = args[3].asDict();
+            if (opts->count("backlog") && (*opts)["backlog"].isNumber())
+                backlog = static_cast<int>((*opts)["backlog"].asNumber());
+        }
+        std::string err;
+        auto listener = TcpListener::listen(eventLoop(), host, port, backlog, false, err);
+        if (!listener)
+            throw RuntimeError("tcp_listen(): cannot listen on " + host + ":" + std::to_string(port) + ": " + err);
+
+        auto st = std::make_shared<ServerState>();
+        st->listener = listener;
+        st->onConnection = args.size() > 2 ? args[2] : QuantumValue();
+        // The listener keeps serving until close(), even if the script drops
+        // the server object; close() breaks this reference cycle.
+        listener->onAccept = [this, st](net::Handle fd)
+        {
+            QuantumValue conn = wrapTcpStream(TcpStream::adopt(eventLoop(), fd));
+            if (!st->onConnection.isNil())
+                callFunction(st->onConnection, {conn});
+            else if (!st->waiting.empty())
+            {
+                auto p = st->waiting.front();
+                st->waiting.pop_front();
+                settlePromise(p, conn, false);
+            }
+            else
+                st->backlog.push_back(conn);
+        };
+        listener->start();
+
+        auto server = std::make_shared<Dict>();
+        auto method = [&](const std::string &name, QuantumNativeFunc f)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = "server." + name;
+            nat->fn = std::move(f);
+            (*server)[name] = QuantumValue(nat);
+        };
+        method("accept", [this, st](std::vector<QuantumValue>) -> QuantumValue
+               {
+            auto p = std::make_shared<PromiseState>();
+            if (!st->backlog.empty())
+            {
+                settlePromise(p, st->backlog.front(), false);
+                st->backlog.pop_front();
+            }
+            else if (st->listener->handle() == net::kInvalid)
+                settlePromise(p, QuantumValue(std::string("server.accept(): server is closed")), true);
+            else
+                st->waiting.push_back(p);
+            return makePromise(p); });
+        method("close", [this, st](std::vector<QuantumValue>) -> QuantumValue
+               {
+            st->listener->close();
+            st->onConnection = QuantumValue();
+            for (auto &p : st->waiting)
+                settlePromise(p, QuantumValue(std::string("server.accept(): server is closed")), true);
+            st->waiting.clear();
+            return QuantumValue(); });
+        (*server)["port"] = QuantumValue(static_cast<double>(listener->port()));
+        (*server)["host"] = QuantumValue(host);
+        return QuantumValue(server); });
+
+    // socket.udp_bind(host, port) — datagram socket; port 0 picks a free port.
+    fn("udp_bind", [this](std::vector<QuantumValue> args) -> QuantumValue
+       {
+        std::string host = args.empty() || args[0].isNil() ? "0.0.0.0" : args[0].toString();
+        int port = args.size() > 1 ? portArg(args, 1, "udp_bind") : 0;
+        std::string err;
+        auto sock = UdpSocket::bind(eventLoop(), host, port, err);
+        if (!sock)
+            throw RuntimeError("udp_bind(): cannot bind " + host + ":" + std::to_string(port) + ": " + err);
+
+        auto st = std::make_shared<UdpState>();
+        st->sock = sock;
+        sock->onMessage = [this, st](const char *data, size_t len, const net::Address &from)
+        {
+            QuantumValue payload(std::string(data, len));
+            QuantumValue fromHost(from.host());
+            QuantumValue fromPort(static_cast<double>(from.port()));
+            if (!st->onMessage.isNil())
+            {
+                callFunction(st->onMessage, {payload, fromHost, fromPort});
+                return;
+            }
+            auto msg = std::make_shared<Dict>();
+            (*msg)["data"] = payload;
+            (*msg)["host"] = fromHost;
+            (*msg)["port"] = fromPort;
+            if (!st->waiting.empty())
+            {
+                auto p = st->waiting.front();
+                st->waiting.pop_front();
+                settlePromise(p, QuantumValue(msg), false);
+            }
+            else if (st->inbox.size() < 4096)
+                st->inbox.push_back(QuantumValue(msg));
+        };
+        sock->start();
+
+        auto obj = std::make_shared<Dict>();
+        auto method = [&](const std::string &name, QuantumNativeFunc f)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = "udp." + name;
+            nat->fn = std::move(f);
+            (*obj)[name] = QuantumValue(nat);
+        };
+        method("send_to", [st](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.size() < 3)
+                throw RuntimeError("udp.send_to() requires data, host and port");
+            net::Address to;
+            std::string host = args[1].toString();
+            std::string err;
+            if (!net::resolve(host == "localhost" ? "127.0.0.1" : host, portArg(args, 2, "udp.send_to"), true, to, err))
+                throw RuntimeError("udp.send_to(): " + err);
+            std::string data = args[0].isString() ? args[0].asString() : args[0].toString();
+            return QuantumValue(st->sock->sendTo(data, to)); });
+        // recv_from() — promise for {data, host, port}.
+        method("recv_from", [this, st](std::vector<QuantumValue>) -> QuantumValue
+               {
+            auto p = std::make_shared<PromiseState>();
+            if (!st->inbox.empty())
+            {
+                settlePromise(p, st->inbox.front(), false);
+                st->inbox.pop_front();
+            }
+            else
+                st->waiting.push_back(p);
+            return makePromise(p); });
+        method("on", [st](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.size() < 2 || args[0].toString() != "message")
+                throw RuntimeError("udp.on() supports only the \"message\" event");
+            st->onMessage = args[1];
+            return QuantumValue(); });
+        method("close", [this, st](std::vector<QuantumValue>) -> QuantumValue
+               {
+            st->sock->close();
+            st->onMessage = QuantumValue();
+            for (auto &p : st->waiting)
+                settlePromise(p, QuantumValue(std::string("udp.recv_from(): socket is closed")), true);
+            st->waiting.clear();
+            return QuantumValue(); });
+        (*obj)["port"] = QuantumValue(static_cast<double>(sock->port()));
+        return QuantumValue(obj); });
+
+    globals->define("socket", QuantumValue(socketDict));
+
+    auto netDict = std::make_shared<Dict>();
+
+    // net.probe(targets, {concurrency, timeout, ports, open_only}) — promise
+    // for parallel arrays {host, port, status, latency_ms} in target order,
+    // plus open / total counts.  Targets are "host:port", "10.0.0.0/24:22",
+    // "10.0.0.5-10.0.0.90:80,443", "[::1]:8080" or {host, port}; a target
+    // without a port uses opts.ports.  status is "open", "closed" (refused),
+    // "timeout" or "error"; latency_ms is nil unless the host answered.
+    auto probe = std::make_shared<QuantumNative>();
+    probe->name = "net.probe";
+    probe->fn = [this](std::vector<QuantumValue> args) -> QuantumValue
+    {
+        if (args.empty())
+            throw RuntimeError("net.probe() requires a target or an array of targets");
+        auto pr = std::make_shared<Probe>(eventLoop());
+        std::vector<int> defaultPorts;
+        if (args.size() > 1 && args[1].isDict())
+        {
+            auto opts = args[1].asDict();
+            auto it = opts->find("concurrency");
+            if (it != opts->end() && it->second.isNumber())
+                pr->concurrency = static_cast<size_t>(std::min(65536.0, std::max(1.0, it->second.asNumber())));
+            it = opts->find("timeout");
+            if (it != opts->end() && it->second.isNumber())
+                pr->timeoutMs = std::max(1.0, it->second.asNumber());
+            it = opts->find("ports");
+            if (it != opts->end() && !it->second.isNil())
+                defaultPorts = portsFromValue(it->second);
+            it = opts->find("open_only");
+            if (it != opts->end())
+                pr->openOnly = it->second.isTruthy();
+        }
+
+        auto addTarget = [&](const QuantumValue &t)
+        {
+            ProbeSpec spec;
+            if (t.isDict())
+            {
+                auto d = t.asDict();
+                auto h = d->find("host");
+                if (h == d->end())
+                    throw RuntimeError("net.probe(): target dict needs a host");
+                spec = parseProbeSpec(h->second.toString(), defaultPorts);
+                auto p = d->find("port");
+                if (p == d->end())
+                    p = d->find("ports");
+                if (p != d->end())
+                    spec.ports = portsFromValue(p->second);
+            }
+            else
+                spec = parseProbeSpec(t.toString(), defaultPorts);
+            if (spec.ports.empty())
+                throw RuntimeError("net.probe(): no port for target '" + t.toString() + "' (give host:port or opts.ports)");
+            pr->cursor.specs.push_back(std::move(spec));
+        };
+        if (args[0].isArray())
+            for (auto &t : *args[0].asArray())
+                addTarget(t);
+        else
+            addTarget(args[0]);
+
+        auto state = std::make_shared<PromiseState>();
+        QuantumValue promise = makePromise(state);
+        pr->resolve = [this](const std::string &host, std::function<void(const net::Address *, const std::string &)> done)
+        { resolveHost(host, 0, std::move(done)); };
+        pr->finished = [this, state](std::vector<Probe::Row> &rows)
+        {
+            static const char *names[] = {"open", "closed", "timeout", "error"};
+            auto hosts = std::make_shared<Array>();
+            auto ports = std::make_shared<Array>();
+            auto status = std::make_shared<Array>();
+            auto latency = std::make_shared<Array>();
+            hosts->reserve(rows.size());
+            ports->reserve(rows.size());
+            status->reserve(rows.size());
+            latency->reserve(rows.size());
+            double open = 0;
+            for (auto &r : rows)
+            {
+                hosts->push_back(QuantumValue(std::move(r.host)));
+                ports->push_back(QuantumValue(static_cast<double>(r.port)));
+                status->push_back(QuantumValue(std::string(names[r.status])));
+                bool answered = r.status == Probe::Open || r.status == Probe::Closed;
+                latency->push_back(answered ? QuantumValue(r.latencyMs) : QuantumValue());
+                open += r.status == Probe::Open;
+            }
+            auto out = std::make_shared<Dict>();
+            (*out)["host"] = QuantumValue(hosts);
+            (*out)["port"] = QuantumValue(ports);
+            (*out)["status"] = QuantumValue(status);
+            (*out)["latency_ms"] = QuantumValue(latency);
+            (*out)["open"] = QuantumValue(open);
+            (*out)["total"] = QuantumValue(static_cast<double>(rows.size()));
+            settlePromise(state, QuantumValue(out), false);
+        };
+        pr->pump();
+        return promise;
+    };
+    (*netDict)["probe"] = QuantumValue(probe);
+    globals->define("net", QuantumValue(netDict));
+}
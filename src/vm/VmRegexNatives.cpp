@@ -0,0 +1,510 @@
+#include "Vm.h"
+#include "Error.h"
+#include "Regex.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─── Regular expression natives ───────────────────────────────────────────────
+// The re module: compile() returns a pattern object whose methods reuse one
+// compiled engine, and the module-level functions go through a per-thread
+// cache of compiled patterns, so a pattern written inline in a loop is
+// parsed once.
+
+namespace
+{
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+    using Caller = std::function<QuantumValue(const QuantumValue &, std::vector<QuantumValue>)>;
+    using Subject = std::shared_ptr<const std::string>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    const QuantumValue &arg(const std::vector<QuantumValue> &args, size_t i)
+    {
+        static const QuantumValue nil;
+        return i < args.size() ? args[i] : nil;
+    }
+
+    // re.I | re.M as a number, or the letters "im".
+    unsigned flagsArg(const QuantumValue &v, const std::string &fn)
+    {
+        if (v.isNil())
+            return 0;
+        if (v.isNumber())
+            return static_cast<unsigned>(v.asNumber()) & (rx::IgnoreCase | rx::Multiline | rx::DotAll);
+        unsigned flags;
+        if (!v.isString() || !rx::parseFlags(v.asString(), flags))
+            throw RuntimeError(fn + "(): flags must be re.I / re.M / re.S or letters like \"im\"");
+        return flags;
+    }
+
+    // A pattern string, or a pattern object from re.compile().
+    std::shared_ptr<rx::Regex> regexArg(const QuantumValue &pattern, const QuantumValue &flags, const std::string &fn)
+    {
+        std::string source;
+        unsigned bits = flagsArg(flags, fn);
+        if (pattern.isDict())
+        {
+            auto &d = *pattern.asDict();
+            auto p = d.find("pattern"), f = d.find("flags");
+            if (p == d.end() || f == d.end())
+                throw RuntimeError(fn + "(): expected a pattern string or compiled pattern");
+            source = p->second.toString();
+            bits |= flagsArg(f->second, fn);
+        }
+        else if (pattern.isString())
+            source = pattern.asString();
+        else
+            throw RuntimeError(fn + "(): expected a pattern string or compiled pattern");
+        std::string error;
+        auto re = rx::cached(source, bits, error);
+        if (!re)
+            throw RuntimeError(fn + "(): " + error);
+        return re;
+    }
+
+    size_t posArg(const QuantumValue &v, size_t size)
+    {
+        if (!v.isNumber() || v.asNumber() <= 0)
+            return 0;
+        return std::min(size, static_cast<size_t>(v.asNumber()));
+    }
+
+    QuantumValue spanText(const std::string &s, const rx::Span &sp)
+    {
+        if (!sp.matched())
+            return QuantumValue();
+        return QuantumValue(s.substr(sp.start, sp.end - sp.start));
+    }
+
+    // Group by number or name.
+    size_t groupIndex(const rx::Regex &re, const QuantumValue &v, const std::string &fn)
+    {
+        if (v.isNil())
+            return 0;
+        if (v.isNumber())
+        {
+            double n = v.asNumber();
+            if (n < 0 || n > static_cast<double>(re.groupCount()))
+                throw IndexError(fn + "(): no such group " + v.toString(), 0);
+            return static_cast<size_t>(n);
+        }
+        auto &names = re.groupNames();
+        for (size_t g = 1; g < names.size(); g++)
+            if (names[g] == v.toString())
+                return g;
+        throw IndexError(fn + "(): no such group '" + v.toString() + "'", 0);
+    }
+
+    // Every match from pos on.  After an empty match the search moves one
+    // byte along so it cannot repeat; a match may still begin where a
+    // non-empty one ended.
+    template <typename F>
+    void eachMatch(rx::Regex &re, const std::string &s, size_t pos, size_t limit, F fn)
+    {
+        std::vector<rx::Span> g;
+        for (size_t count = 0; pos <= s.size() && (limit == 0 || count < limit); count++)
+        {
+            if (!re.exec(s, pos, rx::Anchor::None, &g))
+                break;
+            fn(g);
+            pos = g[0].end > g[0].start ? g[0].end : g[0].end + 1;
+        }
+    }
+
+    // Match object: value / index plus group(), groups(), groupdict(),
+    // start(), end() and span().
+    QuantumValue makeMatch(std::shared_ptr<rx::Regex> re, Subject s, std::vector<rx::Span> groups)
+    {
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "Match.");
+        auto g = std::make_shared<std::vector<rx::Span>>(std::move(groups));
+        (*obj)["value"] = spanText(*s, (*g)[0]);
+        (*obj)["index"] = QuantumValue(static_cast<double>((*g)[0].start));
+
+        // group(n = 0) or group(a, b, ...) for an array of several.
+        method("group", [re, s, g](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.size() <= 1)
+                return spanText(*s, (*g)[groupIndex(*re, arg(args, 0), "Match.group")]);
+            auto out = std::make_shared<Array>();
+            for (auto &a : args)
+                out->push_back(spanText(*s, (*g)[groupIndex(*re, a, "Match.group")]));
+            return QuantumValue(out); });
+
+        // groups(default = nil) — groups 1..n; default stands in for any
+        // group that did not take part.
+        method("groups", [s, g](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            auto out = std::make_shared<Array>();
+            for (size_t i = 1; i < g->size(); i++)
+                out->push_back((*g)[i].matched() ? spanText(*s, (*g)[i]) : arg(args, 0));
+            return QuantumValue(out); });
+
+        method("groupdict", [re, s, g](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            auto out = std::make_shared<Dict>();
+            auto &names = re->groupNames();
+            for (size_t i = 1; i < names.size() && i < g->size(); i++)
+                if (!names[i].empty())
+                    (*out)[names[i]] = (*g)[i].matched() ? spanText(*s, (*g)[i]) : arg(args, 0);
+            return QuantumValue(out); });
+
+        // start / end are -1 for a group that did not take part.
+        auto edge = [re, g](bool start, const char *fn)
+        {
+            return [re, g, start, fn](std::vector<QuantumValue> args) -> QuantumValue
+            {
+                const rx::Span &sp = (*g)[groupIndex(*re, arg(args, 0), fn)];
+                if (!sp.matched())
+                    return QuantumValue(-1.0);
+                return QuantumValue(static_cast<double>(start ? sp.start : sp.end));
+            };
+        };
+        method("start", edge(true, "Match.start"));
+        method("end", edge(false, "Match.end"));
+
+        method("span", [re, g](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            const rx::Span &sp = (*g)[groupIndex(*re, arg(args, 0), "Match.span")];
+            auto out = std::make_shared<Array>();
+            out->push_back(QuantumValue(sp.matched() ? static_cast<double>(sp.start) : -1.0));
+            out->push_back(QuantumValue(sp.matched() ? static_cast<double>(sp.end) : -1.0));
+            return QuantumValue(out); });
+
+        return QuantumValue(obj);
+    }
+
+    QuantumValue execMatch(std::shared_ptr<rx::Regex> re, const QuantumValue &text, size_t pos, rx::Anchor anchor)
+    {
+        auto s = std::make_shared<const std::string>(text.toString());
+        std::vector<rx::Span> g;
+        if (!re->exec(*s, std::min(pos, s->size()), anchor, &g))
+            return QuantumValue();
+        return makeMatch(std::move(re), std::move(s), std::move(g));
+    }
+
+    // Whole matches with no groups, the group with one, arrays with several.
+    QuantumValue findAll(rx::Regex &re, const std::string &s, size_t pos)
+    {
+        auto out = std::make_shared<Array>();
+        const size_t groups = re.groupCount();
+        eachMatch(re, s, pos, 0, [&](const std::vector<rx::Span> &g)
+                  {
+            if (groups == 0)
+                out->push_back(spanText(s, g[0]));
+            else if (groups == 1)
+                out->push_back(g[1].matched() ? spanText(s, g[1]) : QuantumValue(std::string()));
+            else
+            {
+                auto row = std::make_shared<Array>();
+                for (size_t i = 1; i <= groups; i++)
+                    row->push_back(g[i].matched() ? spanText(s, g[i]) : QuantumValue(std::string()));
+                out->push_back(QuantumValue(row));
+            } });
+        return QuantumValue(out);
+    }
+
+    // Lazy iterator of match objects; each search runs when the loop asks.
+    QuantumValue findIter(std::shared_ptr<rx::Regex> re, const QuantumValue &text, size_t pos)
+    {
+        struct Cursor
+        {
+            Subject s;
+            size_t pos;
+            bool done = false;
+        };
+        auto cur = std::make_shared<Cursor>();
+        cur->s = std::make_shared<const std::string>(text.toString());
+        cur->pos = std::min(pos, cur->s->size());
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [re, cur](std::vector<QuantumValue>) -> QuantumValue
+        {
+            std::vector<rx::Span> g;
+            if (cur->done || !re->exec(*cur->s, cur->pos, rx::Anchor::None, &g))
+            {
+                cur->done = true;
+                return QuantumValue();
+            }
+            cur->pos = g[0].end > g[0].start ? g[0].end : g[0].end + 1;
+            cur->done = cur->pos > cur->s->size();
+            return makeMatch(re, cur->s, std::move(g));
+        };
+        return QuantumValue(iter);
+    }
+
+    // A replacement template split into literal text and group references:
+    // \1 .. \99, \g<n>, \g<name>, and \n \t \\ as in Python.
+    struct Template
+    {
+        struct Part
+        {
+            std::string text;
+            int group = -1;
+        };
+        std::vector<Part> parts;
+
+        Template(const std::string &t, const rx::Regex &re)
+        {
+            std::string lit;
+            auto flush = [&]()
+            {
+                if (!lit.empty())
+                    parts.push_back({std::move(lit), -1});
+                lit.clear();
+            };
+            auto ref = [&](size_t g)
+            {
+                if (g > re.groupCount())
+                    throw RuntimeError("re.sub(): invalid group reference " + std::to_string(g));
+                flush();
+                parts.push_back({std::string(), static_cast<int>(g)});
+            };
+            for (size_t i = 0; i < t.size(); i++)
+            {
+                if (t[i] != '\\' || i + 1 == t.size())
+                {
+                    lit += t[i];
+                    continue;
+                }
+                char c = t[++i];
+                if (c >= '0' && c <= '9')
+                {
+                    size_t g = static_cast<size_t>(c - '0');
+                    if (i + 1 < t.size() && t[i + 1] >= '0' && t[i + 1] <= '9')
+                        g = g * 10 + static_cast<size_t>(t[++i] - '0');
+                    ref(g);
+                }
+                else if (c == 'g' && i + 1 < t.size() && t[i + 1] == '<')
+                {
+                    size_t close = t.find('>', i);
+                    if (close == std::string::npos)
+                        throw RuntimeError("re.sub(): missing > in group reference");
+                    std::string name = t.substr(i + 2, close - i - 2);
+                    bool numeric = !name.empty() && name.find_first_not_of("0123456789") == std::string::npos;
+                    ref(numeric ? std::stoul(name) : groupIndex(re, QuantumValue(name), "re.sub"));
+                    i = close;
+                }
+                else if (c == 'n')
+                    lit += '\n';
+                else if (c == 't')
+                    lit += '\t';
+                else if (c == 'r')
+                    lit += '\r';
+                else if (c == '\\')
+                    lit += '\\';
+                else
+                {
+                    lit += '\\';
+                    lit += c;
+                }
+            }
+            flush();
+        }
+
+        void expand(const std::string &s, const std::vector<rx::Span> &g, std::string &out) const
+        {
+            for (auto &p : parts)
+            {
+                if (p.group < 0)
+                    out += p.text;
+                else if (g[p.group].matched())
+                    out.append(s, g[p.group].start, g[p.group].end - g[p.group].start);
+            }
+        }
+    };
+
+    // repl is a template string or a function called with each match object.
+    QuantumValue substitute(std::shared_ptr<rx::Regex> re, const QuantumValue &repl, const QuantumValue &text,
+                            size_t count, bool withCount, const Caller &call)
+    {
+        auto s = std::make_shared<const std::string>(text.toString());
+        std::unique_ptr<Template> tmpl;
+        if (!repl.isFunction())
+            tmpl = std::make_unique<Template>(repl.toString(), *re);
+        std::string out;
+        size_t copied = 0, n = 0;
+        eachMatch(*re, *s, 0, count, [&](const std::vector<rx::Span> &g)
+                  {
+            out.append(*s, copied, g[0].start - copied);
+            if (tmpl)
+                tmpl->expand(*s, g, out);
+            else
+                out += call(repl, {makeMatch(re, s, g)}).toString();
+            copied = g[0].end;
+            n++; });
+        out.append(*s, copied, std::string::npos);
+        if (!withCount)
+            return QuantumValue(out);
+        auto pair = std::make_shared<Array>();
+        pair->push_back(QuantumValue(out));
+        pair->push_back(QuantumValue(static_cast<double>(n)));
+        return QuantumValue(pair);
+    }
+
+    // Python's re.split: captured groups are kept between the pieces.
+    QuantumValue splitBy(rx::Regex &re, const std::string &s, size_t maxsplit)
+    {
+        auto out = std::make_shared<Array>();
+        size_t piece = 0;
+        eachMatch(re, s, 0, maxsplit, [&](const std::vector<rx::Span> &g)
+                  {
+            out->push_back(QuantumValue(s.substr(piece, g[0].start - piece)));
+            for (size_t i = 1; i < g.size(); i++)
+                out->push_back(spanText(s, g[i]));
+            piece = g[0].end; });
+        out->push_back(QuantumValue(s.substr(piece)));
+        return QuantumValue(out);
+    }
+
+    QuantumValue makePattern(std::shared_ptr<rx::Regex> re, Caller call)
+    {
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "Pattern.");
+        (*obj)["pattern"] = QuantumValue(re->pattern());
+        (*obj)["flags"] = QuantumValue(static_cast<double>(re->flags()));
+        (*obj)["groups"] = QuantumValue(static_cast<double>(re->groupCount()));
+        (*obj)["engine"] = QuantumValue(std::string(re->engine()));
+        auto index = std::make_shared<Dict>();
+        auto &names = re->groupNames();
+        for (size_t g = 1; g < names.size(); g++)
+            if (!names[g].empty())
+                (*index)[names[g]] = QuantumValue(static_cast<double>(g));
+        (*obj)["groupindex"] = QuantumValue(index);
+
+        auto anchored = [re](rx::Anchor anchor)
+        {
+            return [re, anchor](std::vector<QuantumValue> args) -> QuantumValue
+            {
+                return execMatch(re, arg(args, 0), posArg(arg(args, 1), SIZE_MAX), anchor);
+            };
+        };
+        // search / match / fullmatch(string, pos = 0)
+        method("search", anchored(rx::Anchor::None));
+        method("match", anchored(rx::Anchor::Start));
+        method("fullmatch", anchored(rx::Anchor::Both));
+
+        method("test", [re](std::vector<QuantumValue> args) -> QuantumValue
+               { return QuantumValue(re->test(arg(args, 0).toString())); });
+
+        method("findall", [re](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            std::string s = arg(args, 0).toString();
+            return findAll(*re, s, posArg(arg(args, 1), s.size())); });
+
+        method("finditer", [re](std::vector<QuantumValue> args) -> QuantumValue
+               { return findIter(re, arg(args, 0), posArg(arg(args, 1), SIZE_MAX)); });
+
+        // sub(repl, string, count = 0) / subn(...) -> [result, replacements]
+        method("sub", [re, call](std::vector<QuantumValue> args) -> QuantumValue
+               { return substitute(re, arg(args, 0), arg(args, 1), posArg(arg(args, 2), SIZE_MAX), false, call); });
+        method("subn", [re, call](std::vector<QuantumValue> args) -> QuantumValue
+               { return substitute(re, arg(args, 0), arg(args, 1), posArg(arg(args, 2), SIZE_MAX), true, call); });
+
+        method("split", [re](std::vector<QuantumValue> args) -> QuantumValue
+               { return splitBy(*re, arg(args, 0).toString(), posArg(arg(args, 1), SIZE_MAX)); });
+
+        return QuantumValue(obj);
+    }
+}
+
+void VM::registerRegexNatives()
+{
+    Caller call = [this](const QuantumValue &fn, std::vector<QuantumValue> args)
+    { return callFunction(fn, std::move(args)); };
+
+    auto re = std::make_shared<Dict>();
+    auto lib = methodsOf(re, "re.");
+    for (auto &[name, bit] : std::initializer_list<std::pair<const char *, unsigned>>{
+             {"I", rx::IgnoreCase}, {"IGNORECASE", rx::IgnoreCase}, {"M", rx::Multiline}, {"MULTILINE", rx::Multiline}, {"S", rx::DotAll}, {"DOTALL", rx::DotAll}})
+        (*re)[name] = QuantumValue(static_cast<double>(bit));
+
+    // re.compile(pattern, flags = 0)
+    lib("compile", [call](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty())
+            throw RuntimeError("re.compile() requires a pattern");
+        return makePattern(regexArg(args[0], arg(args, 1), "re.compile"), call); });
+
+    // re.search / match / fullmatch(pattern, string, flags = 0)
+    auto anchored = [](rx::Anchor anchor, const std::string &fn)
+    {
+        return [anchor, fn](std::vector<QuantumValue> args) -> QuantumValue
+        {
+            if (args.size() < 2)
+                throw RuntimeError(fn + "() requires a pattern and a string");
+            return execMatch(regexArg(args[0], arg(args, 2), fn), args[1], 0, anchor);
+        };
+    };
+    lib("search", anchored(rx::Anchor::None, "re.search"));
+    lib("match", anchored(rx::Anchor::Start, "re.match"));
+    lib("fullmatch", anchored(rx::Anchor::Both, "re.fullmatch"));
+
+    lib("test", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("re.test() requires a pattern and a string");
+        return QuantumValue(regexArg(args[0], arg(args, 2), "re.test")->test(args[1].toString())); });
+
+    lib("findall", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("re.findall() requires a pattern and a string");
+        return findAll(*regexArg(args[0], arg(args, 2), "re.findall"), args[1].toString(), 0); });
+
+    lib("finditer", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("re.finditer() requires a pattern and a string");
+        return findIter(regexArg(args[0], arg(args, 2), "re.finditer"), args[1], 0); });
+
+    // re.sub(pattern, repl, string, count = 0, flags = 0)
+    for (bool withCount : {false, true})
+    {
+        std::string fn = withCount ? "re.subn" : "re.sub";
+        lib(withCount ? "subn" : "sub", [call, withCount, fn](std::vector<QuantumValue> args) -> QuantumValue
+            {
+            if (args.size() < 3)
+                throw RuntimeError(fn + "() requires a pattern, a replacement and a string");
+            return substitute(regexArg(args[0], arg(args, 4), fn), args[1], args[2], posArg(arg(args, 3), SIZE_MAX), withCount, call); });
+    }
+
+    // re.split(pattern, string, maxsplit = 0, flags = 0)
+    lib("split", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("re.split() requires a pattern and a string");
+        return splitBy(*regexArg(args[0], arg(args, 3), "re.split"), args[1].toString(), posArg(arg(args, 2), SIZE_MAX)); });
+
+    // re.escape(text) — backslash before every character with a meaning in
+    // a pattern.
+    lib("escape", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        std::string in = arg(args, 0).toString(), out;
+        out.reserve(in.size());
+        for (char c : in)
+        {
+            if (std::string_view("()[]{}?*+-|^$\\.&~# \t\n\r\v\f/").find(c) != std::string_view::npos)
+                out += '\\';
+            out += c;
+        }
+        return QuantumValue(out); });
+
+    lib("purge", [](std::vector<QuantumValue>) -> QuantumValue
+        {
+        rx::purgeCache();
+        return QuantumValue(); });
+
+    globals->define("re", QuantumValue(re));
+}
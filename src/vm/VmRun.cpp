@@ -1,11 +1,44 @@
 #include "Vm.h"
 #include "Error.h"
+#include "Number.h"
 #include "Disassembler.h"
 #include <iostream>
 #include <string>
 #include <unordered_set>
 
+// ─── runFrame ────────────────────────────────────────────────────────────────
+// Errors thrown by natives and VM checks (RuntimeError, TypeError, ...) are
+// routed to the innermost script try/catch that belongs to this invocation,
+// the same way RAISE does; the handler receives the error message.
+
 void VM::runFrame(size_t stopDepth)
+{
+    for (;;)
+    {
+        try
+        {
+            dispatch(stopDepth);
+            return;
+        }
+        catch (QuantumError &e)
+        {
+            if (stepCount_ > MAX_STEPS || handlers_.empty() ||
+                handlers_.back().frameDepth <= stopDepth)
+                throw;
+            ExceptionHandler h = handlers_.back();
+            handlers_.pop_back();
+            while (frames_.size() > h.frameDepth)
+                frames_.pop_back();
+            closeUpvalues(h.stackDepth);
+            while (stack_.size() > h.stackDepth)
+                stack_.pop_back();
+            push(QuantumValue(std::string(e.what())));
+            frames_.back().ip = h.catchIp;
+        }
+    }
+}
+
+void VM::dispatch(size_t stopDepth)
 {
     while (frames_.size() > stopDepth)
     {
@@ -522,6 +555,17 @@ void VM::runFrame(size_t stopDepth)
                 auto it = d.find(idx.toString());
                 push(it != d.end() ? it->second : QuantumValue());
             }
+            else if (obj.isBytes())
+            {
+                const QuantumBytes &b = *obj.asBytes();
+                long long i = (long long)toNumber(idx, "index", line);
+                if (i < 0)
+                    i += (long long)b.size();
+                if (i < 0 || i >= (long long)b.size())
+                    push(QuantumValue());
+                else
+                    push(QuantumValue((double)b.data()[i]));
+            }
             else
                 throw TypeError("Cannot index into " + obj.typeName(), line);
             break;
@@ -546,6 +590,16 @@ void VM::runFrame(size_t stopDepth)
             }
             else if (obj.isDict())
                 (*obj.asDict())[key.toString()] = val;
+            else if (obj.isBytes())
+            {
+                QuantumBytes &b = *obj.asBytes();
+                long long i = (long long)toNumber(key, "index", line);
+                if (i < 0)
+                    i += (long long)b.size();
+                if (i < 0 || i >= (long long)b.size())
+                    throw IndexError("Bytes index out of range", line);
+                b.data()[i] = (uint8_t)(long long)toNumber(val, "byte value", line);
+            }
             else
                 throw TypeError("Cannot index-assign " + obj.typeName(), line);
 
@@ -667,6 +721,11 @@ void VM::runFrame(size_t stopDepth)
                     push(QuantumValue((double)obj.asDict()->size()));
                     break;
                 }
+                if (obj.isBytes())
+                {
+                    push(QuantumValue((double)obj.asBytes()->size()));
+                    break;
+                }
             }
 
             // Built-in method (array/string/dict methods)
@@ -708,6 +767,30 @@ void VM::runFrame(size_t stopDepth)
             QuantumValue iterable = pop();
             std::shared_ptr<Array> src;
 
+            // Lazy iterators returned by natives (e.g. file.lines()) are used as-is
+            if (iterable.isNative() && iterable.asNative()->name == "__iter__")
+            {
+                push(iterable);
+                break;
+            }
+
+            // Bytes iterate as numbers, read straight from the view.
+            if (iterable.isBytes())
+            {
+                auto bytes = iterable.asBytes();
+                auto pos = std::make_shared<size_t>(0);
+                auto it = std::make_shared<QuantumNative>();
+                it->name = "__iter__";
+                it->fn = [bytes, pos](std::vector<QuantumValue>) -> QuantumValue
+                {
+                    if (*pos < bytes->size())
+                        return QuantumValue((double)bytes->data()[(*pos)++]);
+                    return QuantumValue();
+                };
+                push(QuantumValue(it));
+                break;
+            }
+
             if (iterable.isArray())
                 src = iterable.asArray();
             else if (iterable.isString())
@@ -769,7 +852,7 @@ void VM::runFrame(size_t stopDepth)
                 frame.ip += instr.operand;
                 break;
             }
-            push(next); // push loop variable value
+            push(isIterNil(next) ? QuantumValue() : next); // push loop variable value
             break;
         }
 
@@ -1013,13 +1096,21 @@ void VM::runFrame(size_t stopDepth)
             for (int i = n - 1; i >= 0; --i)
                 args[i] = pop();
 
+            // One write per print rather than one per piece.
+            std::string line;
             for (int i = 0; i < n; ++i)
             {
                 if (i > 0)
-                    std::cout << sep;
-                std::cout << args[i].toString();
+                    line += sep;
+                if (args[i].isNumber())
+                    number::append(line, args[i].asNumber());
+                else if (args[i].isString())
+                    line += args[i].asString();
+                else
+                    line += args[i].toString();
             }
-            std::cout << end;
+            line += end;
+            std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
             std::cout.flush();
             break;
         }
@@ -0,0 +1,594 @@
+#include "Vm.h"
+#include "Error.h"
+#include "MappedFile.h"
+#include "PatternSet.h"
+#include "Regex.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ─── Scanning natives ─────────────────────────────────────────────────────────
+// PatternSet: many literal signatures compiled once into an Aho-Corasick
+// automaton and run over strings, bytes buffers or whole files in a single
+// pass.  scan_files: grep over files, directories and globs on worker
+// threads, streaming matching lines back through a lazy iterator.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    using Method = std::function<void(const std::string &, QuantumNativeFunc)>;
+
+    Method methodsOf(std::shared_ptr<Dict> obj, const std::string &prefix)
+    {
+        return [obj, prefix](const std::string &name, QuantumNativeFunc fn)
+        {
+            auto nat = std::make_shared<QuantumNative>();
+            nat->name = prefix + name;
+            nat->fn = std::move(fn);
+            (*obj)[name] = QuantumValue(nat);
+        };
+    }
+
+    struct SetState
+    {
+        std::vector<std::string> patterns;
+        std::shared_ptr<const PatternSet> set;
+    };
+
+    // {limit: n} — stop after n matches; 0 or absent means no limit.
+    size_t limitArg(const std::vector<QuantumValue> &args, size_t i)
+    {
+        if (args.size() <= i || !args[i].isDict())
+            return SIZE_MAX;
+        auto &opts = *args[i].asDict();
+        auto it = opts.find("limit");
+        if (it == opts.end() || !it->second.isNumber() || it->second.asNumber() < 1)
+            return SIZE_MAX;
+        return static_cast<size_t>(it->second.asNumber());
+    }
+
+    // [{id, pattern, start, end}] in order of end offset.
+    QuantumValue matchArray(const SetState &s, std::string_view text, size_t limit)
+    {
+        std::vector<PatternSet::Match> found;
+        s.set->findAll(text, found, limit);
+        auto out = std::make_shared<Array>();
+        out->reserve(found.size());
+        for (auto &m : found)
+        {
+            auto d = std::make_shared<Dict>();
+            (*d)["id"] = QuantumValue(static_cast<double>(m.pattern));
+            (*d)["pattern"] = QuantumValue(s.patterns[m.pattern]);
+            (*d)["start"] = QuantumValue(static_cast<double>(m.start));
+            (*d)["end"] = QuantumValue(static_cast<double>(m.end));
+            out->push_back(QuantumValue(d));
+        }
+        return QuantumValue(out);
+    }
+
+    // find_all(text, {limit}) — every occurrence, overlapping ones too.
+    // text may be a string or bytes.  A named type rather than a lambda so
+    // that scan_files can recognise a PatternSet object by this method.
+    struct FindAll
+    {
+        std::shared_ptr<SetState> state;
+
+        QuantumValue operator()(std::vector<QuantumValue> args) const
+        {
+            if (args.empty())
+                throw RuntimeError("PatternSet.find_all() requires a string or bytes");
+            std::string scratch;
+            return matchArray(*state, args[0].bytesView(scratch), limitArg(args, 1));
+        }
+    };
+
+    QuantumValue makePatternSet(std::shared_ptr<SetState> state)
+    {
+        auto obj = std::make_shared<Dict>();
+        auto method = methodsOf(obj, "PatternSet.");
+        (*obj)["mode"] = QuantumValue(std::string(state->set->mode()));
+        (*obj)["prefilter"] = QuantumValue(std::string(state->set->prefilter()));
+
+        method("find_all", FindAll{state});
+
+        method("any", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty())
+                return QuantumValue(false);
+            std::string scratch;
+            return QuantumValue(state->set->any(args[0].bytesView(scratch))); });
+
+        method("count", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty())
+                return QuantumValue(0.0);
+            std::string scratch;
+            return QuantumValue(static_cast<double>(state->set->count(args[0].bytesView(scratch)))); });
+
+        // scan_file(path, {limit}) — find_all over a file, memory-mapped
+        // where possible; nil if it can't be opened.
+        method("scan_file", [state](std::vector<QuantumValue> args) -> QuantumValue
+               {
+            if (args.empty())
+                throw RuntimeError("PatternSet.scan_file() requires a path");
+            auto mf = MappedFile::open(args[0].toString());
+            if (!mf)
+                return QuantumValue();
+            mf->spool();
+            mf->adviseSequential();
+            return matchArray(*state, std::string_view(mf->data(), mf->size()), limitArg(args, 1)); });
+
+        method("size", [state](std::vector<QuantumValue>) -> QuantumValue
+               { return QuantumValue(static_cast<double>(state->patterns.size())); });
+
+        method("patterns", [state](std::vector<QuantumValue>) -> QuantumValue
+               {
+            auto out = std::make_shared<Array>();
+            for (auto &p : state->patterns)
+                out->push_back(QuantumValue(p));
+            return QuantumValue(out); });
+
+        return QuantumValue(obj);
+    }
+
+    // ─── scan_files ──────────────────────────────────────────────────────────
+
+    constexpr size_t kBatchHits = 256;       // hits per batch handed to the VM
+    constexpr size_t kMaxQueuedHits = 65536; // workers wait beyond this
+
+    bool caseOption(const QuantumValue &opts)
+    {
+        bool fold = false;
+        if (!opts.isDict())
+            return fold;
+        for (const char *key : {"case_insensitive", "caseInsensitive", "ignore_case"})
+        {
+            auto it = opts.asDict()->find(key);
+            if (it != opts.asDict()->end())
+                fold = it->second.isTruthy();
+        }
+        return fold;
+    }
+
+    std::shared_ptr<SetState> patternSetOf(const QuantumValue &v)
+    {
+        if (!v.isDict())
+            return nullptr;
+        auto &d = *v.asDict();
+        auto it = d.find("find_all");
+        if (it == d.end() || !it->second.isNative())
+            return nullptr;
+        auto *f = it->second.asNative()->fn.target<FindAll>();
+        return f ? f->state : nullptr;
+    }
+
+    // Literals and pattern sets run on an automaton shared by every worker;
+    // a regex is recompiled per worker, since compiled regexes keep their
+    // lazily built DFA states in place.
+    struct Matcher
+    {
+        std::shared_ptr<const PatternSet> set;
+        std::string regex;
+        unsigned flags = 0;
+    };
+
+    // Finds the lines of a buffer that hold a match.  The matcher runs over
+    // the whole buffer rather than line by line: the first match end it
+    // reports names the first line that can match, and only that line is
+    // checked on its own.  ^ and $ are taken per line.
+    class LineFinder
+    {
+    public:
+        explicit LineFinder(const Matcher &m) : set_(m.set)
+        {
+            if (set_)
+                return;
+            std::string error;
+            re_ = rx::cached(m.regex, m.flags | rx::Multiline, error);
+            perLine_ = re_ && std::strcmp(re_->engine(), "dfa") != 0;
+        }
+
+        // Start of the first matching line at or after pos, with its end
+        // (the '\n' or the end of text) in lineEnd; npos when none is left.
+        size_t next(std::string_view text, size_t pos, size_t &lineEnd)
+        {
+            while ((set_ || re_) && pos < text.size())
+            {
+                size_t ls = pos;
+                if (!perLine_)
+                {
+                    size_t e = matchEnd(text, pos);
+                    if (e == std::string_view::npos)
+                        return e;
+                    for (size_t i = std::min(e, text.size()); i > pos; i--)
+                        if (text[i - 1] == '\n')
+                        {
+                            ls = i;
+                            break;
+                        }
+                }
+                size_t le = text.find('\n', ls);
+                lineEnd = le == std::string_view::npos ? text.size() : le;
+                if (set_ || re_->test(text.substr(ls, lineEnd - ls)))
+                    return ls;
+                pos = lineEnd + 1;
+            }
+            return std::string_view::npos;
+        }
+
+    private:
+        size_t matchEnd(std::string_view text, size_t pos)
+        {
+            if (!set_)
+                return re_->firstEnd(text, pos);
+            found_.clear();
+            set_->findAll(text.substr(pos), found_, 1);
+            return found_.empty() ? std::string_view::npos : pos + found_[0].end;
+        }
+
+        std::shared_ptr<const PatternSet> set_;
+        std::shared_ptr<rx::Regex> re_;
+        bool perLine_ = false; // std::regex fallback: no whole-buffer search
+        std::vector<PatternSet::Match> found_;
+    };
+
+    struct Hit
+    {
+        size_t lineNo;
+        std::string line;
+    };
+
+    struct Batch
+    {
+        size_t file;
+        std::vector<Hit> hits;
+    };
+
+    struct ScanState
+    {
+        std::vector<std::string> files;
+        Matcher matcher;
+        size_t maxMatches = SIZE_MAX;
+
+        std::atomic<size_t> nextFile{0};
+        std::atomic<size_t> found{0};
+        std::atomic<bool> stop{false};
+
+        std::mutex mu;
+        std::condition_variable ready; // a batch was queued or a worker quit
+        std::condition_variable room;  // the queue drained below the cap
+        std::deque<Batch> queue;
+        size_t queuedHits = 0;
+        size_t running = 0;
+    };
+
+    void scanWorker(std::shared_ptr<ScanState> st)
+    {
+        LineFinder finder(st->matcher);
+        Batch batch;
+        auto flush = [&]
+        {
+            if (batch.hits.empty())
+                return;
+            std::unique_lock<std::mutex> lock(st->mu);
+            st->room.wait(lock, [&]
+                          { return st->queuedHits < kMaxQueuedHits || st->stop; });
+            if (st->stop && st->found < st->maxMatches)
+                return; // abandoned by the reader
+            st->queuedHits += batch.hits.size();
+            size_t file = batch.file;
+            st->queue.push_back(std::move(batch));
+            batch = Batch{file, {}};
+            st->ready.notify_one();
+        };
+
+        for (size_t i; !st->stop && (i = st->nextFile++) < st->files.size();)
+        {
+            auto mf = MappedFile::open(st->files[i]);
+            if (!mf)
+                continue; // unreadable files are skipped, as grep -s does
+            mf->spool();
+            mf->adviseSequential();
+            std::string_view text(mf->data(), mf->size());
+            batch.file = i;
+            size_t pos = 0, counted = 0, lineNo = 1, lineEnd;
+            while (!st->stop)
+            {
+                size_t ls = finder.next(text, pos, lineEnd);
+                if (ls == std::string_view::npos)
+                    break;
+                lineNo += static_cast<size_t>(std::count(text.begin() + counted, text.begin() + ls, '\n'));
+                counted = ls;
+                if (st->found++ >= st->maxMatches)
+                {
+                    st->stop = true;
+                    break;
+                }
+                size_t le = lineEnd > ls && text[lineEnd - 1] == '\r' ? lineEnd - 1 : lineEnd;
+                batch.hits.push_back({lineNo, std::string(text.substr(ls, le - ls))});
+                if (batch.hits.size() >= kBatchHits)
+                    flush();
+                pos = lineEnd + 1;
+            }
+            flush();
+        }
+
+        std::lock_guard<std::mutex> lock(st->mu);
+        st->running--;
+        st->ready.notify_all();
+    }
+
+    // Owned by the iterator; dropping it stops and joins the workers.
+    struct ScanCursor
+    {
+        std::shared_ptr<ScanState> st;
+        std::vector<std::thread> pool;
+        Batch batch;
+        size_t next = 0;
+
+        ~ScanCursor()
+        {
+            {
+                std::lock_guard<std::mutex> lock(st->mu);
+                st->stop = true;
+                st->room.notify_all();
+            }
+            for (auto &t : pool)
+                t.join();
+        }
+    };
+
+    // '*' and '?' stay within a path component, '**' spans any number of
+    // them, and [a-z] / [!a-z] match one character from a set.
+    bool globMatch(const char *p, const char *pe, const char *s, const char *se)
+    {
+        while (p < pe)
+        {
+            if (*p == '*')
+            {
+                bool deep = p + 1 < pe && p[1] == '*';
+                p += deep ? 2 : 1;
+                if (deep && p < pe && *p == '/' && globMatch(p + 1, pe, s, se))
+                    return true; // "**/" may stand for no directories at all
+                for (const char *t = s;; t++)
+                {
+                    if (globMatch(p, pe, t, se))
+                        return true;
+                    if (t == se || (!deep && *t == '/'))
+                        return false;
+                }
+            }
+            if (s == se)
+                return false;
+            if (*p == '[')
+            {
+                const char *q = p + 1;
+                bool negate = q < pe && (*q == '!' || *q == '^');
+                if (negate)
+                    q++;
+                bool hit = false;
+                for (bool first = true; q < pe && (first || *q != ']'); first = false)
+                {
+                    char lo = *q++, hi = lo;
+                    if (q + 1 < pe && *q == '-' && q[1] != ']')
+                    {
+                        hi = q[1];
+                        q += 2;
+                    }
+                    hit |= *s >= lo && *s <= hi;
+                }
+                if (q < pe)
+                {
+                    if (hit == negate || *s == '/')
+                        return false;
+                    p = q + 1;
+                    s++;
+                    continue;
+                }
+                // no closing ']': an ordinary character
+            }
+            if (*p == '?' ? *s == '/' : *p != *s)
+                return false;
+            p++;
+            s++;
+        }
+        return s == se;
+    }
+
+    bool hasWildcard(const std::string &s)
+    {
+        return s.find_first_of("*?[") != std::string::npos;
+    }
+
+    // Regular files under dir, sorted, descending at most maxDepth levels.
+    void walk(const fs::path &dir, size_t maxDepth, std::vector<std::string> &out,
+              const std::string *pattern = nullptr)
+    {
+        std::error_code ec;
+        std::vector<std::string> found;
+        fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end;
+        for (; !ec && it != end; it.increment(ec))
+        {
+            if (it->is_directory(ec))
+            {
+                if (static_cast<size_t>(it.depth()) + 1 >= maxDepth)
+                    it.disable_recursion_pending();
+                continue;
+            }
+            if (!it->is_regular_file(ec))
+                continue;
+            std::string path = it->path().generic_string();
+            if (dir == "." && path.compare(0, 2, "./") == 0)
+                path.erase(0, 2);
+            if (!pattern || globMatch(pattern->data(), pattern->data() + pattern->size(), path.data(), path.data() + path.size()))
+                found.push_back(std::move(path));
+        }
+        std::sort(found.begin(), found.end());
+        out.insert(out.end(), found.begin(), found.end());
+    }
+
+    // A file, a directory (scanned recursively) or a glob.
+    void expandPath(std::string spec, std::vector<std::string> &out)
+    {
+        std::replace(spec.begin(), spec.end(), '\\', '/');
+        std::error_code ec;
+        if (!hasWildcard(spec))
+        {
+            if (fs::is_directory(spec, ec))
+                walk(spec, SIZE_MAX, out);
+            else
+                out.push_back(spec);
+            return;
+        }
+        // Walk from the last directory before the first wildcard, only as
+        // deep as the pattern reaches.
+        size_t wild = spec.find_first_of("*?[");
+        size_t slash = spec.rfind('/', wild);
+        std::string base = slash == std::string::npos ? "." : spec.substr(0, slash == 0 ? 1 : slash);
+        std::string rest = slash == std::string::npos ? spec : spec.substr(slash + 1);
+        size_t depth = rest.find("**") != std::string::npos
+                           ? SIZE_MAX
+                           : static_cast<size_t>(std::count(rest.begin(), rest.end(), '/')) + 1;
+        walk(base, depth, out, &spec);
+    }
+}
+
+void VM::registerScanNatives()
+{
+    auto reg = [&](const std::string &name, QuantumNativeFunc fn)
+    {
+        auto nat = std::make_shared<QuantumNative>();
+        nat->name = name;
+        nat->fn = std::move(fn);
+        globals->define(name, QuantumValue(nat));
+    };
+
+    // PatternSet(patterns, {case_insensitive}) — patterns is an array of
+    // strings or bytes; a match's id is its index in that array.
+    reg("PatternSet", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.empty() || !args[0].isArray())
+            throw RuntimeError("PatternSet() requires an array of patterns");
+        bool fold = args.size() > 1 && caseOption(args[1]);
+        auto state = std::make_shared<SetState>();
+        auto &list = *args[0].asArray();
+        state->patterns.reserve(list.size());
+        std::string scratch;
+        for (auto &p : list)
+            state->patterns.emplace_back(p.bytesView(scratch));
+        std::vector<std::string_view> views(state->patterns.begin(), state->patterns.end());
+        state->set = std::make_shared<PatternSet>(views, fold);
+        return makePatternSet(state); });
+
+    // scan_files(paths, matcher, {threads, max_matches, case_insensitive})
+    // — paths is a file, directory or glob ("logs/**/*.log"), or an array
+    // of them; matcher is a literal string, an array of literals, a
+    // compiled regex or a PatternSet.  Returns a lazy iterator of
+    // {path, line_no, line}; lines from one file arrive in order, files in
+    // whatever order the workers finish them.
+    reg("scan_files", [](std::vector<QuantumValue> args) -> QuantumValue
+        {
+        if (args.size() < 2)
+            throw RuntimeError("scan_files() requires paths and a matcher");
+        const QuantumValue nil;
+        const QuantumValue &opts = args.size() > 2 ? args[2] : nil;
+        auto st = std::make_shared<ScanState>();
+
+        if (args[0].isString())
+            expandPath(args[0].asString(), st->files);
+        else if (args[0].isArray())
+        {
+            for (auto &p : *args[0].asArray())
+                expandPath(p.toString(), st->files);
+        }
+        else
+            throw RuntimeError("scan_files(): paths must be a path, a glob or an array of them");
+
+        const QuantumValue &m = args[1];
+        if (auto set = patternSetOf(m))
+            st->matcher.set = set->set;
+        else if (m.isString() || m.isBytes() || m.isArray())
+        {
+            std::vector<std::string> literals;
+            std::string scratch;
+            if (m.isArray())
+                for (auto &v : *m.asArray())
+                    literals.emplace_back(v.bytesView(scratch));
+            else
+                literals.emplace_back(m.bytesView(scratch));
+            std::vector<std::string_view> views(literals.begin(), literals.end());
+            st->matcher.set = std::make_shared<PatternSet>(views, caseOption(opts));
+        }
+        else if (m.isDict() && m.asDict()->count("pattern") && m.asDict()->count("flags"))
+        {
+            // A pattern object from re.compile(); compiled here once so that
+            // errors surface now rather than on a worker.
+            st->matcher.regex = m.asDict()->at("pattern").toString();
+            const QuantumValue &f = m.asDict()->at("flags");
+            st->matcher.flags = f.isNumber() ? static_cast<unsigned>(f.asNumber()) : 0;
+            if (caseOption(opts))
+                st->matcher.flags |= rx::IgnoreCase;
+            std::string error;
+            if (!rx::cached(st->matcher.regex, st->matcher.flags | rx::Multiline, error))
+                throw RuntimeError("scan_files(): " + error);
+        }
+        else
+            throw RuntimeError("scan_files(): matcher must be a string, an array of strings, a compiled regex or a PatternSet");
+
+        size_t threads = 0;
+        if (opts.isDict())
+        {
+            auto &o = *opts.asDict();
+            auto it = o.find("threads");
+            if (it != o.end() && it->second.isNumber() && it->second.asNumber() > 0)
+                threads = static_cast<size_t>(it->second.asNumber());
+            it = o.find("max_matches");
+            if (it != o.end() && it->second.isNumber() && it->second.asNumber() >= 0)
+                st->maxMatches = static_cast<size_t>(it->second.asNumber());
+        }
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max<size_t>(1, std::min(threads, st->files.size()));
+
+        auto cur = std::make_shared<ScanCursor>();
+        cur->st = st;
+        st->running = threads;
+        for (size_t t = 0; t < threads; t++)
+            cur->pool.emplace_back(scanWorker, st);
+
+        auto iter = std::make_shared<QuantumNative>();
+        iter->name = "__iter__";
+        iter->fn = [cur](std::vector<QuantumValue>) -> QuantumValue
+        {
+            ScanState &s = *cur->st;
+            while (cur->next >= cur->batch.hits.size())
+            {
+                std::unique_lock<std::mutex> lock(s.mu);
+                s.ready.wait(lock, [&]
+                             { return !s.queue.empty() || s.running == 0; });
+                if (s.queue.empty())
+                    return QuantumValue();
+                cur->batch = std::move(s.queue.front());
+                cur->next = 0;
+                s.queue.pop_front();
+                s.queuedHits -= cur->batch.hits.size();
+                s.room.notify_all();
+            }
+            Hit &h = cur->batch.hits[cur->next++];
+            auto d = std::make_shared<Dict>();
+            (*d)["path"] = QuantumValue(s.files[cur->batch.file]);
+            (*d)["line_no"] = QuantumValue(static_cast<double>(h.lineNo));
+            (*d)["line"] = QuantumValue(std::move(h.line));
+            return QuantumValue(d);
+        };
+        return QuantumValue(iter); });
+}
@@ -1,10 +1,10 @@
 #include "Vm.h"
 #include "Error.h"
+#include "Regex.h"
 #include <algorithm>
 #include <cctype>
 #include <limits>
 #include <memory>
-#include <regex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -74,19 +74,35 @@ QuantumValue VM::callStringMethod(const std::string &str, const std::string &m,
         {
             size_t lastSlash = sep.find_last_of('/');
             std::string pattern = sep.substr(1, lastSlash - 1);
-            std::regex::flag_type flags = std::regex::ECMAScript;
-            if (sep.substr(lastSlash + 1).find('i') != std::string::npos)
-                flags |= std::regex::icase;
-            try
-            {
-                std::regex re(pattern, flags);
-                std::sregex_token_iterator it(str.begin(), str.end(), re, -1), end;
-                for (; it != end; ++it)
-                    arr->push_back(QuantumValue(it->str()));
-            }
-            catch (const std::regex_error &)
-            {
+            unsigned flags = 0;
+            std::string error;
+            std::shared_ptr<rx::Regex> re;
+            if (rx::parseFlags(sep.substr(lastSlash + 1), flags))
+                re = rx::cached(pattern, flags, error);
+            if (!re)
                 arr->push_back(QuantumValue(str));
+            else
+            {
+                // Pieces between matches; an empty match only splits when it
+                // is not where the previous piece ended, and an empty tail is
+                // dropped.
+                std::vector<rx::Span> g;
+                size_t piece = 0, pos = 0;
+                while (pos <= str.size() && re->exec(str, pos, rx::Anchor::None, &g))
+                {
+                    if (g[0].end == g[0].start)
+                    {
+                        pos = g[0].end + 1;
+                        if (g[0].start == piece || g[0].start == str.size())
+                            continue;
+                    }
+                    else
+                        pos = g[0].end;
+                    arr->push_back(QuantumValue(str.substr(piece, g[0].start - piece)));
+                    piece = g[0].end;
+                }
+                if (piece < str.size())
+                    arr->push_back(QuantumValue(str.substr(piece)));
             }
         }
         else
@@ -273,18 +289,14 @@ QuantumValue VM::callStringMethod(const std::string &str, const std::string &m,
             if (lastSlash != 0 && lastSlash != std::string::npos)
             {
                 std::string pattern = str.substr(1, lastSlash - 1);
-                std::string flags = str.substr(lastSlash + 1);
-                std::regex::flag_type regexFlags = std::regex::ECMAScript;
-                if (flags.find('i') != std::string::npos)
-                    regexFlags |= std::regex::icase;
-                try
-                {
-                    return QuantumValue(std::regex_search(args[0].toString(), std::regex(pattern, regexFlags)));
-                }
-                catch (const std::regex_error &)
-                {
-                    return QuantumValue(args[0].toString().find(pattern) != std::string::npos);
-                }
+                unsigned flags = 0;
+                std::string error;
+                std::shared_ptr<rx::Regex> re;
+                if (rx::parseFlags(str.substr(lastSlash + 1), flags))
+                    re = rx::cached(pattern, flags, error);
+                if (re)
+                    return QuantumValue(re->test(args[0].toString()));
+                return QuantumValue(args[0].toString().find(pattern) != std::string::npos);
             }
         }
         return QuantumValue(args[0].toString().find(str) != std::string::npos);